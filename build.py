@@ -221,6 +221,7 @@ CTX.INPUT['common'] = """
 CTX.INPUT['execution'] = """
  FragmentManager.cpp
  JNITopend.cpp
+ SharedPlanCache.cpp
  VoltDBEngine.cpp
 """
 
@@ -237,6 +238,7 @@ CTX.INPUT['executors'] = """
  limitexecutor.cpp
  materializeexecutor.cpp
  materializedscanexecutor.cpp
+ mergejoinexecutor.cpp
  nestloopexecutor.cpp
  nestloopindexexecutor.cpp
  orderbyexecutor.cpp
@@ -271,6 +273,7 @@ CTX.INPUT['plannodes'] = """
  limitnode.cpp
  materializenode.cpp
  materializedscanplannode.cpp
+ mergejoinnode.cpp
  nestloopindexnode.cpp
  nestloopnode.cpp
  orderbynode.cpp
@@ -283,6 +286,7 @@ CTX.INPUT['plannodes'] = """
  seqscannode.cpp
  unionnode.cpp
  updatenode.cpp
+ windowfunctionnode.cpp
 """
 
 CTX.INPUT['indexes'] = """
@@ -298,10 +302,12 @@ CTX.INPUT['storage'] = """
  CopyOnWriteIterator.cpp
  ConstraintFailureException.cpp
  TableStreamer.cpp
+ TableImage.cpp
  ElasticScanner.cpp
  MaterializedViewMetadata.cpp
  persistenttable.cpp
  PersistentTableStats.cpp
+ SharedSchemaCache.cpp
  StreamedTableStats.cpp
  streamedtable.cpp
  table.cpp
@@ -311,9 +317,12 @@ CTX.INPUT['storage'] = """
  tableutil.cpp
  temptable.cpp
  TempTableLimits.cpp
+ TempBlockPool.cpp
+ TupleSpill.cpp
  TupleStreamWrapper.cpp
  RecoveryContext.cpp
  TupleBlock.cpp
+ TupleMigration.cpp
  TableStreamerContext.cpp
  ElasticIndex.cpp
  ElasticIndexReadContext.cpp
@@ -378,6 +387,7 @@ if whichtests in ("${eetestsuite}", "common"):
      pool_test
      tabletuple_test
      elastic_hashinator_test
+     tuple_hash_table_test
     """
 
 if whichtests in ("${eetestsuite}", "execution"):
@@ -385,6 +395,17 @@ if whichtests in ("${eetestsuite}", "execution"):
      add_drop_table
      engine_test
      FragmentManagerTest
+     SharedPlanCacheTest
+    """
+
+if whichtests in ("${eetestsuite}", "executors"):
+    CTX.TESTS['executors'] = """
+     IndexScanExecutorTest
+     MergeJoinExecutorTest
+     NestLoopExecutorTest
+     OrderByExecutorTest
+     SpillingExecutorTest
+     WindowFunctionExecutorTest
     """
 
 if whichtests in ("${eetestsuite}", "expressions"):
@@ -409,11 +430,13 @@ if whichtests in ("${eetestsuite}", "storage"):
      persistent_table_log_test
      PersistentTableMemStatsTest
      serialize_test
+     SharedSchemaCacheTest
      StreamedTable_test
      table_and_indexes_test
      table_test
      tabletuple_export_test
      TempTableLimitsTest
+     TupleSpillTest
      TupleStreamWrapper_test
     """
 
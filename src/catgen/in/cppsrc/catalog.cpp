@@ -30,6 +30,7 @@
 #include "cluster.h"
 #include "common/SerializableEEException.h"
 #include "common/MiscUtil.h"
+#include "common/serializeio.h"
 
 using namespace voltdb;
 using namespace catalog;
@@ -57,15 +58,26 @@ Catalog::~Catalog() {
  * Clear the wasAdded/wasUpdated and deletion path lists.
  */
 void Catalog::cleanupExecutionBookkeeping() {
-    // sad there isn't clean syntax to for_each a map's pair->second
-    boost::unordered_map<std::string, CatalogType*>::iterator iter;
-    for (iter = m_allCatalogObjects.begin(); iter != m_allCatalogObjects.end(); iter++) {
-        CatalogType *ct = iter->second;
+    // only the objects touched by the last execute need clearing
+    boost::unordered_set<CatalogType*>::iterator iter;
+    for (iter = m_changedObjects.begin(); iter != m_changedObjects.end(); iter++) {
+        CatalogType *ct = *iter;
         ct->clearUpdateStatus();
     }
+    m_changedObjects.clear();
     m_deletions.clear();
 }
 
+/*
+ * Flag item and its ancestors as changed by the current execute.
+ */
+void Catalog::markChanged(CatalogType *item) {
+    for (CatalogType *ct = item; ct != NULL && !ct->m_wasChanged; ct = ct->m_parent) {
+        ct->m_wasChanged = true;
+        m_changedObjects.insert(ct);
+    }
+}
+
 void Catalog::purgeDeletions() {
     for (std::vector<std::string>::iterator i = m_deletions.begin();
          i != m_deletions.end();
@@ -84,9 +96,21 @@ void Catalog::purgeDeletions() {
 void Catalog::execute(const string &stmts) {
     cleanupExecutionBookkeeping();
 
-    vector<string> lines = MiscUtil::splitString(stmts, '\n');
-    for (int32_t i = 0; i < lines.size(); ++i) {
-        executeOne(lines[i]);
+    if (isBinaryDiff(stmts)) {
+        executeBinary(stmts);
+    }
+    else {
+        size_t pos = 0;
+        while (pos < stmts.length()) {
+            size_t end = stmts.find('\n', pos);
+            if (end == string::npos) {
+                end = stmts.length();
+            }
+            if (end > pos) {
+                executeOne(stmts.substr(pos, end - pos));
+            }
+            pos = end + 1;
+        }
     }
 
     if (m_unresolved.size() > 0) {
@@ -154,28 +178,48 @@ void Catalog::executeOne(const string &stmt) {
         m_lastUsedPath = item;
     }
 
-    // execute
+    char op = 0;
     if (command.compare("add") == 0) {
+        op = BINARY_DIFF_ADD;
+    }
+    else if (command.compare("set") == 0) {
+        op = BINARY_DIFF_SET;
+    }
+    else if (command.compare("delete") == 0) {
+        op = BINARY_DIFF_DELETE;
+    }
+    executeCommand(item, op, coll, child);
+}
+
+/*
+ * Apply one parsed catalog command to item.
+ */
+void Catalog::executeCommand(CatalogType *item, char op,
+                             const string &coll, const string &child) {
+    if (op == BINARY_DIFF_ADD) {
         CatalogType *type = item->addChild(coll, child);
         if (type == NULL) {
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                            "Catalog failed to add child.");
         }
         type->added();
+        markChanged(type);
         resolveUnresolvedInfo(type->path());
     }
-    else if (command.compare("set") == 0) {
+    else if (op == BINARY_DIFF_SET) {
         item->set(coll, child);
         item->updated();
+        markChanged(item);
     }
-    else if (command.compare("delete") == 0) {
+    else if (op == BINARY_DIFF_DELETE) {
         // remove from collection and hash path to the deletion tracker
         // throw if nothing was removed.
         if(item->removeChild(coll, child)) {
-            m_deletions.push_back(ref + "/" + coll + "[" + child + "]");
+            m_deletions.push_back(item->path() + "/" + coll + "[" + child + "]");
+            markChanged(item);
         }
         else {
-            std::string errmsg = "Catalog reference for " + ref + " not found.";
+            std::string errmsg = "Catalog reference for " + item->path() + " not found.";
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, errmsg);
         }
     }
@@ -185,6 +229,90 @@ void Catalog::executeOne(const string &stmt) {
     }
 }
 
+bool Catalog::isBinaryDiff(const string &stmts) {
+    return stmts.length() >= BINARY_DIFF_MAGIC_LENGTH &&
+        stmts.compare(0, BINARY_DIFF_MAGIC_LENGTH, binaryDiffMagic(), BINARY_DIFF_MAGIC_LENGTH) == 0;
+}
+
+/*
+ * Run a binary diff: each referenced object is looked up once, then
+ * all of its commands are applied to it.
+ */
+void Catalog::executeBinary(const string &stmts) {
+    ReferenceSerializeInput in(stmts.data() + BINARY_DIFF_MAGIC_LENGTH,
+                               stmts.length() - BINARY_DIFF_MAGIC_LENGTH);
+    while (in.hasRemaining()) {
+        string ref = in.readTextString();
+        CatalogType *item = itemForRef(ref);
+        if (item == NULL) {
+            std::string errmsg = "Catalog reference for " + ref + " not found.";
+            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, errmsg);
+        }
+        m_lastUsedPath = item;
+
+        int32_t commandCount = in.readInt();
+        for (int32_t i = 0; i < commandCount; ++i) {
+            char op = in.readChar();
+            string coll = in.readTextString();
+            string child = in.readTextString();
+            executeCommand(item, op, coll, child);
+        }
+    }
+}
+
+string Catalog::toBinaryDiff(const string &stmts) {
+    CopySerializeOutput out;
+    out.writeBytes(binaryDiffMagic(), BINARY_DIFF_MAGIC_LENGTH);
+
+    string lastRef;
+    size_t countPosition = 0;
+    int32_t count = 0;
+    vector<string> lines = MiscUtil::splitString(stmts, '\n');
+    for (int32_t i = 0; i < lines.size(); ++i) {
+        if (lines[i].empty()) {
+            continue;
+        }
+        string command, ref, coll, child;
+        parse(lines[i], command, ref, coll, child);
+
+        // a new group for each change of referenced object
+        if (ref.compare("$PREV") == 0) {
+            if (lastRef.empty()) {
+                std::string errmsg = "$PREV reference was not preceded by a cached reference.";
+                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, errmsg);
+            }
+        }
+        else if (count == 0 || ref != lastRef) {
+            if (count > 0) {
+                out.writeIntAt(countPosition, count);
+            }
+            out.writeTextString(ref);
+            countPosition = out.reserveBytes(sizeof(int32_t));
+            count = 0;
+            lastRef = ref;
+        }
+
+        char op = 0;
+        if (command.compare("add") == 0) {
+            op = BINARY_DIFF_ADD;
+        }
+        else if (command.compare("set") == 0) {
+            op = BINARY_DIFF_SET;
+        }
+        else if (command.compare("delete") == 0) {
+            op = BINARY_DIFF_DELETE;
+        }
+        out.writeChar(op);
+        out.writeTextString(coll);
+        out.writeTextString(child);
+        ++count;
+    }
+    if (count > 0) {
+        out.writeIntAt(countPosition, count);
+    }
+    return string(out.data(), out.size());
+}
+
 const CatalogMap<Cluster> & Catalog::clusters() const {
     return m_clusters;
 }
@@ -246,6 +374,7 @@ void Catalog::unregisterGlobally(CatalogType *catObj) {
     if (iter != m_allCatalogObjects.end()) {
         m_allCatalogObjects.erase(iter);
     }
+    m_changedObjects.erase(catObj);
 }
 
 void Catalog::update() {
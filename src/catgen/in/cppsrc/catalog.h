@@ -27,6 +27,7 @@
 #include <string>
 #include <list>
 #include "boost/unordered_map.hpp"
+#include "boost/unordered_set.hpp"
 #include "catalogtype.h"
 #include "catalogmap.h"
 
@@ -63,7 +64,14 @@ protected:
     //  paths of objects recently deleted from the catalog.
     std::vector<std::string> m_deletions;
 
+    // objects added, set or with children deleted by the last execute,
+    // and their ancestors
+    boost::unordered_set<CatalogType*> m_changedObjects;
+
     void executeOne(const std::string &stmt);
+    void executeCommand(CatalogType *item, char op,
+                        const std::string &coll, const std::string &child);
+    void executeBinary(const std::string &stmts);
     CatalogType * itemForRef(const std::string &ref);
     CatalogType * itemForPath(const CatalogType *parent, const std::string &path);
     CatalogType * itemForPathPart(const CatalogType *parent, const std::string &pathPart) const;
@@ -80,6 +88,13 @@ protected:
 private:
     void resolveUnresolvedInfo(std::string path);
     void cleanupExecutionBookkeeping();
+    void markChanged(CatalogType *item);
+
+    static const char* binaryDiffMagic() { return "\0CDB"; }
+    static const size_t BINARY_DIFF_MAGIC_LENGTH = 4;
+    static const char BINARY_DIFF_ADD = 'a';
+    static const char BINARY_DIFF_SET = 's';
+    static const char BINARY_DIFF_DELETE = 'd';
 
 public:
     void purgeDeletions();
@@ -98,6 +113,16 @@ public:
      */
     void execute(const std::string &stmts);
 
+    /**
+     * Convert newline separated catalog commands into the binary diff form
+     * that execute also accepts. Consecutive commands on the same object
+     * are grouped under its path, which is then resolved once per group.
+     */
+    static std::string toBinaryDiff(const std::string &stmts);
+
+    /** True if stmts is in the binary diff form. */
+    static bool isBinaryDiff(const std::string &stmts);
+
     /** GETTER: The set of the clusters in this catalog */
     const CatalogMap<Cluster> & clusters() const;
 
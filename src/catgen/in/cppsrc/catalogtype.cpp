@@ -36,6 +36,9 @@ CatalogType::CatalogType(Catalog * catalog, CatalogType * parent, const string &
     m_name = name;
     m_path = path;
     m_relativeIndex = -1;
+    m_wasAdded = false;
+    m_wasUpdated = false;
+    m_wasChanged = false;
 
     if (this != m_catalog) {
         m_catalog->registerGlobally(this);
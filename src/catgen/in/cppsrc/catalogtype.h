@@ -53,6 +53,7 @@ class CatalogType {
     void clearUpdateStatus() {
         m_wasAdded = false;
         m_wasUpdated = false;
+        m_wasChanged = false;
     }
     void added() {
         m_wasAdded = true;
@@ -64,6 +65,7 @@ class CatalogType {
 
     bool m_wasAdded;     // victim of 'add' command in catalog update
     bool m_wasUpdated;   // target of 'set' command in catalog update
+    bool m_wasChanged;   // it or anything below it changed in catalog update
 
   protected:
     std::map<std::string, CatalogValue> m_fields;
@@ -126,6 +128,14 @@ public:
     bool wasUpdated() const {
         return m_wasUpdated;
     }
+
+    /**
+     * True if this object or any object below it was added, set or had
+     * children deleted by the last catalog update.
+     */
+    bool wasChanged() const {
+        return m_wasChanged;
+    }
 };
 
 }
@@ -19,13 +19,17 @@
 #define PLANNERDOMVALUE_H_
 
 #include "common/SerializableEEException.h"
+#include "common/serializeio.h"
 
 #include "rapidjson/document.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <climits>
+#include <limits>
 #include <inttypes.h>
+#include <string>
 
 namespace voltdb {
 
@@ -37,128 +41,303 @@ namespace voltdb {
      * It might require some fudging to move from rapidjson to jsoncpp or something,
      * but WAY less fudging than it would take to edit every bit of code that uses
      * this shim.
+     *
+     * A value is either a node of a parsed rapidjson document or a position in
+     * the binary form of a document described at PlannerDomRoot, which is read
+     * in place without building any DOM.
      */
     class PlannerDomValue {
         friend class PlannerDomRoot;
     public:
 
         int32_t asInt() const {
-            if (m_value.IsNull()) {
+            if (m_binary != NULL) {
+                switch (tag()) {
+                case TAG_NULL:
+                    break;
+                case TAG_TINYINT:
+                    return static_cast<int8_t>(m_binary[1]);
+                case TAG_INT:
+                    return readInt(m_binary + 1);
+                case TAG_STRING:
+                    return (int32_t) strtoimax(stringData(), NULL, 10);
+                default:
+                    throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                                  "PlannerDomValue: int value is not an integer");
+                }
+            }
+            if (isNullValue()) {
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                               "PlannerDomValue: int value is null");
             }
-            else if (m_value.IsInt()) {
-                return m_value.GetInt();
+            else if (m_value->IsInt()) {
+                return m_value->GetInt();
             }
-            else if (m_value.IsString()) {
-                return (int32_t) strtoimax(m_value.GetString(), NULL, 10);
+            else if (m_value->IsString()) {
+                return (int32_t) strtoimax(m_value->GetString(), NULL, 10);
             }
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                           "PlannerDomValue: int value is not an integer");
         }
 
         int64_t asInt64() const {
-            if (m_value.IsNull()) {
+            if (m_binary != NULL) {
+                switch (tag()) {
+                case TAG_NULL:
+                    break;
+                case TAG_INT64:
+                    return readLong(m_binary + 1);
+                case TAG_TINYINT:
+                    return static_cast<int8_t>(m_binary[1]);
+                case TAG_INT:
+                    return readInt(m_binary + 1);
+                case TAG_STRING:
+                    return (int64_t) strtoimax(stringData(), NULL, 10);
+                default:
+                    throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                                  "PlannerDomValue: int64 value is non-integral");
+                }
+            }
+            if (isNullValue()) {
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                               "PlannerDomValue: int64 value is null");
             }
-            else if (m_value.IsInt64()) {
-                return m_value.GetInt64();
+            else if (m_value->IsInt64()) {
+                return m_value->GetInt64();
             }
-            else if (m_value.IsInt()) {
-                return m_value.GetInt();
+            else if (m_value->IsInt()) {
+                return m_value->GetInt();
             }
-            else if (m_value.IsString()) {
-                return (int64_t) strtoimax(m_value.GetString(), NULL, 10);
+            else if (m_value->IsString()) {
+                return (int64_t) strtoimax(m_value->GetString(), NULL, 10);
             }
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                           "PlannerDomValue: int64 value is non-integral");
         }
 
         double asDouble() const {
-            if (m_value.IsNull()) {
+            if (m_binary != NULL) {
+                switch (tag()) {
+                case TAG_NULL:
+                    break;
+                case TAG_DOUBLE: {
+                    int64_t bits = readLong(m_binary + 1);
+                    double value;
+                    memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+                case TAG_TINYINT:
+                    return static_cast<int8_t>(m_binary[1]);
+                case TAG_INT:
+                    return readInt(m_binary + 1);
+                case TAG_INT64:
+                    return (double) readLong(m_binary + 1);
+                case TAG_STRING:
+                    return std::strtod(stringData(), NULL);
+                default:
+                    throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                                  "PlannerDomValue: double value is not a number");
+                }
+            }
+            if (isNullValue()) {
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                               "PlannerDomValue: double value is null");
             }
-            else if (m_value.IsDouble()) {
-                return m_value.GetDouble();
+            else if (m_value->IsDouble()) {
+                return m_value->GetDouble();
             }
-            else if (m_value.IsInt()) {
-                return m_value.GetInt();
+            else if (m_value->IsInt()) {
+                return m_value->GetInt();
             }
-            else if (m_value.IsInt64()) {
-                return (double) m_value.GetInt64();
+            else if (m_value->IsInt64()) {
+                return (double) m_value->GetInt64();
             }
-            else if (m_value.IsString()) {
-                return std::strtod(m_value.GetString(), NULL);
+            else if (m_value->IsString()) {
+                return std::strtod(m_value->GetString(), NULL);
             }
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
                                           "PlannerDomValue: double value is not a number");
         }
 
         bool asBool() const {
-            if (m_value.IsNull() || (m_value.IsBool() == false)) {
+            bool isBool = (m_binary != NULL) ?
+                (tag() == TAG_TRUE || tag() == TAG_FALSE) : m_value->IsBool();
+            if (!isBool) {
                 char msg[1024];
                 snprintf(msg, 1024, "PlannerDomValue: value is null or not a bool");
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
             }
-            return m_value.GetBool();
+            return (m_binary != NULL) ? (tag() == TAG_TRUE) : m_value->GetBool();
         }
 
         std::string asStr() const {
-            if (m_value.IsNull() || (m_value.IsString() == false)) {
+            bool isString = (m_binary != NULL) ? (tag() == TAG_STRING) : m_value->IsString();
+            if (!isString) {
                 char msg[1024];
                 snprintf(msg, 1024, "PlannerDomValue: value is null or not a string");
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
             }
-            return m_value.GetString();
+            if (m_binary != NULL) {
+                return std::string(stringData(), readInt(m_binary + 1));
+            }
+            return m_value->GetString();
 
         }
 
         bool hasKey(const char *key) const {
-            return m_value.HasMember(key);
+            if (m_binary != NULL) {
+                return findMember(key) != NULL;
+            }
+            return m_value->HasMember(key);
         }
 
         bool hasNonNullKey(const char *key) const {
+            if (m_binary != NULL) {
+                const char *member = findMember(key);
+                return member != NULL && *member != TAG_NULL;
+            }
             if (!hasKey(key)) {
                 return false;
             }
-            rapidjson::Value &value = m_value[key];
+            rapidjson::Value &value = (*m_value)[key];
             return !value.IsNull();
         }
 
         PlannerDomValue valueForKey(const char *key) const {
-            rapidjson::Value &value = m_value[key];
-            if (value.IsNull()) {
-                char msg[1024];
-                snprintf(msg, 1024, "PlannerDomValue: %s key is null or missing", key);
-                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
+            if (m_binary != NULL) {
+                const char *member = findMember(key);
+                if (member != NULL && *member != TAG_NULL) {
+                    return PlannerDomValue(member);
+                }
             }
-            return PlannerDomValue(value);
+            else {
+                rapidjson::Value &value = (*m_value)[key];
+                if (!value.IsNull()) {
+                    return PlannerDomValue(value);
+                }
+            }
+            char msg[1024];
+            snprintf(msg, 1024, "PlannerDomValue: %s key is null or missing", key);
+            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
         }
 
         int arrayLen() const {
-            if (m_value.IsArray() == false) {
+            bool isArray = (m_binary != NULL) ? (tag() == TAG_ARRAY) : m_value->IsArray();
+            if (isArray == false) {
                 char msg[1024];
                 snprintf(msg, 1024, "PlannerDomValue: value is not an array");
                 throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
             }
-            return m_value.Size();
+            return (m_binary != NULL) ? readInt(m_binary + 1) : m_value->Size();
         }
 
         PlannerDomValue valueAtIndex(int index) const {
-            if (m_value.IsArray() == false) {
-                char msg[1024];
-                snprintf(msg, 1024, "PlannerDomValue: value is not an array");
-                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
+            int length = arrayLen();
+            if (m_binary == NULL) {
+                return PlannerDomValue((*m_value)[index]);
+            }
+            if (index < 0 || index >= length) {
+                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                              "PlannerDomValue: array index out of bounds");
             }
-            return m_value[index];
+            // Elements can only be found by skipping their predecessors, so
+            // remember the last one found. Loops over the array then skip
+            // one element per call instead of starting over each time.
+            if (m_cursor == NULL || index < m_cursorIndex) {
+                m_cursor = m_binary + 1 + 2 * sizeof(int32_t);
+                m_cursorIndex = 0;
+            }
+            for (; m_cursorIndex < index; m_cursorIndex++) {
+                m_cursor = skipValue(m_cursor);
+            }
+            return PlannerDomValue(m_cursor);
         }
 
     private:
-        PlannerDomValue(rapidjson::Value &value) : m_value(value) {}
+        // Type tags of the binary form, see PlannerDomRoot.
+        enum {
+            TAG_NULL = 0,
+            TAG_FALSE = 1,
+            TAG_TRUE = 2,
+            TAG_TINYINT = 3,
+            TAG_INT = 4,
+            TAG_INT64 = 5,
+            TAG_DOUBLE = 6,
+            TAG_STRING = 7,
+            TAG_ARRAY = 8,
+            TAG_OBJECT = 9
+        };
+
+        PlannerDomValue(rapidjson::Value &value) :
+            m_value(&value), m_binary(NULL), m_cursor(NULL), m_cursorIndex(0) {}
+        PlannerDomValue(const char *binary) :
+            m_value(NULL), m_binary(binary), m_cursor(NULL), m_cursorIndex(0) {}
+
+        bool isNullValue() const {
+            return (m_binary != NULL) ? (tag() == TAG_NULL) : m_value->IsNull();
+        }
+
+        char tag() const { return *m_binary; }
+
+        static int32_t readInt(const char *data) {
+            int32_t value;
+            memcpy(&value, data, sizeof(value));
+            return ntohl(value);
+        }
+
+        static int64_t readLong(const char *data) {
+            int64_t value;
+            memcpy(&value, data, sizeof(value));
+            return ntohll(value);
+        }
+
+        // Strings are stored NUL-terminated after their length.
+        const char* stringData() const { return m_binary + 1 + sizeof(int32_t); }
+
+        static const char* skipValue(const char *value) {
+            switch (*value) {
+            case TAG_TINYINT:
+                return value + 2;
+            case TAG_INT:
+                return value + 1 + sizeof(int32_t);
+            case TAG_INT64:
+            case TAG_DOUBLE:
+                return value + 1 + sizeof(int64_t);
+            case TAG_STRING:
+                return value + 1 + sizeof(int32_t) + readInt(value + 1) + 1;
+            case TAG_ARRAY:
+            case TAG_OBJECT:
+                return value + 1 + 2 * sizeof(int32_t) + readInt(value + 1 + sizeof(int32_t));
+            default:
+                return value + 1;
+            }
+        }
+
+        // Returns the member's value, or NULL if there is no such member.
+        const char* findMember(const char *key) const {
+            if (tag() != TAG_OBJECT) {
+                return NULL;
+            }
+            int32_t count = readInt(m_binary + 1);
+            size_t keyLength = strlen(key);
+            const char *member = m_binary + 1 + 2 * sizeof(int32_t);
+            for (int32_t i = 0; i < count; i++) {
+                size_t nameLength = readInt(member);
+                const char *name = member + sizeof(int32_t);
+                const char *value = name + nameLength;
+                if (nameLength == keyLength && memcmp(name, key, keyLength) == 0) {
+                    return value;
+                }
+                member = skipValue(value);
+            }
+            return NULL;
+        }
 
-        rapidjson::Value &m_value;
+        rapidjson::Value *m_value;
+        const char *m_binary;
+        // The binary array element last returned by valueAtIndex.
+        mutable const char *m_cursor;
+        mutable int m_cursorIndex;
     };
 
     /**
@@ -166,23 +345,131 @@ namespace voltdb {
      * Also owns the memory, as it's sole member var is not a reference, but a value.
      * This means if you're still using the DOM when this object gets popped off the
      * stack, bad things might happen. Best to use the DOM and be done with it.
+     *
+     * The root can also be given the compact binary form of a document, which
+     * starts with BINARY_MAGIC and is then one value in network byte order:
+     * a type tag byte followed by an int8, int32 or int64, a double, an int32
+     * length and NUL-terminated string, or for arrays and objects an int32
+     * element count, an int32 byte length of the elements and the elements
+     * themselves. Object members are a key, as an int32 length and the bytes,
+     * followed by a value.
+     * The binary form is read in place, so the buffer must outlive the root.
      */
     class PlannerDomRoot {
     public:
-        PlannerDomRoot(const char *jsonStr) {
+        static const size_t BINARY_MAGIC_LENGTH = 4;
+
+        PlannerDomRoot(const char *jsonStr) : m_binary(NULL) {
             m_document.Parse<0>(jsonStr);
         }
 
+        /** Takes either NUL-terminated JSON text or the binary form. */
+        PlannerDomRoot(const char *data, size_t length) : m_binary(NULL) {
+            if (isBinary(data, length)) {
+                m_binary = data + BINARY_MAGIC_LENGTH;
+            }
+            else {
+                m_document.Parse<0>(data);
+            }
+        }
+
+        static bool isBinary(const char *data, size_t length) {
+            return length > BINARY_MAGIC_LENGTH &&
+                memcmp(data, binaryMagic(), BINARY_MAGIC_LENGTH) == 0;
+        }
+
         bool isNull() {
+            if (m_binary != NULL) {
+                return *m_binary == PlannerDomValue::TAG_NULL;
+            }
             return m_document.IsNull();
         }
 
         PlannerDomValue rootObject() {
+            if (m_binary != NULL) {
+                return PlannerDomValue(m_binary);
+            }
             return PlannerDomValue(m_document);
         }
 
+        /** Serialize a parsed JSON document into the binary form. */
+        std::string toBinary() const {
+            assert(m_binary == NULL);
+            return toBinary(m_document);
+        }
+
+        /** Serialize a rapidjson value into the binary form. */
+        static std::string toBinary(const rapidjson::Value &value) {
+            CopySerializeOutput out;
+            out.writeBytes(binaryMagic(), BINARY_MAGIC_LENGTH);
+            writeBinary(value, out);
+            return std::string(out.data(), out.size());
+        }
+
     private:
+        static const char* binaryMagic() { return "\0PDB"; }
+
+
+        static void writeBinary(const rapidjson::Value &value, SerializeOutput &out) {
+            if (value.IsNull()) {
+                out.writeByte(PlannerDomValue::TAG_NULL);
+            }
+            else if (value.IsBool()) {
+                out.writeByte(value.GetBool() ? PlannerDomValue::TAG_TRUE : PlannerDomValue::TAG_FALSE);
+            }
+            else if (value.IsInt() &&
+                     value.GetInt() >= std::numeric_limits<int8_t>::min() &&
+                     value.GetInt() <= std::numeric_limits<int8_t>::max()) {
+                out.writeByte(PlannerDomValue::TAG_TINYINT);
+                out.writeByte(static_cast<int8_t>(value.GetInt()));
+            }
+            else if (value.IsInt()) {
+                out.writeByte(PlannerDomValue::TAG_INT);
+                out.writeInt(value.GetInt());
+            }
+            else if (value.IsInt64()) {
+                out.writeByte(PlannerDomValue::TAG_INT64);
+                out.writeLong(value.GetInt64());
+            }
+            else if (value.IsNumber()) {
+                out.writeByte(PlannerDomValue::TAG_DOUBLE);
+                out.writeDouble(value.GetDouble());
+            }
+            else if (value.IsString()) {
+                out.writeByte(PlannerDomValue::TAG_STRING);
+                out.writeBinaryString(value.GetString(), value.GetStringLength());
+                out.writeByte(0);
+            }
+            else if (value.IsArray()) {
+                out.writeByte(PlannerDomValue::TAG_ARRAY);
+                out.writeInt(value.Size());
+                size_t lengthPosition = out.reserveBytes(sizeof(int32_t));
+                for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
+                    writeBinary(value[i], out);
+                }
+                out.writeIntAt(lengthPosition,
+                               static_cast<int32_t>(out.position() - lengthPosition - sizeof(int32_t)));
+            }
+            else {
+                assert(value.IsObject());
+                out.writeByte(PlannerDomValue::TAG_OBJECT);
+                size_t countPosition = out.reserveBytes(sizeof(int32_t));
+                size_t lengthPosition = out.reserveBytes(sizeof(int32_t));
+                int32_t count = 0;
+                for (rapidjson::Value::ConstMemberIterator it = value.MemberBegin();
+                     it != value.MemberEnd(); ++it, ++count) {
+                    out.writeInt(static_cast<int32_t>(it->name.GetStringLength()));
+                    out.writeBytes(it->name.GetString(), it->name.GetStringLength());
+                    writeBinary(it->value, out);
+                }
+                out.writeIntAt(countPosition, count);
+                out.writeIntAt(lengthPosition,
+                               static_cast<int32_t>(out.position() - lengthPosition - sizeof(int32_t)));
+            }
+        }
+
         rapidjson::Document m_document;
+        const char *m_binary;
     };
 }
 
@@ -27,13 +27,15 @@ namespace voltdb {
  */
 RecoveryProtoMsg::RecoveryProtoMsg(ReferenceSerializeInput *in) :
         m_in(in),  m_type(static_cast<RecoveryMsgType>(in->readByte())),
-        m_tableId(in->readInt()) {
+        m_tableId(in->readInt()), m_lastScanMessage(false) {
     assert(m_in);
     assert(m_type != RECOVERY_MSG_TYPE_SCAN_COMPLETE);
     int32_t totalTupleCount = in->readInt();
     m_totalTupleCount = *reinterpret_cast<uint32_t*>(&totalTupleCount);
     if (m_type == RECOVERY_MSG_TYPE_COMPLETE)
         m_exportStreamSeqNo = in->readLong();
+    if (m_type == RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES)
+        m_lastScanMessage = in->readBool();
 }
 
 /*
@@ -54,6 +56,10 @@ uint32_t RecoveryProtoMsg::totalTupleCount() {
     return m_totalTupleCount;
 }
 
+bool RecoveryProtoMsg::isLastScanMessage() {
+    return m_lastScanMessage;
+}
+
 ReferenceSerializeInput* RecoveryProtoMsg::stream() {
     return m_in;
 }
@@ -33,6 +33,8 @@ class Pool;
  * Format is:
  * 1 byte message type
  * 4 byte table id
+ * 4 byte total tuple count
+ * 1 byte last scan message flag (RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES only)
  * 4 byte tuple count
  * <tuples>
  *
@@ -66,6 +68,11 @@ public:
      */
     uint32_t totalTupleCount();
 
+    /*
+     * True if no more scanned tuples follow this tuple image message
+     */
+    bool isLastScanMessage();
+
     ReferenceSerializeInput* stream();
 
 private:
@@ -93,6 +100,8 @@ private:
     CatalogId m_tableId;
 
     uint32_t m_totalTupleCount;
+
+    bool m_lastScanMessage;
 };
 }
 #endif //RECOVERY_PROTO_MESSAGE_
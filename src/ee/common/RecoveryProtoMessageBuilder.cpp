@@ -33,6 +33,8 @@ RecoveryProtoMsgBuilder::RecoveryProtoMsgBuilder(
         TupleSerializer *serializer,
         const TupleSchema *schema) :
     m_out(out),
+    m_type(type),
+    m_lastScanMessagePosition(0),
     m_tupleCount(0),
     m_maxSerializedSize(serializer->getMaxSerializedTupleSize(schema))
 {
@@ -40,6 +42,15 @@ RecoveryProtoMsgBuilder::RecoveryProtoMsgBuilder(
     m_out->writeByte(static_cast<int8_t>(type));
     m_out->writeInt(tableId);
     m_out->writeInt(*reinterpret_cast<int32_t*>(&totalTupleCount));
+    if (type == RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES) {
+        m_lastScanMessagePosition = m_out->reserveBytes(sizeof(int8_t));
+        // fixed size storage plus a length prefixed copy of each non-inlined object
+        m_maxSerializedSize = schema->tupleLength();
+        for (uint16_t i = 0; i < schema->getUninlinedObjectColumnCount(); ++i) {
+            m_maxSerializedSize += static_cast<int32_t>(sizeof(int32_t)) +
+                    schema->columnLength(schema->getUninlinedObjectColumnInfoIndex(i));
+        }
+    }
     m_tupleCountPosition = m_out->reserveBytes(sizeof(int32_t));
 }
 
@@ -53,10 +64,24 @@ void RecoveryProtoMsgBuilder::addTuple(TableTuple tuple) {
     m_tupleCount++;
 }
 
+/*
+ * Add a tuple image to be inserted at the recovering partition.
+ */
+void RecoveryProtoMsgBuilder::addTupleImage(const TableTuple &tuple) {
+    assert(m_out);
+    assert(m_type == RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES);
+    assert(canAddMoreTuples());
+    tuple.serializeImageTo(*m_out);
+    m_tupleCount++;
+}
+
 /*
  * Write the tuple count and any other information
  */
-void RecoveryProtoMsgBuilder::finalize() {
+void RecoveryProtoMsgBuilder::finalize(bool lastScanMessage) {
+    if (m_type == RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES) {
+        m_out->writeBoolAt(m_lastScanMessagePosition, lastScanMessage);
+    }
     m_out->writeIntAt(m_tupleCountPosition, m_tupleCount);
 }
 
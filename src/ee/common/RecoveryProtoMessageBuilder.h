@@ -36,6 +36,9 @@ class ReferenceSerializeOutput;
  *
  * Format is:
  * 1 byte message type
+ * 4 byte table id
+ * 4 byte total tuple count
+ * 1 byte last scan message flag (RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES only)
  * 4 byte tuple count
  * <tuples>
  *
@@ -66,9 +69,18 @@ public:
     void addTuple(TableTuple tuple);
 
     /*
-     * Write the tuple count and any other information
+     * Add a tuple image (see TableTuple::serializeImageTo) to be inserted
+     * at the recovering partition. Message type must be
+     * RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES.
      */
-    void finalize();
+    void addTupleImage(const TableTuple &tuple);
+
+    /*
+     * Write the tuple count and any other information. lastScanMessage
+     * tells the receiver of a tuple image message that no more scanned
+     * tuples follow.
+     */
+    void finalize(bool lastScanMessage = false);
 
 private:
     /*
@@ -76,6 +88,13 @@ private:
      */
     ReferenceSerializeOutput *m_out;
 
+    RecoveryMsgType m_type;
+
+    /*
+     * Position of the last scan message flag, tuple image messages only.
+     */
+    size_t m_lastScanMessagePosition;
+
     /*
      * Position to put the count of tuples @ once serialization is complete.
      */
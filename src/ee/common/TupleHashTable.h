@@ -0,0 +1,139 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TUPLEHASHTABLE_H_
+#define TUPLEHASHTABLE_H_
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+/**
+ * Open addressing (linear probing) hash table of tuples compared by value,
+ * as used by the set operators. All entries live in a single array that is
+ * sized up front from the expected tuple count, so there is no allocation
+ * per entry. Each entry keeps the tuple's hash so that probing and growing
+ * never rehash a tuple, plus two counters for the caller's bookkeeping.
+ *
+ * Entries are never removed; zero the count instead. The tuples are not
+ * copied, so the tables they come from must outlive the hash table contents.
+ */
+class TupleHashTable {
+public:
+    struct Entry {
+        Entry() : tuple(), hash(0), count(0), matched(0) {}
+
+        bool isEmpty() const { return tuple.isNullTuple(); }
+
+        TableTuple tuple;
+        size_t hash;
+        size_t count;
+        size_t matched;
+    };
+
+    typedef std::vector<Entry>::iterator iterator;
+
+    explicit TupleHashTable(size_t expectedSize = 0) : m_size(0), m_mask(0) {
+        reset(expectedSize);
+    }
+
+    /** Drop all entries and make room for expectedSize tuples. */
+    void reset(size_t expectedSize) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < expectedSize * 2) {
+            capacity <<= 1;
+        }
+        m_entries.assign(capacity, Entry());
+        m_mask = capacity - 1;
+        m_size = 0;
+    }
+
+    /** Return the entry matching tuple, or NULL. */
+    Entry* find(const TableTuple &tuple) {
+        Entry &entry = probe(tuple, tuple.hashCode());
+        return entry.isEmpty() ? NULL : &entry;
+    }
+
+    /**
+     * Return the entry matching tuple, adding one with zeroed counters if
+     * there is none. inserted tells which of the two happened.
+     */
+    Entry* findOrInsert(const TableTuple &tuple, bool &inserted) {
+        size_t hash = tuple.hashCode();
+        Entry *entry = &probe(tuple, hash);
+        inserted = entry->isEmpty();
+        if (inserted) {
+            if ((m_size + 1) * 2 > m_entries.size()) {
+                grow();
+                entry = &probe(tuple, hash);
+            }
+            entry->tuple = tuple;
+            entry->hash = hash;
+            ++m_size;
+        }
+        return entry;
+    }
+
+    size_t size() const { return m_size; }
+
+    /** Iterates over every slot; skip the ones that are isEmpty(). */
+    iterator begin() { return m_entries.begin(); }
+    iterator end() { return m_entries.end(); }
+
+private:
+    static const size_t MIN_CAPACITY = 16;
+
+    Entry& probe(const TableTuple &tuple, size_t hash) {
+        size_t slot = hash & m_mask;
+        while (true) {
+            Entry &entry = m_entries[slot];
+            if (entry.isEmpty() ||
+                (entry.hash == hash && entry.tuple.equalsNoSchemaCheck(tuple))) {
+                return entry;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+    }
+
+    void grow() {
+        std::vector<Entry> old(m_entries.size() * 2);
+        old.swap(m_entries);
+        m_mask = m_entries.size() - 1;
+        for (iterator it = old.begin(); it != old.end(); ++it) {
+            if (it->isEmpty()) {
+                continue;
+            }
+            size_t slot = it->hash & m_mask;
+            while (!m_entries[slot].isEmpty()) {
+                slot = (slot + 1) & m_mask;
+            }
+            m_entries[slot] = *it;
+        }
+    }
+
+    std::vector<Entry> m_entries;
+    size_t m_size;
+    size_t m_mask;
+};
+
+}
+
+#endif // TUPLEHASHTABLE_H_
@@ -228,6 +228,27 @@ bool TupleSchema::equals(const TupleSchema *other) const {
     return true;
 }
 
+bool TupleSchema::isLayoutPrefixOf(const TupleSchema *other) const {
+    if (other->m_columnCount < m_columnCount ||
+        other->m_allowInlinedObjects != m_allowInlinedObjects) {
+        return false;
+    }
+
+    for (int ii = 0; ii < m_columnCount; ii++) {
+        const ColumnInfo *columnInfo = getColumnInfo(ii);
+        const ColumnInfo *ocolumnInfo = other->getColumnInfo(ii);
+        if (columnInfo->offset != ocolumnInfo->offset ||
+                columnInfo->length != ocolumnInfo->length ||
+                columnInfo->type != ocolumnInfo->type ||
+                columnInfo->allowNull != ocolumnInfo->allowNull ||
+                columnInfo->inlined != ocolumnInfo->inlined) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /*
  * Returns the number of string columns that can't be inlined.
  */
@@ -110,6 +110,10 @@ public:
 
     bool equals(const TupleSchema *other) const;
 
+    /** Returns true if other lays out its leading columns exactly as this
+     * schema does, so a tuple of this schema is a prefix of one of other. */
+    bool isLayoutPrefixOf(const TupleSchema *other) const;
+
 private:
     // holds per column info
     struct ColumnInfo {
@@ -41,6 +41,7 @@ ExecutorContext::ExecutorContext(int64_t siteId,
                 CatalogId hostId) :
     m_topEnd(topend), m_tempStringPool(tempStringPool),
     m_undoQuantum(undoQuantum), m_spHandle(0),
+    m_indexBuildThreads(0),
     m_lastCommittedSpHandle(0),
     m_siteId(siteId), m_partitionId(partitionId),
     m_hostname(hostname), m_hostId(hostId),
@@ -60,6 +60,15 @@ class ExecutorContext {
         m_epoch = epoch;
     }
 
+    // helper threads available to build indexes while no transactions run
+    void setIndexBuildThreads(int threads) {
+        m_indexBuildThreads = threads;
+    }
+
+    int indexBuildThreads() const {
+        return m_indexBuildThreads;
+    }
+
     // helper to configure the context for a new jni call
     void setupForPlanFragments(UndoQuantum *undoQuantum,
                                int64_t spHandle,
@@ -137,6 +146,7 @@ class ExecutorContext {
     int64_t m_spHandle;
     int64_t m_uniqueId;
     int64_t m_currentTxnTimestamp;
+    int m_indexBuildThreads;
   public:
     int64_t m_lastCommittedSpHandle;
     int64_t m_siteId;
@@ -185,6 +185,11 @@ public:
         ::memcpy(destination, getRawPointer(length), length);
     };
 
+    /** True if there are bytes left to read. */
+    bool hasRemaining() const {
+        return current_ < end_;
+    }
+
     /** Write the buffer as hex bytes for debugging */
     std::string fullBufferStringRep();
 
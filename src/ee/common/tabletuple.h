@@ -84,6 +84,7 @@ class TableTuple {
     friend class CopyOnWriteContext;
     friend class ::CopyOnWriteTest_TestTableTupleFlags;
     friend class StandAloneTupleStorage; // ... OK, this friend can also update m_schema.
+    friend class TupleSpill;
 
 public:
     /** Initialize a tuple unassociated with a table (bad idea... dangerous) */
@@ -307,6 +308,14 @@ public:
 
     void deserializeFrom(voltdb::SerializeInput &tupleIn, Pool *stringPool);
     void serializeTo(voltdb::SerializeOutput &output);
+    /**
+     * Tuple images are the raw tuple storage without the header, followed
+     * by the value of each non-inlined column. Reading one copies the
+     * storage as is and replaces the sender's object pointers with fresh
+     * copies of the trailing values. Both ends must share the schema.
+     */
+    void deserializeImageFrom(voltdb::SerializeInput &tupleIn, Pool *stringPool);
+    void serializeImageTo(voltdb::SerializeOutput &output) const;
     void serializeToExport(voltdb::ExportSerializeOutput &io,
                           int colOffset, uint8_t *nullArray);
 
@@ -711,6 +720,28 @@ inline void TableTuple::deserializeFrom(voltdb::SerializeInput &tupleIn, Pool *d
     }
 }
 
+inline void TableTuple::deserializeImageFrom(voltdb::SerializeInput &tupleIn, Pool *dataPool) {
+    assert(m_schema);
+    assert(m_data);
+
+    tupleIn.readBytes(m_data + TUPLE_HEADER_SIZE, m_schema->tupleLength());
+    for (uint16_t i = 0; i < m_schema->getUninlinedObjectColumnCount(); ++i) {
+        const int j = m_schema->getUninlinedObjectColumnInfoIndex(i);
+        NValue::deserializeFrom(tupleIn, m_schema->columnType(j), getDataPtr(j),
+                                false, m_schema->columnLength(j), dataPool);
+    }
+}
+
+inline void TableTuple::serializeImageTo(voltdb::SerializeOutput &output) const {
+    assert(m_schema);
+    assert(m_data);
+
+    output.writeBytes(m_data + TUPLE_HEADER_SIZE, m_schema->tupleLength());
+    for (uint16_t i = 0; i < m_schema->getUninlinedObjectColumnCount(); ++i) {
+        getNValue(m_schema->getUninlinedObjectColumnInfoIndex(i)).serializeTo(output);
+    }
+}
+
 inline void TableTuple::serializeTo(voltdb::SerializeOutput &output) {
     size_t start = output.reserveBytes(4);
 
@@ -271,6 +271,12 @@ string joinToString(JoinType type)
     case JOIN_TYPE_RIGHT: {
         return "RIGHT";
     }
+    case JOIN_TYPE_SEMI: {
+        return "SEMI";
+    }
+    case JOIN_TYPE_ANTI: {
+        return "ANTI";
+    }
     }
     return "INVALID";
 }
@@ -287,6 +293,10 @@ JoinType stringToJoin(string str )
         return JOIN_TYPE_FULL;
     } else if (str == "RIGHT") {
         return JOIN_TYPE_RIGHT;
+    } else if (str == "SEMI") {
+        return JOIN_TYPE_SEMI;
+    } else if (str == "ANTI") {
+        return JOIN_TYPE_ANTI;
     }
     return JOIN_TYPE_INVALID;
 }
@@ -343,6 +353,9 @@ string planNodeToString(PlanNodeType type)
     case PLAN_NODE_TYPE_NESTLOOPINDEX: {
         return "NESTLOOPINDEX";
     }
+    case PLAN_NODE_TYPE_MERGEJOIN: {
+        return "MERGEJOIN";
+    }
     case PLAN_NODE_TYPE_UPDATE: {
         return "UPDATE";
     }
@@ -382,6 +395,9 @@ string planNodeToString(PlanNodeType type)
     case PLAN_NODE_TYPE_DISTINCT: {
         return "DISTINCT";
     }
+    case PLAN_NODE_TYPE_WINDOWFUNCTION: {
+        return "WINDOWFUNCTION";
+    }
     case PLAN_NODE_TYPE_MATERIALIZEDSCAN: {
         return "MATERIALIZEDSCAN";
     }
@@ -405,6 +421,8 @@ PlanNodeType stringToPlanNode(string str )
         return PLAN_NODE_TYPE_NESTLOOP;
     } else if (str == "NESTLOOPINDEX") {
         return PLAN_NODE_TYPE_NESTLOOPINDEX;
+    } else if (str == "MERGEJOIN") {
+        return PLAN_NODE_TYPE_MERGEJOIN;
     } else if (str == "UPDATE") {
         return PLAN_NODE_TYPE_UPDATE;
     } else if (str == "INSERT") {
@@ -431,6 +449,8 @@ PlanNodeType stringToPlanNode(string str )
         return PLAN_NODE_TYPE_LIMIT;
     } else if (str == "DISTINCT") {
         return PLAN_NODE_TYPE_DISTINCT;
+    } else if (str == "WINDOWFUNCTION") {
+        return PLAN_NODE_TYPE_WINDOWFUNCTION;
     } else if (str == "MATERIALIZEDSCAN") {
         return PLAN_NODE_TYPE_MATERIALIZEDSCAN;
     }
@@ -533,6 +553,15 @@ string expressionToString(ExpressionType type)
     case EXPRESSION_TYPE_AGGREGATE_AVG: {
         return "AGGREGATE_AVG";
     }
+    case EXPRESSION_TYPE_AGGREGATE_ROW_NUMBER: {
+        return "AGGREGATE_ROW_NUMBER";
+    }
+    case EXPRESSION_TYPE_AGGREGATE_RANK: {
+        return "AGGREGATE_RANK";
+    }
+    case EXPRESSION_TYPE_AGGREGATE_DENSE_RANK: {
+        return "AGGREGATE_DENSE_RANK";
+    }
     case EXPRESSION_TYPE_FUNCTION: {
         return "FUNCTION";
     }
@@ -616,6 +645,12 @@ ExpressionType stringToExpression(string str )
         return EXPRESSION_TYPE_AGGREGATE_MAX;
     } else if (str == "AGGREGATE_AVG") {
         return EXPRESSION_TYPE_AGGREGATE_AVG;
+    } else if (str == "AGGREGATE_ROW_NUMBER") {
+        return EXPRESSION_TYPE_AGGREGATE_ROW_NUMBER;
+    } else if (str == "AGGREGATE_RANK") {
+        return EXPRESSION_TYPE_AGGREGATE_RANK;
+    } else if (str == "AGGREGATE_DENSE_RANK") {
+        return EXPRESSION_TYPE_AGGREGATE_DENSE_RANK;
     } else if (str == "FUNCTION") {
         return EXPRESSION_TYPE_FUNCTION;
     } else if (str == "VALUE_VECTOR") {
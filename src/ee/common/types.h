@@ -129,6 +129,10 @@ enum JoinType {
     JOIN_TYPE_LEFT          = 2,
     JOIN_TYPE_FULL          = 3,
     JOIN_TYPE_RIGHT         = 4,
+    // Outer tuples with at least one match (IN, EXISTS) or with none
+    // (NOT EXISTS), each output once and without inner columns
+    JOIN_TYPE_SEMI          = 5,
+    JOIN_TYPE_ANTI          = 6,
 };
 
 // ------------------------------------------------------------------
@@ -187,6 +191,7 @@ enum PlanNodeType {
     //
     PLAN_NODE_TYPE_NESTLOOP         = 20,
     PLAN_NODE_TYPE_NESTLOOPINDEX    = 21,
+    PLAN_NODE_TYPE_MERGEJOIN        = 22,
 
     //
     // Operator Nodes
@@ -212,6 +217,7 @@ enum PlanNodeType {
     PLAN_NODE_TYPE_MATERIALIZE      = 55,
     PLAN_NODE_TYPE_LIMIT            = 56,
     PLAN_NODE_TYPE_DISTINCT         = 57,
+    PLAN_NODE_TYPE_WINDOWFUNCTION   = 58,
 };
 
 // ------------------------------------------------------------------
@@ -298,6 +304,10 @@ enum ExpressionType {
     EXPRESSION_TYPE_AGGREGATE_MIN                   = 43,
     EXPRESSION_TYPE_AGGREGATE_MAX                   = 44,
     EXPRESSION_TYPE_AGGREGATE_AVG                   = 45,
+    // ranking functions of a window
+    EXPRESSION_TYPE_AGGREGATE_ROW_NUMBER            = 46,
+    EXPRESSION_TYPE_AGGREGATE_RANK                  = 47,
+    EXPRESSION_TYPE_AGGREGATE_DENSE_RANK            = 48,
 
     // -----------------------------
     // Functions
@@ -441,14 +451,26 @@ enum RecoveryMsgType {
     /*
      * Generated when all recovery data for a table has been generated
      */
-    RECOVERY_MSG_TYPE_COMPLETE = 4
+    RECOVERY_MSG_TYPE_COMPLETE = 4,
+    /*
+     * Message containing freshly scanned tuples as raw tuple images, see
+     * RecoveryProtoMsgBuilder::addTupleImage. 5 is the Java-only Ack.
+     */
+    RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES = 6
 };
 
 // ------------------------------------------------------------------
 // Types of generic tasks that can be submitted to the EE
 // ------------------------------------------------------------------
 enum TaskType {
-    TASK_TYPE_VALIDATE_PARTITIONING = 0
+    TASK_TYPE_VALIDATE_PARTITIONING = 0,
+    TASK_TYPE_SET_INDEX_BUILD_THREADS = 1,
+    TASK_TYPE_SAVE_TABLE_IMAGE = 2,
+    TASK_TYPE_RESTORE_TABLE_IMAGE = 3,
+    TASK_TYPE_SET_TEMP_BLOCK_POOL_SIZE = 4,
+    TASK_TYPE_SET_TEMP_TABLE_SPILL_THRESHOLD = 5,
+    TASK_TYPE_PURGE_EXPIRED_TUPLES = 6,
+    TASK_TYPE_BUILD_DEFERRED_INDEXES = 7
 };
 
 // ------------------------------------------------------------------
@@ -0,0 +1,238 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedPlanCache.h"
+
+#include "common/PlannerDomValue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <boost/functional/hash.hpp>
+
+namespace voltdb {
+
+static SharedPlanCache s_sharedPlanCache(64 * 1024 * 1024);
+
+namespace {
+// Holds the cache mutex for the lifetime of the scope.
+class ScopedLock {
+public:
+    ScopedLock(pthread_mutex_t &mutex) : m_mutex(mutex) { pthread_mutex_lock(&m_mutex); }
+    ~ScopedLock() { pthread_mutex_unlock(&m_mutex); }
+private:
+    pthread_mutex_t &m_mutex;
+};
+
+bool isExpressionOfType(const rapidjson::Value &value, const char *type) {
+    if (!value.IsObject() || !value.HasMember("TYPE")) {
+        return false;
+    }
+    const rapidjson::Value &typeValue = value["TYPE"];
+    return typeValue.IsString() && strcmp(typeValue.GetString(), type) == 0;
+}
+
+// Whether the planner marked the plan as that of an ad hoc query.
+bool isAdHoc(const rapidjson::Value &plan) {
+    if (!plan.IsObject() || !plan.HasMember("AD_HOC")) {
+        return false;
+    }
+    const rapidjson::Value &adHoc = plan["AD_HOC"];
+    return adHoc.IsBool() && adHoc.GetBool();
+}
+
+// Highest parameter index the plan refers to, either through a parameter
+// expression, the PARAMETERS list or a *PARAM_IDX attribute of a node.
+int maxParamIndex(const rapidjson::Value &value) {
+    int maxIndex = -1;
+    if (value.IsObject()) {
+        for (rapidjson::Value::ConstMemberIterator it = value.MemberBegin();
+             it != value.MemberEnd(); ++it) {
+            const char *name = it->name.GetString();
+            size_t nameLength = it->name.GetStringLength();
+            if (nameLength >= 9 && strcmp(name + nameLength - 9, "PARAM_IDX") == 0 &&
+                it->value.IsInt()) {
+                maxIndex = std::max(maxIndex, it->value.GetInt());
+            }
+            else if (strcmp(name, "PARAMETERS") == 0 && it->value.IsArray()) {
+                for (rapidjson::SizeType i = 0; i < it->value.Size(); ++i) {
+                    const rapidjson::Value &parameter = it->value[i];
+                    if (parameter.IsArray() && parameter.Size() > 0 && parameter[0u].IsInt()) {
+                        maxIndex = std::max(maxIndex, parameter[0u].GetInt());
+                    }
+                }
+            }
+            else {
+                maxIndex = std::max(maxIndex, maxParamIndex(it->value));
+            }
+        }
+    }
+    else if (value.IsArray()) {
+        for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+            maxIndex = std::max(maxIndex, maxParamIndex(value[i]));
+        }
+    }
+    return maxIndex;
+}
+
+// Turn each constant expression under value into a parameter expression
+// numbered from base, saving the constant itself in binary form.
+void liftConstants(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator,
+                   int base, std::vector<std::string> &constants) {
+    if (isExpressionOfType(value, "VALUE_CONSTANT")) {
+        constants.push_back(PlannerDomRoot::toBinary(value));
+        value["TYPE"].SetString("VALUE_PARAMETER");
+        value.RemoveMember("VALUE");
+        value.RemoveMember("ISNULL");
+        value.AddMember("PARAM_IDX", base + static_cast<int>(constants.size()) - 1, allocator);
+        return;
+    }
+    if (value.IsObject()) {
+        for (rapidjson::Value::MemberIterator it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+            liftConstants(it->value, allocator, base, constants);
+        }
+    }
+    else if (value.IsArray()) {
+        for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+            liftConstants(value[i], allocator, base, constants);
+        }
+    }
+}
+}
+
+SharedPlanCache& SharedPlanCache::instance() {
+    return s_sharedPlanCache;
+}
+
+SharedPlanCache::SharedPlanCache(size_t capacityBytes)
+    : m_capacityBytes(capacityBytes), m_bytes(0), m_engineCount(0) {
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+SharedPlanCache::~SharedPlanCache() {
+    clear();
+    pthread_mutex_destroy(&m_mutex);
+}
+
+SharedPlanCache::PlanPtr SharedPlanCache::get(int64_t fragId) {
+    ScopedLock lock(m_mutex);
+    typedef PlanSet::nth_index<1>::type plansById;
+    plansById::iterator iter = m_plans.get<1>().find(fragId);
+    if (iter == m_plans.get<1>().end()) {
+        return PlanPtr();
+    }
+    m_plans.get<0>().relocate(m_plans.begin(), m_plans.project<0>(iter));
+    return share(iter->shared);
+}
+
+SharedPlanCache::PlanPtr SharedPlanCache::put(int64_t fragId, const std::string &plan) {
+    // Convert outside of the lock, it is the expensive part.
+    SharedPlan *converted = new SharedPlan();
+    rapidjson::Document document;
+    if (!PlannerDomRoot::isBinary(plan.data(), plan.size())) {
+        document.Parse<0>(plan.c_str());
+    }
+    if (document.IsNull()) {
+        converted->plan.plan = plan;
+    }
+    else {
+        converted->plan.plan = PlannerDomRoot::toBinary(document);
+        if (isAdHoc(document)) {
+            converted->plan.constantBase = maxParamIndex(document) + 1;
+            liftConstants(document, document.GetAllocator(),
+                          converted->plan.constantBase, converted->plan.constants);
+        }
+        if (!converted->plan.constants.empty()) {
+            converted->plan.shape = PlannerDomRoot::toBinary(document);
+            converted->plan.shapeHash = boost::hash<std::string>()(converted->plan.shape);
+        }
+    }
+    converted->bytes = converted->plan.plan.size() + converted->plan.shape.size();
+    for (size_t i = 0; i < converted->plan.constants.size(); ++i) {
+        converted->bytes += converted->plan.constants[i].size();
+    }
+
+    ScopedLock lock(m_mutex);
+    std::pair<PlanSet::iterator, bool> inserted = m_plans.push_front(Entry(fragId, converted));
+    if (!inserted.second) {
+        delete converted;
+        return share(inserted.first->shared);
+    }
+    // Evict the least recently used plans to make room, but always keep
+    // the new one.
+    m_bytes += converted->bytes;
+    while (m_bytes > m_capacityBytes && m_plans.size() > 1) {
+        m_bytes -= m_plans.back().shared->bytes;
+        unreference(m_plans.back().shared);
+        m_plans.pop_back();
+    }
+    return share(converted);
+}
+
+void SharedPlanCache::clear() {
+    ScopedLock lock(m_mutex);
+    removeAll();
+}
+
+size_t SharedPlanCache::size() {
+    ScopedLock lock(m_mutex);
+    return m_plans.size();
+}
+
+size_t SharedPlanCache::bytes() {
+    ScopedLock lock(m_mutex);
+    return m_bytes;
+}
+
+void SharedPlanCache::attachEngine() {
+    ScopedLock lock(m_mutex);
+    ++m_engineCount;
+}
+
+void SharedPlanCache::detachEngine() {
+    ScopedLock lock(m_mutex);
+    assert(m_engineCount > 0);
+    if (--m_engineCount == 0) {
+        removeAll();
+    }
+}
+
+SharedPlanCache::PlanPtr SharedPlanCache::share(SharedPlan *shared) {
+    ++shared->references;
+    return PlanPtr(&shared->plan, Release(this, shared));
+}
+
+void SharedPlanCache::release(SharedPlan *shared) {
+    ScopedLock lock(m_mutex);
+    unreference(shared);
+}
+
+void SharedPlanCache::removeAll() {
+    for (PlanSet::iterator iter = m_plans.begin(); iter != m_plans.end(); ++iter) {
+        unreference(iter->shared);
+    }
+    m_plans.clear();
+    m_bytes = 0;
+}
+
+void SharedPlanCache::unreference(SharedPlan *shared) {
+    if (--shared->references == 0) {
+        delete shared;
+    }
+}
+
+}
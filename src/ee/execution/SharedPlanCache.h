@@ -0,0 +1,179 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDPLANCACHE_H_
+#define SHAREDPLANCACHE_H_
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+// The next #define limits the number of features pulled into the build
+// We don't use those features.
+#define BOOST_MULTI_INDEX_DISABLE_SERIALIZATION
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+namespace voltdb {
+
+/**
+ * LRU cache of serialized plan fragments shared by all the engines (sites)
+ * of a process, so that each plan is fetched from the frontend and parsed
+ * from JSON once per host rather than once per site. Plans are kept in the
+ * binary form of PlannerDomRoot, which each engine then loads into its own
+ * PlanNodeFragment and executors without parsing. Those stay per engine, as
+ * executors keep their temp tables and substituted parameters in the plan
+ * nodes and expressions.
+ *
+ * Entries are keyed by fragment id. The frontend numbers fragments from
+ * the same initial id every time it starts over with an empty plan
+ * repository, which it only does with no engine running, so the cache is
+ * emptied whenever the last engine detaches from it.
+ *
+ * Only the plan bytes are shared. The PlanNodeFragment trees and executors
+ * loaded from them are built by each engine, so a host still holds one
+ * copy of those per site that runs the plan. The cache is bounded by the
+ * bytes of the plans it holds rather than by their number, as plans range
+ * from a few hundred bytes to many kilobytes.
+ *
+ * Cached plans are immutable and shared, not copied. The EE is built with
+ * thread-unsafe shared_ptr reference counts, so each pointer handed out
+ * gets a control block of its own, used by the one engine it was handed
+ * to. The references across engines are counted under the cache mutex.
+ * A plan lives until it is evicted and no engine refers to it any more.
+ *
+ * Ad hoc queries that differ only in their constants arrive as distinct
+ * fragments. The planner marks their plans AD_HOC, and each of those cached
+ * also carries its shape: the plan with every constant expression turned
+ * into a parameter, numbered after the plan's own parameters. A plan with
+ * the same shape as an evicted one can take over its executors, given its
+ * own lifted constants as the extra parameters. Stored procedure plans are
+ * kept as they are.
+ */
+class SharedPlanCache {
+public:
+    struct Plan {
+        Plan() : shapeHash(0), constantBase(0) {}
+
+        /** The plan in binary form, or as fetched if it did not parse */
+        std::string plan;
+        /** The plan with its constants lifted, empty if there are none or
+            the plan is not ad hoc */
+        std::string shape;
+        size_t shapeHash;
+        /** The lifted constant expressions in binary form, in order */
+        std::vector<std::string> constants;
+        /** Parameter index of the first lifted constant */
+        int constantBase;
+    };
+
+    typedef boost::shared_ptr<const Plan> PlanPtr;
+
+    /** The cache shared by every engine in this process. */
+    static SharedPlanCache& instance();
+
+    SharedPlanCache(size_t capacityBytes);
+    ~SharedPlanCache();
+
+    /**
+     * Return the plan cached for fragId, bumping it to the most recently
+     * used position, or an empty pointer on a miss.
+     */
+    PlanPtr get(int64_t fragId);
+
+    /**
+     * Cache the plan fetched for fragId in binary form, along with its
+     * shape, and return it. If another engine cached it in the meantime,
+     * that one is returned.
+     * Plans that fail to parse are kept as they are, to fail the same way
+     * when they are loaded.
+     */
+    PlanPtr put(int64_t fragId, const std::string &plan);
+
+    void clear();
+
+    /** Number of plans cached */
+    size_t size();
+
+    /** Bytes taken by the plans cached */
+    size_t bytes();
+
+    /** Count an engine using the cache. */
+    void attachEngine();
+
+    /** Stop counting an engine, emptying the cache after the last one. */
+    void detachEngine();
+
+private:
+    /** A plan and the number of references to it, its entry's included. */
+    struct SharedPlan {
+        SharedPlan() : bytes(0), references(1) {}
+        Plan plan;
+        /** What the plan counts against the cache capacity */
+        size_t bytes;
+        int references;
+    };
+
+    /** Deleter of the pointers handed out, drops one reference. */
+    class Release {
+    public:
+        Release(SharedPlanCache *cache, SharedPlan *shared) : m_cache(cache), m_shared(shared) {}
+        void operator()(const Plan *) { m_cache->release(m_shared); }
+    private:
+        SharedPlanCache *m_cache;
+        SharedPlan *m_shared;
+    };
+
+    struct Entry {
+        Entry(int64_t fragId, SharedPlan *shared) : fragId(fragId), shared(shared) {}
+        int64_t fragId;
+        SharedPlan *shared;
+    };
+
+    /** Hand out a new reference, with the mutex held. */
+    PlanPtr share(SharedPlan *shared);
+
+    /** Drop a reference, taking the mutex. */
+    void release(SharedPlan *shared);
+
+    /** Empty the cache, with the mutex held. */
+    void removeAll();
+
+    /** Drop the reference of an entry leaving the cache, with the mutex held. */
+    static void unreference(SharedPlan *shared);
+
+    typedef boost::multi_index::multi_index_container<
+        Entry,
+        boost::multi_index::indexed_by<
+            boost::multi_index::sequenced<>,
+            boost::multi_index::ordered_unique<
+                boost::multi_index::member<Entry, int64_t, &Entry::fragId> >
+        >
+    > PlanSet;
+
+    PlanSet m_plans;
+    const size_t m_capacityBytes;
+    size_t m_bytes;
+    int m_engineCount;
+    pthread_mutex_t m_mutex;
+};
+
+}
+
+#endif // SHAREDPLANCACHE_H_
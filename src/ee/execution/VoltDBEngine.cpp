@@ -61,6 +61,7 @@
 #include "common/TupleOutputStreamProcessor.h"
 #include "common/LegacyHashinator.h"
 #include "common/ElasticHashinator.h"
+#include "common/PlannerDomValue.h"
 #include "catalog/catalogmap.h"
 #include "catalog/catalog.h"
 #include "catalog/cluster.h"
@@ -80,6 +81,8 @@
 #include "plannodes/abstractscannode.h"
 #include "plannodes/plannodeutil.h"
 #include "plannodes/plannodefragment.h"
+#include "execution/SharedPlanCache.h"
+#include "expressions/expressionutil.h"
 #include "executors/executorutil.h"
 #include "storage/table.h"
 #include "storage/tablefactory.h"
@@ -90,6 +93,7 @@
 #include "storage/MaterializedViewMetadata.h"
 #include "storage/StreamBlock.h"
 #include "storage/TableCatalogDelegate.hpp"
+#include "storage/TableImage.h"
 #include "org_voltdb_jni_ExecutionEngine.h" // to use static values
 #include "stats/StatsAgent.h"
 #include "voltdbipc.h"
@@ -115,6 +119,8 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy)
     : m_currentUndoQuantum(NULL),
       m_hashinator(NULL),
       m_staticParams(MAX_PARAM_COUNT),
+      m_shapeParams(MAX_PARAM_COUNT),
+      m_executingParams(&m_staticParams),
       m_currentInputDepId(-1),
       m_isELEnabled(false),
       m_stringPool(16777216, 2),
@@ -126,6 +132,9 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy)
     // init the number of planfragments executed
     m_pfCount = 0;
 
+    // temp tables never spill unless asked to
+    m_tempTableSpillThreshold = -1;
+
     // require a site id, at least, to inititalize.
     m_executorContext = NULL;
 
@@ -152,6 +161,9 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy)
     mallopt(M_MMAP_MAX, 65536);             // DEFAULT_MMAP_MAX
     mallopt(M_CHECK_ACTION, 3);             // DEFAULT_CHECK_ACTION
 #endif // LINUX
+
+    SharedPlanCache::instance().attachEngine();
+    SharedSchemaCache::attachEngine();
 }
 
 bool
@@ -224,6 +236,8 @@ VoltDBEngine::~VoltDBEngine() {
 
     // clean up execution plans
     m_plans.clear();
+    m_executorsByShape.clear();
+    SharedPlanCache::instance().detachEngine();
 
     // Clear the undo log before deleting the persistent tables so
     // that the persistent table schema are still around so we can
@@ -249,6 +263,9 @@ VoltDBEngine::~VoltDBEngine() {
 
     delete m_topend;
     delete m_executorContext;
+
+    // the tables still holding shared schemas keep the cache themselves
+    SharedSchemaCache::detachEngine();
 }
 
 // ------------------------------------------------------------------
@@ -270,9 +287,33 @@ Table* VoltDBEngine::getTable(string name) const
     return findInMapOrNull(name, m_tablesByName);
 }
 
-bool VoltDBEngine::serializeTable(int32_t tableId, SerializeOutput* out) const {
+Table* VoltDBEngine::getMigratedTable(int32_t tableId)
+{
+    Table *table = getTable(tableId);
+    if (table && !m_migratingTables.empty()) {
+        finishSchemaChange(table);
+    }
+    if (table && !m_deferredIndexTables.empty()) {
+        buildDeferredIndexes(table);
+    }
+    return table;
+}
+
+Table* VoltDBEngine::getMigratedTable(const string &name)
+{
+    Table *table = getTable(name);
+    if (table && !m_migratingTables.empty()) {
+        finishSchemaChange(table);
+    }
+    if (table && !m_deferredIndexTables.empty()) {
+        buildDeferredIndexes(table);
+    }
+    return table;
+}
+
+bool VoltDBEngine::serializeTable(int32_t tableId, SerializeOutput* out) {
     // Just look in our list of tables
-    Table* table = getTable(tableId);
+    Table* table = getMigratedTable(tableId);
     if (table) {
         table->serializeTo(*out);
         return true;
@@ -297,6 +338,9 @@ int VoltDBEngine::executePlanFragments(int32_t numFragments,
     // count failures
     int failures = 0;
 
+    // a fragment may use any index
+    buildDeferredIndexes();
+
     setUndoToken(undoToken);
 
     // reset these at the start of each batch
@@ -400,14 +444,29 @@ int VoltDBEngine::executePlanFragment(int64_t planfragmentId,
     }
     assert(execsForFrag);
 
+    // Constants lifted out of the plan follow the fragment's parameters.
+    const NValueArray *execParams = &params;
+    if (!execsForFrag->liftedConstants.empty()) {
+        const int base = execsForFrag->liftedParamBase;
+        for (int ii = 0; ii < base; ii++) {
+            m_shapeParams[ii] = params[ii];
+        }
+        for (size_t ii = 0; ii < execsForFrag->liftedConstants.size(); ii++) {
+            m_shapeParams[base + static_cast<int>(ii)] = execsForFrag->liftedConstants[ii];
+        }
+        execParams = &m_shapeParams;
+    }
+    m_executingParams = execParams;
+
     // Walk through the queue and execute each plannode.  The query
     // planner guarantees that for a given plannode, all of its
     // children are positioned before it in this list, therefore
     // dependency tracking is not needed here.
-    size_t ttl = execsForFrag->list.size();
+    const std::vector<AbstractExecutor*> &executorList = execsForFrag->executors->list;
+    size_t ttl = executorList.size();
 
     for (int ctr = 0; ctr < ttl; ++ctr) {
-        AbstractExecutor *executor = execsForFrag->list[ctr];
+        AbstractExecutor *executor = executorList[ctr];
         assert (executor);
 
         if (executor->needsPostExecuteClear())
@@ -417,7 +476,7 @@ int VoltDBEngine::executePlanFragment(int64_t planfragmentId,
         try {
             // Now call the execute method to actually perform whatever action
             // it is that the node is supposed to do...
-            if (!executor->execute(params)) {
+            if (!executor->execute(*execParams)) {
                 VOLT_TRACE("The Executor's execution at position '%d'"
                            " failed for PlanFragment '%jd'",
                            ctr, (intmax_t)planfragmentId);
@@ -730,6 +789,13 @@ VoltDBEngine::processCatalogAdditions(bool addAll, int64_t timestamp)
                 continue;
             }
 
+            // Nothing below an untouched table changed, so its schema and
+            // indexes stand. Tables with views still go through, as their
+            // views may have to follow a rebuilt target table.
+            if (!catalogTable->wasChanged() && catalogTable->views().size() == 0) {
+                continue;
+            }
+
             //////////////////////////////////////////
             // if the table schema has changed, build a new
             // table and migrate tuples over to it, repopulating
@@ -742,10 +808,16 @@ VoltDBEngine::processCatalogAdditions(bool addAll, int64_t timestamp)
                          catalogTable->name().c_str());
                 LogManager::getThreadLogger(LOGGERID_HOST)->log(LOGLEVEL_INFO, msg);
 
-                tcd->processSchemaChanges(*m_database, *catalogTable, m_delegatesByName);
-
-                snprintf(msg, sizeof(msg), "Table %s was successfully rebuilt with new schema.",
-                         catalogTable->name().c_str());
+                if (tcd->processSchemaChanges(*m_database, *catalogTable, m_delegatesByName, true)) {
+                    // the tuples move over on tick, or all at once when the table is next used
+                    m_migratingTables[tcd->getTable()] = tcd;
+                    snprintf(msg, sizeof(msg), "Table %s was rebuilt with new schema and is migrating its tuples.",
+                             catalogTable->name().c_str());
+                }
+                else {
+                    snprintf(msg, sizeof(msg), "Table %s was successfully rebuilt with new schema.",
+                             catalogTable->name().c_str());
+                }
                 LogManager::getThreadLogger(LOGGERID_HOST)->log(LOGLEVEL_INFO, msg);
 
                 // don't continue on to modify/add/remove indexes, because the
@@ -837,6 +909,14 @@ VoltDBEngine::processCatalogAdditions(bool addAll, int64_t timestamp)
                 }
             }
 
+            ///////////////////////////////////////////
+            // pick up any change to the time to live
+            ///////////////////////////////////////////
+
+            const catalog::Column *ttlColumn = catalogTable->ttlcolumn();
+            persistenttable->setTimeToLive(ttlColumn == NULL ? -1 : ttlColumn->index(),
+                                           catalogTable->ttlseconds());
+
             ///////////////////////////////////////////////////
             // now find all of the materialized views to remove
             ///////////////////////////////////////////////////
@@ -903,8 +983,15 @@ VoltDBEngine::processCatalogAdditions(bool addAll, int64_t timestamp)
 bool
 VoltDBEngine::updateCatalog(const int64_t timestamp, const string &catalogPayload)
 {
+    // tables may be dropped or changed, so finish loading them first
+    buildDeferredIndexes();
+
     // clean up execution plans when the tables underneath might change
     m_plans.clear();
+    m_executorsByShape.clear();
+
+    // finish the schema changes of the last update before the next one
+    migrateSchemaChanges(-1);
 
     assert(m_catalog != NULL); // the engine must be initialized
 
@@ -950,6 +1037,7 @@ VoltDBEngine::loadTable(int32_t tableId,
                                              -1,
                                              lastCommittedSpHandle);
 
+    // the table may take more chunks before its indexes are built
     Table* ret = getTable(tableId);
     if (ret == NULL) {
         VOLT_ERROR("Table ID %d doesn't exist. Could not load data",
@@ -965,14 +1053,57 @@ VoltDBEngine::loadTable(int32_t tableId,
         return false;
     }
 
+    finishSchemaChange(table);
     try {
-        table->loadTuplesFrom(serializeIn, NULL, returnUniqueViolations ? &m_resultOutput : NULL);
+        if (returnUniqueViolations || ExecutorContext::currentUndoQuantum() != NULL) {
+            buildDeferredIndexes(table);
+            table->loadTuplesFrom(serializeIn, NULL, returnUniqueViolations ? &m_resultOutput : NULL);
+        } else {
+            // nothing to undo or report, so the indexes can wait for the
+            // last chunk and then take all the tuples at once
+            table->loadTuplesDeferringIndexes(serializeIn, NULL);
+            if (table->hasDeferredIndexes()) {
+                m_deferredIndexTables.insert(table);
+            }
+        }
     } catch (const SerializableEEException &e) {
         throwFatalException("%s", e.message().c_str());
     }
     return true;
 }
 
+/*
+ * Save a persistent table as a table image, which restoreTableFromDisk
+ * maps straight back into tuple storage.
+ */
+bool VoltDBEngine::saveTableToDisk(int32_t clusterId, int32_t databaseId,
+                                   int32_t tableId, std::string saveFilePath)
+{
+    PersistentTable *table = dynamic_cast<PersistentTable*>(getMigratedTable(tableId));
+    if (table == NULL) {
+        VOLT_ERROR("Table ID %d doesn't exist or is not a persistent table."
+                   " Could not save it", (int) tableId);
+        return false;
+    }
+    return TableImage::save(*table, tableId, saveFilePath);
+}
+
+bool VoltDBEngine::restoreTableFromDisk(std::string restoreFilePath)
+{
+    TableImage image;
+    if (!image.map(restoreFilePath)) {
+        VOLT_ERROR("Could not read a table image from %s", restoreFilePath.c_str());
+        return false;
+    }
+    PersistentTable *table = dynamic_cast<PersistentTable*>(getMigratedTable(image.tableId()));
+    if (table == NULL) {
+        VOLT_ERROR("Table ID %d doesn't exist or is not a persistent table."
+                   " Could not restore it", (int) image.tableId());
+        return false;
+    }
+    return table->restoreImage(image);
+}
+
 /*
  * Delete and rebuild id based table collections. Does not affect
  * any currently stored tuples.
@@ -1027,15 +1158,35 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
         return retval;
     }
     else {
-        std::string plan = m_topend->planForFragmentId(fragId);
+        // Another site on this host may already have fetched the plan.
+        SharedPlanCache::PlanPtr sharedPlan = SharedPlanCache::instance().get(fragId);
+        if (!sharedPlan) {
+            std::string fetchedPlan = m_topend->planForFragmentId(fragId);
+
+            if (fetchedPlan.length() == 0) {
+                char msg[1024];
+                snprintf(msg, 1024, "Fetched empty plan from frontend for PlanFragment '%jd'",
+                         (intmax_t)fragId);
+                VOLT_ERROR("%s", msg);
+                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
+            }
+            sharedPlan = SharedPlanCache::instance().put(fragId, fetchedPlan);
+        }
 
-        if (plan.length() == 0) {
-            char msg[1024];
-            snprintf(msg, 1024, "Fetched empty plan from frontend for PlanFragment '%jd'",
-                     (intmax_t)fragId);
-            VOLT_ERROR("%s", msg);
-            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
+        // Ad hoc fragments that differ only in constants are built from the
+        // shape and run on the same executors, each with its own constants.
+        bool useShape = !sharedPlan->shape.empty() &&
+            sharedPlan->constantBase + sharedPlan->constants.size() <= MAX_PARAM_COUNT;
+        if (useShape) {
+            ShapeMap::iterator shapeIter = m_executorsByShape.find(sharedPlan->shapeHash);
+            if (shapeIter != m_executorsByShape.end() &&
+                shapeIter->second->builtFrom->shape == sharedPlan->shape) {
+                boost::shared_ptr<ExecutorVector> ev(new ExecutorVector(fragId, shapeIter->second));
+                bindLiftedConstants(ev.get(), sharedPlan);
+                return addExecutorVector(ev);
+            }
         }
+        const std::string &plan = useShape ? sharedPlan->shape : sharedPlan->plan;
 
         PlanNodeFragment *pnf = NULL;
         try {
@@ -1047,7 +1198,8 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
         catch (...) {
             char msg[1024 * 100];
             snprintf(msg, 1024 * 100, "Unable to initialize PlanNodeFragment for PlanFragment '%jd' with plan:\n%s",
-                     (intmax_t)fragId, plan.c_str());
+                     (intmax_t)fragId,
+                     PlannerDomRoot::isBinary(plan.data(), plan.size()) ? "(binary)" : plan.c_str());
             VOLT_ERROR("%s", msg);
             throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION, msg);
         }
@@ -1072,12 +1224,14 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
             frag_temptable_limit = -1;
         }
 
-        boost::shared_ptr<ExecutorVector> ev(new ExecutorVector(fragId, frag_temptable_log_limit, frag_temptable_limit, pnf));
+        boost::shared_ptr<PlanExecutors> executors(new PlanExecutors(frag_temptable_log_limit, frag_temptable_limit, pnf));
+        executors->limits.setSpillThreshold(m_tempTableSpillThreshold);
+        executors->builtFrom = sharedPlan;
 
         // Initialize each node!
         for (int ctr = 0, cnt = (int)pnf->getExecuteList().size();
              ctr < cnt; ctr++) {
-            if (!initPlanNode(fragId, pnf->getExecuteList()[ctr], &(ev->limits)))
+            if (!initPlanNode(fragId, pnf->getExecuteList()[ctr], &(executors->limits)))
             {
                 char msg[1024 * 10];
                 snprintf(msg, 1024 * 10, "Failed to initialize PlanNode '%s' at position '%d' for PlanFragment '%jd'",
@@ -1089,26 +1243,60 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
 
         // Initialize the vector of executors for this planfragment, used at runtime.
         for (int ctr = 0, cnt = (int)pnf->getExecuteList().size(); ctr < cnt; ctr++) {
-            ev->list.push_back(pnf->getExecuteList()[ctr]->getExecutor());
+            executors->list.push_back(pnf->getExecuteList()[ctr]->getExecutor());
         }
 
-        // add the plan to the back
-        m_plans.get<0>().push_back(ev);
-
-        // remove a plan from the front if the cache is full
-        if (m_plans.size() > PLAN_CACHE_SIZE) {
-            PlanSet::iterator iter = m_plans.get<0>().begin();
-            m_plans.erase(iter);
+        boost::shared_ptr<ExecutorVector> ev(new ExecutorVector(fragId, executors));
+        if (useShape) {
+            bindLiftedConstants(ev.get(), sharedPlan);
+            // A colliding hash of another shape just goes without sharing
+            m_executorsByShape.insert(std::make_pair(sharedPlan->shapeHash, executors));
         }
-
-        VoltDBEngine::ExecutorVector *retval = ev.get();
-        assert(retval);
-        return retval;
+        else {
+            ev->sharedPlan = sharedPlan;
+        }
+        return addExecutorVector(ev);
     }
 
     return NULL;
 }
 
+void VoltDBEngine::bindLiftedConstants(ExecutorVector *ev, SharedPlanCache::PlanPtr sharedPlan) {
+    assert(ev->liftedConstants.empty());
+    ev->sharedPlan = sharedPlan;
+    ev->liftedParamBase = sharedPlan->constantBase;
+    for (size_t ii = 0; ii < sharedPlan->constants.size(); ii++) {
+        const std::string &constant = sharedPlan->constants[ii];
+        PlannerDomRoot domRoot(constant.data(), constant.size());
+        ev->liftedConstants.push_back(ExpressionUtil::constantValueFromJSON(domRoot.rootObject()));
+    }
+}
+
+VoltDBEngine::ExecutorVector *VoltDBEngine::addExecutorVector(boost::shared_ptr<ExecutorVector> ev) {
+    // add the plan to the back
+    m_plans.get<0>().push_back(ev);
+
+    // remove a plan from the front if the cache is full, and the executors
+    // of its shape with the last fragment of that shape
+    if (m_plans.size() > PLAN_CACHE_SIZE) {
+        PlanSet::iterator iter = m_plans.get<0>().begin();
+        boost::shared_ptr<ExecutorVector> evicted = *iter;
+        m_plans.erase(iter);
+        if (!evicted->liftedConstants.empty()) {
+            ShapeMap::iterator shapeIter = m_executorsByShape.find(evicted->sharedPlan->shapeHash);
+            if (shapeIter != m_executorsByShape.end() &&
+                shapeIter->second == evicted->executors &&
+                evicted->executors.use_count() == 2) {
+                m_executorsByShape.erase(shapeIter);
+            }
+        }
+    }
+
+    VoltDBEngine::ExecutorVector *retval = ev.get();
+    assert(retval);
+    return retval;
+}
+
 // -------------------------------------------------
 // Initialization Functions
 // -------------------------------------------------
@@ -1247,6 +1435,99 @@ void VoltDBEngine::tick(int64_t timeInMillis, int64_t lastCommittedSpHandle) {
     BOOST_FOREACH (TablePair table, m_exportingTables) {
         table.second->flushOldTuples(timeInMillis);
     }
+    migrateSchemaChanges(SCHEMA_CHANGE_BLOCKS_PER_TICK);
+}
+
+/*
+ * Delete up to maxTuples of the tuples that have outlived their table's
+ * time to live at timeInMillis, a batch per table at a time so that no
+ * table starves the others. This runs in a single partition transaction,
+ * which supplies the time and the undo quantum, so every replica deletes
+ * the same tuples and a rollback restores them. Returns how many were
+ * deleted.
+ */
+int64_t VoltDBEngine::purgeExpiredTuples(int64_t timeInMillis, int64_t maxTuples) {
+    buildDeferredIndexes();
+    vector<PersistentTable*> expiring;
+    typedef pair<CatalogId, Table*> TablePair;
+    BOOST_FOREACH (TablePair table, m_tables) {
+        PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(table.second);
+        // a table still changing schema is purged once its tuples have
+        // all moved over, rather than moving them all now; replicated
+        // tables are not purged by a single partition
+        if (persistentTable != NULL && persistentTable->hasTimeToLive() &&
+            persistentTable->partitionColumn() >= 0 &&
+            !persistentTable->isMigrating()) {
+            expiring.push_back(persistentTable);
+        }
+    }
+
+    int64_t purged = 0;
+    while (!expiring.empty() && purged < maxTuples) {
+        vector<PersistentTable*>::iterator iter = expiring.begin();
+        while (iter != expiring.end() && purged < maxTuples) {
+            const int64_t batch = std::min(TTL_PURGE_TUPLES_PER_BATCH, maxTuples - purged);
+            int64_t count = (*iter)->purgeExpiredTuples(timeInMillis, batch);
+            purged += count;
+            if (count < batch) {
+                iter = expiring.erase(iter);
+            }
+            else {
+                ++iter;
+            }
+        }
+    }
+    return purged;
+}
+
+/*
+ * Move up to maxBlocks blocks of tuples (all if negative) into each table
+ * left changing schema by a catalog update, forgetting the tables that are
+ * done.
+ */
+void VoltDBEngine::migrateSchemaChanges(int64_t maxBlocks) {
+    map<Table*, TableCatalogDelegate*>::iterator iter = m_migratingTables.begin();
+    while (iter != m_migratingTables.end()) {
+        if (iter->second->migrateSchemaChange(maxBlocks)) {
+            m_migratingTables.erase(iter++);
+        }
+        else {
+            ++iter;
+        }
+    }
+}
+
+/*
+ * Move all the tuples left for table, if it is changing schema, so that
+ * it can be used.
+ */
+void VoltDBEngine::finishSchemaChange(Table *table) {
+    map<Table*, TableCatalogDelegate*>::iterator iter = m_migratingTables.find(table);
+    if (iter != m_migratingTables.end()) {
+        iter->second->migrateSchemaChange(-1);
+        m_migratingTables.erase(iter);
+    }
+}
+
+void VoltDBEngine::buildDeferredIndexes() {
+    BOOST_FOREACH (PersistentTable *table, m_deferredIndexTables) {
+        table->buildDeferredIndexes();
+    }
+    m_deferredIndexTables.clear();
+}
+
+/*
+ * Build the indexes of table, if loadTable left them deferred, so that it
+ * can be used.
+ */
+void VoltDBEngine::buildDeferredIndexes(Table *table) {
+    set<PersistentTable*>::iterator iter =
+        m_deferredIndexTables.find(dynamic_cast<PersistentTable*>(table));
+    if (iter != m_deferredIndexTables.end()) {
+        PersistentTable *persistentTable = *iter;
+        m_deferredIndexTables.erase(iter);
+        persistentTable->buildDeferredIndexes();
+    }
 }
 
 /** For now, bring the Export system to a steady state with no buffers with content */
@@ -1267,12 +1548,12 @@ string VoltDBEngine::debug(void) const {
         boost::shared_ptr<ExecutorVector> ev = *iter;
 
         output << "Fragment ID: " << ev->fragId << ", "
-               << "Executor list size: " << ev->list.size() << ", "
+               << "Executor list size: " << ev->executors->list.size() << ", "
                << "Temp table memory in bytes: "
-               << ev->limits.getAllocated() << endl;
+               << ev->executors->limits.getAllocated() << endl;
 
-        for (executorIter = ev->list.begin();
-             executorIter != ev->list.end();
+        for (executorIter = ev->executors->list.begin();
+             executorIter != ev->executors->list.end();
              executorIter++) {
             output << (*executorIter)->getPlanNode()->debug(" ") << endl;
         }
@@ -1402,7 +1683,7 @@ bool VoltDBEngine::activateTableStream(
         TableStreamType streamType,
         int64_t undoToken,
         ReferenceSerializeInput &serializeIn) {
-    Table* found = getTable(tableId);
+    Table* found = getMigratedTable(tableId);
     if (! found) {
         return false;
     }
@@ -1518,7 +1799,7 @@ int64_t VoltDBEngine::tableStreamSerializeMore(
         table = findInMapOrNull(tableId, m_snapshottingTables);
     }
     else if (tableStreamTypeIsValid(streamType)) {
-        Table* found = getTable(tableId);
+        Table* found = getMigratedTable(tableId);
         if (found) {
             table = dynamic_cast<PersistentTable*>(found);
         }
@@ -1547,7 +1828,7 @@ int64_t VoltDBEngine::tableStreamSerializeMore(
  */
 void VoltDBEngine::processRecoveryMessage(RecoveryProtoMsg *message) {
     CatalogId tableId = message->tableId();
-    Table* found = getTable(tableId);
+    Table* found = getMigratedTable(tableId);
     if (! found) {
         throwFatalException(
                 "Attempted to process recovery message for tableId %d but the table could not be found", tableId);
@@ -1556,6 +1837,18 @@ void VoltDBEngine::processRecoveryMessage(RecoveryProtoMsg *message) {
     table->processRecoveryMessage(message, NULL);
 }
 
+void VoltDBEngine::setIndexBuildThreads(int threads) {
+    m_executorContext->setIndexBuildThreads(threads);
+}
+
+void VoltDBEngine::setTempBlockPoolSize(int64_t bytes) {
+    TempBlockPool::forThisThread()->setHighWaterMark(bytes);
+}
+
+void VoltDBEngine::setTempTableSpillThreshold(int64_t bytes) {
+    m_tempTableSpillThreshold = bytes;
+}
+
 int64_t
 VoltDBEngine::exportAction(bool syncAction, int64_t ackOffset, int64_t seqNo, std::string tableSignature)
 {
@@ -1603,7 +1896,7 @@ void VoltDBEngine::getUSOForExportTable(size_t &ackOffset, int64_t &seqNo, std::
 }
 
 size_t VoltDBEngine::tableHashCode(int32_t tableId) {
-    Table* found = getTable(tableId);
+    Table* found = getMigratedTable(tableId);
     if (! found) {
         throwFatalException("Tried to calculate a hash code for a table that doesn't exist with id %d\n", tableId);
     }
@@ -1657,11 +1950,11 @@ void VoltDBEngine::dispatchValidatePartitioningTask(const char *taskParams) {
     std::vector<int64_t> mispartitionedRowCounts;
 
     BOOST_FOREACH( CatalogId tableId, tableIds) {
-        std::map<CatalogId, Table*>::iterator table = m_tables.find(tableId);
-        if (table == m_tables.end()) {
+        Table *table = getMigratedTable(tableId);
+        if (table == NULL) {
             throwFatalException("Unknown table id %d", tableId);
         } else {
-            mispartitionedRowCounts.push_back(m_tables[tableId]->validatePartitioning(hashinator.get(), m_partitionId));
+            mispartitionedRowCounts.push_back(table->validatePartitioning(hashinator.get(), m_partitionId));
         }
     }
 
@@ -1677,6 +1970,52 @@ void VoltDBEngine::executeTask(TaskType taskType, const char* taskParams) {
     case TASK_TYPE_VALIDATE_PARTITIONING:
         dispatchValidatePartitioningTask(taskParams);
         break;
+    case TASK_TYPE_SET_INDEX_BUILD_THREADS: {
+        ReferenceSerializeInput taskInfo(taskParams, sizeof(int32_t));
+        setIndexBuildThreads(taskInfo.readInt());
+        m_resultOutput.writeInt(0);
+        break;
+    }
+    case TASK_TYPE_SAVE_TABLE_IMAGE: {
+        ReferenceSerializeInput taskInfo(taskParams, std::numeric_limits<std::size_t>::max());
+        const int32_t tableId = taskInfo.readInt();
+        const bool saved = saveTableToDisk(0, 0, tableId, taskInfo.readTextString());
+        m_resultOutput.writeInt(sizeof(int8_t));
+        m_resultOutput.writeBool(saved);
+        break;
+    }
+    case TASK_TYPE_RESTORE_TABLE_IMAGE: {
+        ReferenceSerializeInput taskInfo(taskParams, std::numeric_limits<std::size_t>::max());
+        const bool restored = restoreTableFromDisk(taskInfo.readTextString());
+        m_resultOutput.writeInt(sizeof(int8_t));
+        m_resultOutput.writeBool(restored);
+        break;
+    }
+    case TASK_TYPE_SET_TEMP_BLOCK_POOL_SIZE: {
+        ReferenceSerializeInput taskInfo(taskParams, sizeof(int64_t));
+        setTempBlockPoolSize(taskInfo.readLong());
+        m_resultOutput.writeInt(0);
+        break;
+    }
+    case TASK_TYPE_SET_TEMP_TABLE_SPILL_THRESHOLD: {
+        ReferenceSerializeInput taskInfo(taskParams, sizeof(int64_t));
+        setTempTableSpillThreshold(taskInfo.readLong());
+        m_resultOutput.writeInt(0);
+        break;
+    }
+    case TASK_TYPE_BUILD_DEFERRED_INDEXES:
+        buildDeferredIndexes();
+        m_resultOutput.writeInt(0);
+        break;
+    case TASK_TYPE_PURGE_EXPIRED_TUPLES: {
+        ReferenceSerializeInput taskInfo(taskParams, sizeof(int64_t) * 3);
+        setUndoToken(taskInfo.readLong());
+        const int64_t timeInMillis = taskInfo.readLong();
+        const int64_t purged = purgeExpiredTuples(timeInMillis, taskInfo.readLong());
+        m_resultOutput.writeInt(sizeof(int64_t));
+        m_resultOutput.writeLong(purged);
+        break;
+    }
     default:
         throwFatalException("Unknown task type %d", taskType);
     }
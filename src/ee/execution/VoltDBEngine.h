@@ -74,12 +74,15 @@
 #include "common/TupleOutputStream.h"
 #include "common/TheHashinator.h"
 #include "execution/FragmentManager.h"
+#include "execution/SharedPlanCache.h"
 #include "logging/LogManager.h"
 #include "logging/LogProxy.h"
 #include "logging/StdoutLogProxy.h"
 #include "plannodes/plannodefragment.h"
 #include "stats/StatsAgent.h"
+#include "storage/SharedSchemaCache.h"
 #include "storage/TempTableLimits.h"
+#include "storage/TempBlockPool.h"
 #include "common/ThreadLocalPool.h"
 
 // shorthand for ExecutionEngine versions generated by javah
@@ -108,6 +111,7 @@ class SerializeOutput;
 class PersistentTable;
 class Table;
 class CatalogDelegate;
+class TableCatalogDelegate;
 class PlanNodeFragment;
 class ExecutorContext;
 class RecoveryProtoMsg;
@@ -116,6 +120,11 @@ const int64_t DEFAULT_TEMP_TABLE_MEMORY = 1024 * 1024 * 100;
 const size_t PLAN_CACHE_SIZE = 1024 * 10;
 // how many tuples to scan before calling into java
 const int64_t LONG_OP_THRESHOLD = 10000;
+// how many blocks of tuples each table changing schema moves over per tick
+const int64_t SCHEMA_CHANGE_BLOCKS_PER_TICK = 8;
+// how many tuples that outlived their time to live a purge deletes from
+// one table before moving on to the next
+const int64_t TTL_PURGE_TUPLES_PER_BATCH = 1000;
 
 /**
  * Represents an Execution Engine which holds catalog objects (i.e. table) and executes
@@ -133,11 +142,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
           m_currentUndoQuantum(NULL),
           m_hashinator(NULL),
           m_staticParams(MAX_PARAM_COUNT),
+          m_shapeParams(MAX_PARAM_COUNT),
+          m_executingParams(&m_staticParams),
           m_currentInputDepId(-1),
           m_isELEnabled(false),
           m_numResultDependencies(0),
           m_logManager(new StdoutLogProxy()), m_templateSingleLongTable(NULL), m_topend(NULL)
         {
+            SharedPlanCache::instance().attachEngine();
+            SharedSchemaCache::attachEngine();
         }
 
         VoltDBEngine(Topend *topend, LogProxy *logProxy);
@@ -159,8 +172,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         Table* getTable(int32_t tableId) const;
         Table* getTable(std::string name) const;
+        // Looks a table up to use all of its tuples at once, as loads,
+        // snapshots and recovery do, first moving over the ones left in its
+        // layout from before a schema change and building any indexes its
+        // load deferred. Executors find those as they
+        // go instead, see PersistentTable::isMigrating. NULL if missing.
+        Table* getMigratedTable(int32_t tableId);
+        Table* getMigratedTable(const std::string &name);
         // Serializes table_id to out. Returns true if successful.
-        bool serializeTable(int32_t tableId, SerializeOutput* out) const;
+        bool serializeTable(int32_t tableId, SerializeOutput* out);
 
         // -------------------------------------------------
         // Execution Functions
@@ -261,6 +281,12 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         inline int getReusedResultBufferCapacity() const { return m_reusedResultCapacity;}
 
         NValueArray& getParameterContainer() { return m_staticParams; }
+        /**
+         * The parameters, lifted constants included, of the fragment being
+         * executed, for executors that evaluate their expressions before
+         * their own turn to run (see TempTableSpillSink).
+         */
+        const NValueArray& getExecutingParameters() const { return *m_executingParams; }
         int64_t* getBatchFragmentIdsContainer() { return m_batchFragmentIdsContainer; }
         int64_t* getBatchDepIdsContainer() { return m_batchDepIdsContainer; }
 
@@ -406,6 +432,38 @@ class __attribute__((visibility("default"))) VoltDBEngine {
          */
         void processRecoveryMessage(RecoveryProtoMsg *message);
 
+        /*
+         * Number of helper threads that build the indexes of a table
+         * filled by recovery or a rejoin snapshot, alongside the site
+         * thread. Zero, the default, builds them all on the site thread.
+         * Java sets it through TASK_TYPE_SET_INDEX_BUILD_THREADS.
+         */
+        void setIndexBuildThreads(int threads);
+
+        /*
+         * Build the indexes of every table that loadTable filled from
+         * empty without them, once the last chunk has been loaded. Java
+         * calls it through TASK_TYPE_BUILD_DEFERRED_INDEXES at the end of
+         * a rejoin snapshot, and anything else that needs the indexes
+         * builds them first.
+         */
+        void buildDeferredIndexes();
+
+        /*
+         * Most bytes of freed temp table block storage the site keeps to
+         * reuse for the temp tables of later fragments. Java sets it
+         * through TASK_TYPE_SET_TEMP_BLOCK_POOL_SIZE.
+         */
+        void setTempBlockPoolSize(int64_t bytes);
+
+        /*
+         * Input size in bytes above which ORDER BY and hash aggregation
+         * spill to scratch files instead of working in memory, for the
+         * fragments planned from now on. Negative (the default) to never
+         * spill. Java sets it through TASK_TYPE_SET_TEMP_TABLE_SPILL_THRESHOLD.
+         */
+        void setTempTableSpillThreshold(int64_t bytes);
+
         /**
          * Perform an action on behalf of Export.
          *
@@ -453,6 +511,11 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         void processCatalogDeletes(int64_t timestamp);
         void rebuildTableCollections();
         void initMaterializedViews(bool addAll);
+
+        void migrateSchemaChanges(int64_t maxBlocks);
+        int64_t purgeExpiredTuples(int64_t timeInMillis, int64_t maxTuples);
+        void finishSchemaChange(Table *table);
+        void buildDeferredIndexes(Table *table);
         bool updateCatalogDatabaseReference();
 
         bool hasSameSchema(catalog::Table *t1, voltdb::Table *t2);
@@ -467,22 +530,47 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         /**
          * Keep a list of executors for runtime - intentionally near the top of VoltDBEngine
          */
-        struct ExecutorVector {
-            ExecutorVector(int64_t fragmentId,
-                           int64_t logThreshold,
-                           int64_t memoryLimit,
-                           PlanNodeFragment *fragment) : fragId(fragmentId), planFragment(fragment)
+        struct PlanExecutors {
+            PlanExecutors(int64_t logThreshold,
+                          int64_t memoryLimit,
+                          PlanNodeFragment *fragment) : planFragment(fragment)
             {
                 limits.setLogThreshold(logThreshold);
                 limits.setMemoryLimit(memoryLimit);
             }
 
-            int64_t getFragId() const { return fragId; }
-
-            const int64_t fragId;
             boost::shared_ptr<PlanNodeFragment> planFragment;
             std::vector<AbstractExecutor*> list;
             TempTableLimits limits;
+            // The plan these were built from. For the executors of an ad
+            // hoc plan shape, any of the fragments of that shape.
+            SharedPlanCache::PlanPtr builtFrom;
+        };
+
+        struct ExecutorVector {
+            ExecutorVector(int64_t fragmentId,
+                           boost::shared_ptr<PlanExecutors> planExecutors)
+              : fragId(fragmentId), executors(planExecutors), liftedParamBase(0)
+            {}
+
+            ~ExecutorVector() {
+                for (size_t ii = 0; ii < liftedConstants.size(); ii++) {
+                    liftedConstants[ii].free();
+                }
+            }
+
+            int64_t getFragId() const { return fragId; }
+
+            const int64_t fragId;
+            // Shared by every cached fragment of the same ad hoc plan shape
+            boost::shared_ptr<PlanExecutors> executors;
+
+            // The plan of the fragment this runs.
+            SharedPlanCache::PlanPtr sharedPlan;
+            // Constants lifted out of the plan, passed to the executors as
+            // the parameters from liftedParamBase on.
+            std::vector<NValue> liftedConstants;
+            int liftedParamBase;
         };
 
         /**
@@ -500,6 +588,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         > PlanSet;
         PlanSet m_plans;
 
+        /**
+         * Executors of the ad hoc fragments in m_plans, by shape hash. The
+         * fragments of a shape differ only in their lifted constants, which
+         * are bound per execution, so they all run on the same executors.
+         * An entry goes when the last of its fragments leaves m_plans.
+         */
+        typedef std::map<size_t, boost::shared_ptr<PlanExecutors> > ShapeMap;
+        ShapeMap m_executorsByShape;
+
         /**
          * Get a vector of executors for a given fragment id.
          * Get the vector from the cache if the fragment id is there.
@@ -508,6 +605,12 @@ class __attribute__((visibility("default"))) VoltDBEngine {
          */
         ExecutorVector *getExecutorVectorForFragmentId(const int64_t fragId);
 
+        /** Read the constants lifted out of a shared plan into ev. */
+        void bindLiftedConstants(ExecutorVector *ev, SharedPlanCache::PlanPtr sharedPlan);
+
+        /** Add ev to the plan cache, evicting the least recently used. */
+        ExecutorVector *addExecutorVector(boost::shared_ptr<ExecutorVector> ev);
+
         voltdb::UndoLog m_undoLog;
         voltdb::UndoQuantum *m_currentUndoQuantum;
 
@@ -520,6 +623,7 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         boost::scoped_ptr<TheHashinator> m_hashinator;
         size_t m_startOfResultBuffer;
         int64_t m_tempTableMemoryLimit;
+        int64_t m_tempTableSpillThreshold;
 
         /*
          * Catalog delegates hashed by path.
@@ -556,8 +660,25 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         boost::shared_ptr<catalog::Catalog> m_catalog;
         catalog::Database *m_database;
 
+        /**
+         * Tables that are still moving tuples over from before a schema
+         * change, see migrateSchemaChanges. Lookups through getMigratedTable
+         * finish the move.
+         */
+        std::map<Table*, TableCatalogDelegate*> m_migratingTables;
+
+        /**
+         * Tables loaded without their indexes, see buildDeferredIndexes.
+         * Lookups through getMigratedTable build them.
+         */
+        std::set<PersistentTable*> m_deferredIndexTables;
+
         /** reused parameter container. */
         NValueArray m_staticParams;
+        /** parameters plus lifted constants for fragments run from a plan shape. */
+        NValueArray m_shapeParams;
+        /** m_staticParams or m_shapeParams, whichever the executing fragment uses. */
+        const NValueArray *m_executingParams;
         /** TODO : should be passed as execute() parameter..*/
         int m_usedParamcnt;
 
@@ -635,6 +756,8 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         DefaultTupleSerializer m_tupleSerializer;
 
         ThreadLocalPool m_tlPool;
+
+        TempBlockPoolHolder m_tempBlockPoolHolder;
 };
 
 inline void VoltDBEngine::resetReusedResultOutputBuffer(const size_t headerSize) {
@@ -48,11 +48,16 @@
 #include "common/ValueFactory.hpp"
 #include "common/common.h"
 #include "common/debuglog.h"
+#include "common/executorcontext.hpp"
 #include "common/SerializableEEException.h"
 #include "expressions/abstractexpression.h"
 #include "plannodes/aggregatenode.h"
+#include "plannodes/windowfunctionnode.h"
 #include "storage/temptable.h"
 #include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+#include "storage/TupleSpill.h"
+#include "boost/ptr_container/ptr_vector.hpp"
 
 #include "boost/foreach.hpp"
 #include "boost/unordered_map.hpp"
@@ -315,6 +320,97 @@ public:
     }
 };
 
+/*
+ * The ranking window functions, which ignore their input. The window
+ * executor advances them over each run of peer rows and then finalizes
+ * them once per peer as it outputs the run.
+ */
+class RowNumberAgg : public Agg
+{
+public:
+    RowNumberAgg() : m_count(0) {}
+
+    virtual void advance(const NValue& val)
+    {
+    }
+
+    virtual NValue finalize()
+    {
+        return ValueFactory::getBigIntValue(++m_count);
+    }
+
+    virtual void resetAgg()
+    {
+        m_haveAdvanced = false;
+        m_count = 0;
+    }
+
+private:
+    int64_t m_count;
+};
+
+class RankAgg : public Agg
+{
+public:
+    RankAgg() : m_count(0), m_rank(0) {}
+
+    virtual void advance(const NValue& val)
+    {
+        // The first row since the last output starts a run of peers.
+        if (!m_haveAdvanced) {
+            m_rank = m_count + 1;
+            m_haveAdvanced = true;
+        }
+        ++m_count;
+    }
+
+    virtual NValue finalize()
+    {
+        m_haveAdvanced = false;
+        return ValueFactory::getBigIntValue(m_rank);
+    }
+
+    virtual void resetAgg()
+    {
+        m_haveAdvanced = false;
+        m_count = 0;
+        m_rank = 0;
+    }
+
+private:
+    int64_t m_count;
+    int64_t m_rank;
+};
+
+class DenseRankAgg : public Agg
+{
+public:
+    DenseRankAgg() : m_rank(0) {}
+
+    virtual void advance(const NValue& val)
+    {
+        if (!m_haveAdvanced) {
+            ++m_rank;
+            m_haveAdvanced = true;
+        }
+    }
+
+    virtual NValue finalize()
+    {
+        m_haveAdvanced = false;
+        return ValueFactory::getBigIntValue(m_rank);
+    }
+
+    virtual void resetAgg()
+    {
+        m_haveAdvanced = false;
+        m_rank = 0;
+    }
+
+private:
+    int64_t m_rank;
+};
+
 /*
  * Create an instance of an aggregator for the specified aggregate type and "distinct" flag.
  * The object is allocated from the provided memory pool.
@@ -343,6 +439,12 @@ inline Agg* getAggInstance(Pool& memoryPool, ExpressionType agg_type, bool isDis
             return new (memoryPool) AvgAgg<Distinct>();
         }
         return new (memoryPool) AvgAgg<NotDistinct>();
+    case EXPRESSION_TYPE_AGGREGATE_ROW_NUMBER:
+        return new (memoryPool) RowNumberAgg();
+    case EXPRESSION_TYPE_AGGREGATE_RANK:
+        return new (memoryPool) RankAgg();
+    case EXPRESSION_TYPE_AGGREGATE_DENSE_RANK:
+        return new (memoryPool) DenseRankAgg();
     default:
     {
         char message[128];
@@ -437,6 +539,7 @@ bool AggregateExecutorBase::p_init(AbstractPlanNode*, TempTableLimits* limits)
     }
 
     setTempOutputTable(limits);
+    m_limits = limits;
 
     m_aggTypes = node->getAggregates();
     m_distinctAggs = node->getDistinctAggregates();
@@ -507,7 +610,7 @@ inline void AggregateExecutorBase::initGroupByKeyTuple(PoolBackedTupleStorage &n
 /// Helper method responsible for inserting the results of the
 /// aggregation into a new tuple in the output table as well as passing
 /// through any additional columns from the input table.
-inline void AggregateExecutorBase::insertOutputTuple(AggregateRow* aggregateRow)
+inline void AggregateExecutorBase::insertOutputTuple(AggregateRow* aggregateRow, Pool* objectPool)
 {
     TempTable* output_table = m_tmpOutputTable;
     TableTuple& tmptup = output_table->tempTuple();
@@ -529,7 +632,11 @@ inline void AggregateExecutorBase::insertOutputTuple(AggregateRow* aggregateRow)
         VOLT_TRACE("Passthrough columns: %d", output_col_index);
     }
     if (m_postPredicate == NULL || m_postPredicate->eval(&tmptup, NULL).isTrue()) {
-        output_table->insertTupleNonVirtual(tmptup);
+        if (objectPool == NULL) {
+            output_table->insertTupleNonVirtual(tmptup);
+        } else {
+            output_table->insertTupleNonVirtualWithDeepCopy(tmptup, objectPool);
+        }
     }
 
     VOLT_TRACE("output_table:\n%s", output_table->debug().c_str());
@@ -557,60 +664,209 @@ inline void AggregateExecutorBase::initAggInstances(AggregateRow* aggregateRow)
     }
 }
 
-typedef boost::unordered_map<TableTuple,
-                             AggregateRow*,
-                             TableTupleHasher,
-                             TableTupleEqualityChecker> HashAggregateMapType;
+// A spilled hash aggregation splits its input TupleSpill::MAX_FAN ways
+// by this many bits of the group keys' hashes, and splits a partition
+// again, by the next bits, at most this many times in all.
+static const int SPILL_PARTITION_BITS = 4;
+static const int MAX_SPILL_DEPTH = 4;
+
+static inline size_t spillPartitionOf(const TableTuple& groupByKeyTuple, int depth)
+{
+    // Scramble the hash so that the groups of a partition do not all
+    // share the low bits the hash table picks its buckets by, and take
+    // the top bits for the first split, the ones below for the next.
+    const uint64_t hash = static_cast<uint64_t>(groupByKeyTuple.hashCode()) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash >> (64 - SPILL_PARTITION_BITS * (depth + 1))) %
+        TupleSpill::MAX_FAN;
+}
+
+inline void AggregateHashExecutor::aggregateTuple(HashAggregateMapType& hash,
+                                                  PoolBackedTupleStorage& nextGroupByKeyStorage,
+                                                  const TableTuple& nxtTuple)
+{
+    TableTuple& nextGroupByKeyTuple = nextGroupByKeyStorage;
+    initGroupByKeyTuple(nextGroupByKeyStorage, nxtTuple);
+    AggregateRow *aggregateRow;
+    // Search for the matching group.
+    HashAggregateMapType::const_iterator keyIter = hash.find(nextGroupByKeyTuple);
+
+    // Group not found. Make a new entry in the hash for this new group.
+    if (keyIter == hash.end()) {
+        aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
+        hash.insert(HashAggregateMapType::value_type(nextGroupByKeyTuple, aggregateRow));
+        initAggInstances(aggregateRow);
+        aggregateRow->m_passThroughTuple = nxtTuple;
+        // The map is referencing the current key tuple for use by the new group,
+        // so force a new tuple allocation to hold the next candidate key.
+        nextGroupByKeyTuple.move(NULL);
+    } else {
+        // otherwise, the agg row is the second item of the pair...
+        aggregateRow = keyIter->second;
+    }
+    // update the aggregation calculation.
+    aggregateRow->m_passThroughTuple = nxtTuple;
+    advanceAggs(aggregateRow);
+}
+
+inline void AggregateHashExecutor::outputGroups(HashAggregateMapType& hash, Pool* objectPool)
+{
+    for (HashAggregateMapType::const_iterator iter = hash.begin(); iter != hash.end(); iter++) {
+        AggregateRow *aggregateRow = iter->second;
+        insertOutputTuple(aggregateRow, objectPool);
+        delete aggregateRow;
+    }
+    hash.clear();
+}
 
 bool AggregateHashExecutor::p_execute(const NValueArray& params)
 {
     executeAggBase(params);
 
-    HashAggregateMapType hash;
-
     VOLT_TRACE("looping..");
     Table* input_table = m_abstractNode->getInputTables()[0];
     assert(input_table);
     VOLT_TRACE("input table\n%s", input_table->debug().c_str());
+    // Spill if the input has spilled already while it was produced, or if
+    // it came in whole (from a table that is not our child's temp table)
+    // and is over the threshold.
+    const int64_t tupleSize = input_table->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+    if (!m_partitions.empty() ||
+        (m_limits != NULL && m_groupByKeySchema->columnCount() != 0 &&
+         m_limits->shouldSpill(input_table->activeTupleCount() * tupleSize))) {
+        partitionInput(input_table);
+        // Every input tuple is in a partition now; free the input. Take
+        // the partitions first, as clearing the input discards them.
+        boost::ptr_vector<TupleSpill> partitions;
+        partitions.swap(m_partitions);
+        TempTable* temp_input = dynamic_cast<TempTable*>(input_table);
+        if (temp_input != NULL) {
+            temp_input->deleteAllTuplesNonVirtual(false);
+        }
+        aggregatePartitions(partitions, 0);
+        return true;
+    }
+
+    HashAggregateMapType hash;
     TableIterator it = input_table->iterator();
     TableTuple nxtTuple(input_table->schema());
     PoolBackedTupleStorage nextGroupByKeyStorage(m_groupByKeySchema, &m_memoryPool);
-    TableTuple& nextGroupByKeyTuple = nextGroupByKeyStorage;
-    while (it.next(nxtTuple)) {
-        m_engine->noteTuplesProcessedForProgressMonitoring(1);
-        initGroupByKeyTuple(nextGroupByKeyStorage, nxtTuple);
-        AggregateRow *aggregateRow;
-        // Search for the matching group.
-        HashAggregateMapType::const_iterator keyIter = hash.find(nextGroupByKeyTuple);
-
-        // Group not found. Make a new entry in the hash for this new group.
-        if (keyIter == hash.end()) {
-            aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
-            hash.insert(HashAggregateMapType::value_type(nextGroupByKeyTuple, aggregateRow));
-            initAggInstances(aggregateRow);
-            aggregateRow->m_passThroughTuple = nxtTuple;
-            // The map is referencing the current key tuple for use by the new group,
-            // so force a new tuple allocation to hold the next candidate key.
-            nextGroupByKeyTuple.move(NULL);
-        } else {
-            // otherwise, the agg row is the second item of the pair...
-            aggregateRow = keyIter->second;
+    TupleBlockSpan span;
+    while (it.nextBlock(span)) {
+        for (uint32_t slot = 0; slot < span.count; ++slot) {
+            span.prefetch(slot + TupleBlockSpan::PREFETCH_DISTANCE);
+            if (!span.isVisible(slot)) {
+                continue;
+            }
+            nxtTuple.move(span.tupleAddress(slot));
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            aggregateTuple(hash, nextGroupByKeyStorage, nxtTuple);
         }
-        // update the aggregation calculation.
-        aggregateRow->m_passThroughTuple = nxtTuple;
-        advanceAggs(aggregateRow);
     }
 
     VOLT_TRACE("finalizing..");
-    for (HashAggregateMapType::const_iterator iter = hash.begin(); iter != hash.end(); iter++) {
-        AggregateRow *aggregateRow = iter->second;
-        insertOutputTuple(aggregateRow);
-        delete aggregateRow;
-    }
+    outputGroups(hash, NULL);
 
     return true;
 }
 
+bool AggregateHashExecutor::p_init(AbstractPlanNode* abstractNode, TempTableLimits* limits)
+{
+    if (!AggregateExecutorBase::p_init(abstractNode, limits)) {
+        return false;
+    }
+    // Partition the input and spill it as the child produces it, whenever
+    // it grows past the spill threshold.
+    TempTable* input_table = dynamic_cast<TempTable*>(m_abstractNode->getInputTables()[0]);
+    if (input_table != NULL && m_groupByKeySchema->columnCount() != 0) {
+        input_table->setSpillSink(this);
+    }
+    return true;
+}
+
+void AggregateHashExecutor::spillTuples(TempTable* input_table)
+{
+    // The child is still producing the input, so p_execute has yet to
+    // substitute this fragment's parameters.
+    const NValueArray& params = m_engine->getExecutingParameters();
+    BOOST_FOREACH(AbstractExpression* groupByExpression, m_groupByExpressions) {
+        groupByExpression->substitute(params);
+    }
+    partitionInput(input_table);
+}
+
+void AggregateHashExecutor::discardSpilledTuples()
+{
+    m_partitions.clear();
+}
+
+void AggregateHashExecutor::partitionInput(Table* input_table)
+{
+    const TupleSchema* schema = input_table->schema();
+    if (m_partitions.empty()) {
+        for (size_t i = 0; i < TupleSpill::MAX_FAN; i++) {
+            m_partitions.push_back(new TupleSpill(schema));
+        }
+    }
+    TableIterator it = input_table->iterator();
+    TableTuple nxtTuple(schema);
+    Pool keyPool;
+    PoolBackedTupleStorage groupByKeyStorage(m_groupByKeySchema, &keyPool);
+    while (it.next(nxtTuple)) {
+        initGroupByKeyTuple(groupByKeyStorage, nxtTuple);
+        m_partitions[spillPartitionOf(groupByKeyStorage, 0)].append(nxtTuple);
+    }
+}
+
+void AggregateHashExecutor::aggregatePartitions(boost::ptr_vector<TupleSpill>& partitions, int depth)
+{
+    const TupleSchema* schema = m_abstractNode->getInputTables()[0]->schema();
+    const int64_t tupleSize = schema->tupleLength() + TUPLE_HEADER_SIZE;
+    Pool* tempStringPool = ExecutorContext::getTempStringPool();
+    for (size_t i = 0; i < partitions.size(); i++) {
+        TupleSpill& partition = partitions[i];
+        partition.rewind();
+        Pool partitionPool;
+        TableTuple tuple(schema);
+
+        if (depth + 1 < MAX_SPILL_DEPTH &&
+            m_limits->shouldSpill(partition.tupleCount() * tupleSize)) {
+            // Too big to aggregate in memory still: split it again, reading
+            // each tuple into the same storage.
+            boost::ptr_vector<TupleSpill> parts;
+            for (size_t j = 0; j < TupleSpill::MAX_FAN; j++) {
+                parts.push_back(new TupleSpill(schema));
+            }
+            PoolBackedTupleStorage groupByKeyStorage(m_groupByKeySchema, &partitionPool);
+            tuple.move(partitionPool.allocateZeroes(tupleSize));
+            Pool objects;
+            while (partition.next(tuple, &objects)) {
+                initGroupByKeyTuple(groupByKeyStorage, tuple);
+                parts[spillPartitionOf(groupByKeyStorage, depth + 1)].append(tuple);
+                objects.purge();
+            }
+            VOLT_DEBUG("Hash aggregation split a partition of %d tuples %d levels deep",
+                       (int)partition.tupleCount(), depth + 1);
+            aggregatePartitions(parts, depth + 1);
+            continue;
+        }
+
+        // The partition's tuples and their objects are read into a pool
+        // that lives until its groups are output, with copies of their
+        // objects in the temp string pool.
+        HashAggregateMapType hash;
+        PoolBackedTupleStorage nextGroupByKeyStorage(m_groupByKeySchema, &m_memoryPool);
+        while (true) {
+            tuple.move(partitionPool.allocateZeroes(tupleSize));
+            if (!partition.next(tuple, &partitionPool)) {
+                break;
+            }
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            aggregateTuple(hash, nextGroupByKeyStorage, tuple);
+        }
+        outputGroups(hash, tempStringPool);
+        m_memoryPool.purge();
+    }
+}
 
 bool AggregateSerialExecutor::p_execute(const NValueArray& params)
 {
@@ -700,4 +956,122 @@ bool AggregateSerialExecutor::p_execute(const NValueArray& params)
     return true;
 }
 
+bool WindowFunctionExecutor::p_init(AbstractPlanNode* abstractNode, TempTableLimits* limits)
+{
+    if (!AggregateExecutorBase::p_init(abstractNode, limits)) {
+        return false;
+    }
+    WindowFunctionPlanNode* node = dynamic_cast<WindowFunctionPlanNode*>(m_abstractNode);
+    assert(node);
+
+    // A running DISTINCT aggregate would have to keep every value of its
+    // partition, and the Aggs forget theirs on each finalize.
+    BOOST_FOREACH(bool distinct, m_distinctAggs) {
+        if (distinct) {
+            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                          "Window functions do not support DISTINCT aggregates");
+        }
+    }
+
+    m_orderByExpressions = node->getOrderByExpressions();
+    std::vector<ValueType> windowKeyColumnTypes;
+    std::vector<int32_t> windowKeyColumnSizes;
+    std::vector<bool> windowKeyColumnAllowNull;
+    std::vector<AbstractExpression*> windowKeyExpressions(m_groupByExpressions);
+    windowKeyExpressions.insert(windowKeyExpressions.end(),
+                                m_orderByExpressions.begin(), m_orderByExpressions.end());
+    BOOST_FOREACH(AbstractExpression* expr, windowKeyExpressions) {
+        windowKeyColumnTypes.push_back(expr->getValueType());
+        windowKeyColumnSizes.push_back(expr->getValueSize());
+        windowKeyColumnAllowNull.push_back(true);
+    }
+    m_windowKeySchema = TupleSchema::createTupleSchema(windowKeyColumnTypes,
+                                                       windowKeyColumnSizes,
+                                                       windowKeyColumnAllowNull,
+                                                       true);
+    return true;
+}
+
+inline void WindowFunctionExecutor::initWindowKeyTuple(TableTuple& windowKeyTuple,
+                                                       const TableTuple& nxtTuple)
+{
+    const int partitionKeyCount = static_cast<int>(m_groupByExpressions.size());
+    for (int ii = 0; ii < partitionKeyCount; ii++) {
+        windowKeyTuple.setNValue(ii, m_groupByExpressions[ii]->eval(&nxtTuple));
+    }
+    for (int ii = 0; ii < m_orderByExpressions.size(); ii++) {
+        windowKeyTuple.setNValue(partitionKeyCount + ii, m_orderByExpressions[ii]->eval(&nxtTuple));
+    }
+}
+
+inline void WindowFunctionExecutor::outputPeers(AggregateRow* aggregateRow,
+                                                std::vector<TableTuple>& peers)
+{
+    BOOST_FOREACH(const TableTuple& peer, peers) {
+        aggregateRow->m_passThroughTuple = peer;
+        insertOutputTuple(aggregateRow);
+    }
+    peers.clear();
+}
+
+bool WindowFunctionExecutor::p_execute(const NValueArray& params)
+{
+    executeAggBase(params);
+    BOOST_FOREACH(AbstractExpression* orderByExpression, m_orderByExpressions) {
+        orderByExpression->substitute(params);
+    }
+
+    // Like a serial aggregate, one row of Aggs runs over each partition in
+    // turn. The rows of the current run of peers wait in the input table
+    // until the aggregates have seen all of them.
+    AggregateRow* aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
+    boost::scoped_ptr<AggregateRow> will_finally_delete_aggregate_row(aggregateRow);
+    initAggInstances(aggregateRow);
+    Table* input_table = m_abstractNode->getInputTables()[0];
+    assert(input_table);
+    VOLT_TRACE("input table\n%s", input_table->debug().c_str());
+
+    // The keys of the current run of peers and of the next row, switched
+    // whenever the next row starts a new run.
+    PoolBackedTupleStorage peersKeyStorage(m_windowKeySchema, &m_memoryPool);
+    PoolBackedTupleStorage nextKeyStorage(m_windowKeySchema, &m_memoryPool);
+    peersKeyStorage.allocateActiveTuple();
+    nextKeyStorage.allocateActiveTuple();
+    TableTuple peersKeyTuple = peersKeyStorage;
+    TableTuple nextKeyTuple = nextKeyStorage;
+    const int partitionKeyCount = static_cast<int>(m_groupByExpressions.size());
+    const int windowKeyCount = m_windowKeySchema->columnCount();
+
+    std::vector<TableTuple> peers;
+    TableIterator it = input_table->iterator();
+    TableTuple nxtTuple(input_table->schema());
+    while (it.next(nxtTuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        initWindowKeyTuple(nextKeyTuple, nxtTuple);
+        // Find the first key that differs from those of the run, if any.
+        int changedKey = 0;
+        if (!peers.empty()) {
+            while (changedKey < windowKeyCount &&
+                   nextKeyTuple.getNValue(changedKey).compare(peersKeyTuple.getNValue(changedKey)) == 0) {
+                ++changedKey;
+            }
+        }
+        if (changedKey < windowKeyCount) {
+            outputPeers(aggregateRow, peers);
+            if (changedKey < partitionKeyCount) {
+                VOLT_TRACE("new partition!");
+                aggregateRow->resetAggs();
+            }
+            void* peersKeyStorageAddress = peersKeyTuple.address();
+            peersKeyTuple.move(nextKeyTuple.address());
+            nextKeyTuple.move(peersKeyStorageAddress);
+        }
+        peers.push_back(nxtTuple);
+        aggregateRow->m_passThroughTuple = nxtTuple;
+        advanceAggs(aggregateRow);
+    }
+    outputPeers(aggregateRow, peers);
+    return true;
+}
+
 }
@@ -47,6 +47,8 @@
 #define HSTOREAGGREGATEEXECUTOR_H
 
 #include "executors/abstractexecutor.h"
+#include "storage/temptable.h"
+#include "storage/TupleSpill.h"
 
 #include "common/Pool.hpp"
 #include "common/common.h"
@@ -54,8 +56,12 @@
 #include "common/tabletuple.h"
 #include "expressions/abstractexpression.h"
 
+#include "boost/ptr_container/ptr_vector.hpp"
+#include "boost/unordered_map.hpp"
+
 namespace voltdb {
 struct AggregateRow;
+class TempTableLimits;
 
 /**
  * The base class for aggregate executors regardless of the type of grouping that should be performed.
@@ -65,7 +71,7 @@ class AggregateExecutorBase : public AbstractExecutor
 public:
     AggregateExecutorBase(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
         AbstractExecutor(engine, abstract_node), m_groupByKeySchema(NULL),
-        m_prePredicate(NULL), m_postPredicate(NULL)
+        m_prePredicate(NULL), m_postPredicate(NULL), m_limits(NULL)
     { }
     ~AggregateExecutorBase()
     {
@@ -84,7 +90,9 @@ protected:
     /// Helper method responsible for inserting the results of the
     /// aggregation into a new tuple in the output table as well as passing
     /// through any additional columns from the input table.
-    void insertOutputTuple(AggregateRow* aggregateRow);
+    /// If objectPool is given, the output tuple gets copies of its objects
+    /// from there rather than sharing those of the input.
+    void insertOutputTuple(AggregateRow* aggregateRow, Pool* objectPool = NULL);
 
     void advanceAggs(AggregateRow* aggregateRow);
 
@@ -111,6 +119,7 @@ protected:
     std::vector<int> m_aggregateOutputColumns;
     AbstractExpression* m_prePredicate;    // ENG-1565: for enabling max() using index purpose only
     AbstractExpression* m_postPredicate;
+    TempTableLimits* m_limits;
 };
 
 
@@ -118,15 +127,48 @@ protected:
  * The concrete executor class for PLAN_NODE_TYPE_HASHAGGREGATE
  * in which the input does not need to be sorted and execution will hash the group by key to aggregate the tuples.
  */
-class AggregateHashExecutor : public AggregateExecutorBase
+class AggregateHashExecutor : public AggregateExecutorBase, public TempTableSpillSink
 {
 public:
     AggregateHashExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
         AggregateExecutorBase(engine, abstract_node) { }
     ~AggregateHashExecutor() { }
 
+    /// Spill the tuples of the input so far to the partitions of their
+    /// group keys.
+    void spillTuples(TempTable* input_table);
+    void discardSpilledTuples();
+
 private:
+    typedef boost::unordered_map<TableTuple,
+                                 AggregateRow*,
+                                 TableTupleHasher,
+                                 TableTupleEqualityChecker> HashAggregateMapType;
+
+    virtual bool p_init(AbstractPlanNode*, TempTableLimits*);
     virtual bool p_execute(const NValueArray& params);
+
+    /// Add a tuple to its group, starting the group if it is new. The
+    /// tuple is the group's pass through tuple until the next one of the
+    /// group comes along, so it must stay put until the group is output.
+    void aggregateTuple(HashAggregateMapType& hash,
+                        PoolBackedTupleStorage& nextGroupByKeyStorage,
+                        const TableTuple& nxtTuple);
+
+    void outputGroups(HashAggregateMapType& hash, Pool* objectPool);
+
+    /// Spill the tuples of input_table to the partitions of their group
+    /// keys, starting the partitions if there are none yet.
+    void partitionInput(Table* input_table);
+
+    /// Aggregate spilled partitions one at a time. A partition that is
+    /// over the spill threshold itself is split again first, by other
+    /// bits of its group keys' hashes, unless it is depth splits deep.
+    void aggregatePartitions(boost::ptr_vector<TupleSpill>& partitions, int depth);
+
+    /// Partitions of the input spilled while it was produced. Each group
+    /// is whole within one partition.
+    boost::ptr_vector<TupleSpill> m_partitions;
 };
 
 /**
@@ -145,5 +187,37 @@ private:
     virtual bool p_execute(const NValueArray& params);
 };
 
+/**
+ * The concrete executor class for PLAN_NODE_TYPE_WINDOWFUNCTION, which
+ * computes window functions in one pass over input sorted on the window's
+ * PARTITION BY keys and then its ORDER BY keys, outputting every input row.
+ */
+class WindowFunctionExecutor : public AggregateExecutorBase
+{
+public:
+    WindowFunctionExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
+        AggregateExecutorBase(engine, abstract_node), m_windowKeySchema(NULL) { }
+    ~WindowFunctionExecutor()
+    {
+        if (m_windowKeySchema != NULL) {
+            TupleSchema::freeTupleSchema(m_windowKeySchema);
+        }
+    }
+
+private:
+    virtual bool p_init(AbstractPlanNode*, TempTableLimits*);
+    virtual bool p_execute(const NValueArray& params);
+
+    void initWindowKeyTuple(TableTuple& windowKeyTuple, const TableTuple& nxtTuple);
+
+    /// Output each of a run of peers with the aggregates over the rows of
+    /// its partition up to and including the run.
+    void outputPeers(AggregateRow* aggregateRow, std::vector<TableTuple>& peers);
+
+    std::vector<AbstractExpression*> m_orderByExpressions;
+    /// The PARTITION BY keys followed by the ORDER BY keys
+    TupleSchema* m_windowKeySchema;
+};
+
 }
 #endif
@@ -96,6 +96,7 @@ bool DeleteExecutor::p_execute(const NValueArray &params) {
 
     if (m_truncate) {
         VOLT_TRACE("truncating table %s...", m_targetTable->name().c_str());
+        m_targetTable->finishMigration();
         // count the truncated tuples as deleted
         modified_tuples = m_targetTable->visibleTupleCount();
 
@@ -105,14 +106,16 @@ bool DeleteExecutor::p_execute(const NValueArray &params) {
                    (int)m_targetTable->visibleTupleCount(),
                    (int)m_targetTable->allocatedTupleCount());
 
-        // actually delete all the tuples
-        m_targetTable->deleteAllTuples(true);
+        // actually delete all the tuples, detaching whole blocks where possible
+        m_targetTable->truncateTable();
     }
     else
     {
         assert(m_inputTable);
         assert(m_inputTuple.sizeInValues() == m_inputTable->columnCount());
         assert(m_targetTuple.sizeInValues() == m_targetTable->columnCount());
+        m_targetAddresses.clear();
+        m_targetAddresses.reserve(m_inputTable->tempTableTupleCount());
         TableIterator inputIterator = m_inputTable->iterator();
         while (inputIterator.next(m_inputTuple)) {
             //
@@ -122,16 +125,13 @@ bool DeleteExecutor::p_execute(const NValueArray &params) {
             // tuple on the target table that we will want to blow away. This saves
             // us the trouble of having to do an index lookup
             //
-            void *targetAddress = m_inputTuple.getNValue(0).castAsAddress();
-            m_targetTuple.move(targetAddress);
-
-            // Delete from target table
-            if (!m_targetTable->deleteTuple(m_targetTuple, true)) {
-                VOLT_ERROR("Failed to delete tuple from table '%s'",
-                           m_targetTable->name().c_str());
-                return false;
-            }
+            m_targetAddresses.push_back(static_cast<char*>(m_inputTuple.getNValue(0).castAsAddress()));
         }
+
+        // Delete from target table as one batch, in storage order. Range deletes
+        // fed by an index scan (e.g. DELETE ... WHERE ts < ?) free their slots
+        // block by block and register a single undo action.
+        m_targetTable->deleteTuples(m_targetAddresses, true);
         modified_tuples = m_inputTable->tempTableTupleCount();
         VOLT_TRACE("Deleted %d rows from table : %s with %d active, %d visible, %d allocated",
                    (int)modified_tuples,
@@ -46,6 +46,8 @@
 #ifndef HSTOREDELETEEXECUTOR_H
 #define HSTOREDELETEEXECUTOR_H
 
+#include <vector>
+
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "common/tabletuple.h"
@@ -86,6 +88,8 @@ protected:
     PersistentTable* m_targetTable;
     TableTuple m_inputTuple;
     TableTuple m_targetTuple;
+    /** addresses of the target tuples, reused across executions */
+    std::vector<char*> m_targetAddresses;
 
     /** reference to the engine/context to store the number of
         modified tuples */
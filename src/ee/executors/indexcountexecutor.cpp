@@ -144,6 +144,9 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
     VOLT_DEBUG("IndexCount: %s.%s\n", m_targetTable->name().c_str(),
                m_index->getName().c_str());
 
+    // counting by rank needs every tuple an online schema change left behind
+    m_targetTable->finishMigration();
+
     int activeNumOfSearchKeys = m_numOfSearchkeys;
     IndexLookupType localLookupType = m_lookupType;
     bool searchKeyUnderflow = false, endKeyOverflow = false;
@@ -51,6 +51,7 @@
 #include "common/FatalException.hpp"
 #include "expressions/abstractexpression.h"
 #include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
 #include "indexes/tableindex.h"
 
 // Inline PlanNodes
@@ -71,6 +72,7 @@ bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
     VOLT_TRACE("init IndexScan Executor");
 
     m_projectionNode = NULL;
+    m_projectionAllTupleArray = NULL;
 
     m_node = dynamic_cast<IndexScanPlanNode*>(abstractNode);
     assert(m_node);
@@ -341,6 +343,18 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
     // Now loop through each tuple given to us by the iterator
     //
 
+    //
+    // ONLINE SCHEMA CHANGE
+    // Move in the tuples left behind that the lookup would find: just
+    // the ones at the key of an EQ lookup, all of them for anything else.
+    //
+    if (localLookupType == INDEX_LOOKUP_TYPE_EQ && activeNumOfSearchKeys > 0) {
+        m_targetTable->migrateMatches(m_index, m_searchKey);
+    }
+    else {
+        m_targetTable->finishMigration();
+    }
+
     TableTuple tuple;
     if (activeNumOfSearchKeys > 0) {
         VOLT_TRACE("INDEX_LOOKUP_TYPE(%d) m_numSearchkeys(%d) key:%s",
@@ -393,6 +407,39 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
         limit_node->getLimitAndOffsetByReference(params, limit, offset);
     }
 
+    //
+    // PARENT LIMIT
+    // A parent that takes the first rows of our output in scan order
+    // (see isOrderedOn()) needs no more than its limit plus offset.
+    //
+    if (m_parentLimitNode != NULL) {
+        int parentLimit = -1;
+        int parentOffset = -1;
+        m_parentLimitNode->getLimitAndOffsetByReference(params, parentLimit, parentOffset);
+        if (parentLimit != -1) {
+            if (parentOffset > 0) {
+                parentLimit += parentOffset;
+            }
+            if (limit == -1 || parentLimit < limit) {
+                limit = parentLimit;
+            }
+        }
+    }
+
+    //
+    // INLINE OFFSET BY RANK
+    // When every entry the scan visits counts toward the offset, a countable
+    // index can seek past them by rank rather than visit them one by one.
+    // The end_expression bounds the scan in its own order, so checking it on
+    // the first entry past the offset answers it for the skipped ones too.
+    //
+    if (offset > 0 && m_index->isOrderedIndex() && m_index->isCountableIndex() &&
+        skipNullExpr == NULL && post_expression == NULL &&
+        (localLookupType != INDEX_LOOKUP_TYPE_EQ || activeNumOfSearchKeys == 0)) {
+        m_index->advanceByRank(offset);
+        tuples_skipped = offset;
+    }
+
     //
     // We have to different nextValue() methods for different lookup types
     //
@@ -471,6 +518,71 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
     return true;
 }
 
+bool IndexScanExecutor::isOrderedOn(const std::vector<AbstractExpression*>& sortExprs,
+                                    const std::vector<SortDirectionType>& sortDirs) const
+{
+    assert(sortExprs.size() == sortDirs.size());
+    if (sortExprs.empty()) {
+        return false;
+    }
+    // The index must keep its keys in order, the output columns must map
+    // straight to table columns, and the index must be ordered on table
+    // columns rather than on expressions.
+    if ( ! m_index->isOrderedIndex()) {
+        return false;
+    }
+    if (m_projectionNode != NULL && m_projectionAllTupleArray == NULL) {
+        return false;
+    }
+    if ( ! m_index->getIndexedExpressions().empty()) {
+        return false;
+    }
+
+    //
+    // Work out the scan direction the same way p_execute() does, taking into
+    // account that an overflowing search key can turn it into a full scan in
+    // m_sortDirection. Hash indexes only ever get full-key EQ lookups, whose
+    // tuples all share one key and so are trivially ordered on it.
+    //
+    SortDirectionType scanDirection;
+    if (m_sortDirection == SORT_DIRECTION_TYPE_DESC &&
+        (m_numOfSearchkeys == 0 ||
+         m_lookupType == INDEX_LOOKUP_TYPE_LT ||
+         m_lookupType == INDEX_LOOKUP_TYPE_LTE)) {
+        scanDirection = SORT_DIRECTION_TYPE_DESC;
+    }
+    else if (m_sortDirection != SORT_DIRECTION_TYPE_DESC &&
+             (m_numOfSearchkeys == 0 ||
+              m_lookupType == INDEX_LOOKUP_TYPE_EQ ||
+              m_lookupType == INDEX_LOOKUP_TYPE_GT ||
+              m_lookupType == INDEX_LOOKUP_TYPE_GTE)) {
+        scanDirection = SORT_DIRECTION_TYPE_ASC;
+    }
+    else {
+        return false;
+    }
+
+    // The sort keys must be a prefix of the index columns, all in scan direction.
+    const std::vector<int>& indexColumns = m_index->getColumnIndices();
+    if (sortExprs.size() > indexColumns.size()) {
+        return false;
+    }
+    for (size_t ii = 0; ii < sortExprs.size(); ii++) {
+        if (sortDirs[ii] != scanDirection ||
+            sortExprs[ii]->getExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE) {
+            return false;
+        }
+        int column = static_cast<const TupleValueExpression*>(sortExprs[ii])->getColumnId();
+        if (m_projectionAllTupleArray != NULL) {
+            column = m_projectionAllTupleArray[column];
+        }
+        if (column != indexColumns[ii]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 IndexScanExecutor::~IndexScanExecutor() {
     delete [] m_searchKeyBackingStore;
     delete [] m_projectionExpressions;
@@ -71,10 +71,25 @@ public:
     IndexScanExecutor(VoltDBEngine* engine, AbstractPlanNode* abstractNode)
         : AbstractExecutor(engine, abstractNode)
         , m_projectionExpressions(NULL)
+        , m_parentLimitNode(NULL)
         , m_searchKeyBackingStore(NULL)
     {}
     ~IndexScanExecutor();
 
+    /**
+     * Returns true if this scan emits its output ordered on the given output
+     * column expressions and directions for any parameter values, so that a
+     * parent ORDER BY on them can rely on the scan order instead of sorting.
+     */
+    bool isOrderedOn(const std::vector<AbstractExpression*>& sortExprs,
+                     const std::vector<SortDirectionType>& sortDirs) const;
+
+    /**
+     * Have the scan stop once it has emitted the limit plus offset tuples
+     * of the given parent limit, on top of any inlined limit.
+     */
+    void setParentLimit(LimitPlanNode* limitNode) { m_parentLimitNode = limitNode; }
+
 private:
     bool p_init(AbstractPlanNode*,
                 TempTableLimits* limits);
@@ -107,6 +122,9 @@ private:
 
     TableIndex *m_index;
 
+    // Limit of a parent that consumes the scan output in scan order
+    LimitPlanNode* m_parentLimitNode;
+
     // arrange the memory mgmt aids at the bottom to try to maximize
     // cache hits (by keeping them out of the way of useful runtime data)
     boost::shared_array<int> m_projectionAllTupleArrayPtr;
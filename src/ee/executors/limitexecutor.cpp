@@ -44,6 +44,7 @@
  */
 
 #include "limitexecutor.h"
+#include "executors/indexscanexecutor.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
@@ -79,6 +80,17 @@ LimitExecutor::p_init(AbstractPlanNode* abstract_node,
                                               node->getInputTables()[0]->name(),
                                               node->getInputTables()[0],
                                               limits));
+
+        //
+        // Any rows will do for us, so an index scan below us can
+        // stop as soon as it has produced enough of them.
+        //
+        assert(node->getChildren()[0] != NULL);
+        IndexScanExecutor* scan =
+            dynamic_cast<IndexScanExecutor*>(node->getChildren()[0]->getExecutor());
+        if (scan != NULL) {
+            scan->setParentLimit(node);
+        }
     }
     return true;
 }
@@ -0,0 +1,210 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mergejoinexecutor.h"
+#include "common/debuglog.h"
+#include "common/SerializableEEException.h"
+#include "expressions/abstractexpression.h"
+#include "plannodes/limitnode.h"
+#include "plannodes/mergejoinnode.h"
+#include "storage/table.h"
+#include "storage/temptable.h"
+#include "storage/tableiterator.h"
+
+#include <boost/foreach.hpp>
+
+using namespace std;
+using namespace voltdb;
+
+bool MergeJoinExecutor::p_init(AbstractPlanNode* abstract_node,
+                               TempTableLimits* limits)
+{
+    VOLT_TRACE("init MergeJoin Executor");
+
+    MergeJoinPlanNode* node = dynamic_cast<MergeJoinPlanNode*>(abstract_node);
+    assert(node);
+
+    JoinType join_type = node->getJoinType();
+    if (join_type != JOIN_TYPE_INNER && join_type != JOIN_TYPE_LEFT) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "Merge joins are either inner or left outer");
+    }
+    m_outerKeyExpressions = node->getOuterKeyExpressions();
+    m_innerKeyExpressions = node->getInnerKeyExpressions();
+    if (m_outerKeyExpressions.empty()) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "Merge joins need join keys");
+    }
+
+    // Create output table based on output schema from the plan
+    setTempOutputTable(limits);
+
+    // NULL tuple for outer join
+    if (join_type == JOIN_TYPE_LEFT) {
+        Table* inner_table = node->getInputTables()[1];
+        assert(inner_table);
+        m_null_tuple.init(inner_table->schema());
+    }
+
+    return true;
+}
+
+bool MergeJoinExecutor::hasNullKey(const vector<AbstractExpression*> &keyExpressions,
+                                   const TableTuple *tuple1, const TableTuple *tuple2) const
+{
+    BOOST_FOREACH(AbstractExpression* keyExpression, keyExpressions) {
+        if (keyExpression->eval(tuple1, tuple2).isNull()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int MergeJoinExecutor::compareKeys(const TableTuple &outer_tuple, const TableTuple &inner_tuple) const
+{
+    for (int ii = 0; ii < m_outerKeyExpressions.size(); ii++) {
+        int cmp = m_outerKeyExpressions[ii]->eval(&outer_tuple, NULL).
+            compare(m_innerKeyExpressions[ii]->eval(NULL, &inner_tuple));
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+    return 0;
+}
+
+bool MergeJoinExecutor::p_execute(const NValueArray &params)
+{
+    VOLT_DEBUG("executing MergeJoin...");
+
+    MergeJoinPlanNode* node = dynamic_cast<MergeJoinPlanNode*>(m_abstractNode);
+    assert(node);
+    assert(node->getInputTables().size() == 2);
+
+    TempTable* output_table = dynamic_cast<TempTable*>(node->getOutputTable());
+    assert(output_table);
+
+    Table* outer_table = node->getInputTables()[0];
+    assert(outer_table);
+    Table* inner_table = node->getInputTables()[1];
+    assert(inner_table);
+
+    AbstractExpression *preJoinPredicate = node->getPreJoinPredicate();
+    if (preJoinPredicate) {
+        preJoinPredicate->substitute(params);
+    }
+    AbstractExpression *joinPredicate = node->getJoinPredicate();
+    if (joinPredicate) {
+        joinPredicate->substitute(params);
+    }
+    AbstractExpression *wherePredicate = node->getWherePredicate();
+    if (wherePredicate) {
+        wherePredicate->substitute(params);
+    }
+    BOOST_FOREACH(AbstractExpression* keyExpression, m_outerKeyExpressions) {
+        keyExpression->substitute(params);
+    }
+    BOOST_FOREACH(AbstractExpression* keyExpression, m_innerKeyExpressions) {
+        keyExpression->substitute(params);
+    }
+
+    JoinType join_type = node->getJoinType();
+
+    LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+    int limit = -1;
+    int offset = -1;
+    if (limit_node) {
+        limit_node->getLimitAndOffsetByReference(params, limit, offset);
+    }
+
+    int outer_cols = outer_table->columnCount();
+    int inner_cols = inner_table->columnCount();
+    TableTuple outer_tuple(outer_table->schema());
+    TableTuple inner_tuple(inner_table->schema());
+    TableTuple &joined = output_table->tempTuple();
+    TableTuple null_tuple = m_null_tuple;
+
+    // The run of inner tuples whose key equals the last outer key that
+    // found any, and the inner tuple after it, if any is left.
+    vector<TableTuple> innerRun;
+    TableIterator iterator0 = outer_table->iterator();
+    TableIterator iterator1 = inner_table->iterator();
+    bool innerLeft = iterator1.next(inner_tuple);
+
+    int tuple_ctr = 0;
+    int tuple_skipped = 0;
+    m_engine->setLastAccessedTable(inner_table);
+    while ((limit == -1 || tuple_ctr < limit) && iterator0.next(outer_tuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        bool match = false;
+        // NULL keys are lowest in the sort order and equal to nothing
+        if ((preJoinPredicate == NULL || preJoinPredicate->eval(&outer_tuple, NULL).isTrue()) &&
+            !hasNullKey(m_outerKeyExpressions, &outer_tuple, NULL)) {
+
+            if (innerRun.empty() || compareKeys(outer_tuple, innerRun[0]) != 0) {
+                // Move the inner input up to the outer key and take the run
+                // of tuples with that key, if any.
+                innerRun.clear();
+                while (innerLeft && (hasNullKey(m_innerKeyExpressions, NULL, &inner_tuple) ||
+                                     compareKeys(outer_tuple, inner_tuple) > 0)) {
+                    m_engine->noteTuplesProcessedForProgressMonitoring(1);
+                    innerLeft = iterator1.next(inner_tuple);
+                }
+                while (innerLeft && compareKeys(outer_tuple, inner_tuple) == 0) {
+                    m_engine->noteTuplesProcessedForProgressMonitoring(1);
+                    innerRun.push_back(inner_tuple);
+                    innerLeft = iterator1.next(inner_tuple);
+                }
+            }
+
+            joined.setNValues(0, outer_tuple, 0, outer_cols);
+            for (vector<TableTuple>::iterator it = innerRun.begin();
+                 (limit == -1 || tuple_ctr < limit) && it != innerRun.end(); ++it) {
+                if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &(*it)).isTrue()) {
+                    match = true;
+                    if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &(*it)).isTrue()) {
+                        // Check if we have to skip this tuple because of offset
+                        if (tuple_skipped < offset) {
+                            tuple_skipped++;
+                            continue;
+                        }
+                        ++tuple_ctr;
+                        joined.setNValues(outer_cols, *it, 0, inner_cols);
+                        output_table->insertTupleNonVirtual(joined);
+                    }
+                }
+            }
+        }
+        //
+        // Left Outer Join
+        //
+        if ((limit == -1 || tuple_ctr < limit) && join_type == JOIN_TYPE_LEFT && !match) {
+            if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &null_tuple).isTrue()) {
+                // Check if we have to skip this tuple because of offset
+                if (tuple_skipped < offset) {
+                    tuple_skipped++;
+                    continue;
+                }
+                ++tuple_ctr;
+                joined.setNValues(0, outer_tuple, 0, outer_cols);
+                joined.setNValues(outer_cols, null_tuple, 0, inner_cols);
+                output_table->insertTupleNonVirtual(joined);
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREMERGEJOINEXECUTOR_H
+#define HSTOREMERGEJOINEXECUTOR_H
+
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/abstractexecutor.h"
+
+#include <vector>
+
+namespace voltdb
+{
+
+class AbstractExpression;
+
+/**
+ * Joins two inputs sorted ascending on the join keys by advancing through
+ * both together. Each run of inner tuples with equal keys is kept until
+ * the outer tuples reach a greater key, so that runs of equal outer keys
+ * join with all of it without going back over the inner input.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+public:
+    MergeJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
+        : AbstractExecutor(engine, abstract_node)
+    {}
+protected:
+    bool p_init(AbstractPlanNode* abstract_node,
+                TempTableLimits* limits);
+    bool p_execute(const NValueArray& params);
+
+private:
+    bool hasNullKey(const std::vector<AbstractExpression*> &keyExpressions,
+                    const TableTuple *tuple1, const TableTuple *tuple2) const;
+    int compareKeys(const TableTuple &outer_tuple, const TableTuple &inner_tuple) const;
+
+    std::vector<AbstractExpression*> m_outerKeyExpressions;
+    std::vector<AbstractExpression*> m_innerKeyExpressions;
+    StandAloneTupleStorage m_null_tuple;
+};
+
+}
+
+#endif
@@ -45,11 +45,13 @@
 #include <vector>
 #include <string>
 #include <stack>
+#include <boost/foreach.hpp>
 #include "nestloopexecutor.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
+#include "common/SQLException.h"
 #include "expressions/abstractexpression.h"
 #include "expressions/tuplevalueexpression.h"
 #include "storage/table.h"
@@ -78,16 +80,126 @@ bool NestLoopExecutor::p_init(AbstractPlanNode* abstract_node,
     // Create output table based on output schema from the plan
     setTempOutputTable(limits);
 
-    // NULL tuple for outer join
-    if (node->getJoinType() == JOIN_TYPE_LEFT) {
+    // NULL tuple for outer join, and for the where predicate of semi and
+    // anti joins, which only sees the outer tuple
+    JoinType join_type = node->getJoinType();
+    if (join_type == JOIN_TYPE_LEFT || join_type == JOIN_TYPE_SEMI || join_type == JOIN_TYPE_ANTI) {
         Table* inner_table = node->getInputTables()[1];
         assert(inner_table);
         m_null_tuple.init(inner_table->schema());
     }
 
+    // Semi and anti joins with keys look their matches up in a hash of
+    // the inner tuples by key rather than scan the inner table for each
+    // outer tuple.
+    if ((join_type == JOIN_TYPE_SEMI || join_type == JOIN_TYPE_ANTI) &&
+        !node->getInnerKeyExpressions().empty()) {
+        m_outerKeyExpressions = node->getOuterKeyExpressions();
+        m_innerKeyExpressions = node->getInnerKeyExpressions();
+        std::vector<ValueType> keyColumnTypes;
+        std::vector<int32_t> keyColumnSizes;
+        std::vector<bool> keyColumnAllowNull;
+        for (int ii = 0; ii < m_innerKeyExpressions.size(); ii++) {
+            AbstractExpression* expr = m_innerKeyExpressions[ii];
+            keyColumnTypes.push_back(expr->getValueType());
+            keyColumnSizes.push_back(expr->getValueSize());
+            keyColumnAllowNull.push_back(true);
+        }
+        if (m_keySchema != NULL) {
+            TupleSchema::freeTupleSchema(m_keySchema);
+        }
+        m_keySchema = TupleSchema::createTupleSchema(keyColumnTypes,
+                                                     keyColumnSizes,
+                                                     keyColumnAllowNull,
+                                                     true);
+        m_probeKey = TableTuple(m_keySchema);
+    }
+
     return true;
 }
 
+NestLoopExecutor::~NestLoopExecutor()
+{
+    if (m_keySchema != NULL) {
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+}
+
+/**
+ * Fill the key with the values of the key expressions, which refer to the
+ * tuples as the join predicate does. Return false if the tuples can't join
+ * anything by this key: a value is NULL or doesn't fit the key's type.
+ * The key takes the inner expressions' types, so an outer value that
+ * changes when cast to one (2.5 as a BIGINT is 2) equals no inner value.
+ */
+bool NestLoopExecutor::setKey(TableTuple &key, const std::vector<AbstractExpression*> &keyExpressions,
+                              const TableTuple *tuple1, const TableTuple *tuple2)
+{
+    for (int ii = 0; ii < keyExpressions.size(); ii++) {
+        NValue value = keyExpressions[ii]->eval(tuple1, tuple2);
+        if (value.isNull()) {
+            return false;
+        }
+        try {
+            key.setNValue(ii, value);
+            if (key.getNValue(ii).compare(value) != 0) {
+                return false;
+            }
+        }
+        catch (SQLException &sqlException) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NestLoopExecutor::buildInnerKeyMap(Table* inner_table, TableTuple &inner_tuple)
+{
+    m_memoryPool.purge();
+    m_innerKeys.clear();
+    const size_t keyLength = m_keySchema->tupleLength() + TUPLE_HEADER_SIZE;
+    m_probeKey.move(m_memoryPool.allocateZeroes(keyLength));
+
+    TableTuple key(m_keySchema);
+    key.move(m_memoryPool.allocateZeroes(keyLength));
+    TableIterator iterator1 = inner_table->iterator();
+    while (iterator1.next(inner_tuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        if (setKey(key, m_innerKeyExpressions, NULL, &inner_tuple)) {
+            m_innerKeys.insert(InnerKeyMap::value_type(key, inner_tuple));
+            key.move(m_memoryPool.allocateZeroes(keyLength));
+        }
+    }
+}
+
+bool NestLoopExecutor::hasInnerKeyMatch(const TableTuple &outer_tuple, AbstractExpression *joinPredicate)
+{
+    if (!setKey(m_probeKey, m_outerKeyExpressions, &outer_tuple, NULL)) {
+        return false;
+    }
+    std::pair<InnerKeyMap::const_iterator, InnerKeyMap::const_iterator> candidates =
+        m_innerKeys.equal_range(m_probeKey);
+    for (InnerKeyMap::const_iterator it = candidates.first; it != candidates.second; ++it) {
+        if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &it->second).isTrue()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NestLoopExecutor::hasInnerMatch(const TableTuple &outer_tuple, Table* inner_table, TableTuple &inner_tuple,
+                                     AbstractExpression *joinPredicate)
+{
+    TableIterator iterator1 = inner_table->iterator();
+    while (iterator1.next(inner_tuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 
 bool NestLoopExecutor::p_execute(const NValueArray &params) {
     VOLT_DEBUG("executing NestLoop...");
@@ -140,9 +252,18 @@ bool NestLoopExecutor::p_execute(const NValueArray &params) {
                     "NULL" : wherePredicate->debug(true).c_str());
     }
 
+    BOOST_FOREACH(AbstractExpression* keyExpression, m_outerKeyExpressions) {
+        keyExpression->substitute(params);
+    }
+    BOOST_FOREACH(AbstractExpression* keyExpression, m_innerKeyExpressions) {
+        keyExpression->substitute(params);
+    }
+
     // Join type
     JoinType join_type = node->getJoinType();
-    assert(join_type == JOIN_TYPE_INNER || join_type == JOIN_TYPE_LEFT);
+    assert(join_type == JOIN_TYPE_INNER || join_type == JOIN_TYPE_LEFT ||
+           join_type == JOIN_TYPE_SEMI || join_type == JOIN_TYPE_ANTI);
+    const bool semiOrAnti = (join_type == JOIN_TYPE_SEMI || join_type == JOIN_TYPE_ANTI);
 
     LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
     int limit = -1;
@@ -162,8 +283,34 @@ bool NestLoopExecutor::p_execute(const NValueArray &params) {
     int tuple_ctr = 0;
     int tuple_skipped = 0;
     m_engine->setLastAccessedTable(inner_table);
+    if (semiOrAnti && m_keySchema != NULL) {
+        buildInnerKeyMap(inner_table, inner_tuple);
+    }
     while ((limit == -1 || tuple_ctr < limit) && iterator0.next(outer_tuple)) {
         m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        //
+        // Semi and Anti Join
+        // Each outer tuple is output at most once and without inner columns,
+        // so the search for its matches stops at the first one.
+        //
+        if (semiOrAnti) {
+            bool match = (preJoinPredicate == NULL || preJoinPredicate->eval(&outer_tuple, NULL).isTrue()) &&
+                         (m_keySchema != NULL ?
+                          hasInnerKeyMatch(outer_tuple, joinPredicate) :
+                          hasInnerMatch(outer_tuple, inner_table, inner_tuple, joinPredicate));
+            if (match == (join_type == JOIN_TYPE_SEMI) &&
+                (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &null_tuple).isTrue())) {
+                // Check if we have to skip this tuple because of offset
+                if (tuple_skipped < offset) {
+                    tuple_skipped++;
+                    continue;
+                }
+                ++tuple_ctr;
+                joined.setNValues(0, outer_tuple, 0, outer_cols);
+                output_table->insertTupleNonVirtual(joined);
+            }
+            continue;
+        }
         // did this loop body find at least one match for this tuple?
         bool match = false;
         // For outer joins if outer tuple fails pre-join predicate
@@ -215,6 +362,9 @@ bool NestLoopExecutor::p_execute(const NValueArray &params) {
             }
         }
     }
+    if (semiOrAnti && m_keySchema != NULL) {
+        m_innerKeys.clear();
+    }
 
     return (true);
 }
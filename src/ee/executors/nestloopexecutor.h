@@ -47,13 +47,19 @@
 #define HSTORENESTLOOPEXECUTOR_H
 
 #include "common/common.h"
+#include "common/Pool.hpp"
+#include "common/tabletuple.h"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
 
+#include "boost/unordered_map.hpp"
+
 namespace voltdb {
 
 class UndoLog;
 class ReadWriteSet;
+class AbstractExpression;
+class Table;
 
 /**
  *
@@ -61,13 +67,35 @@ class ReadWriteSet;
 class NestLoopExecutor : public AbstractExecutor {
     public:
         NestLoopExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) :
-            AbstractExecutor(engine, abstract_node) { }
+            AbstractExecutor(engine, abstract_node), m_keySchema(NULL) { }
+        ~NestLoopExecutor();
     protected:
         bool p_init(AbstractPlanNode*,
                     TempTableLimits* limits);
         bool p_execute(const NValueArray &params);
 
         StandAloneTupleStorage m_null_tuple;
+
+    private:
+        // Inner tuples by their join key, for semi and anti joins with keys
+        typedef boost::unordered_multimap<TableTuple,
+                                          TableTuple,
+                                          TableTupleHasher,
+                                          TableTupleEqualityChecker> InnerKeyMap;
+
+        void buildInnerKeyMap(Table* inner_table, TableTuple &inner_tuple);
+        bool setKey(TableTuple &key, const std::vector<AbstractExpression*> &keyExpressions,
+                    const TableTuple *tuple1, const TableTuple *tuple2);
+        bool hasInnerKeyMatch(const TableTuple &outer_tuple, AbstractExpression *joinPredicate);
+        bool hasInnerMatch(const TableTuple &outer_tuple, Table* inner_table, TableTuple &inner_tuple,
+                           AbstractExpression *joinPredicate);
+
+        std::vector<AbstractExpression*> m_outerKeyExpressions;
+        std::vector<AbstractExpression*> m_innerKeyExpressions;
+        TupleSchema* m_keySchema;
+        Pool m_memoryPool;
+        InnerKeyMap m_innerKeys;
+        TableTuple m_probeKey;
 };
 
 }
@@ -245,6 +245,11 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
         limit_node->getLimitAndOffsetByReference(params, limit, offset);
     }
 
+    // Tuples an online schema change left behind are moved in by each EQ
+    // lookup that would find them, or all at once for any other lookup.
+    if (m_lookupType != INDEX_LOOKUP_TYPE_EQ || num_of_searchkeys == 0) {
+        inner_table->finishMigration();
+    }
 
     //
     // OUTER TABLE ITERATION
@@ -385,6 +390,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                 if (num_of_searchkeys > 0)
                 {
                     if (localLookupType == INDEX_LOOKUP_TYPE_EQ) {
+                        inner_table->migrateMatches(index, index_values);
                         index->moveToKey(&index_values);
                     }
                     else if (localLookupType == INDEX_LOOKUP_TYPE_GT) {
@@ -44,18 +44,26 @@
  */
 
 #include <algorithm>
+#include <memory>
+#include <queue>
 #include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include "orderbyexecutor.h"
+#include "executors/indexscanexecutor.h"
 #include "common/debuglog.h"
+#include "common/executorcontext.hpp"
 #include "common/common.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
+#include "common/Pool.hpp"
 #include "plannodes/orderbynode.h"
 #include "plannodes/limitnode.h"
 #include "storage/table.h"
 #include "storage/temptable.h"
 #include "storage/tableiterator.h"
 #include "storage/tablefactory.h"
+#include "storage/TempTableLimits.h"
+#include "storage/TupleSpill.h"
 
 using namespace voltdb;
 using namespace std;
@@ -71,6 +79,7 @@ OrderByExecutor::p_init(AbstractPlanNode* abstract_node,
     assert(node->getInputTables().size() == 1);
 
     assert(node->getChildren()[0] != NULL);
+    m_limits = limits;
 
     //
     // Our output table should look exactly like out input table
@@ -87,6 +96,27 @@ OrderByExecutor::p_init(AbstractPlanNode* abstract_node,
         dynamic_cast<LimitPlanNode*>(node->
                                      getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
 
+    //
+    // OPTIMIZATION: ORDERED INDEX SCAN
+    // If our input comes from an index scan already in our sort order, there
+    // is nothing to sort, and our limit can stop that scan early.
+    //
+    IndexScanExecutor* scan =
+        dynamic_cast<IndexScanExecutor*>(node->getChildren()[0]->getExecutor());
+    m_inputIsSorted = (scan != NULL &&
+                       scan->isOrderedOn(node->getSortExpressions(),
+                                         node->getSortDirections()));
+    if (m_inputIsSorted && limit_node != NULL) {
+        scan->setParentLimit(limit_node);
+    }
+
+    // Otherwise sort runs of the input and spill them as the child
+    // produces it, whenever it grows past the spill threshold.
+    TempTable* input_table = dynamic_cast<TempTable*>(node->getInputTables()[0]);
+    if (!m_inputIsSorted && input_table != NULL) {
+        input_table->setSpillSink(this);
+    }
+
     return true;
 }
 
@@ -133,6 +163,84 @@ private:
     size_t m_keyCount;
 };
 
+/**
+ * Orders the runs of an external merge sort for a priority queue, which
+ * pops its greatest element first: by their current tuples, then by run
+ * so that equal tuples keep their input order.
+ */
+class RunComparer
+{
+public:
+    RunComparer(const TupleComparer& comparer, const vector<TableTuple>& heads)
+        : m_comparer(comparer), m_heads(heads)
+    {
+    }
+
+    bool operator()(size_t a, size_t b)
+    {
+        if (m_comparer(m_heads[b], m_heads[a])) return true;
+        if (m_comparer(m_heads[a], m_heads[b])) return false;
+        return a > b;
+    }
+
+private:
+    TupleComparer m_comparer;
+    const vector<TableTuple>& m_heads;
+};
+
+/**
+ * Reads neighbouring sorted runs back in merged order. Each run has
+ * storage for its current tuple and a pool for that tuple's objects, so
+ * the tuple next() returns stays put until the following call.
+ */
+class RunMerger
+{
+public:
+    RunMerger(const TupleComparer& comparer, const TupleSchema* schema,
+              boost::ptr_vector<TupleSpill>& runs, size_t first, size_t count)
+        : m_runs(runs), m_first(first), m_heads(count, TableTuple(schema)),
+          m_queue(RunComparer(comparer, m_heads)), m_current(count)
+    {
+        const int64_t tupleSize = schema->tupleLength() + TUPLE_HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            m_heads[i].move(m_storage.allocateZeroes(tupleSize));
+            m_objects.push_back(new Pool(32768, 1));
+            m_runs[first + i].rewind();
+            advance(i);
+        }
+    }
+
+    TableTuple* next()
+    {
+        if (m_current < m_heads.size()) {
+            advance(m_current);
+        }
+        if (m_queue.empty()) {
+            return NULL;
+        }
+        m_current = m_queue.top();
+        m_queue.pop();
+        return &m_heads[m_current];
+    }
+
+private:
+    void advance(size_t i)
+    {
+        m_objects[i].purge();
+        if (m_runs[m_first + i].next(m_heads[i], &m_objects[i])) {
+            m_queue.push(i);
+        }
+    }
+
+    boost::ptr_vector<TupleSpill>& m_runs;
+    const size_t m_first;
+    Pool m_storage;
+    boost::ptr_vector<Pool> m_objects;
+    vector<TableTuple> m_heads;
+    priority_queue<size_t, vector<size_t>, RunComparer> m_queue;
+    size_t m_current;
+};
+
 bool
 OrderByExecutor::p_execute(const NValueArray &params)
 {
@@ -161,6 +269,18 @@ OrderByExecutor::p_execute(const NValueArray &params)
 
     VOLT_TRACE("Running OrderBy '%s'", m_abstractNode->debug().c_str());
     VOLT_TRACE("Input Table:\n '%s'", input_table->debug().c_str());
+    // Spill if the input has spilled already while it was produced, or if
+    // it came in whole (from a table that is not our child's temp table)
+    // and is over the threshold.
+    const int64_t tupleSize = input_table->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+    if (!m_inputIsSorted &&
+        (!m_runs.empty() ||
+         (m_limits != NULL &&
+          m_limits->shouldSpill(input_table->activeTupleCount() * tupleSize)))) {
+        sortExternally(input_table, limit, offset);
+        VOLT_TRACE("Result of OrderBy:\n '%s'", output_table->debug().c_str());
+        return true;
+    }
     TableIterator iterator = input_table->iterator();
     TableTuple tuple(input_table->schema());
     vector<TableTuple> xs;
@@ -172,8 +292,10 @@ OrderByExecutor::p_execute(const NValueArray &params)
     }
     VOLT_TRACE("\n***** Input Table PreSort:\n '%s'",
                input_table->debug().c_str());
-    sort(xs.begin(), xs.end(), TupleComparer(node->getSortExpressions(),
-                                             node->getSortDirections()));
+    if (!m_inputIsSorted) {
+        sort(xs.begin(), xs.end(), TupleComparer(node->getSortExpressions(),
+                                                 node->getSortDirections()));
+    }
 
     int tuple_ctr = 0;
     int tuple_skipped = 0;
@@ -209,5 +331,138 @@ OrderByExecutor::p_execute(const NValueArray &params)
     return true;
 }
 
+void
+OrderByExecutor::spillTuples(TempTable* input_table)
+{
+    OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(m_abstractNode);
+    assert(node);
+    // The child is still producing the input, so p_execute has yet to
+    // substitute this fragment's parameters.
+    const NValueArray& params = m_engine->getExecutingParameters();
+    for (int i = 0; i < node->getSortExpressions().size(); i++) {
+        node->getSortExpressions()[i]->substitute(params);
+    }
+    spillRun(input_table);
+}
+
+void
+OrderByExecutor::discardSpilledTuples()
+{
+    m_runs.clear();
+    m_runLevels.clear();
+}
+
+void
+OrderByExecutor::spillRun(Table* input_table)
+{
+    OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(m_abstractNode);
+    assert(node);
+    const TupleSchema* schema = input_table->schema();
+    vector<TableTuple> run;
+    run.reserve(input_table->activeTupleCount());
+    TableIterator iterator = input_table->iterator();
+    TableTuple tuple(schema);
+    while (iterator.next(tuple)) {
+        run.push_back(tuple);
+    }
+    // Sort stably, so that equal tuples keep their input order through
+    // the merges as well.
+    stable_sort(run.begin(), run.end(), TupleComparer(node->getSortExpressions(),
+                                                      node->getSortDirections()));
+    m_runs.push_back(new TupleSpill(schema));
+    m_runLevels.push_back(0);
+    for (vector<TableTuple>::iterator it = run.begin(); it != run.end(); it++) {
+        m_runs.back().append(*it);
+    }
+
+    // Whenever the last MAX_FAN runs are all of one level, merge them into
+    // a run of the next level, so there are at most MAX_FAN - 1 runs of
+    // each level and every tuple is merged once per level.
+    while (m_runs.size() >= TupleSpill::MAX_FAN &&
+           m_runLevels[m_runs.size() - TupleSpill::MAX_FAN] == m_runLevels.back()) {
+        mergeRuns(schema, m_runs.size() - TupleSpill::MAX_FAN, TupleSpill::MAX_FAN);
+    }
+}
+
+void
+OrderByExecutor::mergeRuns(const TupleSchema* schema, size_t first, size_t count)
+{
+    OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(m_abstractNode);
+    assert(node);
+    assert(count <= TupleSpill::MAX_FAN);
+    auto_ptr<TupleSpill> merged(new TupleSpill(schema));
+    {
+        TupleComparer comparer(node->getSortExpressions(), node->getSortDirections());
+        RunMerger merger(comparer, schema, m_runs, first, count);
+        while (TableTuple* tuple = merger.next()) {
+            merged->append(*tuple);
+        }
+    }
+    int level = 0;
+    for (size_t i = first; i < first + count; i++) {
+        level = std::max(level, m_runLevels[i] + 1);
+    }
+    m_runs.erase(m_runs.begin() + first, m_runs.begin() + first + count);
+    m_runs.insert(m_runs.begin() + first, merged.release());
+    m_runLevels.erase(m_runLevels.begin() + first, m_runLevels.begin() + first + count);
+    m_runLevels.insert(m_runLevels.begin() + first, level);
+}
+
+void
+OrderByExecutor::sortExternally(Table* input_table, int limit, int offset)
+{
+    OrderByPlanNode* node = dynamic_cast<OrderByPlanNode*>(m_abstractNode);
+    assert(node);
+    assert(m_tmpOutputTable);
+    const TupleSchema* schema = input_table->schema();
+    if (input_table->activeTupleCount() > 0) {
+        spillRun(input_table);
+    }
+    VOLT_DEBUG("OrderBy spilled %d sorted runs", (int)m_runs.size());
+
+    // Every input tuple is in a run now; free the input before merging.
+    // Clearing the input discards the runs spilled from it, so put them
+    // aside meanwhile.
+    TempTable* temp_input = dynamic_cast<TempTable*>(input_table);
+    if (temp_input != NULL) {
+        boost::ptr_vector<TupleSpill> runs;
+        vector<int> runLevels;
+        runs.swap(m_runs);
+        runLevels.swap(m_runLevels);
+        temp_input->deleteAllTuplesNonVirtual(false);
+        m_runs.swap(runs);
+        m_runLevels.swap(runLevels);
+    }
+
+    // Merge the last, smallest runs until the rest fit in one pass.
+    while (m_runs.size() > TupleSpill::MAX_FAN) {
+        const size_t count = std::min(TupleSpill::MAX_FAN,
+                                      m_runs.size() - TupleSpill::MAX_FAN + 1);
+        mergeRuns(schema, m_runs.size() - count, count);
+    }
+
+    // The output tuples get copies of their objects in the temp string
+    // pool, since the merge reuses the pools of the runs.
+    {
+        TupleComparer comparer(node->getSortExpressions(), node->getSortDirections());
+        RunMerger merger(comparer, schema, m_runs, 0, m_runs.size());
+        Pool* tempStringPool = ExecutorContext::getTempStringPool();
+        int tuple_ctr = 0;
+        int tuple_skipped = 0;
+        while (TableTuple* tuple = merger.next()) {
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            if (tuple_skipped < offset) {
+                tuple_skipped++;
+                continue;
+            }
+            m_tmpOutputTable->insertTupleNonVirtualWithDeepCopy(*tuple, tempStringPool);
+            if (limit >= 0 && ++tuple_ctr >= limit) {
+                break;
+            }
+        }
+    }
+    discardSpilledTuples();
+}
+
 OrderByExecutor::~OrderByExecutor() {
 }
@@ -49,30 +49,66 @@
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
+#include "storage/temptable.h"
+#include "storage/TupleSpill.h"
+
+#include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 namespace voltdb {
 
     class UndoLog;
     class ReadWriteSet;
     class LimitPlanNode;
+    class Table;
 
     /**
      *
      */
-    class OrderByExecutor : public AbstractExecutor {
+    class OrderByExecutor : public AbstractExecutor, public TempTableSpillSink {
     public:
         OrderByExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
-            : AbstractExecutor(engine, abstract_node), limit_node(NULL)
+            : AbstractExecutor(engine, abstract_node), limit_node(NULL),
+              m_inputIsSorted(false), m_limits(NULL)
             { }
         ~OrderByExecutor();
 
+        /** Sort the tuples of the input so far into a spilled run */
+        void spillTuples(TempTable* input_table);
+        void discardSpilledTuples();
+
     protected:
         bool p_init(AbstractPlanNode* abstract_node,
                     TempTableLimits* limits);
         bool p_execute(const NValueArray &params);
 
     private:
+        /**
+         * External merge sort for an input over the spill threshold:
+         * what is left of the input joins the runs spilled while it was
+         * produced, the input is freed, and the runs are merged into the
+         * output.
+         */
+        void sortExternally(Table* input_table, int limit, int offset);
+
+        /** Sort the tuples of input_table and spill them as a new run */
+        void spillRun(Table* input_table);
+
+        /**
+         * Merge count runs starting at first into one run in their place.
+         * Merging only neighbouring runs keeps equal tuples in input order.
+         */
+        void mergeRuns(const TupleSchema* schema, size_t first, size_t count);
+
         LimitPlanNode *limit_node;
+        // The child is an index scan that already emits our sort order
+        bool m_inputIsSorted;
+        TempTableLimits* m_limits;
+        // Sorted runs of the input in input order, and how many merges
+        // went into each, so that runs are merged MAX_FAN of a size at
+        // a time and few scratch files are open at once.
+        boost::ptr_vector<TupleSpill> m_runs;
+        std::vector<int> m_runLevels;
     };
 
 }
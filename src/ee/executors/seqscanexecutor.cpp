@@ -54,6 +54,7 @@
 #include "plannodes/projectionnode.h"
 #include "plannodes/limitnode.h"
 #include "storage/table.h"
+#include "storage/persistenttable.h"
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
@@ -110,6 +111,11 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
     assert(output_table);
     Table* target_table = dynamic_cast<Table*>(node->getTargetTable());
     assert(target_table);
+    // a scan sees every tuple, so an online schema change moves the rest first
+    PersistentTable* persistent_table = dynamic_cast<PersistentTable*>(target_table);
+    if (persistent_table != NULL) {
+        persistent_table->finishMigration();
+    }
     //cout << "SeqScanExecutor: node id" << node->getPlanNodeId() << endl;
     VOLT_TRACE("Sequential Scanning table :\n %s",
                target_table->debug().c_str());
@@ -153,7 +159,7 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
         limit_node != NULL)
     {
         //
-        // Just walk through the table using our iterator and apply
+        // Just walk through the table a block at a time and apply
         // the predicate to each tuple. For each tuple that satisfies
         // our expression, we'll insert them into the output table.
         //
@@ -179,58 +185,72 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
         int tuple_ctr = 0;
         int tuple_skipped = 0;
         m_engine->setLastAccessedTable(target_table);
-        while ((limit == -1 || tuple_ctr < limit) && iterator.next(tuple))
+        TupleBlockSpan span;
+        bool done = false;
+        while (!done && iterator.nextBlock(span))
         {
-            VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
-                       tuple.debug(target_table->name()).c_str(), tuple_ctr,
-                       (int)target_table->activeTupleCount());
-            m_engine->noteTuplesProcessedForProgressMonitoring(1);
-            //
-            // For each tuple we need to evaluate it against our predicate
-            //
-            if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue())
+            for (uint32_t slot = 0; slot < span.count; ++slot)
             {
-                // Check if we have to skip this tuple because of offset
-                if (tuple_skipped < offset) {
-                    tuple_skipped++;
+                span.prefetch(slot + TupleBlockSpan::PREFETCH_DISTANCE);
+                if (!span.isVisible(slot)) {
                     continue;
                 }
-                ++tuple_ctr;
-
+                if (limit != -1 && tuple_ctr >= limit) {
+                    done = true;
+                    break;
+                }
+                tuple.move(span.tupleAddress(slot));
+                VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
+                           tuple.debug(target_table->name()).c_str(), tuple_ctr,
+                           (int)target_table->activeTupleCount());
+                m_engine->noteTuplesProcessedForProgressMonitoring(1);
                 //
-                // Nested Projection
-                // Project (or replace) values from input tuple
+                // For each tuple we need to evaluate it against our predicate
                 //
-                if (projection_node != NULL)
+                if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue())
                 {
-                    TableTuple &temp_tuple = output_table->tempTuple();
-                    for (int ctr = 0; ctr < num_of_columns; ctr++)
-                    {
-                        NValue value =
-                            projection_node->
-                          getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
-                        temp_tuple.setNValue(ctr, value);
-                    }
-                    if (!output_table->insertTuple(temp_tuple))
-                    {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
+                    // Check if we have to skip this tuple because of offset
+                    if (tuple_skipped < offset) {
+                        tuple_skipped++;
+                        continue;
                     }
-                }
-                else
-                {
+                    ++tuple_ctr;
+
                     //
-                    // Insert the tuple into our output table
+                    // Nested Projection
+                    // Project (or replace) values from input tuple
                     //
-                    if (!output_table->insertTuple(tuple)) {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
+                    if (projection_node != NULL)
+                    {
+                        TableTuple &temp_tuple = output_table->tempTuple();
+                        for (int ctr = 0; ctr < num_of_columns; ctr++)
+                        {
+                            NValue value =
+                                projection_node->
+                              getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
+                            temp_tuple.setNValue(ctr, value);
+                        }
+                        if (!output_table->insertTuple(temp_tuple))
+                        {
+                            VOLT_ERROR("Failed to insert tuple from table '%s' into"
+                                       " output table '%s'",
+                                       target_table->name().c_str(),
+                                       output_table->name().c_str());
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        //
+                        // Insert the tuple into our output table
+                        //
+                        if (!output_table->insertTuple(tuple)) {
+                            VOLT_ERROR("Failed to insert tuple from table '%s' into"
+                                       " output table '%s'",
+                                       target_table->name().c_str(),
+                                       output_table->name().c_str());
+                            return false;
+                        }
                     }
                 }
             }
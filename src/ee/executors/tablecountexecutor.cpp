@@ -67,7 +67,9 @@ bool TableCountExecutor::p_execute(const NValueArray &params) {
     assert (node->getPredicate() == NULL);
 
     TableTuple& tmptup = output_table->tempTuple();
-    tmptup.setNValue(0, ValueFactory::getBigIntValue(target_table->visibleTupleCount()));
+    // tuples an online schema change has yet to move in count as well
+    tmptup.setNValue(0, ValueFactory::getBigIntValue(target_table->visibleTupleCount() +
+                                                     target_table->migratingTupleCount()));
     output_table->insertTuple(tmptup);
 
 
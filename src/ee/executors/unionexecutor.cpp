@@ -43,13 +43,11 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include "boost/unordered_set.hpp"
-#include "boost/unordered_map.hpp"
-
 #include "unionexecutor.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
+#include "common/TupleHashTable.h"
 #include "common/FatalException.hpp"
 #include "plannodes/unionnode.h"
 #include "storage/table.h"
@@ -62,11 +60,6 @@ namespace voltdb {
 namespace detail {
 
 struct SetOperator {
-    typedef boost::unordered_set<TableTuple, TableTupleHasher, TableTupleEqualityChecker>
-        TupleSet;
-    typedef boost::unordered_map<TableTuple, size_t, TableTupleHasher, TableTupleEqualityChecker>
-        TupleMap;
-
     SetOperator(std::vector<Table*>& input_tables, Table* output_table, bool is_all) :
         m_input_tables(input_tables), m_output_table(output_table), m_is_all(is_all)
         {}
@@ -82,8 +75,7 @@ struct SetOperator {
     std::vector<Table*>& m_input_tables;
 
     // for debugging - may be unused
-    void printTupleMap(const char* nonce, TupleMap &tuples);
-    void printTupleSet(const char* nonce, TupleSet &tuples);
+    void printTupleHashTable(const char* nonce, TupleHashTable &tuples);
 
     protected:
         virtual bool processTuplesDo() = 0;
@@ -99,28 +91,34 @@ struct UnionSetOperator : public SetOperator {
 
     protected:
         bool processTuplesDo();
-
-    private:
-        bool needToInsert(const TableTuple& tuple, TupleSet& tuples);
-
 };
 
 bool UnionSetOperator::processTuplesDo() {
 
-    // Set to keep candidate tuples.
-    TupleSet tuples;
+    // Set to keep candidate tuples, sized to hold every input tuple.
+    size_t expected = 0;
+    if (!m_is_all) {
+        for (size_t ctr = 0, cnt = m_input_tables.size(); ctr < cnt; ctr++) {
+            expected += m_input_tables[ctr]->activeTupleCount();
+        }
+    }
+    TupleHashTable tuples(expected);
 
     //
     // For each input table, grab their TableIterator and then append all of its tuples
     // to our ouput table. Only distinct tuples are retained.
     //
+    bool inserted = true;
     for (size_t ctr = 0, cnt = m_input_tables.size(); ctr < cnt; ctr++) {
         Table* input_table = m_input_tables[ctr];
         assert(input_table);
         TableIterator iterator = input_table->iterator();
         TableTuple tuple(input_table->schema());
         while (iterator.next(tuple)) {
-            if (m_is_all || needToInsert(tuple, tuples)) {
+            if (!m_is_all) {
+                tuples.findOrInsert(tuple, inserted);
+            }
+            if (inserted) {
                 // we got tuple to insert
                 if (!m_output_table->insertTuple(tuple)) {
                     VOLT_ERROR("Failed to insert tuple from input table '%s' into"
@@ -135,15 +133,6 @@ bool UnionSetOperator::processTuplesDo() {
     return true;
 }
 
-inline
-bool UnionSetOperator::needToInsert(const TableTuple& tuple, TupleSet& tuples) {
-    bool result = tuples.find(tuple) == tuples.end();
-    if (result) {
-        tuples.insert(tuple);
-    }
-    return result;
-}
-
 struct TableSizeLess {
     bool operator()(const Table* t1, const Table* t2) const {
         return t1->activeTupleCount() < t2->activeTupleCount();
@@ -158,9 +147,9 @@ struct ExceptIntersectSetOperator : public SetOperator {
         bool processTuplesDo();
 
     private:
-        void collectTuples(Table& input_table, TupleMap& tuple_map);
-        void exceptTupleMaps(TupleMap& tuple_a, TupleMap& tuple_b);
-        void intersectTupleMaps(TupleMap& tuple_a, TupleMap& tuple_b);
+        void collectTuples(Table& input_table, TupleHashTable& tuples);
+        void exceptTuples(Table& input_table, TupleHashTable& tuples);
+        void intersectTuples(Table& input_table, TupleHashTable& tuples);
 
         bool m_is_except;
 };
@@ -178,58 +167,45 @@ ExceptIntersectSetOperator::ExceptIntersectSetOperator(
 }
 
 // for debugging - may be unused
-void SetOperator::printTupleMap(const char* nonce, TupleMap &tuples) {
-    printf("Printing TupleMap (%s): ", nonce);
-    for (TupleMap::const_iterator mapIt = tuples.begin(); mapIt != tuples.end(); ++mapIt) {
-        TableTuple tuple = mapIt->first;
-        printf("%s, ", tuple.debugNoHeader().c_str());
-    }
-    printf("\n");
-    fflush(stdout);
-}
-
-// for debugging - may be unused
-void SetOperator::printTupleSet(const char* nonce, TupleSet &tuples) {
-    printf("Printing TupleSet (%s): ", nonce);
-    for (TupleSet::const_iterator setIt = tuples.begin(); setIt != tuples.end(); ++setIt) {
-        printf("%s, ", setIt->debugNoHeader().c_str());
+void SetOperator::printTupleHashTable(const char* nonce, TupleHashTable &tuples) {
+    printf("Printing TupleHashTable (%s): ", nonce);
+    for (TupleHashTable::iterator it = tuples.begin(); it != tuples.end(); ++it) {
+        if (!it->isEmpty()) {
+            printf("%s x %ld, ", it->tuple.debugNoHeader().c_str(), (long)it->count);
+        }
     }
     printf("\n");
     fflush(stdout);
 }
 
 bool ExceptIntersectSetOperator::processTuplesDo() {
-    // Map to keep candidate tuples. The key is the tuple itself
-    // The value - tuple's repeat count in the final table.
-    TupleMap tuples;
-
-    // Collect all tuples from the first set
+    // Table to keep candidate tuples. The entry count is the
+    // tuple's repeat count in the final table.
     assert(!m_input_tables.empty());
     Table* input_table = m_input_tables[0];
+    TupleHashTable tuples(input_table->activeTupleCount());
+
+    // Collect all tuples from the first set
     collectTuples(*input_table, tuples);
 
     //
-    // For each remaining input table, collect its tuple into a separate map
-    // and substract/intersect it from/with the first one
+    // Probe each remaining input table's tuples against the first set and
+    // substract/intersect them from/with it in place.
     //
-    TupleMap next_tuples;
     for (size_t ctr = 1, cnt = m_input_tables.size(); ctr < cnt; ctr++) {
-        next_tuples.clear();
         Table* input_table = m_input_tables[ctr];
         assert(input_table);
-        collectTuples(*input_table, next_tuples);
         if (m_is_except) {
-            exceptTupleMaps(tuples, next_tuples);
+            exceptTuples(*input_table, tuples);
         } else {
-            intersectTupleMaps(tuples, next_tuples);
+            intersectTuples(*input_table, tuples);
         }
     }
 
     // Insert remaining tuples to our ouput table
-    for (TupleMap::const_iterator mapIt = tuples.begin(); mapIt != tuples.end(); ++mapIt) {
-        TableTuple tuple = mapIt->first;
-        for (size_t i = 0; i < mapIt->second; ++i) {
-            if (!m_output_table->insertTuple(tuple)) {
+    for (TupleHashTable::iterator it = tuples.begin(); it != tuples.end(); ++it) {
+        for (size_t i = 0; i < it->count; ++i) {
+            if (!m_output_table->insertTuple(it->tuple)) {
                 VOLT_ERROR("Failed to insert tuple from input table '%s' into"
                            " output table '%s'",
                            m_input_tables[0]->name().c_str(),
@@ -241,47 +217,45 @@ bool ExceptIntersectSetOperator::processTuplesDo() {
     return true;
 }
 
-void ExceptIntersectSetOperator::collectTuples(Table& input_table, TupleMap& tuple_map) {
+void ExceptIntersectSetOperator::collectTuples(Table& input_table, TupleHashTable& tuples) {
     TableIterator iterator = input_table.iterator();
     TableTuple tuple(input_table.schema());
+    bool inserted;
     while (iterator.next(tuple)) {
-        TupleMap::iterator mapIt = tuple_map.find(tuple);
-        if (mapIt == tuple_map.end()) {
-            tuple_map.insert(std::make_pair(tuple, 1));
-        } else if (m_is_all) {
-            ++mapIt->second;
+        TupleHashTable::Entry* entry = tuples.findOrInsert(tuple, inserted);
+        if (inserted || m_is_all) {
+            ++entry->count;
         }
     }
 }
 
-void ExceptIntersectSetOperator::exceptTupleMaps(TupleMap& map_a, TupleMap& map_b) {
-    TupleMap::iterator it_a = map_a.begin();
-    while(it_a != map_a.end()) {
-        TupleMap::iterator it_b = map_b.find(it_a->first);
-        if (it_b != map_b.end()) {
-            if (it_a->second > it_b->second) {
-                it_a->second -= it_b->second;
-            }
-            else {
-                it_a = map_a.erase(it_a);
-                continue;
-            }
+void ExceptIntersectSetOperator::exceptTuples(Table& input_table, TupleHashTable& tuples) {
+    TableIterator iterator = input_table.iterator();
+    TableTuple tuple(input_table.schema());
+    while (iterator.next(tuple)) {
+        TupleHashTable::Entry* entry = tuples.find(tuple);
+        if (entry != NULL && entry->count > 0) {
+            // Without ALL the count is at most 1, so any match removes it.
+            --entry->count;
         }
-        ++it_a;
     }
 }
 
-void ExceptIntersectSetOperator::intersectTupleMaps(TupleMap& map_a, TupleMap& map_b) {
-    TupleMap::iterator it_a = map_a.begin();
-    while(it_a != map_a.end()) {
-        TupleMap::iterator it_b = map_b.find(it_a->first);
-        if (it_b == map_b.end()) {
-            it_a = map_a.erase(it_a);
-        } else {
-            it_a->second = std::min(it_a->second, it_b->second);
-            ++it_a;
+void ExceptIntersectSetOperator::intersectTuples(Table& input_table, TupleHashTable& tuples) {
+    // Count the matches in this input, capped by the current count,
+    // then make that the new count: min(count_a, count_b).
+    TableIterator iterator = input_table.iterator();
+    TableTuple tuple(input_table.schema());
+    while (iterator.next(tuple)) {
+        TupleHashTable::Entry* entry = tuples.find(tuple);
+        if (entry != NULL && entry->matched < entry->count) {
+            ++entry->matched;
         }
     }
+    for (TupleHashTable::iterator it = tuples.begin(); it != tuples.end(); ++it) {
+        it->count = it->matched;
+        it->matched = 0;
+    }
 }
 
 boost::shared_ptr<SetOperator> SetOperator::getSetOperator(UnionPlanNode* node) {
@@ -44,6 +44,7 @@
  */
 
 #include <cassert>
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
 #include <boost/foreach.hpp>
 
@@ -152,6 +153,36 @@ bool UpdateExecutor::p_init(AbstractPlanNode* abstract_node,
         }
     }
 
+    // Updates that only touch inlined, fixed-width columns with no index or
+    // view depending on them (counters like SET x = x + 1) are written
+    // directly into block storage instead of going through a temp tuple
+    // copy of the whole row.
+    m_updateInPlace = m_indexesToUpdate.empty() && !m_targetTable->hasMaterializedViews();
+    const TupleSchema *targetSchema = m_targetTable->schema();
+    uint32_t spanBegin = targetSchema->tupleLength();
+    uint32_t spanEnd = 0;
+    for (int map_ctr = 0; m_updateInPlace && map_ctr < m_inputTargetMapSize; map_ctr++) {
+        int targetColumn = m_inputTargetMap[map_ctr].second;
+        ValueType columnType = targetSchema->columnType(targetColumn);
+        if (targetColumn == m_partitionColumn ||
+            !targetSchema->columnIsInlined(targetColumn) ||
+            columnType == VALUE_TYPE_VARCHAR ||
+            columnType == VALUE_TYPE_VARBINARY) {
+            m_updateInPlace = false;
+            break;
+        }
+        uint32_t columnOffset = targetSchema->columnOffset(targetColumn);
+        spanBegin = std::min(spanBegin, columnOffset);
+        spanEnd = std::max(spanEnd, columnOffset + targetSchema->columnLength(targetColumn));
+    }
+    if (m_updateInPlace && spanEnd > spanBegin) {
+        m_inPlaceUndoOffset = spanBegin;
+        m_inPlaceUndoLength = spanEnd - spanBegin;
+    } else {
+        m_updateInPlace = false;
+    }
+    VOLT_TRACE("Update executor in-place mode: %s", m_updateInPlace ? "true" : "false");
+
     return true;
 }
 
@@ -176,6 +207,12 @@ bool UpdateExecutor::p_execute(const NValueArray &params) {
         void *target_address = m_inputTuple.getNValue(0).castAsAddress();
         m_targetTuple.move(target_address);
 
+        if (m_updateInPlace) {
+            m_targetTable->updateTupleInPlace(m_targetTuple, m_inputTuple, m_inputTargetMap,
+                                              m_inPlaceUndoOffset, m_inPlaceUndoLength);
+            continue;
+        }
+
         // Loop through INPUT_COL_IDX->TARGET_COL_IDX mapping and only update
         // the values that we need to. The key thing to note here is that we
         // grab a temp tuple that is a copy of the target tuple (i.e., the tuple
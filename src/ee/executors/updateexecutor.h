@@ -73,6 +73,9 @@ public:
         m_targetTable = NULL;
         m_engine = engine;
         m_partitionColumn = -1;
+        m_updateInPlace = false;
+        m_inPlaceUndoOffset = 0;
+        m_inPlaceUndoLength = 0;
     }
 
 protected:
@@ -94,6 +97,12 @@ protected:
     bool m_partitionColumnIsString;
     std::vector<TableIndex*> m_indexesToUpdate;
 
+    /** true when every updated column can be overwritten directly in block storage */
+    bool m_updateInPlace;
+    /** span of tuple data covering the updated columns, saved for undo */
+    uint32_t m_inPlaceUndoOffset;
+    uint32_t m_inPlaceUndoLength;
+
     /** reference to the engine/context to store the number of modified tuples */
     VoltDBEngine* m_engine;
 };
@@ -252,20 +252,15 @@ static AbstractExpression* caseWhenFactory(ValueType vt,
 }
 
 
-/** convert the enumerated value type into a concrete type for
- * constant value expressions templated ctors */
-static AbstractExpression*
-constantValueFactory(PlannerDomValue obj,
-                     ValueType vt, ExpressionType et,
-                     AbstractExpression *lc, AbstractExpression *rc)
+/** read the value of a constant value expression of the given type */
+static NValue
+constantValue(PlannerDomValue obj, ValueType vt)
 {
-    // read before ctor - can then instantiate fully init'd obj.
     NValue newvalue;
     bool isNull = obj.valueForKey("ISNULL").asBool();
     if (isNull)
     {
-        newvalue = NValue::getNullValue(vt);
-        return new ConstantValueExpression(newvalue);
+        return NValue::getNullValue(vt);
     }
 
     PlannerDomValue valueValue = obj.valueForKey("VALUE");
@@ -313,7 +308,24 @@ constantValueFactory(PlannerDomValue obj,
                                       " type");
     }
 
-    return new ConstantValueExpression(newvalue);
+    return newvalue;
+}
+
+NValue
+ExpressionUtil::constantValueFromJSON(PlannerDomValue obj)
+{
+    return constantValue(obj, stringToValue(obj.valueForKey("VALUE_TYPE").asStr()));
+}
+
+/** convert the enumerated value type into a concrete type for
+ * constant value expressions templated ctors */
+static AbstractExpression*
+constantValueFactory(PlannerDomValue obj,
+                     ValueType vt, ExpressionType et,
+                     AbstractExpression *lc, AbstractExpression *rc)
+{
+    // read before ctor - can then instantiate fully init'd obj.
+    return new ConstantValueExpression(constantValue(obj, vt));
 }
 
 
@@ -541,7 +553,7 @@ ExpressionUtil::convertIfAllParameterValues(const std::vector<voltdb::AbstractEx
 
 void ExpressionUtil::loadIndexedExprsFromJson(std::vector<AbstractExpression*>& indexed_exprs, const std::string& jsonarraystring)
 {
-    PlannerDomRoot domRoot(jsonarraystring.c_str());
+    PlannerDomRoot domRoot(jsonarraystring.c_str(), jsonarraystring.size());
     PlannerDomValue expressionsArray = domRoot.rootObject();
     for (int i = 0; i < expressionsArray.arrayLen(); i++) {
         PlannerDomValue exprValue = expressionsArray.valueAtIndex(i);
@@ -66,6 +66,10 @@ public:
     static AbstractExpression* comparisonFactory(ExpressionType et, AbstractExpression *lc, AbstractExpression *rc);
     static AbstractExpression* conjunctionFactory(ExpressionType et, AbstractExpression *lc, AbstractExpression *rc);
 
+    /** Read the value of a serialized constant value expression. The
+     * caller owns any out-of-line storage of the returned value. */
+    static NValue constantValueFromJSON(PlannerDomValue obj);
+
     static void loadIndexedExprsFromJson(std::vector<voltdb::AbstractExpression*>& indexed_exprs,
                                          const std::string& jsonarraystring);
 
@@ -150,6 +150,22 @@ class CompactingHashMultiMapIndex : public TableIndex
 
     size_t getSize() const { return m_entries.size(); }
 
+    void clear() { m_entries.clear(); }
+
+    TableIndex *detachEntries()
+    {
+        CompactingHashMultiMapIndex *detached = new CompactingHashMultiMapIndex(TupleSchema::createTupleSchema(getKeySchema()), detachedScheme());
+        m_entries.swap(detached->m_entries);
+        return detached;
+    }
+
+    void reattachEntries(TableIndex *detached)
+    {
+        assert(m_entries.size() == 0);
+        m_entries.swap(static_cast<CompactingHashMultiMapIndex*>(detached)->m_entries);
+        delete detached;
+    }
+
     int64_t getMemoryEstimate() const
     {
         return m_entries.bytesAllocated();
@@ -148,6 +148,22 @@ class CompactingHashUniqueIndex : public TableIndex
 
     size_t getSize() const { return m_entries.size(); }
 
+    void clear() { m_entries.clear(); }
+
+    TableIndex *detachEntries()
+    {
+        CompactingHashUniqueIndex *detached = new CompactingHashUniqueIndex(TupleSchema::createTupleSchema(getKeySchema()), detachedScheme());
+        m_entries.swap(detached->m_entries);
+        return detached;
+    }
+
+    void reattachEntries(TableIndex *detached)
+    {
+        assert(m_entries.size() == 0);
+        m_entries.swap(static_cast<CompactingHashUniqueIndex*>(detached)->m_entries);
+        delete detached;
+    }
+
     int64_t getMemoryEstimate() const
     {
         return m_entries.bytesAllocated();
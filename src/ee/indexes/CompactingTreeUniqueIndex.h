@@ -75,6 +75,23 @@ class CompactingTreeUniqueIndex : public TableIndex
         return m_entries.insert(setKeyFromTuple(tuple), tuple->address());
     }
 
+    /**
+     * An empty tree is built in one pass from the sorted keys.
+     */
+    bool addEntries(const std::vector<TableTuple> &tuples)
+    {
+        if (m_entries.size() != 0) {
+            return TableIndex::addEntries(tuples);
+        }
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        for (std::vector<TableTuple>::const_iterator it = tuples.begin(); it != tuples.end(); ++it) {
+            entries.push_back(std::pair<KeyType, const void*>(setKeyFromTuple(&*it), it->address()));
+        }
+        m_inserts += tuples.size();
+        return m_entries.bulkLoad(entries);
+    }
+
     bool deleteEntry(const TableTuple *tuple)
     {
         ++m_deletes;
@@ -280,8 +297,55 @@ class CompactingTreeUniqueIndex : public TableIndex
         return m_entries.rankAsc(mapIter.key());
     }
 
+    /**
+     * See comments in parent class TableIndex
+     */
+    bool moveToRank(int64_t rank, bool forward)
+    {
+        if (!hasRank) {
+            return TableIndex::moveToRank(rank, forward);
+        }
+        ++m_lookups;
+        m_forward = forward;
+        m_keyIter = m_entries.findRank(rank);
+        return !m_keyIter.isEnd();
+    }
+
+    /**
+     * See comments in parent class TableIndex
+     */
+    bool advanceByRank(int64_t count)
+    {
+        if (!hasRank) {
+            return TableIndex::advanceByRank(count);
+        }
+        if (m_keyIter.isEnd()) {
+            return false;
+        }
+        // a rank off either end finds no entry and so ends the scan
+        const int64_t rank = m_entries.rankOf(m_keyIter);
+        m_keyIter = m_entries.findRank(m_forward ? rank + count : rank - count);
+        return !m_keyIter.isEnd();
+    }
+
     size_t getSize() const { return m_entries.size(); }
 
+    void clear() { m_entries.clear(); }
+
+    TableIndex *detachEntries()
+    {
+        CompactingTreeUniqueIndex *detached = new CompactingTreeUniqueIndex(TupleSchema::createTupleSchema(getKeySchema()), detachedScheme());
+        m_entries.swap(detached->m_entries);
+        return detached;
+    }
+
+    void reattachEntries(TableIndex *detached)
+    {
+        assert(m_entries.size() == 0);
+        m_entries.swap(static_cast<CompactingTreeUniqueIndex*>(detached)->m_entries);
+        delete detached;
+    }
+
     int64_t getMemoryEstimate() const
     {
         return m_entries.bytesAllocated();
@@ -73,6 +73,17 @@ TableIndex::~TableIndex()
     }
 }
 
+bool TableIndex::addEntries(const std::vector<TableTuple> &tuples)
+{
+    ensureCapacity(static_cast<uint32_t>(getSize() + tuples.size()));
+    for (std::vector<TableTuple>::const_iterator it = tuples.begin(); it != tuples.end(); ++it) {
+        if (!addEntry(&*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::string TableIndex::debug() const
 {
     std::ostringstream buffer;
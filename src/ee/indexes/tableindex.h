@@ -192,6 +192,13 @@ public:
      */
     virtual bool addEntry(const TableTuple *tuple) = 0;
 
+    /**
+     * adds an index entry for each of the passed tuples, stopping at
+     * the first one that can't be added. Indexes that can build
+     * themselves faster from a whole batch override this.
+     */
+    virtual bool addEntries(const std::vector<TableTuple> &tuples);
+
     /**
      * removes the index entry linked to given value (and tuple
      * pointer, if it's non-unique index).
@@ -360,6 +367,15 @@ public:
         return m_scheme.countable;
     }
 
+    /**
+     * True if the index keeps its keys in order, so that a scan from
+     * moveToEnd(true) visits them smallest first.
+     */
+    inline bool isOrderedIndex() const
+    {
+        return m_scheme.type == BALANCED_TREE_INDEX;
+    }
+
     virtual bool hasKey(const TableTuple *searchKey) = 0;
 
     /**
@@ -393,9 +409,48 @@ public:
         throwFatalException("Invoked non-countable TableIndex virtual method getCounterLET which has no implementation");
     }
 
+    /**
+     * This function only supports countable tree index. It selects the entry
+     * of the given rank, counting from 1 in ascending key order, and starts a
+     * scan from it in the given direction for nextValue().
+     *
+     * @Return false if there is no entry of that rank.
+     */
+    virtual bool moveToRank(int64_t rank, bool forward)
+    {
+        throwFatalException("Invoked non-countable TableIndex virtual method moveToRank which has no implementation");
+    }
+
+    /**
+     * This function only supports countable tree index. It skips the next
+     * count entries of a scan for nextValue(), as count calls to nextValue()
+     * would, but seeks by rank in logarithmic time instead of visiting them.
+     *
+     * @Return false if the scan has no entries left.
+     */
+    virtual bool advanceByRank(int64_t count)
+    {
+        throwFatalException("Invoked non-countable TableIndex virtual method advanceByRank which has no implementation");
+    }
+
 
     virtual size_t getSize() const = 0;
 
+    /**
+     * Remove all entries at once, without the per-entry work of
+     * deleteEntry. Used when a table is truncated.
+     */
+    virtual void clear() = 0;
+
+    /**
+     * Move all entries into a new index of the same type that serves only
+     * as their holder, leaving this index empty. reattachEntries hands
+     * them back and deletes the holder. Used by truncate so that its undo
+     * does not have to rebuild the index.
+     */
+    virtual TableIndex *detachEntries() = 0;
+    virtual void reattachEntries(TableIndex *detached) = 0;
+
     // Return the amount of memory we think is allocated for this
     // index.
     virtual int64_t getMemoryEstimate() const = 0;
@@ -463,6 +518,15 @@ protected:
 
     TableIndex(const TupleSchema *keySchema, const TableIndexScheme &scheme);
 
+    // The scheme for a holder of detached entries, which must not take
+    // ownership of the indexed expressions.
+    TableIndexScheme detachedScheme() const
+    {
+        TableIndexScheme scheme(m_scheme);
+        scheme.indexedExpressions.clear();
+        return scheme;
+    }
+
     TableIndexScheme m_scheme;
     const TupleSchema * const m_keySchema;
     const std::string m_id;
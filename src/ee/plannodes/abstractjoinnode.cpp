@@ -45,6 +45,7 @@
 
 #include "abstractjoinnode.h"
 
+#include "common/FatalException.hpp"
 #include "expressions/abstractexpression.h"
 
 #include <stdexcept>
@@ -67,6 +68,12 @@ AbstractJoinPlanNode::~AbstractJoinPlanNode()
     delete m_preJoinPredicate;
     delete m_joinPredicate;
     delete m_wherePredicate;
+    for (int i = 0; i < m_outerKeyExpressions.size(); i++) {
+        delete m_outerKeyExpressions[i];
+    }
+    for (int i = 0; i < m_innerKeyExpressions.size(); i++) {
+        delete m_innerKeyExpressions[i];
+    }
 }
 
 JoinType AbstractJoinPlanNode::getJoinType() const
@@ -89,6 +96,16 @@ AbstractExpression* AbstractJoinPlanNode::getWherePredicate() const
     return m_wherePredicate;
 }
 
+const vector<AbstractExpression*>& AbstractJoinPlanNode::getOuterKeyExpressions() const
+{
+    return m_outerKeyExpressions;
+}
+
+const vector<AbstractExpression*>& AbstractJoinPlanNode::getInnerKeyExpressions() const
+{
+    return m_innerKeyExpressions;
+}
+
 string AbstractJoinPlanNode::debugInfo(const string& spacer) const
 {
     ostringstream buffer;
@@ -108,6 +125,13 @@ string AbstractJoinPlanNode::debugInfo(const string& spacer) const
         buffer << spacer << "Where Predicate\n";
         buffer << m_wherePredicate->debug(spacer);
     }
+    for (int i = 0; i < m_outerKeyExpressions.size(); i++)
+    {
+        buffer << spacer << "Outer Key[" << i << "]\n";
+        buffer << m_outerKeyExpressions[i]->debug(spacer);
+        buffer << spacer << "Inner Key[" << i << "]\n";
+        buffer << m_innerKeyExpressions[i]->debug(spacer);
+    }
     return (buffer.str());
 }
 
@@ -119,6 +143,12 @@ AbstractJoinPlanNode::loadFromJSONObject(PlannerDomValue obj)
     loadPredicateFromJSONObject("PRE_JOIN_PREDICATE", obj, m_preJoinPredicate);
     loadPredicateFromJSONObject("JOIN_PREDICATE", obj, m_joinPredicate);
     loadPredicateFromJSONObject("WHERE_PREDICATE", obj, m_wherePredicate);
+    loadExpressionsFromJSONObject("OUTER_KEY_EXPRESSIONS", obj, m_outerKeyExpressions);
+    loadExpressionsFromJSONObject("INNER_KEY_EXPRESSIONS", obj, m_innerKeyExpressions);
+    if (m_outerKeyExpressions.size() != m_innerKeyExpressions.size()) {
+        throwFatalException("Join has %d outer keys but %d inner keys",
+                            (int)m_outerKeyExpressions.size(), (int)m_innerKeyExpressions.size());
+    }
 }
 
 
@@ -132,3 +162,15 @@ AbstractJoinPlanNode::loadPredicateFromJSONObject(const char* predicateType, con
         predicate = NULL;
     }
 }
+
+void
+AbstractJoinPlanNode::loadExpressionsFromJSONObject(const char* expressionsType, const PlannerDomValue& obj,
+                                                    vector<AbstractExpression*>& expressions)
+{
+    if (obj.hasNonNullKey(expressionsType)) {
+        PlannerDomValue expressionsArray = obj.valueForKey(expressionsType);
+        for (int i = 0; i < expressionsArray.arrayLen(); i++) {
+            expressions.push_back(AbstractExpression::buildExpressionTree(expressionsArray.valueAtIndex(i)));
+        }
+    }
+}
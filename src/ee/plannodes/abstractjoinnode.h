@@ -68,6 +68,10 @@ public:
 
     AbstractExpression* getWherePredicate() const;
 
+    const std::vector<AbstractExpression*>& getOuterKeyExpressions() const;
+
+    const std::vector<AbstractExpression*>& getInnerKeyExpressions() const;
+
     virtual std::string debugInfo(const std::string& spacer) const;
 
 protected:
@@ -76,6 +80,9 @@ protected:
     void loadPredicateFromJSONObject(
         const char* predicateType, const PlannerDomValue& obj, AbstractExpression*& predicate);
 
+    void loadExpressionsFromJSONObject(
+        const char* expressionsType, const PlannerDomValue& obj, std::vector<AbstractExpression*>& expressions);
+
     // This is the outer-table-only join expression. If the outer tuple fails it,
     // it may still be part of the result set (pending other filtering)
     // but can't be joined with any tuple from the inner table.
@@ -91,7 +98,13 @@ protected:
     // joined tuple after it's assembled
     AbstractExpression* m_wherePredicate;
 
-    // Currently either inner or left outer.
+    // Optional equi-join keys: an outer and an inner tuple can only join
+    // if their keys are equal and none of them is NULL. The join predicate
+    // still applies to the tuples that do, so it may or may not repeat it.
+    std::vector<AbstractExpression*> m_outerKeyExpressions;
+    std::vector<AbstractExpression*> m_innerKeyExpressions;
+
+    // Either inner, left outer, semi or anti.
     JoinType m_joinType;
 };
 
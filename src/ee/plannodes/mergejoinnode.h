@@ -0,0 +1,44 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREMERGEJOINNODE_H
+#define HSTOREMERGEJOINNODE_H
+
+#include "abstractjoinnode.h"
+
+namespace voltdb
+{
+
+/**
+ * A join of two inputs that are both sorted ascending on the join keys,
+ * such as the output of ordered index scans. The keys are the
+ * OUTER_KEY_EXPRESSIONS and INNER_KEY_EXPRESSIONS of the join, and the
+ * join predicate, if any, applies to the tuples with equal keys.
+ * Either inner or left outer.
+ */
+class MergeJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    MergeJoinPlanNode() : AbstractJoinPlanNode() { }
+    ~MergeJoinPlanNode();
+
+    virtual PlanNodeType getPlanNodeType() const { return PLAN_NODE_TYPE_MERGEJOIN; }
+};
+
+}
+
+#endif
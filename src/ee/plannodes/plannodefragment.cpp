@@ -94,7 +94,9 @@ PlanNodeFragment::createFromCatalog(const string value)
     //cout << "DEBUG PlanNodeFragment::createFromCatalog: value.size() == " << value.size() << endl;
     //cout << "DEBUG PlanNodeFragment::createFromCatalog: value == " << value << endl;
 
-    PlannerDomRoot domRoot(value.c_str());
+    // The plan is either JSON text or its binary form, which loads
+    // without a parse; see PlannerDomRoot.
+    PlannerDomRoot domRoot(value.c_str(), value.size());
 
     PlanNodeFragment *retval = PlanNodeFragment::fromJSONObject(domRoot.rootObject());
     return retval;
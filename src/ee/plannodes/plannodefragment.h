@@ -72,7 +72,8 @@ class PlanNodeFragment {
     PlanNodeFragment();
     virtual ~PlanNodeFragment();
 
-    // construct a new fragment from the catalog's serialization
+    // construct a new fragment from the catalog's serialization,
+    // either JSON or its binary form (see PlannerDomRoot)
     static PlanNodeFragment * createFromCatalog(const std::string);
 
     // construct a new fragment from a serialized json object
@@ -57,6 +57,7 @@
 #include "plannodes/limitnode.h"
 #include "plannodes/materializenode.h"
 #include "plannodes/materializedscanplannode.h"
+#include "plannodes/mergejoinnode.h"
 #include "plannodes/nestloopnode.h"
 #include "plannodes/nestloopindexnode.h"
 #include "plannodes/projectionnode.h"
@@ -66,6 +67,7 @@
 #include "plannodes/seqscannode.h"
 #include "plannodes/unionnode.h"
 #include "plannodes/updatenode.h"
+#include "plannodes/windowfunctionnode.h"
 
 #include <sstream>
 
@@ -122,6 +124,12 @@ voltdb::AbstractPlanNode* getEmptyPlanNode(voltdb::PlanNodeType type) {
             ret = new voltdb::NestLoopIndexPlanNode();
             break;
         // ------------------------------------------------------------------
+        // MergeJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_MERGEJOIN):
+            ret = new voltdb::MergeJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
         // Update
         // ------------------------------------------------------------------
         case (voltdb::PLAN_NODE_TYPE_UPDATE):
@@ -146,6 +154,9 @@ voltdb::AbstractPlanNode* getEmptyPlanNode(voltdb::PlanNodeType type) {
         case (voltdb::PLAN_NODE_TYPE_AGGREGATE):
             ret = new voltdb::AggregatePlanNode(type);
             break;
+        case (voltdb::PLAN_NODE_TYPE_WINDOWFUNCTION):
+            ret = new voltdb::WindowFunctionPlanNode();
+            break;
         // ------------------------------------------------------------------
         // Union
         // ------------------------------------------------------------------
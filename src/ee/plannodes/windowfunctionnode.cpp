@@ -0,0 +1,59 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "windowfunctionnode.h"
+
+#include "expressions/abstractexpression.h"
+
+#include <sstream>
+
+using namespace std;
+using namespace voltdb;
+
+WindowFunctionPlanNode::~WindowFunctionPlanNode()
+{
+    for (int i = 0; i < m_orderByExpressions.size(); i++)
+    {
+        delete m_orderByExpressions[i];
+    }
+}
+
+string WindowFunctionPlanNode::debugInfo(const string &spacer) const {
+    ostringstream buffer;
+    buffer << AggregatePlanNode::debugInfo(spacer);
+    buffer << spacer << "OrderByExpressions[";
+    for (int ctr = 0, cnt = (int) m_orderByExpressions.size();
+         ctr < cnt; ctr++)
+    {
+        buffer << spacer << m_orderByExpressions[ctr]->debug(spacer);
+    }
+    buffer << "]\n";
+    return buffer.str();
+}
+
+void
+WindowFunctionPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AggregatePlanNode::loadFromJSONObject(obj);
+
+    if (obj.hasNonNullKey("ORDERBY_EXPRESSIONS")) {
+        PlannerDomValue orderByExpressionsArray = obj.valueForKey("ORDERBY_EXPRESSIONS");
+        for (int i = 0; i < orderByExpressionsArray.arrayLen(); i++) {
+            m_orderByExpressions.push_back(AbstractExpression::buildExpressionTree(orderByExpressionsArray.valueAtIndex(i)));
+        }
+    }
+}
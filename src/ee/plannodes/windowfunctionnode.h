@@ -0,0 +1,56 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREWINDOWFUNCTIONNODE_H
+#define HSTOREWINDOWFUNCTIONNODE_H
+
+#include "plannodes/aggregatenode.h"
+
+namespace voltdb
+{
+
+/**
+ * Window functions over input sorted on the window's PARTITION BY keys
+ * and then on its ORDER BY keys. Each input row is output with the value
+ * of every window function at that row, so the aggregates run rather than
+ * collapse the rows of a group.
+ *
+ * The aggregates are serialized as those of an AggregatePlanNode, with the
+ * PARTITION BY keys as its GROUPBY_EXPRESSIONS, and the ORDER BY keys as
+ * ORDERBY_EXPRESSIONS. Rows of a partition with equal ORDER BY keys are
+ * peers, which share their rank and the value of each running aggregate.
+ */
+class WindowFunctionPlanNode : public AggregatePlanNode
+{
+public:
+    WindowFunctionPlanNode() : AggregatePlanNode(PLAN_NODE_TYPE_WINDOWFUNCTION) { }
+    ~WindowFunctionPlanNode();
+
+    const std::vector<AbstractExpression*>& getOrderByExpressions() const
+    { return m_orderByExpressions; }
+
+    std::string debugInfo(const std::string &spacer) const;
+
+protected:
+    virtual void loadFromJSONObject(PlannerDomValue obj);
+
+    std::vector<AbstractExpression*> m_orderByExpressions;
+};
+
+}
+
+#endif
@@ -44,7 +44,7 @@ CopyOnWriteContext::CopyOnWriteContext(
                                                                "COW of " + table.name(),
                                                                &table, NULL)),
              m_pool(2097152, 320),
-             m_blocks(surgeon.getData()),
+             m_blocks(),
              m_tuple(table.schema()),
              m_finishedTableScan(false),
              m_totalTuples(totalTuples),
@@ -54,13 +54,17 @@ CopyOnWriteContext::CopyOnWriteContext(
              m_inserts(0),
              m_updates(0)
 {
+    surgeon.borrowData(m_blocks);
+    surgeon.pinBlocks(m_blocks);
 }
 
 /**
  * Destructor.
  */
 CopyOnWriteContext::~CopyOnWriteContext()
-{}
+{
+    m_surgeon.unpinBlocks(m_blocks);
+}
 
 
 /**
@@ -148,7 +152,7 @@ int64_t CopyOnWriteContext::handleStreamMore(TupleOutputStreamProcessor &outputS
                     assert(!tuple.isPendingDeleteOnUndoRelease());
                     CopyOnWriteIterator *iter = static_cast<CopyOnWriteIterator*>(m_iterator.get());
                     //Save the extra lookup if possible
-                    m_surgeon.deleteTupleStorage(tuple, iter->m_currentBlock);
+                    m_surgeon.deleteTupleStorage(tuple, TBPtr(iter->m_currentBlock));
                 }
 
                 /*
@@ -261,13 +265,11 @@ bool CopyOnWriteContext::notifyTupleDelete(TableTuple &tuple) {
     }
 
     /**
-     * Find out which block the address is contained in. Lower bound returns the first entry
-     * in the index >= the address. Unless the address happens to be equal then the block
-     * we are looking for is probably the previous entry. Then check if the address fits
-     * in the previous entry. If it doesn't then the block is something new.
+     * Find out which block the address is contained in. If it is not one of the
+     * blocks being snapshotted then the block is something new.
      */
-    TBPtr block = PersistentTable::findBlock(tuple.address(), m_blocks, getTable().getTableAllocationSize());
-    if (block.get() == NULL) {
+    TupleBlock *block = PersistentTable::findBlock(tuple.address(), m_blocks, getTable().getTableAllocationSize());
+    if (block == NULL) {
         // tuple not in snapshot region, don't care about this tuple
         return true;
     }
@@ -309,8 +311,8 @@ void CopyOnWriteContext::markTupleDirty(TableTuple tuple, bool newTuple) {
     /**
      * Find out which block the address is contained in.
      */
-    TBPtr block = PersistentTable::findBlock(tuple.address(), m_blocks, getTable().getTableAllocationSize());
-    if (block.get() == NULL) {
+    TupleBlock *block = PersistentTable::findBlock(tuple.address(), m_blocks, getTable().getTableAllocationSize());
+    if (block == NULL) {
         // tuple not in snapshot region, don't care about this tuple, no need to dirty it
         tuple.setDirtyFalse();
         return;
@@ -340,15 +342,15 @@ void CopyOnWriteContext::notifyBlockWasCompactedAway(TBPtr block) {
     m_blocksCompacted++;
     CopyOnWriteIterator *iter = static_cast<CopyOnWriteIterator*>(m_iterator.get());
     if (iter->m_blockIterator != m_blocks.end()) {
-        TBPtr nextBlock = iter->m_blockIterator.data();
+        TupleBlock *nextBlock = iter->m_blockIterator.data();
         //The next block is the one that was compacted away
         //Need to move the iterator forward to skip it
-        if (nextBlock == block) {
+        if (nextBlock == block.get()) {
             iter->m_blockIterator++;
 
             //There is another block after the one that was compacted away
             if (iter->m_blockIterator != m_blocks.end()) {
-                TBPtr newNextBlock = iter->m_blockIterator.data();
+                TupleBlock *newNextBlock = iter->m_blockIterator.data();
                 m_blocks.erase(block->address());
                 iter->m_blockIterator = m_blocks.find(newNextBlock->address());
                 iter->m_end = m_blocks.end();
@@ -113,8 +113,10 @@ private:
     /**
      * Copied and sorted tuple blocks that can be binary searched in order to find out. The pair
      * contains the block address as well as the original index of the block.
+     * The iterator erases each block once it has scanned it. The map is pinned
+     * on the table, which keeps the blocks left in it allocated.
      */
-    TBMap m_blocks;
+    TBBorrowedMap m_blocks;
 
     /**
      * Iterator over the table via a CopyOnWriteIterator or an iterator over
@@ -22,7 +22,7 @@ namespace voltdb {
 CopyOnWriteIterator::CopyOnWriteIterator(
         PersistentTable *table,
         PersistentTableSurgeon *surgeon,
-        TBMap blocks) :
+        TBBorrowedMap &blocks) :
         m_table(table), m_surgeon(surgeon), m_blocks(blocks),
         m_blockIterator(m_blocks.begin()), m_end(m_blocks.end()),
         m_tupleLength(table->getTupleLength()),
@@ -50,7 +50,12 @@ bool CopyOnWriteIterator::next(TableTuple &out) {
     while (true) {
         if (m_blockOffset >= m_currentBlock->unusedTupleBoundry()) {
             if (m_blockIterator == m_end) {
-                m_surgeon->snapshotFinishedScanningBlock(m_currentBlock, TBPtr());
+                m_surgeon->snapshotFinishedScanningBlock(m_currentBlock, NULL);
+                m_blocks.erase(m_currentBlock->address());
+                m_blockIterator = m_blocks.end();
+                m_end = m_blocks.end();
+                m_currentBlock = NULL;
+                m_surgeon->releaseRetiredBlocks();
                 break;
             }
             m_surgeon->snapshotFinishedScanningBlock(m_currentBlock, m_blockIterator.data());
@@ -71,9 +76,10 @@ bool CopyOnWriteIterator::next(TableTuple &out) {
             m_blocks.erase(finishedBlock);
             m_blockIterator = m_blocks.upper_bound(m_currentBlock->address());
             m_end = m_blocks.end();
+            m_surgeon->releaseRetiredBlocks();
         }
-        assert(m_location < m_currentBlock.get()->address() + m_table->getTableAllocationSize());
-        assert(m_location < m_currentBlock.get()->address() + (m_table->getTupleLength() * m_table->getTuplesPerBlock()));
+        assert(m_location < m_currentBlock->address() + m_table->getTableAllocationSize());
+        assert(m_location < m_currentBlock->address() + (m_table->getTupleLength() * m_table->getTuplesPerBlock()));
         assert (out.sizeInValues() == m_table->columnCount());
         m_blockOffset++;
         out.move(m_location);
@@ -99,9 +105,8 @@ int64_t CopyOnWriteIterator::countRemaining() const {
     TableTuple out(m_table->schema());
     uint32_t blockOffset = m_blockOffset;
     char *location = m_location;
-    TupleBlock *pcurrentBlock = m_currentBlock.get();
-    TBPtr currentBlock(pcurrentBlock);
-    TBMapI blockIterator = m_blockIterator;
+    TupleBlock *currentBlock = m_currentBlock;
+    TBBorrowedMapI blockIterator = m_blockIterator;
     int64_t count = 0;
     while (true) {
         if (blockOffset >= currentBlock->unusedTupleBoundry()) {
@@ -34,7 +34,7 @@ public:
     CopyOnWriteIterator(
         PersistentTable *table,
         PersistentTableSurgeon *surgeon,
-        TBMap blocks);
+        TBBorrowedMap &blocks);
 
     /**
      * When a tuple is "dirty" it is still active, but will never be a "found" tuple
@@ -77,11 +77,13 @@ private:
     PersistentTableSurgeon *m_surgeon;
 
     /**
-     * Index of the current block being iterated over
+     * Index of the blocks left to iterate over, the current one included.
+     * The blocks are borrowed, and the map is the context's, which pins
+     * it so that the table keeps them allocated.
      */
-    TBMap m_blocks;
-    TBMapI m_blockIterator;
-    TBMapI m_end;
+    TBBorrowedMap &m_blocks;
+    TBBorrowedMapI m_blockIterator;
+    TBBorrowedMapI m_end;
 
     /**
      * Length of a tuple
@@ -96,7 +98,7 @@ private:
     bool m_didFirstIteration;
 
     uint32_t m_blockOffset;
-    TBPtr m_currentBlock;
+    TupleBlock *m_currentBlock;
 };
 }
 
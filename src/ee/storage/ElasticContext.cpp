@@ -69,7 +69,7 @@ ElasticContext::handleActivation(TableStreamType streamType)
             return ACTIVATION_SUCCEEDED;
         }
         m_surgeon.createIndex();
-        m_scanner.reset(new ElasticScanner(getTable(), m_surgeon.getData()));
+        m_scanner.reset(new ElasticScanner(getTable(), m_surgeon));
         m_indexActive = true;
         return ACTIVATION_SUCCEEDED;
     }
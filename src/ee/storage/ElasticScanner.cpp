@@ -24,20 +24,25 @@ namespace voltdb
 /**
  * Constructor.
  */
-ElasticScanner::ElasticScanner(PersistentTable &table, TBMap &data) :
+ElasticScanner::ElasticScanner(PersistentTable &table, PersistentTableSurgeon &surgeon) :
     m_table(table),
-    m_blockMap(data),
+    m_surgeon(surgeon),
     m_tupleSize(m_table.getTupleLength()),
-    m_blockIterator(m_blockMap.begin()),
-    m_blockEnd(m_blockMap.end()),
     m_currentBlockPtr(NULL),
     m_tuplePtr(NULL),
     m_tupleIndex(0),
     m_scanComplete(false)
-{}
+{
+    m_surgeon.borrowData(m_blockMap);
+    m_surgeon.pinBlocks(m_blockMap);
+    m_blockIterator = m_blockMap.begin();
+    m_blockEnd = m_blockMap.end();
+}
 
 ElasticScanner::~ElasticScanner()
-{}
+{
+    m_surgeon.unpinBlocks(m_blockMap);
+}
 
 /**
  * Internal method that handles transitions between blocks and
@@ -47,15 +52,22 @@ bool ElasticScanner::continueScan() {
     if (!m_scanComplete) {
         // First block or end of block?
         if (m_currentBlockPtr == NULL || m_tupleIndex >= m_currentBlockPtr->unusedTupleBoundry()) {
+            // Let the table free the finished block once it lets go of it.
+            if (m_currentBlockPtr != NULL) {
+                char *finishedBlock = m_currentBlockPtr->address();
+                m_blockMap.erase(finishedBlock);
+                m_blockIterator = m_blockMap.upper_bound(finishedBlock);
+                m_blockEnd = m_blockMap.end();
+                m_currentBlockPtr = NULL;
+                m_surgeon.releaseRetiredBlocks();
+            }
             // No more blocks?
             m_scanComplete = (m_blockIterator == m_blockEnd);
             if (!m_scanComplete) {
                 // Shift to the next block.
                 m_tuplePtr = m_blockIterator.key();
                 m_currentBlockPtr = m_blockIterator.data();
-                m_scannedBlocks.insert(m_currentBlockPtr);
                 assert(m_currentBlockPtr->address() == m_tuplePtr);
-                m_blockIterator.data() = TBPtr();
                 m_tupleIndex = 0;
                 m_blockIterator++;
             }
@@ -73,8 +85,8 @@ bool ElasticScanner::next(TableTuple &out)
     while (!found && continueScan()) {
         assert(m_currentBlockPtr != NULL);
         // Sanity checks.
-        assert(m_tuplePtr < m_currentBlockPtr.get()->address() + m_table.getTableAllocationSize());
-        assert(m_tuplePtr < m_currentBlockPtr.get()->address() + (m_tupleSize * m_table.getTuplesPerBlock()));
+        assert(m_tuplePtr < m_currentBlockPtr->address() + m_table.getTableAllocationSize());
+        assert(m_tuplePtr < m_currentBlockPtr->address() + (m_tupleSize * m_table.getTuplesPerBlock()));
         assert (out.sizeInValues() == m_table.columnCount());
         // Grab the tuple pointer.
         out.move(m_tuplePtr);
@@ -93,13 +105,13 @@ bool ElasticScanner::next(TableTuple &out)
  */
 void ElasticScanner::notifyBlockWasCompactedAway(TBPtr block) {
     if (!m_scanComplete && m_blockIterator != m_blockEnd) {
-        TBPtr nextBlock = m_blockIterator.data();
-        if (nextBlock == block) {
+        TupleBlock *nextBlock = m_blockIterator.data();
+        if (nextBlock == block.get()) {
             // The next block was compacted away.
             m_blockIterator++;
             if (m_blockIterator != m_blockEnd) {
                 // There is a block to skip to.
-                TBPtr newNextBlock = m_blockIterator.data();
+                TupleBlock *newNextBlock = m_blockIterator.data();
                 m_blockMap.erase(block->address());
                 m_blockIterator = m_blockMap.find(newNextBlock->address());
                 m_blockEnd = m_blockMap.end();
@@ -111,9 +123,10 @@ void ElasticScanner::notifyBlockWasCompactedAway(TBPtr block) {
                 m_blockIterator = m_blockMap.end();
                 m_blockEnd = m_blockMap.end();
             }
-        } else {
+        } else if (block.get() != m_currentBlockPtr) {
             // Some random block was compacted away.
-            // Remove it and regenerate the iterator.
+            // Remove it and regenerate the iterator. The current block
+            // stays pinned until the scan moves past it.
             m_blockMap.erase(block->address());
             m_blockIterator = m_blockMap.find(nextBlock->address());
             m_blockEnd = m_blockMap.end();
@@ -26,6 +26,7 @@ namespace voltdb
 {
 
 class PersistentTable;
+class PersistentTableSurgeon;
 class TableTuple;
 
 /**
@@ -38,9 +39,11 @@ class ElasticScanner : public TupleIterator
   public:
 
     /**
-     * Constructor.
+     * Constructor. The scanner pins the map of the blocks it has yet to
+     * scan until it is destroyed, so that the table keeps those blocks
+     * allocated while the scanner may still walk them.
      */
-    ElasticScanner(PersistentTable &table, TBMap &data);
+    ElasticScanner(PersistentTable &table, PersistentTableSurgeon &surgeon);
 
     /**
      * Destructor.
@@ -76,20 +79,24 @@ class ElasticScanner : public TupleIterator
     /// Table being iterated.
     PersistentTable &m_table;
 
-    /// Block map.
-    TBMap m_blockMap;
+    /// Surgeon of the table, for pinning its blocks.
+    PersistentTableSurgeon &m_surgeon;
+
+    /// Blocks left to scan, the current one included, borrowed from the table.
+    /// Pinned for the life of the scanner.
+    TBBorrowedMap m_blockMap;
 
     /// Tuple size in bytes.
     const int m_tupleSize;
 
     /// Block iterator.
-    TBMapI m_blockIterator;
+    TBBorrowedMapI m_blockIterator;
 
     /// Block iterator end marker.
-    TBMapI m_blockEnd;
+    TBBorrowedMapI m_blockEnd;
 
     /// Current block pointer.
-    TBPtr m_currentBlockPtr;
+    TupleBlock *m_currentBlockPtr;
 
     /// Current tuple pointer.
     char *m_tuplePtr;
@@ -97,9 +104,6 @@ class ElasticScanner : public TupleIterator
     /// Current tuple index (0-n within the block).
     uint32_t m_tupleIndex;
 
-    /// Already-processed blocks.
-    boost::unordered_set<TBPtr> m_scannedBlocks;
-
     /// Set to true after last tuple is returned.
     bool m_scanComplete;
 };
@@ -0,0 +1,61 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PERSISTENTTABLEUNDODELETEBATCHACTION_H_
+#define PERSISTENTTABLEUNDODELETEBATCHACTION_H_
+
+#include "common/UndoAction.h"
+#include "storage/persistenttable.h"
+
+namespace voltdb {
+
+/*
+ * Undo action covering every tuple removed by one PersistentTable::deleteTuples
+ * call. The tuple addresses are kept in storage order. The action is registered
+ * before the first tuple is deleted and covers only the leading tuples that
+ * have been reported through tupleDeleted.
+ */
+class PersistentTableUndoDeleteBatchAction: public UndoAction {
+public:
+    inline PersistentTableUndoDeleteBatchAction(char **deletedTuples, PersistentTableSurgeon *table)
+        : m_tuples(deletedTuples), m_count(0), m_table(table)
+    {}
+
+    void tupleDeleted() { ++m_count; }
+
+private:
+    virtual ~PersistentTableUndoDeleteBatchAction() { }
+
+    /*
+     * Undo whatever this undo action was created to undo. In this case reinsert the tuples into the table.
+     */
+    virtual void undo() { m_table->deleteTuplesForUndo(m_tuples, m_count); }
+
+    /*
+     * Release any resources held by the undo action. It will not need to be undone in the future.
+     * In this case free the tuples, block by block.
+     */
+    virtual void release() { m_table->deleteTuplesRelease(m_tuples, m_count); }
+
+private:
+    char **m_tuples;
+    size_t m_count;
+    PersistentTableSurgeon *m_table;
+};
+
+}
+
+#endif /* PERSISTENTTABLEUNDODELETEBATCHACTION_H_ */
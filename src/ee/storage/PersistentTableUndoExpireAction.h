@@ -0,0 +1,57 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERSISTENTTABLEUNDOEXPIREACTION_H_
+#define PERSISTENTTABLEUNDOEXPIREACTION_H_
+
+#include "common/UndoAction.h"
+#include "storage/persistenttable.h"
+
+namespace voltdb {
+
+/*
+ * Counts the tuples one purge of expired tuples deleted once the
+ * transaction that purged them commits. The deletes themselves are undone
+ * by their own PersistentTableUndoDeleteBatchAction.
+ */
+class PersistentTableUndoExpireAction: public UndoAction {
+public:
+    inline PersistentTableUndoExpireAction(size_t count, PersistentTableSurgeon *table)
+        : m_count(count), m_table(table)
+    {}
+
+private:
+    virtual ~PersistentTableUndoExpireAction() { }
+
+    /*
+     * Nothing was counted yet, so there is nothing to undo.
+     */
+    virtual void undo() { }
+
+    /*
+     * The purge committed, so count its tuples as expired.
+     */
+    virtual void release() { m_table->expiredTuplesRelease(m_count); }
+
+private:
+    size_t m_count;
+    PersistentTableSurgeon *m_table;
+};
+
+}
+
+#endif /* PERSISTENTTABLEUNDOEXPIREACTION_H_ */
@@ -0,0 +1,69 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERSISTENTTABLEUNDOINPLACEUPDATEACTION_H_
+#define PERSISTENTTABLEUNDOINPLACEUPDATEACTION_H_
+
+#include "common/UndoAction.h"
+#include "storage/persistenttable.h"
+
+
+namespace voltdb {
+
+/*
+ * Undo action for PersistentTable::updateTupleInPlace. Only the span of
+ * tuple data that the update overwrote is kept, rather than full copies
+ * of the old and new tuples.
+ */
+class PersistentTableUndoInPlaceUpdateAction: public UndoAction {
+public:
+
+    inline PersistentTableUndoInPlaceUpdateAction(char* tuple, char* oldBytes,
+                                                  uint32_t offset, uint32_t length,
+                                                  PersistentTableSurgeon *table)
+      : m_tuple(tuple), m_oldBytes(oldBytes),
+        m_offset(offset), m_length(length), m_table(table)
+    { }
+
+    /*
+     * Undo whatever this undo action was created to undo. In this
+     * case the saved bytes are copied back over the tuple data.
+     */
+    virtual void undo()
+    {
+        m_table->updateTupleInPlaceForUndo(m_tuple, m_oldBytes, m_offset, m_length);
+    }
+
+    /*
+     * Release any resources held by the undo action. It will not need
+     * to be undone in the future. In this case the tuple is unpinned.
+     */
+    virtual void release() { m_table->updateTupleInPlaceRelease(); }
+
+    virtual ~PersistentTableUndoInPlaceUpdateAction() { }
+
+private:
+    char* const m_tuple;
+    char* const m_oldBytes;
+    uint32_t const m_offset;
+    uint32_t const m_length;
+    PersistentTableSurgeon * const m_table;
+};
+
+}
+
+#endif /* PERSISTENTTABLEUNDOINPLACEUPDATEACTION_H_ */
@@ -0,0 +1,72 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERSISTENTTABLEUNDOTRUNCATEACTION_H_
+#define PERSISTENTTABLEUNDOTRUNCATEACTION_H_
+
+#include "common/UndoAction.h"
+#include "storage/persistenttable.h"
+
+
+namespace voltdb {
+
+/*
+ * Undo action for PersistentTable::truncateTable. Holds on to the
+ * tuple blocks and index entries that the truncate detached from the table.
+ */
+class PersistentTableUndoTruncateAction: public UndoAction {
+public:
+
+    inline PersistentTableUndoTruncateAction(TBMap &detachedBlocks,
+                                             std::vector<TableIndex*> &detachedIndexes,
+                                             uint32_t tupleCount, int64_t nonInlinedMemorySize,
+                                             PersistentTableSurgeon *table)
+      : m_tupleCount(tupleCount), m_nonInlinedMemorySize(nonInlinedMemorySize), m_table(table)
+    {
+        m_detachedBlocks.swap(detachedBlocks);
+        m_detachedIndexes.swap(detachedIndexes);
+    }
+
+    /*
+     * Undo whatever this undo action was created to undo. In this
+     * case the blocks and index entries are re-attached to the table.
+     */
+    virtual void undo()
+    {
+        m_table->truncateTableForUndo(m_detachedBlocks, m_detachedIndexes, m_tupleCount, m_nonInlinedMemorySize);
+    }
+
+    /*
+     * Release any resources held by the undo action. It will not need
+     * to be undone in the future. In this case the blocks, the
+     * strings they reference and the detached index entries are freed.
+     */
+    virtual void release() { m_table->truncateTableRelease(m_detachedBlocks, m_detachedIndexes); }
+
+    virtual ~PersistentTableUndoTruncateAction() { }
+
+private:
+    TBMap m_detachedBlocks;
+    std::vector<TableIndex*> m_detachedIndexes;
+    uint32_t const m_tupleCount;
+    int64_t const m_nonInlinedMemorySize;
+    PersistentTableSurgeon * const m_table;
+};
+
+}
+
+#endif /* PERSISTENTTABLEUNDOTRUNCATEACTION_H_ */
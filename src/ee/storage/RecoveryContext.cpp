@@ -35,7 +35,7 @@ RecoveryContext::RecoveryContext(
     m_firstMessage(true),
     m_iterator(getTable().iterator()),
     m_tableId(tableId),
-    m_recoveryPhase(RECOVERY_MSG_TYPE_SCAN_TUPLES) {
+    m_recoveryPhase(RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES) {
 }
 
 /*
@@ -85,9 +85,9 @@ bool RecoveryContext::nextMessage(ReferenceSerializeOutput *out) {
             getTable().schema());
     TableTuple tuple(getTable().schema());
     while (message.canAddMoreTuples() && m_iterator.next(tuple)) {
-        message.addTuple(tuple);
+        message.addTupleImage(tuple);
     }
-    message.finalize();
+    message.finalize(!m_iterator.hasNext());
     return true;
 }
 
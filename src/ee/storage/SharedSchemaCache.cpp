@@ -0,0 +1,147 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "storage/SharedSchemaCache.h"
+#include "common/FatalException.hpp"
+#include "common/TupleSchema.h"
+
+namespace voltdb {
+
+// The process's cache, and how many engines and schema references hold
+// it. Plain data, so nothing here is destroyed at exit.
+static pthread_mutex_t s_processCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static SharedSchemaCache *s_processCache = NULL;
+static int s_processCacheRefcount = 0;
+
+// The column layout as a string, to key the cache on.
+static std::string layoutKey(const std::vector<ValueType> &columnTypes,
+                             const std::vector<int32_t> &columnLengths,
+                             const std::vector<bool> &columnAllowNull) {
+    std::string key;
+    key.reserve(columnTypes.size() * (sizeof(int8_t) + sizeof(int32_t) + sizeof(int8_t)));
+    for (size_t i = 0; i < columnTypes.size(); ++i) {
+        const int8_t type = static_cast<int8_t>(columnTypes[i]);
+        const int32_t length = columnLengths[i];
+        const int8_t allowNull = columnAllowNull[i] ? 1 : 0;
+        key.append(reinterpret_cast<const char*>(&type), sizeof(type));
+        key.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        key.append(reinterpret_cast<const char*>(&allowNull), sizeof(allowNull));
+    }
+    return key;
+}
+
+SharedSchemaCache& SharedSchemaCache::instance() {
+    pthread_mutex_lock(&s_processCacheMutex);
+    SharedSchemaCache *cache = s_processCache;
+    pthread_mutex_unlock(&s_processCacheMutex);
+    if (cache == NULL) {
+        throwFatalException("The shared schema cache was used with no engine attached");
+    }
+    return *cache;
+}
+
+void SharedSchemaCache::attachEngine() {
+    holdProcessCache();
+}
+
+void SharedSchemaCache::detachEngine() {
+    dropProcessCache();
+}
+
+void SharedSchemaCache::holdProcessCache() {
+    pthread_mutex_lock(&s_processCacheMutex);
+    if (s_processCache == NULL) {
+        s_processCache = new SharedSchemaCache();
+        s_processCache->m_processWide = true;
+    }
+    ++s_processCacheRefcount;
+    pthread_mutex_unlock(&s_processCacheMutex);
+}
+
+void SharedSchemaCache::dropProcessCache() {
+    pthread_mutex_lock(&s_processCacheMutex);
+    assert(s_processCache != NULL && s_processCacheRefcount > 0);
+    SharedSchemaCache *unused = NULL;
+    if (--s_processCacheRefcount == 0) {
+        unused = s_processCache;
+        s_processCache = NULL;
+    }
+    pthread_mutex_unlock(&s_processCacheMutex);
+    delete unused;
+}
+
+SharedSchemaCache::SharedSchemaCache() : m_processWide(false) {
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+SharedSchemaCache::~SharedSchemaCache() {
+    for (std::map<std::string, Entry>::iterator it = m_schemas.begin(); it != m_schemas.end(); ++it) {
+        TupleSchema::freeTupleSchema(it->second.schema);
+    }
+    pthread_mutex_destroy(&m_mutex);
+}
+
+TupleSchema* SharedSchemaCache::acquire(const std::vector<ValueType> &columnTypes,
+                                        const std::vector<int32_t> &columnLengths,
+                                        const std::vector<bool> &columnAllowNull) {
+    const std::string key = layoutKey(columnTypes, columnLengths, columnAllowNull);
+    pthread_mutex_lock(&m_mutex);
+    Entry &entry = m_schemas[key];
+    if (entry.schema == NULL) {
+        entry.schema = TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                                      columnAllowNull, true);
+        m_layouts[entry.schema] = key;
+    }
+    ++entry.refcount;
+    TupleSchema *schema = entry.schema;
+    pthread_mutex_unlock(&m_mutex);
+    if (m_processWide) {
+        // the schema holds the cache until it is released
+        holdProcessCache();
+    }
+    return schema;
+}
+
+void SharedSchemaCache::release(const TupleSchema *schema) {
+    pthread_mutex_lock(&m_mutex);
+    std::map<const TupleSchema*, std::string>::iterator layout = m_layouts.find(schema);
+    if (layout == m_layouts.end()) {
+        pthread_mutex_unlock(&m_mutex);
+        throwFatalException("Released a schema that is not in the shared schema cache");
+    }
+    std::map<std::string, Entry>::iterator entry = m_schemas.find(layout->second);
+    assert(entry != m_schemas.end());
+    if (--entry->second.refcount == 0) {
+        TupleSchema::freeTupleSchema(entry->second.schema);
+        m_schemas.erase(entry);
+        m_layouts.erase(layout);
+    }
+    pthread_mutex_unlock(&m_mutex);
+    if (m_processWide) {
+        // may delete this cache, so last
+        dropProcessCache();
+    }
+}
+
+size_t SharedSchemaCache::size() {
+    pthread_mutex_lock(&m_mutex);
+    size_t size = m_schemas.size();
+    pthread_mutex_unlock(&m_mutex);
+    return size;
+}
+
+}
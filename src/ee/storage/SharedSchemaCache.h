@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDSCHEMACACHE_H_
+#define SHAREDSCHEMACACHE_H_
+
+#include <pthread.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "common/types.h"
+
+namespace voltdb {
+class TupleSchema;
+
+/**
+ * The TupleSchemas of the persistent tables, shared by all the engines
+ * (sites) of a process. Every site loads the same catalog, so without
+ * sharing each host holds one identical schema per table per site.
+ *
+ * Schemas are immutable once created and are looked up by their column
+ * layout. Each one is reference counted, under the cache mutex, by the
+ * tables using it and freed when the last of them releases it.
+ *
+ * The process's cache is created by the first engine to attach to it and
+ * deleted once every engine has detached and every schema acquired from
+ * it has been released, so that it never goes away, as a static would at
+ * exit, under an engine still holding its schemas.
+ */
+class SharedSchemaCache {
+public:
+    /**
+     * The cache shared by every engine in this process. Only to be used
+     * while an engine is attached or a schema from it is held.
+     */
+    static SharedSchemaCache& instance();
+
+    /** Count an engine using the process's cache, creating it for the first. */
+    static void attachEngine();
+
+    /** Stop counting an engine, deleting the cache if nothing holds it. */
+    static void detachEngine();
+
+    SharedSchemaCache();
+    ~SharedSchemaCache();
+
+    /**
+     * Return the schema with this column layout, creating it if no table
+     * uses one yet. Each call must be paired with a release.
+     */
+    TupleSchema* acquire(const std::vector<ValueType> &columnTypes,
+                         const std::vector<int32_t> &columnLengths,
+                         const std::vector<bool> &columnAllowNull);
+
+    /** Drop a reference to a schema returned by acquire. */
+    void release(const TupleSchema *schema);
+
+    /** Number of distinct schemas in use */
+    size_t size();
+
+private:
+    static void holdProcessCache();
+    static void dropProcessCache();
+
+    struct Entry {
+        Entry() : schema(NULL), refcount(0) {}
+        TupleSchema *schema;
+        int refcount;
+    };
+
+    std::map<std::string, Entry> m_schemas;
+    std::map<const TupleSchema*, std::string> m_layouts;
+    pthread_mutex_t m_mutex;
+    // set for the process's cache, which each schema reference holds too
+    bool m_processWide;
+};
+
+}
+
+#endif // SHAREDSCHEMACACHE_H_
@@ -33,9 +33,11 @@
 #include "storage/constraintutil.h"
 #include "storage/MaterializedViewMetadata.h"
 #include "storage/persistenttable.h"
+#include "storage/SharedSchemaCache.h"
 #include "storage/StreamBlock.h"
 #include "storage/table.h"
 #include "storage/tablefactory.h"
+#include "storage/TupleMigration.h"
 
 #include <boost/foreach.hpp>
 
@@ -46,28 +48,32 @@ using namespace std;
 namespace voltdb {
 
 TableCatalogDelegate::TableCatalogDelegate(int32_t catalogId, string path, string signature) :
-    CatalogDelegate(catalogId, path), m_table(NULL), m_exportEnabled(false),
+    CatalogDelegate(catalogId, path), m_table(NULL), m_migration(), m_exportEnabled(false),
     m_signature(signature)
 {
 }
 
 TableCatalogDelegate::~TableCatalogDelegate()
 {
+    dropMigration();
     if (m_table) {
         m_table->decrementRefcount();
     }
 }
 
-TupleSchema *TableCatalogDelegate::createTupleSchema(catalog::Table const &catalogTable) {
+// The column layout of a catalog table, in column order.
+static void getColumnLayout(catalog::Table const &catalogTable,
+                            vector<ValueType> &columnTypes,
+                            vector<int32_t> &columnLengths,
+                            vector<bool> &columnAllowNull) {
     // Columns:
     // Column is stored as map<String, Column*> in Catalog. We have to
     // sort it by Column index to preserve column order.
     const int numColumns = static_cast<int>(catalogTable.columns().size());
-    vector<ValueType> columnTypes(numColumns);
-    vector<int32_t> columnLengths(numColumns);
-    vector<bool> columnAllowNull(numColumns);
+    columnTypes.resize(numColumns);
+    columnLengths.resize(numColumns);
+    columnAllowNull.resize(numColumns);
     map<string, catalog::Column*>::const_iterator col_iterator;
-    vector<string> columnNames(numColumns);
     for (col_iterator = catalogTable.columns().begin();
          col_iterator != catalogTable.columns().end(); col_iterator++) {
         const catalog::Column *catalog_column = col_iterator->second;
@@ -81,10 +87,14 @@ TupleSchema *TableCatalogDelegate::createTupleSchema(catalog::Table const &catal
         columnLengths[columnIndex] = length;
         columnAllowNull[columnIndex] = catalog_column->nullable();
     }
+}
 
-    return TupleSchema::createTupleSchema(columnTypes,
-                                          columnLengths,
-                                          columnAllowNull, true);
+TupleSchema *TableCatalogDelegate::acquireSharedTupleSchema(catalog::Table const &catalogTable) {
+    vector<ValueType> columnTypes;
+    vector<int32_t> columnLengths;
+    vector<bool> columnAllowNull;
+    getColumnLayout(catalogTable, columnTypes, columnLengths, columnAllowNull);
+    return SharedSchemaCache::instance().acquire(columnTypes, columnLengths, columnAllowNull);
 }
 
 bool TableCatalogDelegate::getIndexScheme(catalog::Table const &catalogTable,
@@ -251,8 +261,8 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
         columnNames[catalog_column->index()] = catalog_column->name();
     }
 
-    // get the schema for the table
-    TupleSchema *schema = createTupleSchema(catalogTable);
+    // get the schema for the table, shared with the other sites
+    TupleSchema *schema = acquireSharedTupleSchema(catalogTable);
 
     // Indexes
     map<string, TableIndexScheme> index_map;
@@ -286,6 +296,7 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
                                constraintutil::getTypeName(type).c_str(),
                                catalog_constraint->name().c_str(),
                                catalogTable.name().c_str());
+                    SharedSchemaCache::instance().release(schema);
                     return NULL;
                 }
                 // Make sure they didn't declare more than one primary key index
@@ -296,6 +307,7 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
                                catalogTable.name().c_str(),
                                catalog_constraint->index()->name().c_str(),
                                pkey_index_id.c_str());
+                    SharedSchemaCache::instance().release(schema);
                     return NULL;
                 }
                 pkey_index_id = catalog_constraint->index()->name();
@@ -311,6 +323,7 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
                                constraintutil::getTypeName(type).c_str(),
                                catalog_constraint->name().c_str(),
                                catalogTable.name().c_str());
+                    SharedSchemaCache::instance().release(schema);
                     return NULL;
                 }
                 break;
@@ -327,6 +340,7 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
                 VOLT_ERROR("Invalid constraint type '%s' for '%s'",
                            constraintutil::getTypeName(type).c_str(),
                            catalog_constraint->name().c_str());
+                SharedSchemaCache::instance().release(schema);
                 return NULL;
         }
     }
@@ -360,7 +374,7 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
     Table *table = TableFactory::getPersistentTable(databaseId, tableName,
                                                     schema, columnNames,
                                                     partitionColumnIndex, exportEnabled,
-                                                    tableIsExportOnly);
+                                                    tableIsExportOnly, 0, true);
 
     // add a pkey index if one exists
     if (pkey_index_id.size() != 0) {
@@ -377,6 +391,13 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
         table->addIndex(index);
     }
 
+    // rows expire after their time to live, if the table has one
+    PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(table);
+    const catalog::Column* ttlColumn = catalogTable.ttlcolumn();
+    if (persistentTable != NULL && ttlColumn != NULL) {
+        persistentTable->setTimeToLive(ttlColumn->index(), catalogTable.ttlseconds());
+    }
+
     return table;
 }
 
@@ -450,10 +471,11 @@ void migrateViews(const catalog::CatalogMap<catalog::MaterializedViewInfo> & vie
 }
 
 
-void
+bool
 TableCatalogDelegate::processSchemaChanges(catalog::Database const &catalogDatabase,
                                            catalog::Table const &catalogTable,
-                                           std::map<std::string, CatalogDelegate*> const &delegatesByName)
+                                           std::map<std::string, CatalogDelegate*> const &delegatesByName,
+                                           bool allowOnline)
 {
     ///////////////////////////////////////////////
     // Create a new table so two tables exist
@@ -464,17 +486,43 @@ TableCatalogDelegate::processSchemaChanges(catalog::Database const &catalogDatab
     assert(newTable);
     PersistentTable *existingTable = dynamic_cast<PersistentTable*>(m_table);
 
-    ///////////////////////////////////////////////
-    // Move tuples from one table to the other
-    ///////////////////////////////////////////////
-    migrateChangedTuples(catalogTable, existingTable, newTable);
+    // Views have to move over together with the tuples they summarize, so
+    // tables involved in any move their tuples right away. So do tables
+    // whose tuples change layout or that change indexes, which lookups on
+    // the new table could not find in the old one (see TupleMigration).
+    bool online = allowOnline &&
+        catalogTable.views().size() == 0 &&
+        catalogTable.materializer() == NULL &&
+        existingTable->activeTupleCount() > 0;
+
+    if (online) {
+        m_migration.reset(new TupleMigration(catalogTable, existingTable, newTable, true));
+        online = m_migration->isIncremental();
+        if (!online) {
+            m_migration.reset();
+        }
+    }
 
-    migrateViews(catalogTable.views(), existingTable, newTable, delegatesByName);
+    if (online) {
+        ///////////////////////////////////////////////
+        // Keep the old table, with its reference, for
+        // the tuples still to move
+        ///////////////////////////////////////////////
+        m_table = NULL;
+    }
+    else {
+        ///////////////////////////////////////////////
+        // Move tuples from one table to the other
+        ///////////////////////////////////////////////
+        migrateChangedTuples(catalogTable, existingTable, newTable);
 
-    ///////////////////////////////////////////////
-    // Drop the old table
-    ///////////////////////////////////////////////
-    deleteCommand();
+        migrateViews(catalogTable.views(), existingTable, newTable, delegatesByName);
+
+        ///////////////////////////////////////////////
+        // Drop the old table
+        ///////////////////////////////////////////////
+        deleteCommand();
+    }
 
     ///////////////////////////////////////////////
     // Patch up the new table as a replacement
@@ -484,6 +532,29 @@ TableCatalogDelegate::processSchemaChanges(catalog::Database const &catalogDatab
     newTable->configureIndexStats(catalogDatabase.relativeIndex());
     newTable->incrementRefcount();
     m_table = newTable;
+    return online;
+}
+
+bool
+TableCatalogDelegate::migrateSchemaChange(int64_t maxBlocks)
+{
+    if (!m_migration) {
+        return true;
+    }
+    if (!m_migration->migrate(maxBlocks)) {
+        return false;
+    }
+    dropMigration();
+    return true;
+}
+
+void
+TableCatalogDelegate::dropMigration()
+{
+    if (m_migration) {
+        m_migration->existingTable()->decrementRefcount();
+        m_migration.reset();
+    }
 }
 
 void
@@ -493,136 +564,20 @@ TableCatalogDelegate::migrateChangedTuples(catalog::Table const &catalogTable,
 {
     int64_t existingTupleCount = existingTable->activeTupleCount();
 
-    // remove all indexes from the existing table
-    const vector<TableIndex*> currentIndexes = existingTable->allIndexes();
-    for (int i = 0; i < currentIndexes.size(); i++) {
-        existingTable->removeIndex(currentIndexes[i]);
-    }
-
-    // All the (surviving) materialized views depending on the existing table will need to be "transfered"
-    // to the new table -- BUT there's no rush.
-    // The "deleteTupleForSchemaChange" variant of deleteTuple used here on the existing table
-    // leaves any dependent materialized view tables untouched/intact
-    // (technically, temporarily out of synch with the shrinking table).
-    // But the normal "insertPersistentTuple" used here on the new table tries to populate any dependent
-    // serialized views.
-    // Rather than empty the surviving view tables, and transfer them to the new table to be re-populated "retail",
-    // transfer them "wholesale" post-migration.
-
-    // figure out what goes in each columns of the new table
-
-    // set default values once in the temp tuple
-    int columnCount = newTable->columnCount();
-
-    // default values
-    boost::scoped_array<NValue> defaults_array(new NValue[columnCount]);
-    NValue *defaults = defaults_array.get();
-
-    // map from existing table
-    int columnSourceMap[columnCount];
-
-    // Indicator that object allocation is required in the column assignment,
-    // to cover an explosion from an inline-sized to an out-of-line-sized string.
-    bool columnExploded[columnCount];
-
-    vector<std::string> oldColumnNames = existingTable->getColumnNames();
-
-    catalog::CatalogMap<catalog::Column>::field_map_iter colIter;
-    for (colIter = catalogTable.columns().begin();
-         colIter != catalogTable.columns().end();
-         colIter++)
-    {
-        std::string colName = colIter->second->name();
-        catalog::Column *column = colIter->second;
-        int newIndex = column->index();
-
-        // assign a default value, if one exists
-        ValueType defaultColType = static_cast<ValueType>(column->defaulttype());
-        if (defaultColType == VALUE_TYPE_INVALID) {
-            defaults[newIndex] = ValueFactory::getNullValue();
-        }
-        else {
-            std::string defaultValue = column->defaultvalue();
-            defaults[newIndex] = ValueFactory::nvalueFromSQLDefaultType(defaultColType, defaultValue);
-        }
-
-        // find a source column in the existing table, if one exists
-        columnSourceMap[newIndex] = -1; // -1 is code for not found, use defaults
-        for (int oldIndex = 0; oldIndex < oldColumnNames.size(); oldIndex++) {
-            if (oldColumnNames[oldIndex].compare(colName) == 0) {
-                columnSourceMap[newIndex] = oldIndex;
-                columnExploded[newIndex] = (existingTable->schema()->columnIsInlined(oldIndex) &&
-                                            ! newTable->schema()->columnIsInlined(newIndex));
-                break;
-            }
-        }
-    }
-
-    TableTuple scannedTuple(existingTable->schema());
-
-    int64_t tuplesMigrated = 0;
-
-    // going to run until the source table has no allocated blocks
-    size_t blocksLeft = existingTable->allocatedBlockCount();
-    while (blocksLeft) {
-
-        TableIterator &iterator = existingTable->iterator();
-        TableTuple &tupleToInsert = newTable->tempTuple();
-
-        while (iterator.next(scannedTuple)) {
-
-            //printf("tuple: %s\n", scannedTuple.debug(existingTable->name()).c_str());
-
-            // set the values from the old table or from defaults
-            for (int i = 0; i < columnCount; i++) {
-                if (columnSourceMap[i] >= 0) {
-                    NValue value = scannedTuple.getNValue(columnSourceMap[i]);
-                    if (columnExploded[i]) {
-                        value.allocateObjectFromInlinedValue();
-                    }
-                    tupleToInsert.setNValue(i, value);
-                }
-                else {
-                    tupleToInsert.setNValue(i, defaults[i]);
-                }
-            }
-
-            // insert into the new table
-            newTable->insertPersistentTuple(tupleToInsert, false);
-
-            // delete from the old table
-            existingTable->deleteTupleForSchemaChange(scannedTuple);
-
-            // note one tuple moved
-            ++tuplesMigrated;
-
-            // if a block was just deleted, start the iterator again on the next block
-            // this avoids using the block iterator over a changing set of blocks
-            size_t prevBlocksLeft = blocksLeft;
-            blocksLeft = existingTable->allocatedBlockCount();
-            if (blocksLeft < prevBlocksLeft) {
-                break;
-            }
-        }
-    }
-
-    // release any memory held by the default values --
-    // normally you'd want this in a finally block, but since this code failing
-    // implies serious problems, we'll not worry our pretty little heads
-    for (int i = 0; i < columnCount; i++) {
-        defaults[i].free();
-    }
+    TupleMigration migration(catalogTable, existingTable, newTable, false);
+    migration.migrate(-1);
 
     // check tuple counts are sane
     assert(newTable->activeTupleCount() == existingTupleCount);
     // dumb way to structure an assert avoids unused variable warning (lame)
-    if (tuplesMigrated != existingTupleCount) {
-        assert(tuplesMigrated == existingTupleCount);
+    if (migration.tuplesMigrated() != existingTupleCount) {
+        assert(migration.tuplesMigrated() == existingTupleCount);
     }
 }
 
 void TableCatalogDelegate::deleteCommand()
 {
+    dropMigration();
     if (m_table) {
         m_table->decrementRefcount();
         m_table = NULL;
@@ -23,6 +23,8 @@
 #include "catalog/table.h"
 #include "catalog/index.h"
 
+#include "boost/scoped_ptr.hpp"
+
 namespace catalog {
 class Database;
 }
@@ -32,6 +34,7 @@ class Table;
 class PersistentTable;
 class ExecutorContext;
 class TupleSchema;
+class TupleMigration;
 struct TableIndexScheme;
 
 // There might be a better place for this, but current callers happen to have this header in common.
@@ -62,15 +65,39 @@ class TableCatalogDelegate : public CatalogDelegate {
     int init(catalog::Database const &catalogDatabase,
              catalog::Table const &catalogTable);
 
-    void processSchemaChanges(catalog::Database const &catalogDatabase,
-                             catalog::Table const &catalogTable,
-                             std::map<std::string, CatalogDelegate*> const &tablesByName);
+    /**
+     * Replace the table with one built for the changed catalog schema and
+     * move the tuples over. With allowOnline, a table outside of any
+     * materialized view that only gains columns is replaced right away but
+     * keeps its tuples in the old table, to be moved over by
+     * migrateSchemaChange or by lookups on the new table. Returns true if
+     * there are tuples left to move.
+     */
+    bool processSchemaChanges(catalog::Database const &catalogDatabase,
+                              catalog::Table const &catalogTable,
+                              std::map<std::string, CatalogDelegate*> const &tablesByName,
+                              bool allowOnline = false);
+
+    /**
+     * Move up to maxBlocks blocks of tuples (all if negative) left over by
+     * an online schema change into the new table. Returns true once none
+     * are left.
+     */
+    bool migrateSchemaChange(int64_t maxBlocks);
+
+    bool isMigrating() const {
+        return m_migration.get() != NULL;
+    }
 
     static void migrateChangedTuples(catalog::Table const &catalogTable,
                                      voltdb::PersistentTable* existingTable,
                                      voltdb::PersistentTable* newTable);
 
-    static TupleSchema *createTupleSchema(catalog::Table const &catalogTable);
+    /**
+     * Return the catalog table's schema from the SharedSchemaCache, for a
+     * table made with a shared schema.
+     */
+    static TupleSchema *acquireSharedTupleSchema(catalog::Table const &catalogTable);
 
     static bool getIndexScheme(catalog::Table const &catalogTable,
                                catalog::Index const &catalogIndex,
@@ -101,7 +128,11 @@ class TableCatalogDelegate : public CatalogDelegate {
     static Table *constructTableFromCatalog(catalog::Database const &catalogDatabase,
                                             catalog::Table const &catalogTable);
 
+    void dropMigration();
+
     voltdb::Table *m_table;
+    // the old table and progress of an online schema change
+    boost::scoped_ptr<TupleMigration> m_migration;
     bool m_exportEnabled;
     std::string m_signature;
 };
@@ -0,0 +1,259 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "storage/TableImage.h"
+#include "common/FatalException.hpp"
+#include "common/NValue.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+namespace voltdb {
+
+static const char TABLE_IMAGE_MAGIC[4] = { 'V', 'T', 'I', '2' };
+// written as is, so it reads back differently on a host of the other byte order
+static const uint32_t TABLE_IMAGE_BYTE_ORDER = 0x01020304;
+static const int64_t NULL_OBJECT_OFFSET = -1;
+static const size_t COLUMN_INFO_SIZE = sizeof(int8_t) + sizeof(int32_t) + sizeof(int8_t);
+
+template<typename T> static void appendRaw(std::string &buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendShort(std::string &buffer, int16_t value) {
+    appendRaw<int16_t>(buffer, static_cast<int16_t>(htons(value)));
+}
+
+static void appendInt(std::string &buffer, int32_t value) {
+    appendRaw<int32_t>(buffer, static_cast<int32_t>(htonl(value)));
+}
+
+static void appendLong(std::string &buffer, int64_t value) {
+    appendRaw<int64_t>(buffer, static_cast<int64_t>(htonll(value)));
+}
+
+TableImage::TableImage() :
+    m_mapping(NULL), m_mappingLength(0), m_schema(NULL), m_tuples(NULL),
+    m_objects(NULL), m_objectsLength(0), m_tupleCount(0), m_tupleLength(0)
+{
+}
+
+TableImage::~TableImage() {
+    if (m_mapping != NULL) {
+        ::munmap(const_cast<char*>(m_mapping), m_mappingLength);
+    }
+}
+
+bool TableImage::save(Table &table, CatalogId tableId, const std::string &path) {
+    const TupleSchema *schema = table.schema();
+    const int32_t tupleLength = static_cast<int32_t>(schema->tupleLength() + TUPLE_HEADER_SIZE);
+    const uint16_t objectColumnCount = schema->getUninlinedObjectColumnCount();
+
+    std::string header(TABLE_IMAGE_MAGIC, sizeof(TABLE_IMAGE_MAGIC));
+    appendRaw<uint32_t>(header, TABLE_IMAGE_BYTE_ORDER);
+    appendInt(header, tableId);
+    appendInt(header, tupleLength);
+    appendShort(header, static_cast<int16_t>(schema->columnCount()));
+    for (int i = 0; i < schema->columnCount(); ++i) {
+        appendRaw<int8_t>(header, static_cast<int8_t>(schema->columnType(i)));
+        appendInt(header, schema->columnLength(i));
+        appendRaw<int8_t>(header, schema->columnIsInlined(i) ? 1 : 0);
+    }
+    // the counts are filled in once the tuples have been written
+    const size_t countsPosition = header.size();
+    appendLong(header, 0);
+    appendLong(header, 0);
+
+    FILE *file = ::fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = ::fwrite(header.data(), 1, header.size(), file) == header.size();
+
+    // The tuples, with each object pointer replaced by the offset the
+    // object will have in the object segment.
+    std::vector<char> image(tupleLength);
+    int64_t tupleCount = 0;
+    int64_t objectsLength = 0;
+    TableTuple tuple(schema);
+    TableIterator &tuples = table.iterator();
+    while (ok && tuples.next(tuple)) {
+        ::memcpy(&image[0], tuple.address(), tupleLength);
+        for (uint16_t i = 0; i < objectColumnCount; ++i) {
+            const int column = schema->getUninlinedObjectColumnInfoIndex(i);
+            const NValue value = tuple.getNValue(column);
+            int64_t offset = htonll(NULL_OBJECT_OFFSET);
+            if (!value.isNull()) {
+                offset = htonll(objectsLength);
+                objectsLength += sizeof(int32_t) + ValuePeeker::peekObjectLength(value);
+            }
+            ::memcpy(&image[TUPLE_HEADER_SIZE + schema->columnOffset(column)], &offset, sizeof(offset));
+        }
+        ok = ::fwrite(&image[0], 1, tupleLength, file) == static_cast<size_t>(tupleLength);
+        ++tupleCount;
+    }
+
+    // The objects, in the same order.
+    if (objectColumnCount != 0) {
+        TableIterator &objects = table.iterator();
+        while (ok && objects.next(tuple)) {
+            for (uint16_t i = 0; ok && i < objectColumnCount; ++i) {
+                const NValue value = tuple.getNValue(schema->getUninlinedObjectColumnInfoIndex(i));
+                if (value.isNull()) {
+                    continue;
+                }
+                const int32_t length = ValuePeeker::peekObjectLength(value);
+                const int32_t networkLength = htonl(length);
+                ok = ::fwrite(&networkLength, 1, sizeof(networkLength), file) == sizeof(networkLength) &&
+                     ::fwrite(ValuePeeker::peekObjectValue(value), 1, length, file) == static_cast<size_t>(length);
+            }
+        }
+    }
+
+    if (ok) {
+        std::string counts;
+        appendLong(counts, tupleCount);
+        appendLong(counts, objectsLength);
+        ok = ::fseek(file, static_cast<long>(countsPosition), SEEK_SET) == 0 &&
+             ::fwrite(counts.data(), 1, counts.size(), file) == counts.size();
+    }
+    return (::fclose(file) == 0) && ok;
+}
+
+bool TableImage::map(const std::string &path) {
+    assert(m_mapping == NULL);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(TABLE_IMAGE_MAGIC))) {
+        ::close(fd);
+        return false;
+    }
+    void *mapping = ::mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+    m_mapping = static_cast<const char*>(mapping);
+    m_mappingLength = status.st_size;
+
+    const char *end = m_mapping + m_mappingLength;
+    const char *cursor = m_mapping;
+    const size_t fixedLength = sizeof(int32_t) * 2 + sizeof(int16_t);
+    if (m_mappingLength < sizeof(TABLE_IMAGE_MAGIC) + sizeof(uint32_t) + fixedLength ||
+        ::memcmp(cursor, TABLE_IMAGE_MAGIC, sizeof(TABLE_IMAGE_MAGIC)) != 0) {
+        return false;
+    }
+    cursor += sizeof(TABLE_IMAGE_MAGIC);
+    uint32_t byteOrder;
+    ::memcpy(&byteOrder, cursor, sizeof(byteOrder));
+    if (byteOrder != TABLE_IMAGE_BYTE_ORDER) {
+        return false;
+    }
+    cursor += sizeof(byteOrder);
+    m_schema = cursor;
+    ReferenceSerializeInput header(cursor, end - cursor);
+    header.readInt();
+    m_tupleLength = header.readInt();
+    const int16_t columnCount = header.readShort();
+    if (columnCount < 0 ||
+        end - m_schema < static_cast<ptrdiff_t>(fixedLength + columnCount * COLUMN_INFO_SIZE + sizeof(int64_t) * 2)) {
+        return false;
+    }
+    header.getRawPointer(columnCount * COLUMN_INFO_SIZE);
+    m_tupleCount = header.readLong();
+    m_objectsLength = header.readLong();
+    cursor = static_cast<const char*>(header.getRawPointer(0));
+    if (m_tupleLength <= 0 || m_tupleCount < 0 || m_objectsLength < 0 ||
+        (end - cursor) != m_tupleCount * m_tupleLength + m_objectsLength) {
+        return false;
+    }
+    m_tuples = cursor;
+    m_objects = cursor + m_tupleCount * m_tupleLength;
+    return true;
+}
+
+CatalogId TableImage::tableId() const {
+    assert(m_schema != NULL);
+    ReferenceSerializeInput header(m_schema, sizeof(int32_t));
+    return header.readInt();
+}
+
+bool TableImage::matches(const TupleSchema *schema) const {
+    assert(m_schema != NULL);
+    ReferenceSerializeInput header(m_schema, m_tuples - m_schema);
+    header.readInt();
+    if (header.readInt() != static_cast<int32_t>(schema->tupleLength() + TUPLE_HEADER_SIZE) ||
+        header.readShort() != schema->columnCount()) {
+        return false;
+    }
+    for (int i = 0; i < schema->columnCount(); ++i) {
+        const int8_t type = header.readByte();
+        const int32_t length = header.readInt();
+        const int8_t inlined = header.readByte();
+        if (type != static_cast<int8_t>(schema->columnType(i)) ||
+            length != schema->columnLength(i) ||
+            (inlined != 0) != schema->columnIsInlined(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t TableImage::tupleCount() const {
+    return m_tupleCount;
+}
+
+void TableImage::copyTuple(int64_t i, TableTuple &target) const {
+    assert(i >= 0 && i < m_tupleCount);
+    const TupleSchema *schema = target.getSchema();
+    char *storage = target.address();
+    ::memcpy(storage, m_tuples + i * m_tupleLength, m_tupleLength);
+    for (uint16_t k = 0; k < schema->getUninlinedObjectColumnCount(); ++k) {
+        const int column = schema->getUninlinedObjectColumnInfoIndex(k);
+        char *slot = storage + TUPLE_HEADER_SIZE + schema->columnOffset(column);
+        int64_t offset;
+        ::memcpy(&offset, slot, sizeof(offset));
+        offset = ntohll(offset);
+        if (offset == NULL_OBJECT_OFFSET) {
+            *reinterpret_cast<void**>(slot) = NULL;
+            continue;
+        }
+        if (offset < 0 || offset > m_objectsLength - static_cast<int64_t>(sizeof(int32_t))) {
+            throwFatalException("Table image object offset %ld is out of range", (long)offset);
+        }
+        ReferenceSerializeInput objects(m_objects + offset, static_cast<size_t>(m_objectsLength - offset));
+        NValue::deserializeFrom(objects, schema->columnType(column), slot, false,
+                                schema->columnLength(column), NULL);
+    }
+}
+
+}
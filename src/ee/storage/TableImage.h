@@ -0,0 +1,102 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TABLEIMAGE_H_
+#define TABLEIMAGE_H_
+
+#include <string>
+#include <stdint.h>
+#include "common/ids.h"
+
+namespace voltdb {
+class Table;
+class TableTuple;
+class TupleSchema;
+
+/**
+ * A table saved to disk in the layout of its tuple blocks, to be mapped
+ * back into memory on restore rather than deserialized value by value.
+ *
+ * Format is:
+ * 4 byte magic "VTI2"
+ * 4 byte byte order mark 0x01020304, in the writer's byte order
+ * 4 byte table id
+ * 4 byte tuple length, header included
+ * 2 byte column count, then per column:
+ *   1 byte type, 4 byte length, 1 byte inlined flag
+ * 8 byte tuple count
+ * 8 byte length of the object segment
+ * <tuple count tuples of tuple length bytes each>
+ * <object segment>
+ *
+ * The tuples are stored exactly as in a tuple block, except that the
+ * pointer of each non-inlined object holds its offset in the object
+ * segment instead, or -1 for NULL. The object segment holds each object
+ * as it is serialized in a table: a 4 byte length followed by its bytes.
+ *
+ * The header fields, object offsets and object lengths are in network
+ * byte order like the rest of VoltDB's serialization. The column values
+ * inside the tuples are copied from memory as they are, so an image
+ * whose byte order mark reads differently is refused.
+ */
+class TableImage {
+public:
+    TableImage();
+    ~TableImage();
+
+    /**
+     * Write the table to path as an image. Return false if the file
+     * could not be written.
+     */
+    static bool save(Table &table, CatalogId tableId, const std::string &path);
+
+    /**
+     * Map the image at path. Return false if it can't be read or is not
+     * a table image.
+     */
+    bool map(const std::string &path);
+
+    CatalogId tableId() const;
+
+    /**
+     * True if the image was saved from a table with this exact layout.
+     */
+    bool matches(const TupleSchema *schema) const;
+
+    int64_t tupleCount() const;
+
+    /**
+     * Copy the ith tuple of the image into target's storage, header
+     * included, and point its non-inlined columns at fresh copies of its
+     * objects.
+     */
+    void copyTuple(int64_t i, TableTuple &target) const;
+
+private:
+    const char *m_mapping;
+    size_t m_mappingLength;
+    const char *m_schema;
+    const char *m_tuples;
+    const char *m_objects;
+    int64_t m_objectsLength;
+    int64_t m_tupleCount;
+    int32_t m_tupleLength;
+};
+
+}
+
+#endif /* TABLEIMAGE_H_ */
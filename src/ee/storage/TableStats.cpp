@@ -36,6 +36,7 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("TUPLE_ALLOCATED_MEMORY");
     columnNames.push_back("TUPLE_DATA_MEMORY");
     columnNames.push_back("STRING_DATA_MEMORY");
+    columnNames.push_back("TUPLES_EXPIRED");
     return columnNames;
 }
 
@@ -50,6 +51,7 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
 }
 
 Table*
@@ -84,7 +86,7 @@ TableStats::generateEmptyTableStatsTable()
 TableStats::TableStats(Table* table)
     : StatsSource(), m_table(table), m_lastTupleCount(0),
       m_lastAllocatedTupleMemory(0), m_lastOccupiedTupleMemory(0),
-      m_lastStringDataMemory(0)
+      m_lastStringDataMemory(0), m_lastExpiredTupleCount(0)
 {
 }
 
@@ -129,6 +131,7 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         occupied_tuple_mem_kb = m_table->occupiedTupleMemory() / 1024;
     }
     int64_t string_data_mem_kb = m_table->nonInlinedMemorySize() / 1024;
+    int64_t expiredTupleCount = m_table->expiredTupleCount();
 
     if (interval()) {
         tupleCount = tupleCount - m_lastTupleCount;
@@ -142,6 +145,8 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         string_data_mem_kb =
             string_data_mem_kb - (m_lastStringDataMemory / 1024);
         m_lastStringDataMemory = m_table->nonInlinedMemorySize();
+        expiredTupleCount = expiredTupleCount - m_lastExpiredTupleCount;
+        m_lastExpiredTupleCount = m_table->expiredTupleCount();
     }
 
     if (string_data_mem_kb > INT32_MAX)
@@ -169,6 +174,8 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["STRING_DATA_MEMORY"],
                       ValueFactory::
                       getIntegerValue(static_cast<int32_t>(string_data_mem_kb)));
+    tuple->setNValue(StatsSource::m_columnName2Index["TUPLES_EXPIRED"],
+                     ValueFactory::getBigIntValue(expiredTupleCount));
 }
 
 /**
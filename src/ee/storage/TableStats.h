@@ -106,6 +106,7 @@ private:
     int64_t m_lastAllocatedTupleMemory;
     int64_t m_lastOccupiedTupleMemory;
     int64_t m_lastStringDataMemory;
+    int64_t m_lastExpiredTupleCount;
 };
 
 }
@@ -108,6 +108,17 @@ namespace voltdb
         {
             return (findStreamContext(streamType) != NULL);
         }
+
+        /**
+         * Return true if managing a stream of any type.
+         */
+        bool hasAnyStream() const
+        {
+            return (hasStreamType(TABLE_STREAM_SNAPSHOT) ||
+                    hasStreamType(TABLE_STREAM_ELASTIC_INDEX) ||
+                    hasStreamType(TABLE_STREAM_ELASTIC_INDEX_READ) ||
+                    hasStreamType(TABLE_STREAM_RECOVERY));
+        }
     };
 
 } // namespace voltdb
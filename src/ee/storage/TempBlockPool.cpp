@@ -0,0 +1,102 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "storage/TempBlockPool.h"
+
+#include <cassert>
+#include <utility>
+#include <pthread.h>
+
+namespace voltdb {
+
+// This thread's pool and the number of holders keeping it alive
+typedef std::pair<int, TempBlockPool*> HeldPool;
+static pthread_key_t m_poolKey;
+static pthread_once_t m_poolKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createPoolKey() {
+    (void)pthread_key_create(&m_poolKey, NULL);
+}
+
+TempBlockPoolHolder::TempBlockPoolHolder() {
+    (void)pthread_once(&m_poolKeyOnce, createPoolKey);
+    HeldPool *held = static_cast<HeldPool*>(pthread_getspecific(m_poolKey));
+    if (held == NULL) {
+        held = new HeldPool(0, new TempBlockPool(TEMP_TABLE_BLOCK_SIZE, DEFAULT_TEMP_BLOCK_POOL_SIZE));
+        pthread_setspecific(m_poolKey, held);
+    }
+    ++held->first;
+}
+
+TempBlockPoolHolder::~TempBlockPoolHolder() {
+    HeldPool *held = static_cast<HeldPool*>(pthread_getspecific(m_poolKey));
+    assert(held != NULL);
+    if (--held->first == 0) {
+        pthread_setspecific(m_poolKey, NULL);
+        delete held->second;
+        delete held;
+    }
+}
+
+TempBlockPool* TempBlockPool::forThisThread() {
+    (void)pthread_once(&m_poolKeyOnce, createPoolKey);
+    HeldPool *held = static_cast<HeldPool*>(pthread_getspecific(m_poolKey));
+    return held == NULL ? NULL : held->second;
+}
+
+TempBlockPool::TempBlockPool(size_t blockSize, int64_t highWaterMark) :
+    m_blockSize(blockSize), m_maxBlocks(0)
+{
+    setHighWaterMark(highWaterMark);
+}
+
+TempBlockPool::~TempBlockPool() {
+    setHighWaterMark(0);
+}
+
+char* TempBlockPool::acquire() {
+    if (m_blocks.empty()) {
+        return new char[m_blockSize];
+    }
+    char *storage = m_blocks.back();
+    m_blocks.pop_back();
+    return storage;
+}
+
+void TempBlockPool::release(char *storage) {
+    if (m_blocks.size() < m_maxBlocks) {
+        m_blocks.push_back(storage);
+    }
+    else {
+        delete [] storage;
+    }
+}
+
+void TempBlockPool::setHighWaterMark(int64_t bytes) {
+    m_maxBlocks = bytes > 0 ? static_cast<size_t>(bytes) / m_blockSize : 0;
+    trim(bytes);
+}
+
+void TempBlockPool::trim(int64_t bytes) {
+    const size_t keep = bytes > 0 ? static_cast<size_t>(bytes) / m_blockSize : 0;
+    while (m_blocks.size() > keep) {
+        delete [] m_blocks.back();
+        m_blocks.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEMPBLOCKPOOL_H_
+#define TEMPBLOCKPOOL_H_
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace voltdb {
+
+// Target size of a temp table block
+const int TEMP_TABLE_BLOCK_SIZE = 131072;
+// Default limit on the storage a site keeps for reuse
+const int64_t DEFAULT_TEMP_BLOCK_POOL_SIZE = 64 * TEMP_TABLE_BLOCK_SIZE;
+
+/**
+ * Storage of the temp table blocks freed on a site, kept for the temp
+ * tables of the next fragments rather than freed and allocated (and page
+ * faulted in) again for every query. There is one per thread while a
+ * TempBlockPoolHolder is alive there, see forThisThread.
+ *
+ * Only blocks of the pool's block size are kept, and only up to the high
+ * water mark. A temp table is charged in its TempTableLimits for each
+ * block it takes, from the pool or not. The blocks still in the pool
+ * count against the memory limit as well, and are freed before a
+ * fragment is refused memory on their account.
+ */
+class TempBlockPool {
+public:
+    TempBlockPool(size_t blockSize, int64_t highWaterMark);
+    ~TempBlockPool();
+
+    /** This thread's pool, or NULL if it has none */
+    static TempBlockPool* forThisThread();
+
+    size_t blockSize() const {
+        return m_blockSize;
+    }
+
+    /** Return storage for a block, reusing a pooled one if there is one */
+    char* acquire();
+
+    /** Keep the storage of a block for reuse, or free it if the pool is full */
+    void release(char *storage);
+
+    /** Set the most bytes of storage to keep, freeing any over it */
+    void setHighWaterMark(int64_t bytes);
+
+    /** Free pooled storage until at most bytes of it are left */
+    void trim(int64_t bytes);
+
+    int64_t highWaterMark() const {
+        return static_cast<int64_t>(m_maxBlocks * m_blockSize);
+    }
+
+    size_t pooledBlockCount() const {
+        return m_blocks.size();
+    }
+
+    int64_t pooledBytes() const {
+        return static_cast<int64_t>(m_blocks.size() * m_blockSize);
+    }
+
+private:
+    std::vector<char*> m_blocks;
+    const size_t m_blockSize;
+    size_t m_maxBlocks;
+};
+
+/**
+ * Gives the thread a TempBlockPool for as long as it is alive. As with
+ * ThreadLocalPool, holders on one thread are reference counted and share
+ * one pool, which goes with the last of them.
+ */
+class TempBlockPoolHolder {
+public:
+    TempBlockPoolHolder();
+    ~TempBlockPoolHolder();
+};
+
+}
+
+#endif /* TEMPBLOCKPOOL_H_ */
@@ -18,6 +18,7 @@
 #include "TempTableLimits.h"
 
 #include "common/SQLException.h"
+#include "storage/TempBlockPool.h"
 #include "logging/LogManager.h"
 
 #include <cstdio>
@@ -28,6 +29,7 @@ TempTableLimits::TempTableLimits()
     : m_currMemoryInBytes(0),
       m_logThreshold(-1),
       m_memoryLimit(1024 * 1024 * 100),
+      m_spillThreshold(-1),
       m_logLatch(false)
 {
 }
@@ -46,6 +48,14 @@ void
 TempTableLimits::increaseAllocated(int bytes)
 {
     m_currMemoryInBytes += bytes;
+    // The site's pooled temp block storage counts against the limit
+    // too, but is given up before the fragment is.
+    TempBlockPool *pool = TempBlockPool::forThisThread();
+    if (m_memoryLimit > 0 && pool != NULL &&
+        m_currMemoryInBytes + pool->pooledBytes() > m_memoryLimit)
+    {
+        pool->trim(m_memoryLimit - m_currMemoryInBytes);
+    }
     if (m_memoryLimit > 0 &&
         m_currMemoryInBytes > m_memoryLimit)
     {
@@ -99,3 +109,15 @@ TempTableLimits::getMemoryLimit() const
 {
     return m_memoryLimit;
 }
+
+void
+TempTableLimits::setSpillThreshold(int64_t threshold)
+{
+    m_spillThreshold = threshold;
+}
+
+int64_t
+TempTableLimits::getSpillThreshold() const
+{
+    return m_spillThreshold;
+}
@@ -36,7 +36,9 @@ namespace voltdb
          * Increase the amount of memory accumulated in temp tables.
          * Will log once at INFO level to the SQL instance if the log
          * threshold is set and it is crossed.  Will throw a
-         * SQLException when the memory limit is exceeded.
+         * SQLException when the memory limit is exceeded.  Storage
+         * held in the site's TempBlockPool counts against the limit
+         * as well, and is freed first to stay under it.
          */
         void increaseAllocated(int bytes);
         void reduceAllocated(int bytes);
@@ -46,6 +48,17 @@ namespace voltdb
         int64_t getLogThreshold() const;
         void setMemoryLimit(int64_t limit);
         int64_t getMemoryLimit() const;
+        void setSpillThreshold(int64_t threshold);
+        int64_t getSpillThreshold() const;
+
+        /**
+         * True if executors that can spill to disk should spill an
+         * input of this many bytes rather than work on it in memory.
+         */
+        bool shouldSpill(int64_t bytes) const
+        {
+            return m_spillThreshold >= 0 && bytes > m_spillThreshold;
+        }
 
     private:
         // The current amount of memory used by temp tables for this
@@ -58,6 +71,11 @@ namespace voltdb
         // and the execution aborted.  A negative value will disable
         // this behavior.
         int64_t m_memoryLimit;
+        // The input size above which executors that are able to spill
+        // to disk (ORDER BY and hash aggregation) do so, to keep their
+        // temp tables under the memory limit.  A negative value will
+        // disable spilling.
+        int64_t m_spillThreshold;
         // True if we have already generated a log message for
         // exceeding the log threshold and not yet dropped below it.
         bool m_logLatch;
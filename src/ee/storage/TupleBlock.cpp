@@ -18,13 +18,61 @@
 #include "storage/table.h"
 #include <sys/mman.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "common/FatalException.hpp"
 #include "common/ThreadLocalPool.h"
+#include "storage/TempBlockPool.h"
 
 namespace voltdb {
 
 volatile int tupleBlocksAllocated = 0;
 
-TupleBlock::TupleBlock(Table *table, TBBucketPtr bucket) :
+/*
+ * Storage of size bytes starting on a multiple of alignment, a power of
+ * two at least as large as size.
+ */
+static char* allocateAlignedStorage(size_t size, size_t alignment) {
+#ifdef USE_MMAP
+    // Map enough to find an aligned start, then unmap what is around it.
+    char *mapping = static_cast<char*>(::mmap(0, size + alignment, PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANON, -1, 0));
+    if (mapping == MAP_FAILED) {
+        std::cout << strerror( errno ) << std::endl;
+        throwFatalException("Failed mmap");
+    }
+    char *storage = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(mapping) + alignment - 1) & ~(alignment - 1));
+    if (storage != mapping) {
+        ::munmap(mapping, storage - mapping);
+    }
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t mapped = (size + pageSize - 1) & ~(pageSize - 1);
+    if (mapping + size + alignment != storage + mapped) {
+        ::munmap(storage + mapped, (mapping + size + alignment) - (storage + mapped));
+    }
+    return storage;
+#else
+    void *storage = NULL;
+    if (::posix_memalign(&storage, alignment, size) != 0) {
+        throwFatalException("Failed to allocate %ld bytes of tuple block storage", (long)size);
+    }
+    return static_cast<char*>(storage);
+#endif
+}
+
+static void freeAlignedStorage(char *storage, size_t size) {
+#ifdef USE_MMAP
+    if (::munmap(storage, size) != 0) {
+        std::cout << strerror( errno ) << std::endl;
+        throwFatalException("Failed munmap");
+    }
+#else
+    ::free(storage);
+#endif
+}
+
+TupleBlock::TupleBlock(Table *table, TBBucketPtr bucket, bool pooledStorage) :
 #ifdef MEMCHECK
         m_table(table),
 #endif
@@ -37,22 +85,26 @@ TupleBlock::TupleBlock(Table *table, TBBucketPtr bucket) :
         m_lastCompactionOffset(0),
         m_tuplesPerBlockDivNumBuckets(m_tuplesPerBlock / static_cast<double>(TUPLE_BLOCK_NUM_BUCKETS)),
         m_bucket(bucket),
-        m_bucketIndex(0)
+        m_bucketIndex(0),
+        m_pooledStorage(false),
+        m_storageSize(0)
 {
-#ifdef MEMCHECK
-    m_storage = new char[table->m_tableAllocationSize];
-#else
-#ifdef USE_MMAP
-    m_storage = static_cast<char*>(::mmap( 0, table->m_tableAllocationSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0 ));
-    if (m_storage == MAP_FAILED) {
-        std::cout << strerror( errno ) << std::endl;
-        throwFatalException("Failed mmap");
+#ifndef MEMCHECK
+    if (pooledStorage) {
+        TempBlockPool *pool = TempBlockPool::forThisThread();
+        if (pool != NULL && pool->blockSize() == static_cast<size_t>(table->m_tableAllocationSize)) {
+            m_storage = pool->acquire();
+            m_pooledStorage = true;
+        }
     }
-#else
-    //m_storage = static_cast<char*>(ThreadLocalPool::getExact(m_table->m_tableAllocationSize)->malloc());
-    m_storage = new char[table->m_tableAllocationSize];
-#endif
 #endif
+    if (!m_pooledStorage) {
+        // The header lets containing() find this block from any of its tuples.
+        m_storageSize = table->m_tableAllocationSize;
+        char *header = allocateAlignedStorage(m_storageSize, storageAlignment(table->m_tableAllocationSize));
+        *reinterpret_cast<TupleBlock**>(header) = this;
+        m_storage = header + TUPLE_BLOCK_HEADER_SIZE;
+    }
     tupleBlocksAllocated++;
 }
 
@@ -62,18 +114,20 @@ TupleBlock::~TupleBlock() {
       std::cout << "Destructing tuple block " << static_cast<void*>(this)
                 << " with " << tupleBlocksAllocated << " left " << std::endl;
     */
-#ifdef MEMCHECK
-    delete []m_storage;
-#else
-#ifdef USE_MMAP
-    if (::munmap( m_storage, m_table->m_tableAllocationSize) != 0) {
-        std::cout << strerror( errno ) << std::endl;
-        throwFatalException("Failed munmap");
+    if (m_bucket != NULL) {
+        m_bucket->erase(this);
     }
-#else
-    delete []m_storage;
-#endif
-#endif
+    if (m_pooledStorage) {
+        // the pool is gone if the thread's last TempBlockPoolHolder is
+        TempBlockPool *pool = TempBlockPool::forThisThread();
+        if (pool != NULL) {
+            pool->release(m_storage);
+        } else {
+            delete []m_storage;
+        }
+        return;
+    }
+    freeAlignedStorage(m_storage - TUPLE_BLOCK_HEADER_SIZE, m_storageSize);
 }
 
 std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementListener *listener) {
@@ -30,6 +30,7 @@
 #include <math.h>
 #include <iostream>
 #include "boost_ext/FastAllocator.hpp"
+#include "common/Pool.hpp"
 #include "common/ThreadLocalPool.h"
 #include "common/tabletuple.h"
 #include <deque>
@@ -78,17 +79,51 @@ typedef boost::intrusive_ptr<TupleBlock> TBPtr;
 //typedef TupleBlock* TBPtr;
 typedef stx::btree_map< char*, TBPtr > TBMap;
 typedef TBMap::iterator TBMapI;
-typedef stx::btree_set<TBPtr> TBBucket;
+// The blocks of a table as seen by a stream, which borrows them from the
+// table rather than holding references
+typedef stx::btree_map< char*, TupleBlock* > TBBorrowedMap;
+typedef TBBorrowedMap::iterator TBBorrowedMapI;
+// Buckets hold the blocks of a table by load without owning them. A
+// block leaves its bucket before the table lets go of it.
+typedef stx::btree_set<TupleBlock*> TBBucket;
 typedef TBBucket::iterator TBBucketI;
 typedef boost::shared_ptr<TBBucket> TBBucketPtr;
 typedef std::vector<TBBucketPtr> TBBucketMap;
 const int TUPLE_BLOCK_NUM_BUCKETS = 20;
+// Bytes of a block's storage in front of its tuples. Unless the storage
+// is pooled, they hold the address of the block itself.
+const int TUPLE_BLOCK_HEADER_SIZE = 64;
 
 class TupleBlock {
     friend void ::intrusive_ptr_add_ref(voltdb::TupleBlock * p);
     friend void ::intrusive_ptr_release(voltdb::TupleBlock * p);
 public:
-    TupleBlock(Table *table, TBBucketPtr bucket);
+    /**
+     * With pooledStorage, the block takes its storage from the thread's
+     * TempBlockPool, and gives it back there when it is destroyed.
+     */
+    TupleBlock(Table *table, TBBucketPtr bucket, bool pooledStorage = false);
+
+    /**
+     * Alignment of the storage of the blocks of a table with the given
+     * allocation size, which is a power of two that has room for the
+     * block header as well as the tuples. Storage that is not pooled is
+     * aligned on its own size, and starts with the header.
+     */
+    static inline size_t storageAlignment(int tableAllocationSize) {
+        assert(tableAllocationSize > 0 && (tableAllocationSize & (tableAllocationSize - 1)) == 0);
+        return static_cast<size_t>(tableAllocationSize);
+    }
+
+    /**
+     * The block holding a tuple, found in constant time by masking the
+     * tuple's address down to the header of its block's storage. Not for
+     * blocks with pooled storage.
+     */
+    static inline TupleBlock* containing(const char *tuple, size_t alignment) {
+        const uintptr_t header = reinterpret_cast<uintptr_t>(tuple) & ~(alignment - 1);
+        return *reinterpret_cast<TupleBlock* const*>(header);
+    }
 
     double loadFactor() {
         return m_activeTuples / m_tuplesPerBlock;
@@ -111,7 +146,7 @@ public:
             //Remove self from current bucket and null out the bucket
             if (m_bucket.get() != NULL) {
                 //std::cout << static_cast<void*>(this) << " is full, erasing from bucket" << std::endl;
-                m_bucket->erase(TBPtr(this));
+                m_bucket->erase(this);
                 m_bucket = TBBucketPtr();
             }
             return -1;
@@ -125,7 +160,7 @@ public:
             if (m_bucket.get() != NULL) {
                 //std::cout << static_cast<void*>(this) << " has only deleted tuples that are pending undo release "
                 //        << tuplesPendingDeleteOnUndoRelease << std::endl;
-                m_bucket->erase(TBPtr(this));
+                m_bucket->erase(this);
                 m_bucket = TBBucketPtr();
             }
             return -1;
@@ -168,11 +203,11 @@ public:
 
     void swapToBucket(TBBucketPtr newBucket) {
         if (m_bucket != NULL) {
-            m_bucket->erase(TBPtr(this));
+            m_bucket->erase(this);
         }
         m_bucket = newBucket;
         if (m_bucket != NULL) {
-            m_bucket->insert(TBPtr(this));
+            m_bucket->insert(this);
         }
     }
 
@@ -246,6 +281,9 @@ private:
 
     TBBucketPtr m_bucket;
     int m_bucketIndex;
+    bool m_pooledStorage;
+    // Bytes of storage, header included, when it is not pooled
+    size_t m_storageSize;
 
 };
 
@@ -0,0 +1,114 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TUPLEMIGRATION_H
+#define TUPLEMIGRATION_H
+
+#include "common/NValue.hpp"
+#include "common/tabletuple.h"
+
+#include "boost/scoped_array.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace catalog {
+class Table;
+}
+
+namespace voltdb {
+class PersistentTable;
+class TableIndex;
+
+/*
+ * Moves the tuples of a table into a new table for a changed schema,
+ * deleting each from the existing table as it goes.
+ *
+ * An incremental migration leaves the tuples in the existing table to be
+ * moved a few blocks at a time, while the new table is already in use.
+ * Whatever looks a tuple up through an index of the new table first moves
+ * the tuples it would find over, using the matching index that the
+ * existing table keeps until it is empty.
+ */
+class TupleMigration {
+  public:
+    /**
+     * With allowIncremental, a change that only appends columns, to a
+     * table whose indexes all stay the same, is set up to run
+     * incrementally and attaches itself to the new table.
+     */
+    TupleMigration(catalog::Table const &catalogTable,
+                   PersistentTable* existingTable,
+                   PersistentTable* newTable,
+                   bool allowIncremental);
+    ~TupleMigration();
+
+    /**
+     * Move up to maxBlocks blocks of tuples, all if negative. Returns true
+     * once none are left.
+     */
+    bool migrate(int64_t maxBlocks);
+
+    /** Move the tuples that match searchKey on the new table's index. */
+    void migrateMatches(const TableIndex *index, const TableTuple &searchKey);
+
+    /**
+     * Move the tuples that a unique index of the new table would find
+     * for tuple, so that inserting or updating to its keys can check them.
+     */
+    void migrateUniqueMatches(const TableTuple &tuple);
+
+    bool isIncremental() const {
+        return m_incremental;
+    }
+
+    int64_t tuplesMigrated() const {
+        return m_tuplesMigrated;
+    }
+
+    PersistentTable *existingTable() const {
+        return m_existingTable;
+    }
+
+  private:
+    void moveTuple(TableTuple &existing);
+    void finishIfEmpty();
+
+    PersistentTable *m_existingTable;
+    PersistentTable *m_newTable;
+    const int m_columnCount;
+    // default values
+    boost::scoped_array<NValue> m_defaults;
+    // a new table tuple holding the defaults of appended columns
+    boost::scoped_array<char> m_defaultsData;
+    TableTuple m_defaultsTuple;
+    // map from existing table
+    boost::scoped_array<int> m_columnSourceMap;
+    boost::scoped_array<bool> m_columnExploded;
+    // set when the change only appends columns, leaving the existing
+    // tuple layout as the leading part of the new one, so each tuple
+    // moves with a single copy of its bytes
+    bool m_appendOnly;
+    bool m_incremental;
+    // each index of the new table with its match on the existing table
+    std::vector<std::pair<const TableIndex*, TableIndex*> > m_indexes;
+    int64_t m_tuplesMigrated;
+};
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "storage/TupleSpill.h"
+#include "common/NValue.hpp"
+#include "common/SQLException.h"
+#include "common/ValuePeeker.hpp"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace voltdb {
+
+const size_t TupleSpill::MAX_FAN;
+
+TupleSpill::TupleSpill(const TupleSchema *schema) :
+    m_schema(schema), m_file(NULL), m_tupleCount(0), m_readCount(0)
+{
+}
+
+TupleSpill::~TupleSpill() {
+    if (m_file != NULL) {
+        ::fclose(m_file);
+    }
+}
+
+void TupleSpill::fail(const char *operation) {
+    char msg[1024];
+    snprintf(msg, sizeof(msg), "Unable to %s the scratch file of a temp table spill: %s",
+             operation, ::strerror(errno));
+    throw SQLException(SQLException::volt_temp_table_memory_overflow, msg);
+}
+
+void TupleSpill::append(const TableTuple &tuple) {
+    assert(m_readCount == 0);
+    size_t length = m_schema->tupleLength();
+    for (uint16_t i = 0; i < m_schema->getUninlinedObjectColumnCount(); ++i) {
+        const NValue value = tuple.getNValue(m_schema->getUninlinedObjectColumnInfoIndex(i));
+        length += sizeof(int32_t);
+        if (!value.isNull()) {
+            length += ValuePeeker::peekObjectLength(value);
+        }
+    }
+    if (m_buffer.size() < length) {
+        m_buffer.resize(length);
+    }
+    if (m_file == NULL) {
+        m_file = ::tmpfile();
+        if (m_file == NULL) {
+            fail("create");
+        }
+    }
+    ReferenceSerializeOutput image(&m_buffer[0], length);
+    tuple.serializeImageTo(image);
+    assert(image.position() == length);
+
+    const int32_t imageLength = static_cast<int32_t>(length);
+    if (::fwrite(&imageLength, 1, sizeof(imageLength), m_file) != sizeof(imageLength) ||
+        ::fwrite(&m_buffer[0], 1, length, m_file) != length) {
+        fail("write");
+    }
+    ++m_tupleCount;
+}
+
+void TupleSpill::rewind() {
+    if (m_file != NULL && (::fflush(m_file) != 0 || ::fseek(m_file, 0, SEEK_SET) != 0)) {
+        fail("rewind");
+    }
+    m_readCount = 0;
+}
+
+bool TupleSpill::next(TableTuple &target, Pool *stringPool) {
+    if (m_readCount == m_tupleCount) {
+        return false;
+    }
+    int32_t length;
+    if (::fread(&length, 1, sizeof(length), m_file) != sizeof(length) || length < 0) {
+        fail("read");
+    }
+    if (m_buffer.size() < static_cast<size_t>(length)) {
+        m_buffer.resize(length);
+    }
+    if (::fread(&m_buffer[0], 1, length, m_file) != static_cast<size_t>(length)) {
+        fail("read");
+    }
+    ReferenceSerializeInput image(&m_buffer[0], length);
+    target.deserializeImageFrom(image, stringPool);
+    target.setActiveTrue();
+    ++m_readCount;
+    return true;
+}
+
+}
@@ -0,0 +1,86 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TUPLESPILL_H_
+#define TUPLESPILL_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+namespace voltdb {
+class Pool;
+class TableTuple;
+class TupleSchema;
+
+/**
+ * A sequence of tuples written out to an anonymous scratch file so that
+ * an executor can put aside more tuples than it may keep in memory, and
+ * read them back in the order they were written. The file is created
+ * with the first tuple, so a spill that stays empty costs no file, and
+ * goes away with the spill.
+ *
+ * Each tuple is stored as a 4 byte length followed by its image (see
+ * TableTuple::serializeImageTo), so the objects of non-inlined columns
+ * are spilled with it.
+ */
+class TupleSpill {
+public:
+    /**
+     * Most spills an executor merges, or splits its input across, in one
+     * pass. Executors with more to spill than that work in passes, so a
+     * fragment keeps only a few scratch files open at a time.
+     */
+    static const size_t MAX_FAN = 16;
+
+    explicit TupleSpill(const TupleSchema *schema);
+    ~TupleSpill();
+
+    /**
+     * Throws a SQLException if the scratch file can't be created or
+     * written.
+     */
+    void append(const TableTuple &tuple);
+
+    /** Finish writing, and start reading from the first tuple */
+    void rewind();
+
+    /**
+     * Read the next tuple into target's storage and mark it active. The
+     * objects of its non-inlined columns are copied into stringPool.
+     * Return false after the last tuple.
+     */
+    bool next(TableTuple &target, Pool *stringPool);
+
+    int64_t tupleCount() const {
+        return m_tupleCount;
+    }
+
+private:
+    void fail(const char *operation);
+
+    const TupleSchema *m_schema;
+    FILE *m_file;
+    std::vector<char> m_buffer;
+    int64_t m_tupleCount;
+    int64_t m_readCount;
+};
+
+}
+
+#endif /* TUPLESPILL_H_ */
@@ -48,6 +48,8 @@
 #include <cstdio>
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/scoped_array.hpp>
+#include <pthread.h>
 #include "storage/persistenttable.h"
 #include "common/debuglog.h"
 #include "common/serializeio.h"
@@ -57,6 +59,8 @@
 #include "common/executorcontext.hpp"
 #include "common/FatalException.hpp"
 #include "common/types.h"
+#include "common/ValuePeeker.hpp"
+#include "common/ValueFactory.hpp"
 #include "common/RecoveryProtoMessage.h"
 #include "common/StreamPredicateList.h"
 #include "indexes/tableindex.h"
@@ -69,13 +73,19 @@
 #include "storage/PersistentTableStats.h"
 #include "storage/PersistentTableUndoInsertAction.h"
 #include "storage/PersistentTableUndoDeleteAction.h"
+#include "storage/PersistentTableUndoDeleteBatchAction.h"
+#include "storage/PersistentTableUndoExpireAction.h"
 #include "storage/PersistentTableUndoUpdateAction.h"
+#include "storage/PersistentTableUndoInPlaceUpdateAction.h"
+#include "storage/PersistentTableUndoTruncateAction.h"
 #include "storage/ConstraintFailureException.h"
 #include "storage/MaterializedViewMetadata.h"
 #include "storage/CopyOnWriteContext.h"
+#include "storage/TableImage.h"
+#include "storage/TupleMigration.h"
 #include "storage/tableiterator.h"
 
-#include <algorithm>    // std::find
+#include <algorithm>    // std::find, std::sort
 
 namespace voltdb {
 
@@ -90,8 +100,13 @@ PersistentTable::PersistentTable(int partitionColumn, int tableAllocationTargetS
     m_allowNulls(),
     m_partitionColumn(partitionColumn),
     stats_(this),
+    m_ttlColumn(-1),
+    m_ttlMicros(0),
+    m_expiredTupleCount(0),
+    m_migration(NULL),
     m_failedCompactionCount(0),
     m_invisibleTuplesPendingDeleteCount(0),
+    m_indexesDeferred(false),
     m_surgeon(*this)
 {
     for (int ii = 0; ii < TUPLE_BLOCK_NUM_BUCKETS; ii++) {
@@ -102,6 +117,9 @@ PersistentTable::PersistentTable(int partitionColumn, int tableAllocationTargetS
 
 PersistentTable::~PersistentTable()
 {
+    // let the streams unpin while the table is still whole
+    m_tableStreamer.reset();
+
     for (int ii = 0; ii < TUPLE_BLOCK_NUM_BUCKETS; ii++) {
         m_blocksNotPendingSnapshotLoad[ii]->clear();
         m_blocksPendingSnapshotLoad[ii]->clear();
@@ -196,13 +214,125 @@ void PersistentTable::nextFreeTuple(TableTuple *tuple) {
 
 void PersistentTable::deleteAllTuples(bool freeAllocatedStrings) {
     // nothing interesting
-    TableIterator ti(this, m_data.begin());
+    TableIterator ti = iteratorDeletingAsWeGo();
     TableTuple tuple(m_schema);
     while (ti.next(tuple)) {
         deleteTuple(tuple, true);
     }
 }
 
+void PersistentTable::truncateTable() {
+    // Anything that has to observe individual deletes forces the slow path:
+    // materialized views, active snapshot/elastic/recovery streams and the
+    // elastic index. Tuples already pinned by undo actions of this transaction
+    // (pending deletes, in-place updates) must also stay in the block map so
+    // those actions can find them.
+    if (!m_views.empty() ||
+        m_tuplesPinnedByUndo != 0 ||
+        m_invisibleTuplesPendingDeleteCount != 0 ||
+        m_surgeon.hasIndex() ||
+        (m_tableStreamer != NULL && m_tableStreamer->hasAnyStream())) {
+        deleteAllTuples(true);
+        return;
+    }
+
+    TBMap detachedBlocks;
+    detachedBlocks.swap(m_data);
+    for (TBMapI i = detachedBlocks.begin(); i != detachedBlocks.end(); ++i) {
+        //Eliminates circular reference
+        i.data()->swapToBucket(TBBucketPtr());
+    }
+    m_blocksNotPendingSnapshot.clear();
+    m_blocksPendingSnapshot.clear();
+    m_blocksWithSpace.clear();
+
+    const uint32_t tupleCount = m_tupleCount;
+    const int64_t nonInlinedMemorySize = m_nonInlinedMemorySize;
+    m_tupleCount = 0;
+    m_nonInlinedMemorySize = 0;
+
+    std::vector<TableIndex*> detachedIndexes;
+    detachedIndexes.reserve(m_indexes.size());
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        detachedIndexes.push_back(index->detachEntries());
+    }
+
+    UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
+    if (uq) {
+        uq->registerUndoAction(new (*uq) PersistentTableUndoTruncateAction(detachedBlocks, detachedIndexes,
+                                                                           tupleCount, nonInlinedMemorySize,
+                                                                           &m_surgeon));
+    } else {
+        truncateTableRelease(detachedBlocks, detachedIndexes);
+    }
+}
+
+/*
+ * Re-attach the blocks and index entries detached by truncateTable.
+ * Everything inserted after the truncate has already been undone, so the
+ * table and its indexes are empty and the detached entries, which still
+ * point at the same tuple addresses, can be swapped straight back.
+ */
+void PersistentTable::truncateTableForUndo(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes,
+                                           uint32_t tupleCount, int64_t nonInlinedMemorySize)
+{
+    assert(m_tupleCount == 0);
+    m_data.swap(detachedBlocks);
+    for (TBMapI i = detachedBlocks.begin(); i != detachedBlocks.end(); ++i) {
+        i.data()->swapToBucket(TBBucketPtr());
+    }
+    m_blocksNotPendingSnapshot.clear();
+    m_blocksWithSpace.clear();
+
+    for (TBMapI i = m_data.begin(); i != m_data.end(); ++i) {
+        TBPtr block = i.data();
+        m_blocksNotPendingSnapshot.insert(block);
+        if (block->hasFreeTuples()) {
+            m_blocksWithSpace.insert(block);
+        }
+        int bucketIndex = block->calculateBucketIndex();
+        if (bucketIndex != -1) {
+            block->swapToBucket(m_blocksNotPendingSnapshotLoad[bucketIndex]);
+        }
+    }
+    m_tupleCount = tupleCount;
+    m_nonInlinedMemorySize = nonInlinedMemorySize;
+
+    assert(detachedIndexes.size() == m_indexes.size());
+    for (size_t i = 0; i < m_indexes.size(); ++i) {
+        m_indexes[i]->reattachEntries(detachedIndexes[i]);
+    }
+    detachedIndexes.clear();
+}
+
+/*
+ * Free the blocks and index entries detached by truncateTable. Only tables
+ * with non-inlined columns need to visit their tuples; otherwise this is
+ * per block.
+ */
+void PersistentTable::truncateTableRelease(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes)
+{
+    BOOST_FOREACH(TableIndex *detached, detachedIndexes) {
+        delete detached;
+    }
+    detachedIndexes.clear();
+
+    if (m_schema->getUninlinedObjectColumnCount() != 0) {
+        TableTuple tuple(m_schema);
+        for (TBMapI i = detachedBlocks.begin(); i != detachedBlocks.end(); ++i) {
+            TBPtr block = i.data();
+            char *dataPtr = block->address();
+            for (uint32_t offset = 0; offset < block->unusedTupleBoundry(); ++offset, dataPtr += m_tupleLength) {
+                tuple.move(dataPtr);
+                if (tuple.isActive()) {
+                    tuple.freeObjectColumns();
+                }
+            }
+        }
+    }
+    detachedBlocks.clear();
+}
+
 void setSearchKeyFromTuple(TableTuple &source) {
     keyTuple.setNValue(0, source.getNValue(1));
     keyTuple.setNValue(1, source.getNValue(2));
@@ -220,6 +350,11 @@ bool PersistentTable::insertTuple(TableTuple &source)
 
 void PersistentTable::insertPersistentTuple(TableTuple &source, bool fallible)
 {
+    // tuples still to move in must be here for the unique checks
+    if (m_migration != NULL) {
+        m_migration->migrateUniqueMatches(source);
+    }
+
     //
     // First get the next free tuple
     // This will either give us one from the free slot list, or
@@ -241,6 +376,30 @@ void PersistentTable::insertPersistentTuple(TableTuple &source, bool fallible)
     }
 }
 
+void PersistentTable::insertTupleForSchemaChange(TableTuple &source, const TableTuple &defaults)
+{
+    assert(source.getSchema()->isLayoutPrefixOf(m_schema));
+    TableTuple target(m_schema);
+    PersistentTable::nextFreeTuple(&target);
+
+    const uint32_t prefixLength = source.getSchema()->tupleLength();
+    ::memcpy(target.address() + TUPLE_HEADER_SIZE,
+             source.address() + TUPLE_HEADER_SIZE, prefixLength);
+    ::memcpy(target.address() + TUPLE_HEADER_SIZE + prefixLength,
+             defaults.address() + TUPLE_HEADER_SIZE + prefixLength,
+             m_schema->tupleLength() - prefixLength);
+
+    // each tuple needs its own copy of an appended column's object
+    for (uint16_t ii = 0; ii < m_schema->getUninlinedObjectColumnCount(); ii++) {
+        const uint16_t column = m_schema->getUninlinedObjectColumnInfoIndex(ii);
+        if (column >= source.sizeInValues()) {
+            target.setNValueAllocateForObjectCopies(column, defaults.getNValue(column), NULL);
+        }
+    }
+
+    insertTupleCommon(source, target, false);
+}
+
 void PersistentTable::insertTupleCommon(TableTuple &source, TableTuple &target, bool fallible)
 {
     if (fallible) {
@@ -338,6 +497,9 @@ bool PersistentTable::updateTupleWithSpecificIndexes(TableTuple &targetTupleToUp
      * Check for index constraint violations.
      */
     if (fallible) {
+        if (m_migration != NULL) {
+            m_migration->migrateUniqueMatches(sourceTupleWithNewValues);
+        }
         if ( ! checkUpdateOnUniqueIndexes(targetTupleToUpdate,
                                           sourceTupleWithNewValues,
                                           indexesToUpdate)) {
@@ -467,6 +629,74 @@ bool PersistentTable::updateTupleWithSpecificIndexes(TableTuple &targetTupleToUp
     return true;
 }
 
+/*
+ * Update that writes the new column values directly into the tuple's block
+ * storage. No index or view maintenance is needed because the caller has
+ * verified that none depends on the updated columns. The tuple stays pinned
+ * (and compaction stays off) until the undo action is undone or released,
+ * so the undo action can address the tuple directly rather than look it up.
+ */
+void PersistentTable::updateTupleInPlace(TableTuple &targetTupleToUpdate,
+                                         const TableTuple &sourceTuple,
+                                         std::vector<std::pair<int, int> > const &sourceToTargetColumns,
+                                         uint32_t undoOffset, uint32_t undoLength)
+{
+    const size_t columnCount = sourceToTargetColumns.size();
+
+    // Null constraint violations must be detected before anything is written.
+    for (size_t i = 0; i < columnCount; ++i) {
+        const int targetColumn = sourceToTargetColumns[i].second;
+        FAIL_IF(!m_allowNulls[targetColumn] &&
+                sourceTuple.getNValue(sourceToTargetColumns[i].first).isNull()) {
+            TableTuple &tempTuple = getTempTupleInlined(targetTupleToUpdate);
+            for (size_t j = 0; j < columnCount; ++j) {
+                tempTuple.setNValue(sourceToTargetColumns[j].second,
+                                    sourceTuple.getNValue(sourceToTargetColumns[j].first));
+            }
+            throw ConstraintFailureException(this, tempTuple, targetTupleToUpdate,
+                                             CONSTRAINT_TYPE_NOT_NULL);
+        }
+    }
+
+    if (m_tableStreamer != NULL) {
+        m_tableStreamer->notifyTupleUpdate(targetTupleToUpdate);
+    }
+
+    UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
+    if (uq) {
+        // Save the "before" image of the changed bytes only. This is done before
+        // any value is written so a failed cast part way through is undoable.
+        char *oldBytes = uq->allocatePooledCopy(targetTupleToUpdate.address() + TUPLE_HEADER_SIZE + undoOffset,
+                                                undoLength);
+        m_tuplesPinnedByUndo++;
+        uq->registerUndoAction(new (*uq) PersistentTableUndoInPlaceUpdateAction(targetTupleToUpdate.address(),
+                                                                                oldBytes, undoOffset, undoLength,
+                                                                                &m_surgeon), this);
+    }
+
+    // this is the actual write of the new values
+    for (size_t i = 0; i < columnCount; ++i) {
+        targetTupleToUpdate.setNValue(sourceToTargetColumns[i].second,
+                                      sourceTuple.getNValue(sourceToTargetColumns[i].first));
+    }
+}
+
+/*
+ * Revert an in-place update by copying the saved "before" bytes back over
+ * the tuple data. The tuple cannot have moved because it was pinned.
+ */
+void PersistentTable::updateTupleInPlaceForUndo(char* tupleData, const char* oldBytes,
+                                                uint32_t offset, uint32_t length)
+{
+    ::memcpy(tupleData + TUPLE_HEADER_SIZE + offset, oldBytes, length);
+    m_tuplesPinnedByUndo--;
+}
+
+void PersistentTable::updateTupleInPlaceRelease()
+{
+    m_tuplesPinnedByUndo--;
+}
+
 /*
  * sourceTupleWithNewValues contains a copy of the tuple data before the update
  * and tupleWithUnwantedValues contains a copy of the updated tuple data.
@@ -578,7 +808,7 @@ void PersistentTable::deleteTupleRelease(char* tupleData)
  * Actually follow through with a "delete" -- this is common code between UndoDeleteAction release and the
  * all-at-once infallible deletes that bypass Undo processing.
  */
-void PersistentTable::deleteTupleFinalize(TableTuple &target)
+void PersistentTable::deleteTupleFinalize(TableTuple &target, TBPtr block)
 {
     // A snapshot (background scan) in progress can still cause a hold-up.
     // notifyTupleDelete() defaults to returning true for all context types
@@ -607,16 +837,196 @@ void PersistentTable::deleteTupleFinalize(TableTuple &target)
     }
 
     // No snapshot in progress cares, just whack it.
-    deleteTupleStorage(target); // also frees object columns
+    deleteTupleStorage(target, block); // also frees object columns
+}
+
+void PersistentTable::deleteTuples(std::vector<char*> &tupleAddresses, bool fallible)
+{
+    if (tupleAddresses.empty()) {
+        return;
+    }
+    // Blocks are contiguous, so address order is block order.
+    std::sort(tupleAddresses.begin(), tupleAddresses.end());
+
+    const size_t count = tupleAddresses.size();
+    UndoQuantum *uq = fallible ? ExecutorContext::currentUndoQuantum() : NULL;
+    // The undo action is registered before anything changes and counts
+    // each tuple as it leaves the indexes, so if a view throws part way
+    // through the batch only the tuples already deleted are restored.
+    PersistentTableUndoDeleteBatchAction *undoAction = NULL;
+    if (uq) {
+        char **pooledAddresses = uq->allocatePooledCopy(&tupleAddresses[0], count * sizeof(char*));
+        undoAction = new (*uq) PersistentTableUndoDeleteBatchAction(pooledAddresses, &m_surgeon);
+        uq->registerUndoAction(undoAction, this);
+    }
+
+    TableTuple target(m_schema);
+    BOOST_FOREACH(char *tupleAddress, tupleAddresses) {
+        target.move(tupleAddress);
+        // May not delete an already deleted tuple.
+        assert(target.isActive());
+
+        deleteFromAllIndexes(&target);
+        if (undoAction) {
+            target.setPendingDeleteOnUndoReleaseTrue();
+            ++m_tuplesPinnedByUndo;
+            ++m_invisibleTuplesPendingDeleteCount;
+            undoAction->tupleDeleted();
+        }
+
+        // handle any materialized views
+        for (int i = 0; i < m_views.size(); i++) {
+            m_views[i]->processTupleDelete(target, fallible);
+        }
+    }
+
+    if (undoAction) {
+        return;
+    }
+
+    // Here, for reasons of infallibility or no active UndoLog, there is no undo, there is only DO.
+    deleteTuplesFinalize(&tupleAddresses[0], count);
+}
+
+void PersistentTable::setTimeToLive(int column, int32_t ttlSeconds)
+{
+    if (column >= 0 && m_schema->columnType(column) != VALUE_TYPE_TIMESTAMP) {
+        char msg[1024];
+        snprintf(msg, 1024, "Table %s can't expire rows by column %s, which is not a TIMESTAMP",
+                 m_name.c_str(), columnName(column).c_str());
+        LogManager::getThreadLogger(LOGGERID_SQL)->log(LOGLEVEL_ERROR, msg);
+        column = -1;
+    }
+    m_ttlColumn = column;
+    m_ttlMicros = static_cast<int64_t>(ttlSeconds) * 1000000;
+}
+
+int64_t PersistentTable::purgeExpiredTuples(int64_t timeInMillis, int64_t maxTuples)
+{
+    if (m_ttlColumn < 0) {
+        return 0;
+    }
+    TableIndex *byTimestamp = NULL;
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        if (index->isOrderedIndex() && index->getIndexedExpressions().empty() &&
+            index->getColumnIndices()[0] == m_ttlColumn) {
+            byTimestamp = index;
+            break;
+        }
+    }
+    if (byTimestamp == NULL) {
+        return 0;
+    }
+
+    // NULLs sort first and never expire, so start at the smallest
+    // timestamp rather than walking past them on every purge.
+    TableTuple searchKey(byTimestamp->getKeySchema());
+    boost::scoped_array<char> searchKeyStorage(new char[searchKey.getSchema()->tupleLength()]);
+    searchKey.moveNoHeader(searchKeyStorage.get());
+    searchKey.setAllNulls();
+    searchKey.setNValue(0, ValueFactory::getTimestampValue(INT64_MIN + 1));
+    byTimestamp->moveToKeyOrGreater(&searchKey);
+
+    // Collect the oldest tuples first; deleting them would move the index
+    // out from under the scan.
+    const int64_t expiredBefore = timeInMillis * 1000 - m_ttlMicros;
+    std::vector<char*> expired;
+    TableTuple tuple(m_schema);
+    while (static_cast<int64_t>(expired.size()) < maxTuples &&
+           !(tuple = byTimestamp->nextValue()).isNullTuple()) {
+        if (ValuePeeker::peekTimestamp(tuple.getNValue(m_ttlColumn)) >= expiredBefore) {
+            break;
+        }
+        expired.push_back(tuple.address());
+    }
+
+    // Undone with the transaction that purges, and only counted once it
+    // commits.
+    deleteTuples(expired, true);
+    UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
+    if (uq == NULL) {
+        m_expiredTupleCount += expired.size();
+    }
+    else if (!expired.empty()) {
+        uq->registerUndoAction(new (*uq) PersistentTableUndoExpireAction(expired.size(), &m_surgeon));
+    }
+    return static_cast<int64_t>(expired.size());
+}
+
+/**
+ * This entry point is triggered by the successful release of an UndoDeleteBatchAction.
+ */
+void PersistentTable::deleteTuplesRelease(char **tupleAddresses, size_t count)
+{
+    TableTuple target(m_schema);
+    for (size_t i = 0; i < count; ++i) {
+        target.move(tupleAddresses[i]);
+        target.setPendingDeleteOnUndoReleaseFalse();
+    }
+    m_tuplesPinnedByUndo -= static_cast<uint32_t>(count);
+    m_invisibleTuplesPendingDeleteCount -= static_cast<int>(count);
+    deleteTuplesFinalize(tupleAddresses, count);
+}
+
+/*
+ * Free address-ordered tuples, looking up the owning block only when the
+ * next tuple falls outside the previous one's block.
+ */
+void PersistentTable::deleteTuplesFinalize(char **tupleAddresses, size_t count)
+{
+    TableTuple target(m_schema);
+    TBPtr block;
+    for (size_t i = 0; i < count; ++i) {
+        char *tupleAddress = tupleAddresses[i];
+        if (block.get() == NULL ||
+            tupleAddress < block->address() ||
+            tupleAddress >= block->address() + m_tableAllocationSize) {
+            block = findBlock(tupleAddress);
+        }
+        target.move(tupleAddress);
+        deleteTupleFinalize(target, block);
+    }
+}
+
+/*
+ * Reinsert the tuples of an undone batch delete into the indexes, in the
+ * reverse of the order they were deleted.
+ */
+void PersistentTable::deleteTuplesForUndo(char **tupleAddresses, size_t count)
+{
+    for (size_t i = count; i > 0; --i) {
+        insertTupleForUndo(tupleAddresses[i - 1]);
+    }
 }
 
 /**
  * Assumptions:
- *  All tuples will be deleted in storage order.
- *  Indexes and views have been destroyed first.
+ *  Views have been destroyed first.
+ *  The only indexes left are the ones an online schema change looks up
+ *  tuples by before they move.
  */
-void PersistentTable::deleteTupleForSchemaChange(TableTuple &target) {
-    deleteTupleStorage(target); // also frees object columns
+void PersistentTable::deleteTupleForSchemaChange(TableTuple &target, bool freeObjects) {
+    deleteFromAllIndexes(&target);
+    deleteTupleStorage(target, TBPtr(NULL), freeObjects); // frees object columns unless taken over
+}
+
+int64_t PersistentTable::migratingTupleCount() const {
+    if (m_migration == NULL) {
+        return 0;
+    }
+    return m_migration->existingTable()->activeTupleCount();
+}
+
+void PersistentTable::migrateMatches(const TableIndex *index, const TableTuple &searchKey) {
+    if (m_migration != NULL) {
+        m_migration->migrateMatches(index, searchKey);
+    }
+}
+
+void PersistentTable::finishMigration() {
+    if (m_migration != NULL) {
+        m_migration->migrate(-1);
+    }
 }
 
 /*
@@ -885,6 +1295,13 @@ void PersistentTable::processLoadedTuple(TableTuple &tuple,
                                          ReferenceSerializeOutput *uniqueViolationOutput,
                                          int32_t &serializedTupleCount,
                                          size_t &tupleCountPosition) {
+    if (m_indexesDeferred) {
+        FAIL_IF(!checkNulls(tuple)) {
+            throw ConstraintFailureException(this, tuple, TableTuple(), CONSTRAINT_TYPE_NOT_NULL);
+        }
+        insertLoadedImage(tuple);
+        return;
+    }
     try {
         insertTupleCommon(tuple, tuple, true);
     } catch (ConstraintFailureException &e) {
@@ -994,11 +1411,251 @@ void PersistentTable::processRecoveryMessage(RecoveryProtoMsg* message, Pool *po
         loadTuplesFromNoHeader(*message->stream(), pool);
         break;
     }
+    case RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES: {
+        // Views are maintained per tuple, so only plain tables defer their indexes.
+        if (!m_indexesDeferred && isPersistentTableEmpty() && m_views.empty()) {
+            m_indexesDeferred = true;
+        }
+        loadTupleImages(*message->stream(), pool);
+        if (message->isLastScanMessage() && m_indexesDeferred) {
+            buildDeferredIndexes();
+        }
+        break;
+    }
     default:
         throwFatalException("Attempted to process a recovery message of unknown type %d", message->msgType());
     }
 }
 
+void PersistentTable::loadTupleImages(SerializeInput &serialize_io, Pool *stringPool) {
+    int tupleCount = serialize_io.readInt();
+    assert(tupleCount >= 0);
+
+    TableTuple target(m_schema);
+    for (int i = 0; i < tupleCount; ++i) {
+        nextFreeTuple(&target);
+        target.deserializeImageFrom(serialize_io, stringPool);
+        insertLoadedImage(target);
+    }
+}
+
+void PersistentTable::loadTuplesDeferringIndexes(SerializeInput &serialize_in, Pool *stringPool) {
+    // Views are maintained per tuple, so only plain tables defer their
+    // indexes, and only from empty, as the build takes every tuple stored.
+    if (!m_indexesDeferred && isPersistentTableEmpty() && m_views.empty()) {
+        m_indexesDeferred = true;
+    }
+    loadTuplesFrom(serialize_in, stringPool);
+}
+
+bool PersistentTable::restoreImage(const TableImage &image) {
+    if (!image.matches(m_schema) || !isPersistentTableEmpty()) {
+        return false;
+    }
+    if (!m_indexesDeferred && m_views.empty()) {
+        m_indexesDeferred = true;
+    }
+    TableTuple target(m_schema);
+    for (int64_t i = 0; i < image.tupleCount(); ++i) {
+        nextFreeTuple(&target);
+        image.copyTuple(i, target);
+        insertLoadedImage(target);
+    }
+    if (m_indexesDeferred) {
+        buildDeferredIndexes();
+    }
+    return true;
+}
+
+/*
+ * Finish inserting a tuple whose storage was copied in from an image.
+ */
+void PersistentTable::insertLoadedImage(TableTuple &target) {
+    target.setActiveTrue();
+    target.setDirtyFalse();
+    target.setPendingDeleteFalse();
+    target.setPendingDeleteOnUndoReleaseFalse();
+
+    if (!m_indexesDeferred) {
+        int32_t serializedTupleCount = 0;
+        size_t tupleCountPosition = 0;
+        processLoadedTuple(target, NULL, serializedTupleCount, tupleCountPosition);
+        return;
+    }
+    if (m_schema->getUninlinedObjectColumnCount() != 0) {
+        increaseStringMemCount(target.getNonInlinedMemorySize());
+    }
+    if (m_tableStreamer != NULL) {
+        m_tableStreamer->notifyTupleInsert(target);
+    }
+}
+
+/*
+ * Indexes shared out between the site thread and the helper threads of a
+ * parallel index build. Each thread takes the next unbuilt index until
+ * none are left.
+ */
+struct IndexBuildWork {
+    IndexBuildWork(const std::vector<TableTuple> &tuples) :
+        tuples(tuples), next(0), failed(NULL)
+    {
+        pthread_mutex_init(&lock, NULL);
+    }
+
+    ~IndexBuildWork() {
+        pthread_mutex_destroy(&lock);
+    }
+
+    // Leave the indexes not yet taken unbuilt.
+    void stop() {
+        pthread_mutex_lock(&lock);
+        next = indexes.size();
+        pthread_mutex_unlock(&lock);
+    }
+
+    const std::vector<TableTuple> &tuples;
+    std::vector<TableIndex*> indexes;
+    size_t next;
+    TableIndex *failed;
+    // why the first thread to throw stopped, for the site thread to report
+    std::string error;
+    pthread_mutex_t lock;
+};
+
+static void buildNextIndexes(IndexBuildWork *work) {
+    while (true) {
+        pthread_mutex_lock(&work->lock);
+        if (work->next == work->indexes.size()) {
+            pthread_mutex_unlock(&work->lock);
+            return;
+        }
+        TableIndex *index = work->indexes[work->next++];
+        pthread_mutex_unlock(&work->lock);
+
+        if (!index->addEntries(work->tuples)) {
+            pthread_mutex_lock(&work->lock);
+            work->failed = index;
+            pthread_mutex_unlock(&work->lock);
+        }
+    }
+}
+
+/*
+ * An exception can't leave a helper thread, so whichever thread throws
+ * records why and stops the build for the site thread to report.
+ */
+static void *buildIndexes(void *arg) {
+    IndexBuildWork *work = static_cast<IndexBuildWork*>(arg);
+    std::string error;
+    try {
+        buildNextIndexes(work);
+        return NULL;
+    } catch (const SerializableEEException &e) {
+        error = e.message();
+    } catch (const FatalException &e) {
+        error = e.m_reason;
+    } catch (const std::exception &e) {
+        error = e.what();
+    } catch (...) {
+        error = "unknown exception";
+    }
+    pthread_mutex_lock(&work->lock);
+    if (work->error.empty()) {
+        work->error = error;
+    }
+    work->next = work->indexes.size();
+    pthread_mutex_unlock(&work->lock);
+    return NULL;
+}
+
+/*
+ * The helper threads of an index build. However the build ends, they are
+ * stopped and joined before the work they share goes away.
+ */
+class IndexBuildHelpers {
+public:
+    IndexBuildHelpers(IndexBuildWork &work) : m_work(work) {}
+
+    ~IndexBuildHelpers() {
+        m_work.stop();
+        BOOST_FOREACH(pthread_t helper, m_helpers) {
+            pthread_join(helper, NULL);
+        }
+    }
+
+    void start(int count) {
+        if (count <= 0) {
+            return;
+        }
+        m_helpers.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            pthread_t helper;
+            if (pthread_create(&helper, NULL, buildIndexes, &m_work) != 0) {
+                return;
+            }
+            m_helpers.push_back(helper);
+        }
+    }
+
+private:
+    IndexBuildWork &m_work;
+    std::vector<pthread_t> m_helpers;
+};
+
+/*
+ * Build every index from the tuples loaded while the indexes were
+ * deferred. The indexes are empty, so each can sort its keys and build
+ * itself in one pass rather than take the tuples one at a time.
+ */
+void PersistentTable::buildDeferredIndexes() {
+    assert(m_indexesDeferred);
+    m_indexesDeferred = false;
+
+    std::vector<TableTuple> tuples;
+    tuples.reserve(m_tupleCount);
+    TableIterator iter(this, m_data.begin());
+    TableTuple tuple(m_schema);
+    while (iter.next(tuple)) {
+        tuples.push_back(tuple);
+    }
+    addToIndexes(tuples);
+}
+
+/*
+ * Add tuples already in storage to every index. With helper threads
+ * configured, the indexes are built in parallel from the same read-only
+ * list of tuples. Indexes on expressions stay on the site thread since
+ * evaluating them uses its temp string pool.
+ */
+void PersistentTable::addToIndexes(const std::vector<TableTuple> &tuples) {
+    ExecutorContext *context = ExecutorContext::getExecutorContext();
+    int helperCount = (context == NULL) ? 0 : context->indexBuildThreads();
+    IndexBuildWork work(tuples);
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        if (helperCount > 0 && index->getIndexedExpressions().empty()) {
+            work.indexes.push_back(index);
+        } else if (!index->addEntries(tuples)) {
+            work.failed = index;
+        }
+    }
+
+    {
+        IndexBuildHelpers helpers(work);
+        // the site thread takes a share of the work too
+        helpers.start(std::min(helperCount, static_cast<int>(work.indexes.size()) - 1));
+        buildIndexes(&work);
+    }
+
+    if (!work.error.empty()) {
+        throwFatalException("Failed to build the indexes of table %s: %s",
+                            m_name.c_str(), work.error.c_str());
+    }
+    if (work.failed != NULL) {
+        throwFatalException("Loaded data for table %s violates unique index %s",
+                            m_name.c_str(), work.failed->getName().c_str());
+    }
+}
+
 /**
  * Create a tree index on the primary key and then iterate it and hash
  * the tuple data.
@@ -1157,6 +1814,7 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap) {
             m_blocksNotPendingSnapshot.erase(lightest);
             m_blocksPendingSnapshot.erase(lightest);
             lightest->swapToBucket(TBBucketPtr());
+            retireBlock(lightest);
         } else {
             int lightestBucketChange = bucketChanges.second;
             if (lightestBucketChange != -1) {
@@ -48,6 +48,7 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <boost/scoped_ptr.hpp>
@@ -86,9 +87,11 @@ class SerializeInput;
 class Topend;
 class MaterializedViewMetadata;
 class RecoveryProtoMsg;
+class TableImage;
 class TupleOutputStreamProcessor;
 class ReferenceSerializeInput;
 class PersistentTable;
+class TupleMigration;
 
 /**
  * Interface used by contexts, scanners, iterators, and undo actions to access
@@ -102,15 +105,28 @@ class PersistentTableSurgeon {
 public:
 
     TBMap &getData();
+    void borrowData(TBBorrowedMap &blocks);
+    void pinBlocks(const TBBorrowedMap &blocks);
+    void unpinBlocks(const TBBorrowedMap &blocks);
+    void releaseRetiredBlocks();
     void insertTupleForUndo(char *tuple);
     void updateTupleForUndo(char* targetTupleToUpdate,
                             char* sourceTupleWithNewValues,
                             bool revertIndexes);
+    void updateTupleInPlaceForUndo(char* tupleData, const char* oldBytes,
+                                   uint32_t offset, uint32_t length);
+    void updateTupleInPlaceRelease();
+    void truncateTableForUndo(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes,
+                              uint32_t tupleCount, int64_t nonInlinedMemorySize);
+    void truncateTableRelease(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes);
+    void deleteTuplesForUndo(char **tupleAddresses, size_t count);
+    void deleteTuplesRelease(char **tupleAddresses, size_t count);
+    void expiredTuplesRelease(size_t count);
     bool deleteTuple(TableTuple &tuple, bool fallible=true);
     void deleteTupleForUndo(char* tupleData, bool skipLookup = false);
     void deleteTupleRelease(char* tuple);
     void deleteTupleStorage(TableTuple &tuple, TBPtr block = TBPtr(NULL));
-    void snapshotFinishedScanningBlock(TBPtr finishedBlock, TBPtr nextBlock);
+    void snapshotFinishedScanningBlock(TupleBlock *finishedBlock, TupleBlock *nextBlock);
     uint32_t getTupleCount() const;
 
     // Elastic index methods. Used by ElasticContext.
@@ -227,10 +243,21 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
         return new TableIterator(this, m_data.begin());
     }
 
+    // Return a table iterator for a scan that deletes the tuples it
+    // visits, which may free the block it is on
+    TableIterator iteratorDeletingAsWeGo() {
+        return TableIterator(this, m_data.begin(), &m_data);
+    }
+
     // ------------------------------------------------------------------
     // GENERIC TABLE OPERATIONS
     // ------------------------------------------------------------------
     virtual void deleteAllTuples(bool freeAllocatedStrings);
+    // Delete all tuples by detaching the tuple blocks and clearing the
+    // indexes wholesale instead of visiting every tuple. The detached blocks
+    // are kept by the undo action and freed on release. Falls back to
+    // deleteAllTuples when views or table streams must see each delete.
+    void truncateTable();
     // The fallible flag is used to denote a change to a persistent table
     // which is part of a long transaction that has been vetted and can
     // never fail (e.g. violate a constraint).
@@ -239,6 +266,20 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // Constraint checks are bypassed and the change does not make use of "undo" support.
     // TODO: change meaningless bool return type to void (starting in class Table) and migrate callers.
     virtual bool deleteTuple(TableTuple &tuple, bool fallible=true);
+    // Delete a set of tuples identified by address, e.g. the output of an
+    // index range scan feeding a DELETE. The addresses are sorted in place so
+    // the tuples are visited and their slots freed block by block, and the
+    // whole set shares a single undo action.
+    void deleteTuples(std::vector<char*> &tupleAddresses, bool fallible=true);
+    // Make each tuple expire ttlSeconds after the TIMESTAMP in column, or
+    // never for a column of -1. Expired tuples are only purged through an
+    // ordered index whose first key is that column.
+    void setTimeToLive(int column, int32_t ttlSeconds);
+    bool hasTimeToLive() const { return m_ttlColumn >= 0; }
+    // Delete up to maxTuples of the tuples expired at timeInMillis, oldest
+    // first, as a fallible deleteTuple would. Returns how many were deleted.
+    int64_t purgeExpiredTuples(int64_t timeInMillis, int64_t maxTuples);
+    virtual int64_t expiredTupleCount() const { return m_expiredTupleCount; }
     // TODO: change meaningless bool return type to void (starting in class Table) and migrate callers.
     virtual bool insertTuple(TableTuple &tuple);
     // Optimized version of update that only updates specific indexes.
@@ -258,14 +299,45 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
                                                 TableTuple &sourceTupleWithNewValues,
                                                 std::vector<TableIndex*> const &indexesToUpdate,
                                                 bool fallible=true);
+    // Update of inlined, fixed-width columns that no index depends on.
+    // The new values are written directly into block storage without
+    // staging the whole row in a temp tuple, and only the byte range
+    // [undoOffset, undoOffset + undoLength) of the tuple data is saved
+    // for undo. The caller is responsible for checking that the target
+    // columns qualify and that the table has no materialized views.
+    void updateTupleInPlace(TableTuple &targetTupleToUpdate,
+                            const TableTuple &sourceTuple,
+                            std::vector<std::pair<int, int> > const &sourceToTargetColumns,
+                            uint32_t undoOffset, uint32_t undoLength);
 
     // ------------------------------------------------------------------
     // PERSISTENT TABLE OPERATIONS
     // ------------------------------------------------------------------
-    void deleteTupleForSchemaChange(TableTuple &target);
+    void deleteTupleForSchemaChange(TableTuple &target, bool freeObjects = true);
 
     void insertPersistentTuple(TableTuple &source, bool fallible);
 
+    // Take over a tuple of the table this one replaces, when the change
+    // only appended columns. This only makes the copy cheaper: the tuple
+    // is still rewritten into a block of this table, as every table's
+    // blocks hold tuples of its one schema. The existing bytes are copied
+    // in a single memcpy, non-inlined objects are handed over rather than
+    // deep copied, and the appended columns are copied from defaults. The
+    // caller then deletes the source for the schema change without freeing
+    // its objects.
+    void insertTupleForSchemaChange(TableTuple &source, const TableTuple &defaults);
+
+    // While an online schema change leaves tuples in the table this one
+    // replaces (see TupleMigration), whatever reads the table moves them
+    // over first: a lookup on a whole index key just the ones it would
+    // find, and scans, counts and range lookups all of them. Inserts and
+    // updates move the ones their unique keys clash with.
+    bool isMigrating() const { return m_migration != NULL; }
+    int64_t migratingTupleCount() const;
+    void migrateMatches(const TableIndex *index, const TableTuple &searchKey);
+    void finishMigration();
+    void setMigration(TupleMigration *migration) { m_migration = migration; }
+
     /// This is not used in any production code path -- it is a convenient wrapper used by tests.
     bool updateTuple(TableTuple &targetTupleToUpdate, TableTuple &sourceTupleWithNewValues)
     {
@@ -286,9 +358,16 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     virtual std::string debug();
 
     /*
-     * Find the block a tuple belongs to. Returns TBPtr(NULL) if no block is found.
+     * Find the block a tuple of a table with blocks of blockSize belongs
+     * to. Returns TBPtr(NULL) if it is not one of blocks.
      */
     static TBPtr findBlock(char *tuple, TBMap &blocks, int blockSize);
+    static TupleBlock* findBlock(char *tuple, TBBorrowedMap &blocks, int blockSize);
+
+    /*
+     * Find the block of this table a tuple belongs to, in constant time.
+     */
+    TBPtr findBlock(char *tuple);
 
     int partitionColumn() const { return m_partitionColumn; }
     /** inlined here because it can't be inlined in base Table, as it
@@ -299,6 +378,8 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     /** Add/drop/list materialized views to this table */
     void addMaterializedView(MaterializedViewMetadata *view);
 
+    bool hasMaterializedViews() const { return !m_views.empty(); }
+
     /**
      * Prepare table for streaming from serialized data.
      * Return true on success or false if it was already active.
@@ -331,6 +412,31 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
      */
     void processRecoveryMessage(RecoveryProtoMsg* message, Pool *pool);
 
+    /**
+     * Fill this empty table from a table image, see TableImage. Return
+     * false, leaving the table untouched, if the image does not match the
+     * table's layout or the table is not empty.
+     */
+    bool restoreImage(const TableImage &image);
+
+    /**
+     * Load tuples serialized as for Table::loadTuplesFrom when there is
+     * nothing to undo and no unique violation to report, as when a
+     * rejoining site loads a snapshot chunk by chunk. Into an empty table,
+     * the tuples of every chunk only go into storage, and the indexes stay
+     * deferred until buildDeferredIndexes is called after the last one.
+     */
+    void loadTuplesDeferringIndexes(SerializeInput &serialize_in, Pool *stringPool);
+
+    bool hasDeferredIndexes() const { return m_indexesDeferred; }
+
+    /**
+     * Build every index from the tuples loaded while the indexes were
+     * deferred, each taking them all at once, on the helper threads of
+     * ExecutorContext::indexBuildThreads() if there are any.
+     */
+    void buildDeferredIndexes();
+
     /**
      * Create a tree index on the primary key and then iterate it and hash
      * the tuple data.
@@ -387,14 +493,14 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
                                     std::vector<std::string> &predicateStrings,
                                     bool skipInternalActivation);
 
-    void snapshotFinishedScanningBlock(TBPtr finishedBlock, TBPtr nextBlock) {
+    void snapshotFinishedScanningBlock(TupleBlock *finishedBlock, TupleBlock *nextBlock) {
         if (nextBlock != NULL) {
-            assert(m_blocksPendingSnapshot.find(nextBlock) != m_blocksPendingSnapshot.end());
-            m_blocksPendingSnapshot.erase(nextBlock);
+            assert(m_blocksPendingSnapshot.find(TBPtr(nextBlock)) != m_blocksPendingSnapshot.end());
+            m_blocksPendingSnapshot.erase(TBPtr(nextBlock));
             nextBlock->swapToBucket(TBBucketPtr());
         }
         if (finishedBlock != NULL && !finishedBlock->isEmpty()) {
-            m_blocksNotPendingSnapshot.insert(finishedBlock);
+            m_blocksNotPendingSnapshot.insert(TBPtr(finishedBlock));
             int bucketIndex = finishedBlock->calculateBucketIndex();
             if (bucketIndex != -1) {
                 finishedBlock->swapToBucket(m_blocksNotPendingSnapshotLoad[bucketIndex]);
@@ -402,6 +508,20 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
         }
     }
 
+    /*
+     * A snapshot or elastic stream pins the map of the blocks it has yet
+     * to scan, and erases each block from it once the scan has passed it.
+     * A block the table lets go of (emptied or compacted away) while it
+     * is still in a pinned map is retired rather than freed, as the
+     * stream will still walk it. Retired blocks are freed once no pinned
+     * map holds them; blocks no stream still needs are freed at once.
+     */
+    void pinBlocks(const TBBorrowedMap &blocks);
+    void unpinBlocks(const TBBorrowedMap &blocks);
+    void retireBlock(const TBPtr &block);
+    void releaseRetiredBlocks();
+    bool isBlockPinned(TupleBlock *block) const;
+
     void nextFreeTuple(TableTuple *tuple);
     bool doCompactionWithinSubset(TBBucketMap *bucketMap);
     void doForcedCompaction();
@@ -436,14 +556,25 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     void updateTupleForUndo(char* targetTupleToUpdate,
                             char* sourceTupleWithNewValues,
                             bool revertIndexes);
+    void updateTupleInPlaceForUndo(char* tupleData, const char* oldBytes,
+                                   uint32_t offset, uint32_t length);
+    void updateTupleInPlaceRelease();
+    void truncateTableForUndo(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes,
+                              uint32_t tupleCount, int64_t nonInlinedMemorySize);
+    void truncateTableRelease(TBMap &detachedBlocks, std::vector<TableIndex*> &detachedIndexes);
     void deleteTupleForUndo(char* tupleData, bool skipLookup = false);
     void deleteTupleRelease(char* tuple);
-    void deleteTupleFinalize(TableTuple &tuple);
+    void deleteTuplesForUndo(char **tupleAddresses, size_t count);
+    void deleteTuplesRelease(char **tupleAddresses, size_t count);
+    void deleteTuplesFinalize(char **tupleAddresses, size_t count);
+    void deleteTupleFinalize(TableTuple &tuple, TBPtr block = TBPtr(NULL));
     /**
      * Normally this will return the tuple storage to the free list.
      * In the memcheck build it will return the storage to the heap.
+     * The tuple's non-inlined objects are freed unless freeObjects is
+     * false, when another tuple has taken them over.
      */
-    void deleteTupleStorage(TableTuple &tuple, TBPtr block = TBPtr(NULL));
+    void deleteTupleStorage(TableTuple &tuple, TBPtr block = TBPtr(NULL), bool freeObjects = true);
 
     /*
      * Implemented by persistent table and called by Table::loadTuplesFrom
@@ -454,6 +585,15 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
                                     int32_t &serializedTupleCount,
                                     size_t &tupleCountPosition);
 
+    /*
+     * Insert the tuple images of a recovery message, either one at a time
+     * with all of the usual index maintenance or, while the indexes are
+     * deferred, only into storage.
+     */
+    void loadTupleImages(SerializeInput &serialize_io, Pool *stringPool);
+    void insertLoadedImage(TableTuple &target);
+    void addToIndexes(const std::vector<TableTuple> &tuples);
+
     TBPtr allocateNextBlock();
 
     // CONSTRAINTS
@@ -472,6 +612,14 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // is Export enabled
     bool m_exportEnabled;
 
+    // time to live
+    int m_ttlColumn;
+    int64_t m_ttlMicros;
+    int64_t m_expiredTupleCount;
+
+    // the online schema change still moving tuples in, if any
+    TupleMigration *m_migration;
+
 
     // STORAGE TRACKING
 
@@ -489,6 +637,10 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // that have never been allocated
     stx::btree_set<TBPtr > m_blocksWithSpace;
 
+    // Block retirement, declared ahead of the streams that pin it
+    std::vector<const TBBorrowedMap*> m_pinnedBlockMaps;
+    std::vector<TBPtr> m_retiredBlocks;
+
     // Provides access to all table streaming apparati, including COW and recovery.
     boost::shared_ptr<TableStreamerInterface> m_tableStreamer;
 
@@ -500,6 +652,11 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // This is a testability feature not intended for use in product logic.
     int m_invisibleTuplesPendingDeleteCount;
 
+    // Set while a recovery scan or loadTuplesDeferringIndexes fills an
+    // empty table without touching the indexes, which are built in one
+    // pass after the last scan message or loaded chunk.
+    bool m_indexesDeferred;
+
     // Surgeon passed to classes requiring "deep" access to avoid excessive friendship.
     PersistentTableSurgeon m_surgeon;
 };
@@ -516,6 +673,25 @@ inline TBMap &PersistentTableSurgeon::getData() {
     return m_table.m_data;
 }
 
+inline void PersistentTableSurgeon::borrowData(TBBorrowedMap &blocks) {
+    blocks.clear();
+    for (TBMapI i = m_table.m_data.begin(); i != m_table.m_data.end(); ++i) {
+        blocks.insert(i.key(), i.data().get());
+    }
+}
+
+inline void PersistentTableSurgeon::pinBlocks(const TBBorrowedMap &blocks) {
+    m_table.pinBlocks(blocks);
+}
+
+inline void PersistentTableSurgeon::unpinBlocks(const TBBorrowedMap &blocks) {
+    m_table.unpinBlocks(blocks);
+}
+
+inline void PersistentTableSurgeon::releaseRetiredBlocks() {
+    m_table.releaseRetiredBlocks();
+}
+
 inline void PersistentTableSurgeon::insertTupleForUndo(char *tuple) {
     m_table.insertTupleForUndo(tuple);
 }
@@ -526,6 +702,38 @@ inline void PersistentTableSurgeon::updateTupleForUndo(char* targetTupleToUpdate
     m_table.updateTupleForUndo(targetTupleToUpdate, sourceTupleWithNewValues, revertIndexes);
 }
 
+inline void PersistentTableSurgeon::updateTupleInPlaceForUndo(char* tupleData, const char* oldBytes,
+                                                              uint32_t offset, uint32_t length) {
+    m_table.updateTupleInPlaceForUndo(tupleData, oldBytes, offset, length);
+}
+
+inline void PersistentTableSurgeon::updateTupleInPlaceRelease() {
+    m_table.updateTupleInPlaceRelease();
+}
+
+inline void PersistentTableSurgeon::truncateTableForUndo(TBMap &detachedBlocks,
+                                                         std::vector<TableIndex*> &detachedIndexes,
+                                                         uint32_t tupleCount, int64_t nonInlinedMemorySize) {
+    m_table.truncateTableForUndo(detachedBlocks, detachedIndexes, tupleCount, nonInlinedMemorySize);
+}
+
+inline void PersistentTableSurgeon::truncateTableRelease(TBMap &detachedBlocks,
+                                                         std::vector<TableIndex*> &detachedIndexes) {
+    m_table.truncateTableRelease(detachedBlocks, detachedIndexes);
+}
+
+inline void PersistentTableSurgeon::deleteTuplesForUndo(char **tupleAddresses, size_t count) {
+    m_table.deleteTuplesForUndo(tupleAddresses, count);
+}
+
+inline void PersistentTableSurgeon::deleteTuplesRelease(char **tupleAddresses, size_t count) {
+    m_table.deleteTuplesRelease(tupleAddresses, count);
+}
+
+inline void PersistentTableSurgeon::expiredTuplesRelease(size_t count) {
+    m_table.m_expiredTupleCount += count;
+}
+
 inline bool PersistentTableSurgeon::deleteTuple(TableTuple &tuple, bool fallible) {
     return m_table.deleteTuple(tuple, fallible);
 }
@@ -542,7 +750,7 @@ inline void PersistentTableSurgeon::deleteTupleStorage(TableTuple &tuple, TBPtr
     m_table.deleteTupleStorage(tuple, block);
 }
 
-inline void PersistentTableSurgeon::snapshotFinishedScanningBlock(TBPtr finishedBlock, TBPtr nextBlock) {
+inline void PersistentTableSurgeon::snapshotFinishedScanningBlock(TupleBlock *finishedBlock, TupleBlock *nextBlock) {
     m_table.snapshotFinishedScanningBlock(finishedBlock, nextBlock);
 }
 
@@ -675,7 +883,7 @@ inline TableTuple& PersistentTable::getTempTupleInlined(TableTuple &source) {
 }
 
 
-inline void PersistentTable::deleteTupleStorage(TableTuple &tuple, TBPtr block)
+inline void PersistentTable::deleteTupleStorage(TableTuple &tuple, TBPtr block, bool freeObjects)
 {
     // May not delete an already deleted tuple.
     assert(tuple.isActive());
@@ -686,7 +894,9 @@ inline void PersistentTable::deleteTupleStorage(TableTuple &tuple, TBPtr block)
     // This frees referenced strings -- when could possibly be a better time?
     if (m_schema->getUninlinedObjectColumnCount() != 0) {
         decreaseStringMemCount(tuple.getNonInlinedMemorySize());
-        tuple.freeObjectColumns();
+        if (freeObjects) {
+            tuple.freeObjectColumns();
+        }
     }
 
     tuple.setActiveFalse();
@@ -699,10 +909,7 @@ inline void PersistentTable::deleteTupleStorage(TableTuple &tuple, TBPtr block)
     }
 
     if (block.get() == NULL) {
-        block = findBlock(tuple.address(), m_data, m_tableAllocationSize);
-        if (block.get() == NULL) {
-            throwFatalException("Tried to find a tuple block for a tuple but couldn't find one");
-        }
+        block = findBlock(tuple.address());
     }
 
     bool transitioningToBlockWithSpace = !block->hasFreeTuples();
@@ -729,31 +936,82 @@ inline void PersistentTable::deleteTupleStorage(TableTuple &tuple, TBPtr block)
         assert(m_blocksPendingSnapshot.find(block) == m_blocksPendingSnapshot.end());
         //Eliminates circular reference
         block->swapToBucket(TBBucketPtr());
+        retireBlock(block);
     } else if (transitioningToBlockWithSpace) {
         m_blocksWithSpace.insert(block);
     }
 }
 
 inline TBPtr PersistentTable::findBlock(char *tuple, TBMap &blocks, int blockSize) {
-    if (!blocks.empty()) {
-        TBMapI i = blocks.lower_bound(tuple);
+    // The tuple's address says which block holds it; the map only says
+    // whether that is one of the blocks asked about.
+    TupleBlock *block = TupleBlock::containing(tuple, TupleBlock::storageAlignment(blockSize));
+    TBMapI i = blocks.find(block->address());
+    if (i == blocks.end()) {
+        return TBPtr(NULL);
+    }
+    if (i.data().get() == NULL) {
+        throwFatalException("A block has gone missing in the tuple block map.");
+    }
+    return i.data();
+}
 
-        // Not the first tuple of any known block, move back a block, see if it
-        // belongs to the previous block
-        if (i == blocks.end() || i.key() != tuple) {
-            i--;
-        }
+inline TupleBlock* PersistentTable::findBlock(char *tuple, TBBorrowedMap &blocks, int blockSize) {
+    TupleBlock *block = TupleBlock::containing(tuple, TupleBlock::storageAlignment(blockSize));
+    TBBorrowedMapI i = blocks.find(block->address());
+    if (i == blocks.end()) {
+        return NULL;
+    }
+    if (i.data() == NULL) {
+        throwFatalException("A block has gone missing in the tuple block map.");
+    }
+    return i.data();
+}
 
-        // If the tuple is within the block boundaries, we found the block
-        if (i.key() <= tuple && tuple < i.key() + blockSize) {
-            if (i.data().get() == NULL) {
-                throwFatalException("A block has gone missing in the tuple block map.");
-            }
-            return i.data();
+inline TBPtr PersistentTable::findBlock(char *tuple) {
+    TupleBlock *block = TupleBlock::containing(tuple, TupleBlock::storageAlignment(m_tableAllocationSize));
+    assert(tuple >= block->address() && tuple < block->address() + m_tableAllocationSize);
+    return TBPtr(block);
+}
+
+inline void PersistentTable::pinBlocks(const TBBorrowedMap &blocks) {
+    m_pinnedBlockMaps.push_back(&blocks);
+}
+
+inline void PersistentTable::unpinBlocks(const TBBorrowedMap &blocks) {
+    std::vector<const TBBorrowedMap*>::iterator pinned =
+        std::find(m_pinnedBlockMaps.begin(), m_pinnedBlockMaps.end(), &blocks);
+    assert(pinned != m_pinnedBlockMaps.end());
+    m_pinnedBlockMaps.erase(pinned);
+    releaseRetiredBlocks();
+}
+
+inline void PersistentTable::retireBlock(const TBPtr &block) {
+    if (isBlockPinned(block.get())) {
+        m_retiredBlocks.push_back(block);
+    }
+}
+
+inline void PersistentTable::releaseRetiredBlocks() {
+    std::vector<TBPtr>::iterator retired = m_retiredBlocks.begin();
+    while (retired != m_retiredBlocks.end()) {
+        if (isBlockPinned(retired->get())) {
+            ++retired;
+        }
+        else {
+            retired = m_retiredBlocks.erase(retired);
         }
     }
+}
 
-    return TBPtr(NULL);
+inline bool PersistentTable::isBlockPinned(TupleBlock *block) const {
+    for (size_t ii = 0; ii < m_pinnedBlockMaps.size(); ii++) {
+        TBBorrowedMap::const_iterator pinned = m_pinnedBlockMaps[ii]->find(block->address());
+        if (pinned != m_pinnedBlockMaps[ii]->end() && pinned.data() == block) {
+            return true;
+        }
+    }
+    return false;
 }
 
 inline TBPtr PersistentTable::allocateNextBlock() {
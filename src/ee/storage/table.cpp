@@ -43,6 +43,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <cstdio>
@@ -57,6 +58,7 @@
 #include "common/Pool.hpp"
 #include "common/FatalException.hpp"
 #include "indexes/tableindex.h"
+#include "storage/SharedSchemaCache.h"
 #include "storage/tableiterator.h"
 #include "storage/persistenttable.h"
 
@@ -78,6 +80,7 @@ Table::Table(int tableAllocationTargetSize) :
     m_databaseId(-1),
     m_name(""),
     m_ownsTupleSchema(true),
+    m_sharesTupleSchema(false),
     m_tableAllocationTargetSize(tableAllocationTargetSize),
     m_pkeyIndex(NULL),
     m_refcount(0)
@@ -95,11 +98,7 @@ Table::~Table() {
     m_pkeyIndex = NULL;
 
     // clear the schema
-    if (m_ownsTupleSchema) {
-        TupleSchema::freeTupleSchema(m_schema);
-    }
-
-    m_schema = NULL;
+    releaseTupleSchema();
 
     // clear any cached column serializations
     if (m_columnHeaderData)
@@ -107,38 +106,37 @@ Table::~Table() {
     m_columnHeaderData = NULL;
 }
 
+void Table::releaseTupleSchema() {
+    if (m_sharesTupleSchema) {
+        SharedSchemaCache::instance().release(m_schema);
+        m_sharesTupleSchema = false;
+    }
+    else if (m_ownsTupleSchema) {
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+    m_schema = NULL;
+}
+
 void Table::initializeWithColumns(TupleSchema *schema, const std::vector<string> &columnNames, bool ownsTupleSchema) {
 
     // copy the tuple schema
-    if (m_ownsTupleSchema) {
-        TupleSchema::freeTupleSchema(m_schema);
-    }
+    releaseTupleSchema();
     m_ownsTupleSchema = ownsTupleSchema;
     m_schema  = schema;
 
     m_columnCount = schema->columnCount();
 
     m_tupleLength = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
+    // Block storage is a power of two in size and aligned on its size,
+    // with the block header in front of the tuples, so that a tuple's
+    // address masks down to its block (see TupleBlock::containing).
 #ifdef MEMCHECK
     m_tuplesPerBlock = 1;
-    m_tableAllocationSize = m_tupleLength;
-#else
-    m_tuplesPerBlock = m_tableAllocationTargetSize / m_tupleLength;
-#ifdef USE_MMAP
-    if (m_tuplesPerBlock < 1) {
-        m_tuplesPerBlock = 1;
-        m_tableAllocationSize = nexthigher(m_tupleLength);
-    } else {
-        m_tableAllocationSize = nexthigher(m_tableAllocationTargetSize);
-    }
+    m_tableAllocationSize = nexthigher(static_cast<int>(m_tupleLength) + TUPLE_BLOCK_HEADER_SIZE);
 #else
-    if (m_tuplesPerBlock < 1) {
-        m_tuplesPerBlock = 1;
-        m_tableAllocationSize = m_tupleLength;
-    } else {
-        m_tableAllocationSize = m_tableAllocationTargetSize;
-    }
-#endif
+    m_tableAllocationSize = nexthigher(std::max(m_tableAllocationTargetSize,
+                                                static_cast<int>(m_tupleLength) + TUPLE_BLOCK_HEADER_SIZE));
+    m_tuplesPerBlock = (m_tableAllocationSize - TUPLE_BLOCK_HEADER_SIZE) / m_tupleLength;
 #endif
 
     // initialize column names
@@ -315,9 +313,16 @@ bool Table::serializeTo(SerializeOutput &serialize_io) {
     int64_t written_count = 0;
     TableIterator titer = iterator();
     TableTuple tuple(m_schema);
-    while (titer.next(tuple)) {
-        tuple.serializeTo(serialize_io);
-        ++written_count;
+    TupleBlockSpan span;
+    while (titer.nextBlock(span)) {
+        for (uint32_t slot = 0; slot < span.count; ++slot) {
+            span.prefetch(slot + TupleBlockSpan::PREFETCH_DISTANCE);
+            if (span.isVisible(slot)) {
+                tuple.move(span.tupleAddress(slot));
+                tuple.serializeTo(serialize_io);
+                ++written_count;
+            }
+        }
     }
     assert(written_count == m_tupleCount);
 
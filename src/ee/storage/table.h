@@ -188,6 +188,11 @@ class Table {
         return m_nonInlinedMemorySize;
     }
 
+    // Tuples deleted because their time to live ran out
+    virtual int64_t expiredTupleCount() const {
+        return 0;
+    }
+
     // ------------------------------------------------------------------
     // COLUMNS
     // ------------------------------------------------------------------
@@ -394,6 +399,8 @@ protected:
 
     void initializeWithColumns(TupleSchema *schema, const std::vector<std::string> &columnNames, bool ownsTupleSchema);
 
+    void releaseTupleSchema();
+
     // per table-type initialization
     virtual void onSetColumns() {
     };
@@ -432,6 +439,8 @@ protected:
 
     // If this table owns the TupleSchema it is responsible for deleting it in the destructor
     bool m_ownsTupleSchema;
+    // If the TupleSchema came from the SharedSchemaCache it is released there instead
+    bool m_sharesTupleSchema;
 
     const int m_tableAllocationTargetSize;
     int m_tableAllocationSize;
@@ -65,7 +65,8 @@ Table* TableFactory::getPersistentTable(
             int partitionColumn,
             bool exportEnabled,
             bool exportOnly,
-            int tableAllocationTargetSize)
+            int tableAllocationTargetSize,
+            bool sharedTupleSchema)
 {
     Table *table = NULL;
 
@@ -76,7 +77,8 @@ Table* TableFactory::getPersistentTable(
         table = new PersistentTable(partitionColumn, tableAllocationTargetSize);
     }
 
-    initCommon(databaseId, table, name, schema, columnNames, true);
+    initCommon(databaseId, table, name, schema, columnNames, !sharedTupleSchema);
+    table->m_sharesTupleSchema = sharedTupleSchema;
 
     // initialize stats for the table
     configureStats(databaseId, name, table);
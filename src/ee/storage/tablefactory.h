@@ -74,6 +74,8 @@ public:
     * Every PersistentTable must be instantiated via this method.
     * Also, columns can't be added/changed/removed after a PersistentTable
     * instance is made. TableColumn is immutable.
+    * With sharedTupleSchema, the schema came from the SharedSchemaCache and
+    * the table releases it there rather than freeing it.
     */
     static Table* getPersistentTable(
         voltdb::CatalogId databaseId,
@@ -83,7 +85,8 @@ public:
         int partitionColumn = -1, // defaults provided for ease of testing.
         bool exportEnabled = false,
         bool exportOnly = false,
-        int tableAllocationTargetSize = 0);
+        int tableAllocationTargetSize = 0,
+        bool sharedTupleSchema = false);
 
     /**
     * Creates an empty temp table with given name and columns.
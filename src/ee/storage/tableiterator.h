@@ -57,11 +57,54 @@ namespace voltdb {
 class TempTable;
 class PersistentTable;
 
+/**
+ * The tuple slots of one tuple block, as handed out by
+ * TableIterator::nextBlock. Slots are tupleLength bytes apart. In a dense
+ * span every slot holds a tuple to scan. Otherwise check each slot with
+ * isVisible, as the slots of deleted tuples and tuples pending delete are
+ * skipped by a scan.
+ */
+struct TupleBlockSpan {
+    // How many slots ahead of the current one a scan should prefetch
+    enum { PREFETCH_DISTANCE = 4 };
+
+    char *address;
+    uint32_t tupleLength;
+    uint32_t count;
+    bool dense;
+
+    char *tupleAddress(uint32_t i) const {
+        return address + static_cast<size_t>(i) * tupleLength;
+    }
+
+    void prefetch(uint32_t i) const {
+        if (i < count) {
+            __builtin_prefetch(tupleAddress(i));
+        }
+    }
+
+    bool isVisible(uint32_t i) const {
+        if (dense) {
+            return true;
+        }
+        const char flags = *tupleAddress(i);
+        return (flags & (ACTIVE_MASK | PENDING_DELETE_MASK | PENDING_DELETE_ON_UNDO_RELEASE_MASK)) ==
+            ACTIVE_MASK;
+    }
+};
+
 /**
  * Iterator for table which neglects deleted tuples.
  * TableIterator is a small and copiable object.
  * You can copy it, not passing a pointer of it.
  *
+ * An iterator borrows the block it is scanning from the table rather
+ * than taking a reference to it, so it must not outlive a change that
+ * frees that block. A scan that deletes the tuples it visits can free
+ * the block under itself; it gets an iterator from
+ * PersistentTable::iteratorDeletingAsWeGo, which holds on to its current
+ * block until it moves past it and looks up the next block afresh.
+ *
  * This class should be a virtual interface or should
  * be templated on the underlying table data iterator.
  * Either change requires some updating of the iterators
@@ -81,12 +124,20 @@ public:
      * @return true if succeeded. false if no more active tuple is there.
     */
     bool next(TableTuple &out);
+
+    /**
+     * Hand out the next block of the table as a whole, for scans that run
+     * their own loop over its tuples. Returns false once no tuples are
+     * left. Use either this or next on an iterator, not both.
+     */
+    bool nextBlock(TupleBlockSpan &span);
+
     bool hasNext();
     int getLocation() const;
 
 private:
     // Get an iterator via table->iterator()
-    TableIterator(Table *, TBMapI);
+    TableIterator(Table *, TBMapI, TBMap *deletingFrom = NULL);
     TableIterator(Table *, std::vector<TBPtr>::iterator);
 
 
@@ -117,7 +168,10 @@ private:
     uint32_t m_foundTuples;
     uint32_t m_tupleLength;
     uint32_t m_tuplesPerBlock;
-    TBPtr m_currentBlock;
+    TupleBlock *m_currentBlock;
+    // Only set when deleting as we go, to keep m_currentBlock alive
+    TBPtr m_heldBlock;
+    TBMap *m_deletingFrom;
     std::vector<TBPtr>::iterator m_tempBlockIterator;
     bool m_tempTableIterator;
 };
@@ -130,13 +184,14 @@ inline TableIterator::TableIterator(Table *parent, std::vector<TBPtr>::iterator
       m_activeTuples((int) m_table->m_tupleCount),
       m_foundTuples(0), m_tupleLength(parent->m_tupleLength),
       m_tuplesPerBlock(parent->m_tuplesPerBlock), m_currentBlock(NULL),
+      m_deletingFrom(NULL),
       m_tempBlockIterator(start),
       m_tempTableIterator(true)
     {
     }
 
 
-inline TableIterator::TableIterator(Table *parent, TBMapI start)
+inline TableIterator::TableIterator(Table *parent, TBMapI start, TBMap *deletingFrom)
     :
       m_table(parent),
       m_blockIterator(start),
@@ -146,6 +201,7 @@ inline TableIterator::TableIterator(Table *parent, TBMapI start)
       m_activeTuples((int) m_table->m_tupleCount),
       m_foundTuples(0), m_tupleLength(parent->m_tupleLength),
       m_tuplesPerBlock(parent->m_tuplesPerBlock), m_currentBlock(NULL),
+      m_deletingFrom(deletingFrom),
       m_tempTableIterator(false)
     {
     }
@@ -160,6 +216,7 @@ inline void TableIterator::reset(std::vector<TBPtr>::iterator start) {
     m_tupleLength = m_table->m_tupleLength;
     m_tuplesPerBlock = m_table->m_tuplesPerBlock;
     m_currentBlock = NULL;
+    m_heldBlock.reset();
 }
 
 inline void TableIterator::reset(TBMapI start) {
@@ -172,6 +229,7 @@ inline void TableIterator::reset(TBMapI start) {
     m_tupleLength = m_table->m_tupleLength;
     m_tuplesPerBlock = m_table->m_tuplesPerBlock;
     m_currentBlock = NULL;
+    m_heldBlock.reset();
 }
 
 inline bool TableIterator::hasNext() {
@@ -195,8 +253,16 @@ inline bool TableIterator::persistentNext(TableTuple &out) {
 //            if (m_blockIterator == m_table->m_data.end()) {
 //                throwFatalException("Could not find the expected number of tuples during a table scan");
 //            }
+            if (m_deletingFrom != NULL && m_currentBlock != NULL) {
+                // The scan may have deleted the block it was on, which
+                // can move the other blocks around in the map
+                m_blockIterator = m_deletingFrom->upper_bound(m_currentBlock->address());
+            }
             m_dataPtr = m_blockIterator.key();
-            m_currentBlock = m_blockIterator.data();
+            m_currentBlock = m_blockIterator.data().get();
+            if (m_deletingFrom != NULL) {
+                m_heldBlock = m_blockIterator.data();
+            }
             m_blockOffset = 0;
             m_blockIterator++;
         } else {
@@ -204,8 +270,8 @@ inline bool TableIterator::persistentNext(TableTuple &out) {
         }
         assert (out.sizeInValues() == m_table->columnCount());
         out.move(m_dataPtr);
-        assert(m_dataPtr < m_currentBlock.get()->address() + m_table->m_tableAllocationTargetSize);
-        assert(m_dataPtr < m_currentBlock.get()->address() + (m_table->m_tupleLength * m_table->m_tuplesPerBlock));
+        assert(m_dataPtr < m_currentBlock->address() + m_table->m_tableAllocationSize);
+        assert(m_dataPtr < m_currentBlock->address() + (m_table->m_tupleLength * m_table->m_tuplesPerBlock));
         //assert(m_foundTuples == m_location);
         ++m_location;
         ++m_blockOffset;
@@ -232,7 +298,7 @@ inline bool TableIterator::tempNext(TableTuple &out) {
         if (m_currentBlock == NULL ||
             m_blockOffset >= m_currentBlock->unusedTupleBoundry())
         {
-            m_currentBlock = *m_tempBlockIterator;
+            m_currentBlock = m_tempBlockIterator->get();
             m_dataPtr = m_currentBlock->address();
             m_blockOffset = 0;
             m_tempBlockIterator++;
@@ -241,8 +307,8 @@ inline bool TableIterator::tempNext(TableTuple &out) {
         }
         assert (out.sizeInValues() == m_table->columnCount());
         out.move(m_dataPtr);
-        assert(m_dataPtr < m_currentBlock.get()->address() + m_table->m_tableAllocationTargetSize);
-        assert(m_dataPtr < m_currentBlock.get()->address() + (m_table->m_tupleLength * m_table->m_tuplesPerBlock));
+        assert(m_dataPtr < m_currentBlock->address() + m_table->m_tableAllocationSize);
+        assert(m_dataPtr < m_currentBlock->address() + (m_table->m_tupleLength * m_table->m_tuplesPerBlock));
 
 
         //assert(m_foundTuples == m_location);
@@ -259,6 +325,30 @@ inline bool TableIterator::tempNext(TableTuple &out) {
     return false;
 }
 
+inline bool TableIterator::nextBlock(TupleBlockSpan &span) {
+    if (m_foundTuples >= m_activeTuples) {
+        return false;
+    }
+    TupleBlock *block;
+    if (m_tempTableIterator) {
+        block = m_tempBlockIterator->get();
+        ++m_tempBlockIterator;
+        span.address = block->address();
+        span.dense = true;
+    }
+    else {
+        span.address = m_blockIterator.key();
+        block = m_blockIterator.data().get();
+        ++m_blockIterator;
+        span.dense = false;
+    }
+    span.tupleLength = m_tupleLength;
+    span.count = block->unusedTupleBoundry();
+    m_location += span.count;
+    m_foundTuples += m_tempTableIterator ? span.count : block->activeTuples();
+    return true;
+}
+
 inline int TableIterator::getLocation() const {
     return m_location;
 }
@@ -45,15 +45,15 @@
 
 #include "temptable.h"
 #include "common/debuglog.h"
-
-#define TABLE_BLOCKSIZE 131072
+#include "storage/TempBlockPool.h"
 
 namespace voltdb {
 
 TempTable::TempTable()
-  : Table(TABLE_BLOCKSIZE),
+  : Table(TEMP_TABLE_BLOCK_SIZE),
     m_iter(this, m_data.begin()),
-    m_limits(NULL)
+    m_limits(NULL),
+    m_spillSink(NULL)
 {
 }
 
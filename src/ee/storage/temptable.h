@@ -58,6 +58,29 @@ namespace voltdb {
 class TableColumn;
 class TableFactory;
 class TableStats;
+class TempTable;
+
+/**
+ * An executor that can put its input aside in scratch files, so that the
+ * input need not be held in memory all at once. Registered on its input
+ * temp table, it gets the table's tuples whenever the table is about to
+ * grow past its spill threshold (see TempTableLimits::shouldSpill), so
+ * spilling starts while the child executor is still producing the input.
+ */
+class TempTableSpillSink {
+  public:
+    virtual ~TempTableSpillSink() {}
+
+    /**
+     * Put aside every tuple of table, which is emptied afterwards.
+     */
+    virtual void spillTuples(TempTable *table) = 0;
+
+    /**
+     * Drop the tuples put aside so far, as the table is being cleared.
+     */
+    virtual void discardSpilledTuples() = 0;
+};
 
 /**
  * Represents a Temporary Table to store temporary result (final
@@ -130,6 +153,12 @@ class TempTable : public Table {
 
     bool isTempTableEmpty() { return m_tupleCount == 0; }
 
+    /**
+     * Hand the tuples over to sink, when there are more than the spill
+     * threshold allows, instead of allocating another block.
+     */
+    void setSpillSink(TempTableSpillSink *sink) { m_spillSink = sink; }
+
     int64_t tempTableTupleCount() const { return m_tupleCount; }
 
     // ------------------------------------------------------------------
@@ -163,8 +192,12 @@ class TempTable : public Table {
     };
 
   private:
+    void clearTuples(bool freeAllocatedStrings);
+
     // pointers to chunks of data. Specific to table impl. Don't leak this type.
     std::vector<TBPtr> m_data;
+
+    TempTableSpillSink *m_spillSink;
 };
 
 inline void TempTable::insertTupleNonVirtualWithDeepCopy(TableTuple &source, Pool *pool) {
@@ -204,6 +237,14 @@ inline void TempTable::insertTempTuple(TableTuple &source) {
 }
 
 inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
+    // Tuples the sink put aside are part of the contents being deleted.
+    if (m_spillSink != NULL) {
+        m_spillSink->discardSpilledTuples();
+    }
+    clearTuples(freeAllocatedStrings);
+}
+
+inline void TempTable::clearTuples(bool freeAllocatedStrings) {
 
     if (m_tupleCount == 0) {
         return;
@@ -236,7 +277,7 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
 }
 
 inline TBPtr TempTable::allocateNextBlock() {
-    TBPtr block(new (ThreadLocalPool::getExact(sizeof(TupleBlock))->malloc()) TupleBlock(this, TBBucketPtr()));
+    TBPtr block(new (ThreadLocalPool::getExact(sizeof(TupleBlock))->malloc()) TupleBlock(this, TBBucketPtr(), true));
     m_data.push_back(block);
 
     if (m_limits) {
@@ -254,7 +295,17 @@ inline void TempTable::nextFreeTuple(TableTuple *tuple) {
 
     TBPtr block = m_data.back();
     if (!block->hasFreeTuples()) {
-        block = allocateNextBlock();
+        if (m_spillSink != NULL && m_limits != NULL &&
+            m_limits->shouldSpill(static_cast<int64_t>(m_data.size() + 1) * m_tableAllocationSize)) {
+            // Every tuple so far is complete; let the sink have them all
+            // and start over in the first block.
+            m_spillSink->spillTuples(this);
+            clearTuples(false);
+            block = m_data.back();
+        }
+        else {
+            block = allocateNextBlock();
+        }
     }
 
     std::pair<char*, int> pair = block->nextFreeTuple();
@@ -20,6 +20,7 @@
 
 #include <cstdlib>
 #include <utility>
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <iostream>
@@ -167,6 +168,10 @@ namespace voltdb {
         bool erase(const Key &key, const Data &value);
         /** delete from iterator */
         bool erase(iterator &iter);
+        /** remove everything and shrink back to the initial bucket count */
+        void clear();
+        /** exchange entries with another table of the same type without rehashing */
+        void swap(CompactingHashTable &other);
         /** STL-ish size() method */
         size_t size() const { return m_count; }
 
@@ -280,6 +285,43 @@ namespace voltdb {
         // free the memory used for nodes
     }
 
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::clear() {
+        // Only visit the nodes when keys or values need their destructors run.
+        if (!boost::has_trivial_destructor<Key>::value || !boost::has_trivial_destructor<Data>::value) {
+            for (size_t i = 0; i < TABLE_SIZES[m_sizeIndex]; ++i) {
+                for (HashNode *node = m_buckets[i]; node; node = node->nextInBucket) {
+                    for (HashNode *keyNode = node; keyNode; keyNode = m_unique ? NULL : keyNode->nextWithKey) {
+                        keyNode->key.~Key();
+                        keyNode->value.~Data();
+                    }
+                }
+            }
+        }
+
+        // start over with a fresh, zeroed bucket array of the initial size
+        munmap(m_buckets, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
+        m_sizeIndex = BUCKET_INITIAL_INDEX;
+        void *memory = mmap(NULL, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex], PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        assert(memory);
+        m_buckets = reinterpret_cast<HashNode**>(memory);
+        memset(m_buckets, 0, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
+
+        m_count = 0;
+        m_uniqueCount = 0;
+        m_allocator.clear();
+    }
+
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::swap(CompactingHashTable &other) {
+        assert(m_unique == other.m_unique);
+        std::swap(m_buckets, other.m_buckets);
+        std::swap(m_count, other.m_count);
+        std::swap(m_uniqueCount, other.m_uniqueCount);
+        std::swap(m_sizeIndex, other.m_sizeIndex);
+        m_allocator.swap(other.m_allocator);
+    }
+
     template<class K, class T, class H, class EK, class ET>
     typename CompactingHashTable<K, T, H, EK, ET>::iterator CompactingHashTable<K, T, H, EK, ET>::find(const Key &key) const {
         uint64_t hash = m_hasher(key);
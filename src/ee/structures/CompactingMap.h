@@ -23,6 +23,9 @@
 #include <utility>
 #include <limits>
 #include <cassert>
+#include <vector>
+#include <algorithm>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 #include "ContiguousAllocator.h"
 
 typedef u_int32_t NodeCount;
@@ -97,6 +100,15 @@ protected:
     // follows STL conventions
     Compare m_comper;
 
+    // orders entries by key for bulkLoad
+    struct EntryLess {
+        EntryLess(const Compare &comper) : m_comper(comper) {}
+        bool operator()(const std::pair<Key, Data> &lhs, const std::pair<Key, Data> &rhs) const {
+            return m_comper(lhs.first, rhs.first) < 0;
+        }
+        const Compare &m_comper;
+    };
+
 public:
 
     class iterator {
@@ -126,8 +138,14 @@ public:
     bool insert(std::pair<Key, Data> value);
     // A syntactically convenient analog to CompactingHashTable's insert function
     bool insert(const Key &key, const Data &data) { return insert(std::pair<Key, Data>(key, data)); }
+    // Fill an empty map in one pass, see the definition
+    bool bulkLoad(std::vector<std::pair<Key, Data> > &entries);
     bool erase(const Key &key);
     bool erase(iterator &iter);
+    void clear();
+    // Exchange entries with another map of the same type in O(n) pointer
+    // fixups, without comparing or reallocating anything
+    void swap(CompactingMap &other);
     iterator find(const Key &key) { return iterator(this, lookup(key)); }
     iterator findRank(int64_t ith) { return iterator(this, lookupRank(ith)); }
     int64_t size() const { return m_count; }
@@ -151,6 +169,9 @@ public:
     // Must pass a key that already in map, or else return -1
     int64_t rankAsc(const Key& key);
     int64_t rankUpper(const Key& key);
+    // Rank of the entry under the iterator itself, so exact among duplicates,
+    // or -1 if the map keeps no ranks or the iterator is at the end
+    int64_t rankOf(const iterator &iter) const;
 
     /**
      * For debugging: verify the RB-tree constraints are met. SLOW.
@@ -176,11 +197,14 @@ protected:
     TreeNode *predecessor(const TreeNode *x) const;
 
     // sub functions to make the magic happen
+    TreeNode *buildBalanced(TreeNode **nodes, int64_t count, TreeNode *parent,
+                            int depth, int redDepth);
     void leftRotate(TreeNode *x);
     void rightRotate(TreeNode *x);
     void insertFixup(TreeNode *z);
     void deleteFixup(TreeNode *x);
     void fragmentFixup(TreeNode *x);
+    void adoptNodes(TreeNode *node, const TreeNode *otherNil);
 
     // debugging and testing methods
     bool isReachableNode(const TreeNode* start, const TreeNode *dest) const;
@@ -214,6 +238,57 @@ CompactingMap<Key, Data, Compare, hasRank>::~CompactingMap() {
     }
 }
 
+/**
+ * Remove every entry without rebalancing. Nodes are only visited when the
+ * key or value type needs its destructor run; otherwise the allocator's
+ * buffers are simply released.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::clear() {
+    if (!boost::has_trivial_destructor<Key>::value || !boost::has_trivial_destructor<Data>::value) {
+        iterator iter = begin();
+        while (!iter.isEnd()) {
+            iter.key().~Key();
+            iter.value().~Data();
+            iter.moveNext();
+        }
+    }
+    m_root = &NIL;
+    m_count = 0;
+    m_allocator.clear();
+}
+
+/**
+ * The nodes stay where they are in the allocator buffers, which change
+ * hands. Only the links to each map's NIL sentinel have to be redirected.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::swap(CompactingMap &other) {
+    assert(m_unique == other.m_unique);
+    std::swap(m_count, other.m_count);
+    std::swap(m_root, other.m_root);
+    m_allocator.swap(other.m_allocator);
+    if (m_root == &other.NIL) {
+        m_root = &NIL;
+    } else {
+        adoptNodes(m_root, &other.NIL);
+    }
+    if (other.m_root == &NIL) {
+        other.m_root = &other.NIL;
+    } else {
+        other.adoptNodes(other.m_root, &NIL);
+    }
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::adoptNodes(TreeNode *node, const TreeNode *otherNil) {
+    if (node->parent == otherNil) node->parent = &NIL;
+    if (node->left == otherNil) node->left = &NIL;
+    else adoptNodes(node->left, otherNil);
+    if (node->right == otherNil) node->right = &NIL;
+    else adoptNodes(node->right, otherNil);
+}
+
 template<typename Key, typename Data, typename Compare, bool hasRank>
 bool CompactingMap<Key, Data, Compare, hasRank>::erase(const Key &key) {
     TreeNode *node = lookup(key);
@@ -301,6 +376,74 @@ bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> val
     return true;
 }
 
+/**
+ * Sort the entries and build the tree from them directly, instead of
+ * descending and rebalancing once per entry. Nodes are allocated in key
+ * order and linked into a tree that is full on every level but the
+ * deepest, which is colored red so that every path sees the same number
+ * of black nodes.
+ *
+ * The map must be empty. Returns false, leaving it empty, if the map is
+ * unique and two of the entries have equal keys.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingMap<Key, Data, Compare, hasRank>::bulkLoad(std::vector<std::pair<Key, Data> > &entries) {
+    assert(m_count == 0);
+    std::sort(entries.begin(), entries.end(), EntryLess(m_comper));
+
+    int64_t count = static_cast<int64_t>(entries.size());
+    if (m_unique) {
+        for (int64_t i = 1; i < count; ++i) {
+            if (m_comper(entries[i - 1].first, entries[i].first) == 0) {
+                return false;
+            }
+        }
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    std::vector<TreeNode*> nodes(count);
+    for (int64_t i = 0; i < count; ++i) {
+        void *memory = m_allocator.alloc();
+        assert(memory);
+        // placement new
+        TreeNode *z = new(memory) TreeNode();
+        z->key = entries[i].first;
+        z->value = entries[i].second;
+        nodes[i] = z;
+    }
+
+    // depth of the deepest level, left black when it is the root
+    int deepest = 0;
+    while ((static_cast<int64_t>(2) << deepest) <= count) {
+        ++deepest;
+    }
+    m_root = buildBalanced(&nodes[0], count, &NIL, 0, deepest == 0 ? -1 : deepest);
+    m_count = count;
+    assert(m_allocator.count() == m_count);
+    return true;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *
+CompactingMap<Key, Data, Compare, hasRank>::buildBalanced(TreeNode **nodes, int64_t count, TreeNode *parent,
+                                                          int depth, int redDepth) {
+    if (count == 0) {
+        return &NIL;
+    }
+    int64_t middle = count / 2;
+    TreeNode *x = nodes[middle];
+    x->parent = parent;
+    x->color = (depth == redDepth) ? RED : BLACK;
+    x->left = buildBalanced(nodes, middle, x, depth + 1, redDepth);
+    x->right = buildBalanced(nodes + middle + 1, count - middle - 1, x, depth + 1, redDepth);
+    if (hasRank) {
+        x->subct = static_cast<NodeCount>(count);
+    }
+    return x;
+}
+
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::iterator CompactingMap<Key, Data, Compare, hasRank>::lowerBound(const Key &key) {
     TreeNode *x = m_root;
@@ -786,6 +929,21 @@ int64_t CompactingMap<Key, Data, Compare, hasRank>::rankUpper(const Key& key) {
     return rankAsc(it.key()) - 1;
 }
 
+template<typename Key, typename Data, typename Compare, bool hasRank>
+int64_t CompactingMap<Key, Data, Compare, hasRank>::rankOf(const iterator &iter) const {
+    if (!hasRank || iter.isEnd()) return -1;
+    const TreeNode *p = iter.m_node;
+    int64_t ct = getSubct(p->left) + 1;
+    // every left subtree we climb out of from its right holds smaller entries
+    while (p->parent != &NIL) {
+        if (p->parent->right == p) {
+            ct += getSubct(p->parent->left) + 1;
+        }
+        p = p->parent;
+    }
+    return ct;
+}
+
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::lookupRank(int64_t ith) {
     if (!hasRank) return &NIL;
@@ -17,6 +17,7 @@
 
 #include "ContiguousAllocator.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace voltdb;
@@ -25,11 +26,7 @@ ContiguousAllocator::ContiguousAllocator(int32_t allocSize, int32_t chunkSize)
 : m_count(0), m_allocSize(allocSize), m_chunkSize(chunkSize), m_tail(NULL), m_blockCount(0) {}
 
 ContiguousAllocator::~ContiguousAllocator() {
-    while (m_tail) {
-        Buffer *buf = m_tail->prev;
-        free(m_tail);
-        m_tail = buf;
-    }
+    clear();
 }
 
 void *ContiguousAllocator::alloc() {
@@ -88,6 +85,32 @@ void ContiguousAllocator::trim() {
     }
 }
 
+/**
+ * Release every buffer at once. Callers are responsible for having
+ * destroyed anything that lived in the allocations.
+ */
+void ContiguousAllocator::clear() {
+    while (m_tail) {
+        Buffer *buf = m_tail->prev;
+        free(m_tail);
+        m_tail = buf;
+    }
+    m_count = 0;
+    m_blockCount = 0;
+}
+
+/**
+ * Exchange buffers with an allocator of the same geometry. The
+ * allocations do not move.
+ */
+void ContiguousAllocator::swap(ContiguousAllocator &other) {
+    assert(m_allocSize == other.m_allocSize);
+    assert(m_chunkSize == other.m_chunkSize);
+    std::swap(m_count, other.m_count);
+    std::swap(m_tail, other.m_tail);
+    std::swap(m_blockCount, other.m_blockCount);
+}
+
 size_t ContiguousAllocator::bytesAllocated() const {
     size_t total = static_cast<size_t>(m_blockCount) *
         static_cast<size_t>(m_allocSize) *
@@ -52,6 +52,8 @@ public:
     void *alloc();
     void *last() const;
     void trim();
+    void clear();
+    void swap(ContiguousAllocator &other);
     int64_t count() const { return m_count; }
 
     size_t bytesAllocated() const;
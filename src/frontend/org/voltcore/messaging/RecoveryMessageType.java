@@ -41,5 +41,9 @@ public enum RecoveryMessageType {
     /*
      * Not used in the EE. Sites receiving blocks of data ack them with this message
      */
-    Ack;
+    Ack,
+    /*
+     * Message containing freshly scanned tuples as raw tuple images
+     */
+    ScanTupleImages;
 }
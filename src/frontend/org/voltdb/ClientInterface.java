@@ -29,10 +29,12 @@ import java.nio.channels.ServerSocketChannel;
 import java.nio.channels.SocketChannel;
 import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.Collections;
 import java.util.HashMap;
 import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
+import java.util.Set;
 import java.util.concurrent.Callable;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.CopyOnWriteArrayList;
@@ -127,6 +129,7 @@ public class ClientInterface implements SnapshotDaemon.DaemonInitiator {
     public static final long RESTORE_AGENT_CID          = Long.MIN_VALUE + 1;
     public static final long SNAPSHOT_UTIL_CID          = Long.MIN_VALUE + 2;
     public static final long ELASTIC_JOIN_CID           = Long.MIN_VALUE + 3;
+    public static final long TTL_PURGE_CID              = Long.MIN_VALUE + 4;
     // Leave CL_REPLAY_BASE_CID at the end, it uses this as a base and generates more cids
     public static final long CL_REPLAY_BASE_CID         = Long.MIN_VALUE + 100;
 
@@ -140,6 +143,14 @@ public class ClientInterface implements SnapshotDaemon.DaemonInitiator {
     private final SnapshotDaemon m_snapshotDaemon = new SnapshotDaemon();
     private final SnapshotDaemonAdapter m_snapshotDaemonAdapter = new SnapshotDaemonAdapter();
 
+    // how many expired rows one @PurgeExpiredTuples transaction deletes
+    private static final long TTL_PURGE_TUPLES_PER_TXN = Long.getLong("TTL_PURGE_TUPLES_PER_TXN", 1000);
+    private final SimpleClientResponseAdapter m_ttlPurgeAdapter =
+            new SimpleClientResponseAdapter(TTL_PURGE_CID, "TimeToLivePurgeAdapter");
+    // partitions led from this host with a purge in flight
+    private final Set<Integer> m_ttlPurgesInFlight =
+            Collections.newSetFromMap(new ConcurrentHashMap<Integer, Boolean>());
+
     // Atomically allows the catalog reference to change between access
     private final AtomicReference<CatalogContext> m_catalogContext = new AtomicReference<CatalogContext>(null);
 
@@ -2111,6 +2122,92 @@ public class ClientInterface implements SnapshotDaemon.DaemonInitiator {
                 }
             }
         }, 200, 200, TimeUnit.MILLISECONDS);
+
+        bindAdapter(m_ttlPurgeAdapter);
+        VoltDB.instance().scheduleWork(new Runnable() {
+            @Override
+            public void run() {
+                try {
+                    purgeExpiredTuples();
+                } catch (Exception ex) {
+                    log.warn("Exception while purging expired rows", ex);
+                }
+            }
+        }, 1, 1, TimeUnit.SECONDS);
+    }
+
+    /**
+     * Start a single partition @PurgeExpiredTuples at each partition led
+     * from this host that has none in flight, if any table has a time to
+     * live. Each purge deletes a bounded batch inside its own transaction,
+     * so it is undone on rollback and never holds up a partition for long.
+     */
+    private void purgeExpiredTuples() {
+        if (VoltDB.instance().getMode() != OperationMode.RUNNING ||
+            VoltDB.instance().getReplicationRole() == ReplicationRole.REPLICA) {
+            return;
+        }
+        boolean hasTimeToLive = false;
+        for (Table table : m_catalogContext.get().database.getTables()) {
+            hasTimeToLive = hasTimeToLive || table.getTtlseconds() > 0;
+        }
+        if (!hasTimeToLive) {
+            return;
+        }
+
+        final int thisHostId = CoreUtils.getHostIdFromHSId(m_mailbox.getHSId());
+        VoltTable partitionKeys = TheHashinator.getPartitionKeys(VoltType.INTEGER);
+        for (int i = 0; i < partitionKeys.getRowCount(); i++) {
+            VoltTableRow row = partitionKeys.fetchRow(i);
+            final int partition = (int) row.getLong(0);
+            final int partitionKey = (int) row.getLong(1);
+            if (CoreUtils.getHostIdFromHSId(m_cartographer.getHSIdForSinglePartitionMaster(partition)) ==
+                    thisHostId && m_ttlPurgesInFlight.add(partition)) {
+                initiatePurgeExpiredTuples(partition, partitionKey);
+            }
+        }
+    }
+
+    /**
+     * Purge one batch at the partition, and another right away while
+     * batches come back full.
+     */
+    private void initiatePurgeExpiredTuples(final int partition, final int partitionKey) {
+        StoredProcedureInvocation spi = new StoredProcedureInvocation();
+        spi.procName = "@PurgeExpiredTuples";
+        spi.params = new FutureTask<ParameterSet>(new Callable<ParameterSet>() {
+            @Override
+            public ParameterSet call() {
+                return ParameterSet.fromArrayNoCopy(partitionKey, TTL_PURGE_TUPLES_PER_TXN);
+            }
+        });
+        spi.clientHandle = m_ttlPurgeAdapter.registerCallback(new SimpleClientResponseAdapter.Callback() {
+            @Override
+            public void handleResponse(ClientResponse response) {
+                boolean more = false;
+                if (response.getStatus() == ClientResponse.SUCCESS) {
+                    more = response.getResults()[0].asScalarLong() >= TTL_PURGE_TUPLES_PER_TXN;
+                } else {
+                    log.warn("Failed to purge expired rows at partition " + partition + ": " +
+                             response.getStatusString());
+                }
+                if (!more) {
+                    m_ttlPurgesInFlight.remove(partition);
+                    return;
+                }
+                VoltDB.instance().scheduleWork(new Runnable() {
+                    @Override
+                    public void run() {
+                        initiatePurgeExpiredTuples(partition, partitionKey);
+                    }
+                }, 0, 0, TimeUnit.MILLISECONDS);
+            }
+        });
+        if (!createTransaction(m_ttlPurgeAdapter.connectionId(), spi, false, true, false,
+                               partition, 0, EstTime.currentTimeMillis())) {
+            // try again on the next round
+            m_ttlPurgesInFlight.remove(partition);
+        }
     }
 
     private static final long CLIENT_HANGUP_TIMEOUT = Long.getLong("CLIENT_HANGUP_TIMEOUT", 4000);
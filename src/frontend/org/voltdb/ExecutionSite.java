@@ -1698,6 +1698,26 @@ implements Runnable, SiteProcedureConnection, SiteSnapshotConnection
         throw new UnsupportedOperationException();
     }
 
+    @Override
+    public boolean saveTableImage(int tableId, String path) {
+        throw new UnsupportedOperationException();
+    }
+
+    @Override
+    public boolean restoreTableImage(String path) {
+        throw new UnsupportedOperationException();
+    }
+
+    @Override
+    public long purgeExpiredTuples(long timeInMillis, long maxTuples) {
+        throw new UnsupportedOperationException();
+    }
+
+    @Override
+    public void buildDeferredIndexes() {
+        throw new UnsupportedOperationException();
+    }
+
     @Override
     public void setBatch(int batchIndex) {}
 
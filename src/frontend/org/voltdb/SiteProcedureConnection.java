@@ -179,4 +179,17 @@ public interface SiteProcedureConnection {
 
     public void updateHashinator(HashinatorConfig config);
     public long[] validatePartitioning(long tableIds[], int hashinatorType, byte hashinatorConfig[]);
+
+    // Table images, the tuple storage of a table saved to a local file
+    // and mapped back into an empty table with the same layout
+    public boolean saveTableImage(int tableId, String path);
+    public boolean restoreTableImage(String path);
+
+    // Delete up to maxTuples rows that have outlived their table's time
+    // to live at the given time, undone if the transaction rolls back
+    public long purgeExpiredTuples(long timeInMillis, long maxTuples);
+
+    // Build the indexes of the tables a rejoin snapshot loaded without
+    // them, once its last chunk is in
+    public void buildDeferredIndexes();
 }
@@ -145,6 +145,7 @@ public class SystemProcedureCatalog {
         builder.put("@LoadSinglepartitionTable",new Config("org.voltdb.sysprocs.LoadSinglepartitionTable", true,  false, false, 0, VoltType.VARBINARY, false, false, false, false));
         builder.put("@Promote",                 new Config("org.voltdb.sysprocs.Promote",                  false, false, true,  0, VoltType.INVALID,   false, false, true,  true));
         builder.put("@ValidatePartitioning",    new Config("org.voltdb.sysprocs.ValidatePartitioning",     false, false, false, 0, VoltType.INVALID,   false, false, true,  true));
+        builder.put("@PurgeExpiredTuples",      new Config("org.voltdb.sysprocs.PurgeExpiredTuples",       true,  false, false, 0, VoltType.INTEGER,   false, false, false, false));
         builder.put("@GetHashinatorConfig",     new Config("org.voltdb.sysprocs.GetHashinatorConfig",      false, true,  false, 0, VoltType.INVALID,   true,  false, true,  true));
         listing = builder.build();
     }
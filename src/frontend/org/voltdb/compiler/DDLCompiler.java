@@ -351,6 +351,25 @@ public class DDLCompiler {
             "([\\w.$]+)" +                      // (1) <table name>
             "\\s*;\\z"                          // (end statement)
             );
+
+    /**
+     * EXPIRE TABLE statement regex
+     * NB supports only unquoted table and column names
+     * Capture groups are tagged as (1), (2) and (3) in comments below.
+     */
+    static final Pattern expirePattern = Pattern.compile(
+            "(?i)" +                            // (ignore case)
+            "\\A"  +                            // start statement
+            "EXPIRE\\s+TABLE\\s+" +             // EXPIRE TABLE
+            "([\\w$]+)" +                       // (1) <table name>
+            "\\s+ON\\s+COLUMN\\s+" +            // ON COLUMN
+            "([\\w$]+)" +                       // (2) <column name>
+            "\\s+AFTER\\s+" +                   // AFTER
+            "(\\d+)" +                          // (3) <seconds>
+            "\\s+SECONDS" +                     // SECONDS
+            "\\s*;\\z"                          // (end statement)
+            );
+
     /**
      * Regex Description:
      *
@@ -376,12 +395,15 @@ public class DDLCompiler {
      *      | -- or
      *      \\A -- beginning of statement
      *      EXPORT -- token
+     *      | -- or
+     *      \\A -- beginning of statement
+     *      EXPIRE -- token
      * \\s -- one space
      * </pre>
      */
     static final Pattern voltdbStatementPrefixPattern = Pattern.compile(
             "(?i)((?<=\\ACREATE\\s{0,1024})" +
-            "(?:PROCEDURE|ROLE)|\\APARTITION|\\AREPLICATE|\\AEXPORT|\\AIMPORT)\\s"
+            "(?:PROCEDURE|ROLE)|\\APARTITION|\\AREPLICATE|\\AEXPORT|\\AIMPORT|\\AEXPIRE)\\s"
             );
 
     static final String TABLE = "TABLE";
@@ -389,6 +411,7 @@ public class DDLCompiler {
     static final String PARTITION = "PARTITION";
     static final String REPLICATE = "REPLICATE";
     static final String EXPORT = "EXPORT";
+    static final String EXPIRE = "EXPIRE";
     static final String ROLE = "ROLE";
 
     enum Permission {
@@ -567,7 +590,7 @@ public class DDLCompiler {
             return false;
         }
 
-        // either PROCEDURE, REPLICATE, PARTITION, ROLE, or EXPORT
+        // either PROCEDURE, REPLICATE, PARTITION, ROLE, EXPORT, or EXPIRE
         String commandPrefix = statementMatcher.group(1).toUpperCase();
 
         // matches if it is CREATE PROCEDURE [ALLOW <role> ...] FROM CLASS <class-name>;
@@ -811,6 +834,29 @@ public class DDLCompiler {
             return true;
         }
 
+        // matches if it is EXPIRE TABLE <table> ON COLUMN <column> AFTER <seconds> SECONDS
+        statementMatcher = expirePattern.matcher(statement);
+        if( statementMatcher.matches()) {
+            String tableName = checkIdentifierStart(statementMatcher.group(1), statement);
+            String columnName = checkIdentifierStart(statementMatcher.group(2), statement);
+            int seconds = 0;
+            try {
+                seconds = Integer.parseInt(statementMatcher.group(3));
+            }
+            catch (NumberFormatException ex) {
+                // too many digits, reported below
+            }
+            if (seconds < 1) {
+                throw m_compiler.new VoltCompilerException(String.format(
+                        "Invalid EXPIRE TABLE statement: \"%s\", " +
+                        "the time to live must be from 1 to %d seconds",
+                        statement.substring(0,statement.length()-1), Integer.MAX_VALUE));
+            }
+            m_tracker.addTimeToLive(tableName, columnName, seconds);
+
+            return true;
+        }
+
         /*
          * if no correct syntax regex matched above then at this juncture
          * the statement is syntax incorrect
@@ -855,6 +901,13 @@ public class DDLCompiler {
                     statement.substring(0,statement.length()-1))); // remove trailing semicolon
         }
 
+        if( EXPIRE.equals(commandPrefix)) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Invalid EXPIRE TABLE statement: \"%s\", " +
+                    "expected syntax: EXPIRE TABLE <table> ON COLUMN <column> AFTER <seconds> SECONDS",
+                    statement.substring(0,statement.length()-1))); // remove trailing semicolon
+        }
+
         // Not a VoltDB-specific DDL statement.
         return false;
     }
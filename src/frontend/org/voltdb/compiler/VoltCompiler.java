@@ -91,6 +91,7 @@ import org.voltdb.compilereport.ReportMaker;
 import org.voltdb.expressions.AbstractExpression;
 import org.voltdb.expressions.TupleValueExpression;
 import org.voltdb.types.ConstraintType;
+import org.voltdb.types.IndexType;
 import org.voltdb.utils.CatalogUtil;
 import org.voltdb.utils.Encoder;
 import org.voltdb.utils.InMemoryJarfile;
@@ -854,6 +855,51 @@ public class VoltCompiler {
             }
         }
 
+        // Handle the time to live of the tables named by EXPIRE TABLE
+        for (String tableName : voltDdlTracker.m_ttlColumnMap.keySet()) {
+            final Table table = tables.getIgnoreCase(tableName);
+            if (table == null) {
+                msg += "EXPIRE TABLE has unknown TABLE '" + tableName + "'";
+                throw new VoltCompilerException(msg);
+            }
+            // expired rows are purged by a transaction at each partition
+            if (table.getIsreplicated()) {
+                msg += "EXPIRE TABLE '" + table.getTypeName() + "' is replicated; only partitioned " +
+                    "tables can expire rows.";
+                throw new VoltCompilerException(msg);
+            }
+            String colName = voltDdlTracker.m_ttlColumnMap.get(tableName);
+            final Column ttlCol = table.getColumns().getIgnoreCase(colName);
+            if (ttlCol == null) {
+                msg += "EXPIRE TABLE has unknown COLUMN '" + colName + "'";
+                throw new VoltCompilerException(msg);
+            }
+            if (VoltType.get((byte) ttlCol.getType()) != VoltType.TIMESTAMP) {
+                msg += "Time to live column '" + table.getTypeName() + "." + colName + "' is not a TIMESTAMP.";
+                throw new VoltCompilerException(msg);
+            }
+            // expired rows are found oldest first through a tree index led by the column
+            boolean hasTimestampIndex = false;
+            for (Index index : table.getIndexes()) {
+                if (index.getType() != IndexType.BALANCED_TREE.getValue() ||
+                    ! index.getExpressionsjson().isEmpty()) {
+                    continue;
+                }
+                for (ColumnRef cref : index.getColumns()) {
+                    if (cref.getIndex() == 0 && cref.getColumn().equals(ttlCol)) {
+                        hasTimestampIndex = true;
+                    }
+                }
+            }
+            if ( ! hasTimestampIndex) {
+                msg += "Time to live column '" + table.getTypeName() + "." + colName + "' needs a tree " +
+                    "index that starts with it.";
+                throw new VoltCompilerException(msg);
+            }
+            table.setTtlcolumn(ttlCol);
+            table.setTtlseconds(voltDdlTracker.m_ttlSecondsMap.get(tableName));
+        }
+
         // add database estimates info
         addDatabaseEstimatesInfo(m_estimates, db);
 
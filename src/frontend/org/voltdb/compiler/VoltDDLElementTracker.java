@@ -40,6 +40,9 @@ public class VoltDDLElementTracker {
     final Map<String, ProcedureDescriptor> m_procedureMap =
             new HashMap<String, ProcedureDescriptor>();
     final Set<String> m_exports = new HashSet<String>();
+    // time to live column and seconds by table name, from EXPIRE TABLE
+    final Map<String, String> m_ttlColumnMap = new HashMap<String, String>();
+    final Map<String, Integer> m_ttlSecondsMap = new HashMap<String, Integer>();
     // additional non-procedure classes for the jar
     String[] m_extraClassses = new String[0];
 
@@ -181,4 +184,31 @@ public class VoltDDLElementTracker {
         return m_exports;
     }
 
+    /**
+     * Track the time to live of a table from an EXPIRE TABLE statement
+     * @param tableName a table name
+     * @param colName the TIMESTAMP column its rows expire after
+     * @param seconds how many seconds after it they expire
+     * @throws VoltCompilerException when the table already has a time to
+     *   live or the time is not positive
+     */
+    void addTimeToLive(String tableName, String colName, int seconds)
+        throws VoltCompilerException
+    {
+        assert tableName != null && ! tableName.trim().isEmpty();
+        assert colName != null && ! colName.trim().isEmpty();
+
+        if (m_ttlColumnMap.containsKey(tableName.toLowerCase())) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Time to live already specified for table \"%s\"", tableName));
+        }
+        if (seconds <= 0) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Time to live for table \"%s\" must be at least one second", tableName));
+        }
+
+        m_ttlColumnMap.put(tableName.toLowerCase(), colName);
+        m_ttlSecondsMap.put(tableName.toLowerCase(), seconds);
+    }
+
 }
\ No newline at end of file
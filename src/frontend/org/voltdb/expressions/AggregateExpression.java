@@ -67,6 +67,9 @@ public class AggregateExpression extends AbstractExpression {
         switch (type) {
         case AGGREGATE_COUNT:
         case AGGREGATE_COUNT_STAR:
+        case AGGREGATE_ROW_NUMBER:
+        case AGGREGATE_RANK:
+        case AGGREGATE_DENSE_RANK:
             //
             // Always an integer
             //
@@ -172,6 +172,7 @@ public class ElasticJoinProducer extends JoinProducerBase implements TaskLog {
             }
 
             JOINLOG.debug(m_whoami + " data transfer is finished");
+            siteConnection.buildDeferredIndexes();
 
             if (m_snapshotCompletionMonitor.isDone()) {
                 try {
@@ -485,6 +485,26 @@ public class MpRoSite implements Runnable, SiteProcedureConnection
         throw new RuntimeException("RO MP Site doesn't do this, shouldn't be here.");
     }
 
+    @Override
+    public boolean saveTableImage(int tableId, String path) {
+        throw new RuntimeException("RO MP Site doesn't do this, shouldn't be here.");
+    }
+
+    @Override
+    public boolean restoreTableImage(String path) {
+        throw new RuntimeException("RO MP Site doesn't do this, shouldn't be here.");
+    }
+
+    @Override
+    public long purgeExpiredTuples(long timeInMillis, long maxTuples) {
+        throw new RuntimeException("RO MP Site doesn't do this, shouldn't be here.");
+    }
+
+    @Override
+    public void buildDeferredIndexes() {
+        throw new RuntimeException("RO MP Site doesn't do this, shouldn't be here.");
+    }
+
     @Override
     public void setBatch(int batchIndex) {
         // don't need to do anything here
@@ -287,6 +287,7 @@ public class RejoinProducer extends JoinProducerBase {
         } else {
             REJOINLOG.debug(m_whoami + "Rejoin snapshot transfer is finished");
             m_rejoinSiteProcessor.close();
+            siteConnection.buildDeferredIndexes();
 
             Preconditions.checkNotNull(m_streamSnapshotMb);
             VoltDB.instance().getHostMessenger().removeMailbox(m_streamSnapshotMb.getHSId());
@@ -66,6 +66,7 @@ import org.voltdb.catalog.CatalogMap;
 import org.voltdb.catalog.Cluster;
 import org.voltdb.catalog.Database;
 import org.voltdb.catalog.Table;
+import org.voltdb.common.Constants;
 import org.voltdb.dtxn.SiteTracker;
 import org.voltdb.dtxn.TransactionState;
 import org.voltdb.dtxn.UndoAction;
@@ -112,6 +113,11 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
 
     // Enumerate execution sites by host.
     private static final AtomicInteger siteIndexCounter = new AtomicInteger(0);
+    // Bytes of freed temp table block storage each EE keeps for reuse
+    private static final long TEMP_BLOCK_POOL_SIZE = Long.getLong("TEMP_BLOCK_POOL_SIZE", 8 * 1024 * 1024);
+    // Input bytes above which ORDER BY and hash aggregation spill to
+    // scratch files; negative to never spill
+    private static final long TEMP_TABLE_SPILL_THRESHOLD = Long.getLong("TEMP_TABLE_SPILL_THRESHOLD", -1);
     private final int m_siteIndex = siteIndexCounter.getAndIncrement();
 
     // Manages pending tasks.
@@ -460,6 +466,7 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
                             hashinatorConfig);
                 eeTemp.loadCatalog( timestamp, serializedCatalog);
             }
+            configureEE(eeTemp);
         }
         // just print error info an bail if we run into an error here
         catch (final Exception ex) {
@@ -471,6 +478,26 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
     }
 
 
+    /** Pass the EE the settings it takes after construction */
+    void configureEE(ExecutionEngine ee)
+    {
+        // All the sites of a host rejoin together, so each builds its
+        // indexes with its share of the cores.
+        int sitesPerHost = m_context.cluster.getDeployment().get("deployment").getSitesperhost();
+        int indexBuildThreads = Math.max(0, CoreUtils.availableProcessors() / Math.max(1, sitesPerHost) - 1);
+        ByteBuffer params = ByteBuffer.allocate(4);
+        params.putInt(indexBuildThreads);
+        ee.executeTask(TaskType.SET_INDEX_BUILD_THREADS, params.array());
+
+        params = ByteBuffer.allocate(8);
+        params.putLong(TEMP_BLOCK_POOL_SIZE);
+        ee.executeTask(TaskType.SET_TEMP_BLOCK_POOL_SIZE, params.array());
+
+        params = ByteBuffer.allocate(8);
+        params.putLong(TEMP_TABLE_SPILL_THRESHOLD);
+        ee.executeTask(TaskType.SET_TEMP_TABLE_SPILL_THRESHOLD, params.array());
+    }
+
     @Override
     public void run()
     {
@@ -1138,6 +1165,39 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
         return mispartitionedRows;
     }
 
+    @Override
+    public boolean saveTableImage(int tableId, String path) {
+        byte pathBytes[] = path.getBytes(Constants.UTF8ENCODING);
+        ByteBuffer paramBuffer = ByteBuffer.allocate(4 + 4 + pathBytes.length);
+        paramBuffer.putInt(tableId);
+        paramBuffer.putInt(pathBytes.length);
+        paramBuffer.put(pathBytes);
+        return m_ee.executeTask(TaskType.SAVE_TABLE_IMAGE, paramBuffer.array())[0] != 0;
+    }
+
+    @Override
+    public boolean restoreTableImage(String path) {
+        byte pathBytes[] = path.getBytes(Constants.UTF8ENCODING);
+        ByteBuffer paramBuffer = ByteBuffer.allocate(4 + pathBytes.length);
+        paramBuffer.putInt(pathBytes.length);
+        paramBuffer.put(pathBytes);
+        return m_ee.executeTask(TaskType.RESTORE_TABLE_IMAGE, paramBuffer.array())[0] != 0;
+    }
+
+    @Override
+    public long purgeExpiredTuples(long timeInMillis, long maxTuples) {
+        ByteBuffer paramBuffer = ByteBuffer.allocate(8 + 8 + 8);
+        paramBuffer.putLong(getNextUndoToken(m_currentTxnId));
+        paramBuffer.putLong(timeInMillis);
+        paramBuffer.putLong(maxTuples);
+        return ByteBuffer.wrap(m_ee.executeTask(TaskType.PURGE_EXPIRED_TUPLES, paramBuffer.array())).getLong();
+    }
+
+    @Override
+    public void buildDeferredIndexes() {
+        m_ee.executeTask(TaskType.BUILD_DEFERRED_INDEXES, new byte[0]);
+    }
+
     @Override
     public void setBatch(int batchIndex) {
         m_ee.setBatch(batchIndex);
@@ -53,7 +53,14 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
     static VoltLogger log = new VoltLogger("HOST");
 
     public static enum TaskType {
-        VALIDATE_PARTITIONING(0);
+        VALIDATE_PARTITIONING(0),
+        SET_INDEX_BUILD_THREADS(1),
+        SAVE_TABLE_IMAGE(2),
+        RESTORE_TABLE_IMAGE(3),
+        SET_TEMP_BLOCK_POOL_SIZE(4),
+        SET_TEMP_TABLE_SPILL_THRESHOLD(5),
+        PURGE_EXPIRED_TUPLES(6),
+        BUILD_DEFERRED_INDEXES(7);
 
         private TaskType(int taskId) {
             this.taskId = taskId;
@@ -17,6 +17,8 @@
 
 package org.voltdb.jni;
 
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
 import java.io.IOException;
 import java.io.UnsupportedEncodingException;
 import java.nio.ByteBuffer;
@@ -210,10 +212,73 @@ public class ExecutionEngineJNI extends ExecutionEngine {
     public void updateCatalog(long timestamp, final String catalogDiffs) throws EEException {
         LOG.trace("Loading Application Catalog...");
         int errorCode = 0;
-        errorCode = nativeUpdateCatalog(pointer, timestamp, getStringBytes(catalogDiffs));
+        errorCode = nativeUpdateCatalog(pointer, timestamp, getBinaryCatalogDiff(catalogDiffs));
         checkErrorCode(errorCode);
     }
 
+    /** Prefix of the binary catalog diff form, see Catalog::isBinaryDiff. */
+    private static final byte[] BINARY_CATALOG_DIFF_MAGIC = { 0, 'C', 'D', 'B' };
+
+    /**
+     * Encode newline separated catalog commands in the binary diff form of
+     * Catalog::toBinaryDiff. Consecutive commands on the same object are
+     * grouped under its path, so the EE resolves each path once.
+     */
+    static byte[] getBinaryCatalogDiff(final String catalogDiffs) {
+        try {
+            ByteArrayOutputStream bytes = new ByteArrayOutputStream(catalogDiffs.length());
+            DataOutputStream out = new DataOutputStream(bytes);
+            out.write(BINARY_CATALOG_DIFF_MAGIC);
+
+            ByteArrayOutputStream groupBytes = new ByteArrayOutputStream();
+            DataOutputStream group = new DataOutputStream(groupBytes);
+            String lastRef = null;
+            int count = 0;
+            for (String line : catalogDiffs.split("\n")) {
+                if (line.length() == 0) {
+                    continue;
+                }
+                // command ref collection-or-field name-or-value
+                String[] parts = line.split(" ", 4);
+                if (parts.length != 4) {
+                    throw new IllegalArgumentException("Malformed catalog command: " + line);
+                }
+                if (count == 0 || !(parts[1].equals("$PREV") || parts[1].equals(lastRef))) {
+                    if (count > 0) {
+                        writeBinaryCatalogDiffGroup(out, lastRef, count, groupBytes);
+                    }
+                    lastRef = parts[1];
+                    count = 0;
+                }
+                group.writeByte(parts[0].charAt(0));
+                writeBinaryCatalogDiffString(group, parts[2]);
+                writeBinaryCatalogDiffString(group, parts[3]);
+                count++;
+            }
+            if (count > 0) {
+                writeBinaryCatalogDiffGroup(out, lastRef, count, groupBytes);
+            }
+            out.flush();
+            return bytes.toByteArray();
+        } catch (IOException e) {
+            throw new AssertionError(e);
+        }
+    }
+
+    private static void writeBinaryCatalogDiffGroup(DataOutputStream out, String ref, int count,
+                                                    ByteArrayOutputStream groupBytes) throws IOException {
+        writeBinaryCatalogDiffString(out, ref);
+        out.writeInt(count);
+        groupBytes.writeTo(out);
+        groupBytes.reset();
+    }
+
+    private static void writeBinaryCatalogDiffString(DataOutputStream out, String value) throws IOException {
+        byte[] valueBytes = getStringBytes(value);
+        out.writeInt(valueBytes.length);
+        out.write(valueBytes);
+    }
+
     private static byte[] getStringBytes(String string) {
         try {
             return string.getBytes("UTF-8");
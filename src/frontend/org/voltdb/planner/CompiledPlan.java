@@ -203,12 +203,16 @@ public class CompiledPlan {
     }
 
     public static byte[] bytesForPlan(AbstractPlanNode planGraph) {
+        return bytesForPlan(planGraph, false);
+    }
+
+    public static byte[] bytesForPlan(AbstractPlanNode planGraph, boolean isAdHoc) {
         if (planGraph == null) {
             return null;
         }
 
         PlanNodeList planList = new PlanNodeList(planGraph);
-        return planList.toJSONString().getBytes(Constants.UTF8ENCODING);
+        return planList.toJSONString(isAdHoc).getBytes(Constants.UTF8ENCODING);
     }
 
     // A reusable step extracted from boundParamIndexes so it can be applied to two different
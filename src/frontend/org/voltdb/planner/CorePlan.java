@@ -78,8 +78,8 @@ public class CorePlan {
      * @param catalogVersion The version of the catalog this plan was generated against.
      */
     public CorePlan(CompiledPlan plan, int catalogVersion) {
-        aggregatorFragment = CompiledPlan.bytesForPlan(plan.rootPlanGraph);
-        collectorFragment = CompiledPlan.bytesForPlan(plan.subPlanGraph);
+        aggregatorFragment = CompiledPlan.bytesForPlan(plan.rootPlanGraph, true);
+        collectorFragment = CompiledPlan.bytesForPlan(plan.subPlanGraph, true);
 
         // compute the hashes
         MessageDigest md = null;
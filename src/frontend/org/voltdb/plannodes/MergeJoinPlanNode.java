@@ -0,0 +1,156 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package org.voltdb.plannodes;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json_voltpatches.JSONException;
+import org.json_voltpatches.JSONObject;
+import org.json_voltpatches.JSONStringer;
+import org.voltdb.catalog.Cluster;
+import org.voltdb.catalog.Database;
+import org.voltdb.compiler.DatabaseEstimates;
+import org.voltdb.compiler.ScalarValueHints;
+import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.expressions.ExpressionUtil;
+import org.voltdb.expressions.TupleValueExpression;
+import org.voltdb.types.PlanNodeType;
+
+/**
+ * A join of two children that are both sorted ascending on the join keys,
+ * such as ordered index scans. Each outer key expression is matched to the
+ * inner key expression at the same position; the join predicate, if any,
+ * applies to the tuples with equal keys. Either inner or left outer.
+ */
+public class MergeJoinPlanNode extends AbstractJoinPlanNode {
+
+    public enum Members {
+        OUTER_KEY_EXPRESSIONS,
+        INNER_KEY_EXPRESSIONS;
+    }
+
+    protected List<AbstractExpression> m_outerKeyExpressions = new ArrayList<AbstractExpression>();
+    protected List<AbstractExpression> m_innerKeyExpressions = new ArrayList<AbstractExpression>();
+
+    public MergeJoinPlanNode() {
+        super();
+    }
+
+    @Override
+    public PlanNodeType getPlanNodeType() {
+        return PlanNodeType.MERGEJOIN;
+    }
+
+    /**
+     * Add a pair of join keys: the outer child's key and the inner child's.
+     */
+    public void addKeyExpressions(AbstractExpression outerKey, AbstractExpression innerKey)
+    {
+        m_outerKeyExpressions.add((AbstractExpression) outerKey.clone());
+        m_innerKeyExpressions.add((AbstractExpression) innerKey.clone());
+    }
+
+    @Override
+    public void validate() throws Exception {
+        super.validate();
+
+        if (m_outerKeyExpressions.isEmpty() ||
+            m_outerKeyExpressions.size() != m_innerKeyExpressions.size()) {
+            throw new Exception("ERROR: Mismatched or missing join keys for PlanNode '" + this + "'");
+        }
+        for (AbstractExpression key : m_outerKeyExpressions) {
+            key.validate();
+        }
+        for (AbstractExpression key : m_innerKeyExpressions) {
+            key.validate();
+        }
+    }
+
+    @Override
+    public void computeCostEstimates(long childOutputTupleCountEstimate,
+                                     Cluster cluster,
+                                     Database db,
+                                     DatabaseEstimates estimates,
+                                     ScalarValueHints[] paramHints)
+    {
+        // Each child is read once, in order.
+        m_estimatedOutputTupleCount = childOutputTupleCountEstimate;
+        m_estimatedProcessedTupleCount = childOutputTupleCountEstimate;
+    }
+
+    @Override
+    public void resolveColumnIndexes()
+    {
+        super.resolveColumnIndexes();
+
+        // The keys are evaluated on their own child's tuples.
+        resolveKeys(m_outerKeyExpressions, m_children.get(0).getOutputSchema(), 0);
+        resolveKeys(m_innerKeyExpressions, m_children.get(1).getOutputSchema(), 1);
+    }
+
+    private static void resolveKeys(List<AbstractExpression> keys, NodeSchema schema, int tableIdx)
+    {
+        for (AbstractExpression key : keys) {
+            for (TupleValueExpression tve : ExpressionUtil.getTupleValueExpressions(key)) {
+                int index = tve.resolveColumnIndexesUsingSchema(schema);
+                if (index == -1) {
+                    throw new RuntimeException("Unable to find index for join key TVE: " +
+                                               tve.toString());
+                }
+                tve.setColumnIndex(index);
+                tve.setTableIndex(tableIdx);
+            }
+        }
+    }
+
+    @Override
+    public void toJSONString(JSONStringer stringer) throws JSONException
+    {
+        super.toJSONString(stringer);
+        stringer.key(Members.OUTER_KEY_EXPRESSIONS.name()).array();
+        for (AbstractExpression key : m_outerKeyExpressions) {
+            stringer.object();
+            key.toJSONString(stringer);
+            stringer.endObject();
+        }
+        stringer.endArray();
+        stringer.key(Members.INNER_KEY_EXPRESSIONS.name()).array();
+        for (AbstractExpression key : m_innerKeyExpressions) {
+            stringer.object();
+            key.toJSONString(stringer);
+            stringer.endObject();
+        }
+        stringer.endArray();
+    }
+
+    @Override
+    public void loadFromJSONObject( JSONObject jobj, Database db ) throws JSONException
+    {
+        super.loadFromJSONObject(jobj, db);
+        AbstractExpression.loadFromJSONArrayChild(m_outerKeyExpressions, jobj,
+                                                  Members.OUTER_KEY_EXPRESSIONS.name(), null);
+        AbstractExpression.loadFromJSONArrayChild(m_innerKeyExpressions, jobj,
+                                                  Members.INNER_KEY_EXPRESSIONS.name(), null);
+    }
+
+    @Override
+    protected String explainPlanForNode(String indent) {
+        return "MERGE " + this.m_joinType.toString() + " JOIN" + explainFilters(indent);
+    }
+
+}
@@ -32,7 +32,8 @@ import org.json_voltpatches.JSONStringer;
 public class PlanNodeList extends PlanNodeTree implements Comparable<PlanNodeList> {
 
     public enum Members {
-        EXECUTE_LIST;
+        EXECUTE_LIST,
+        AD_HOC;
     }
 
     protected List<AbstractPlanNode> m_list = new ArrayList<AbstractPlanNode>();
@@ -130,6 +131,14 @@ public class PlanNodeList extends PlanNodeTree implements Comparable<PlanNodeLis
 
     @Override
     public String toJSONString() {
+        return toJSONString(false);
+    }
+
+    /**
+     * Serialize the plan, marking the plan of an ad hoc query so the EE can
+     * reuse its executors for plans that differ from it only in constants.
+     */
+    public String toJSONString(boolean isAdHoc) {
         JSONStringer stringer = new JSONStringer();
         try {
             stringer.object();
@@ -141,6 +150,10 @@ public class PlanNodeList extends PlanNodeTree implements Comparable<PlanNodeLis
             }
             stringer.endArray(); //end execution list
 
+            if (isAdHoc) {
+                stringer.key(Members.AD_HOC.name()).value(true);
+            }
+
             stringer.endObject(); //end PlanNodeList
         } catch (JSONException e) {
             // HACK ugly ugly to make the JSON handling
@@ -0,0 +1,116 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package org.voltdb.plannodes;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json_voltpatches.JSONException;
+import org.json_voltpatches.JSONObject;
+import org.json_voltpatches.JSONStringer;
+import org.voltdb.catalog.Database;
+import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.expressions.ExpressionUtil;
+import org.voltdb.expressions.TupleValueExpression;
+import org.voltdb.types.ExpressionType;
+import org.voltdb.types.PlanNodeType;
+
+/**
+ * Plan node representing window functions (ROW_NUMBER, RANK, DENSE_RANK and
+ * the aggregates) over input sorted by the partition (group by) expressions
+ * and then the order by expressions. Each input row is output with the
+ * value of every function appended.
+ */
+public class WindowFunctionPlanNode extends AggregatePlanNode {
+
+    public enum Members {
+        ORDERBY_EXPRESSIONS;
+    }
+
+    protected List<AbstractExpression> m_orderByExpressions = new ArrayList<AbstractExpression>();
+
+    public WindowFunctionPlanNode() {
+        super();
+    }
+
+    @Override
+    public PlanNodeType getPlanNodeType() {
+        return PlanNodeType.WINDOWFUNCTION;
+    }
+
+    public void addOrderByExpression(AbstractExpression expr)
+    {
+        if (expr == null) {
+            return;
+        }
+        m_orderByExpressions.add((AbstractExpression) expr.clone());
+    }
+
+    @Override
+    public void resolveColumnIndexes()
+    {
+        super.resolveColumnIndexes();
+
+        NodeSchema input_schema = m_children.get(0).getOutputSchema();
+        List<TupleValueExpression> order_tves =
+            new ArrayList<TupleValueExpression>();
+        for (AbstractExpression order_exp : m_orderByExpressions)
+        {
+            order_tves.addAll(ExpressionUtil.getTupleValueExpressions(order_exp));
+        }
+        for (TupleValueExpression tve : order_tves)
+        {
+            int index = tve.resolveColumnIndexesUsingSchema(input_schema);
+            tve.setColumnIndex(index);
+        }
+    }
+
+    @Override
+    public void toJSONString(JSONStringer stringer) throws JSONException {
+        super.toJSONString(stringer);
+
+        if (!m_orderByExpressions.isEmpty())
+        {
+            stringer.key(Members.ORDERBY_EXPRESSIONS.name()).array();
+            for (int i = 0; i < m_orderByExpressions.size(); i++) {
+                stringer.object();
+                m_orderByExpressions.get(i).toJSONString(stringer);
+                stringer.endObject();
+            }
+            stringer.endArray();
+        }
+    }
+
+    @Override
+    protected String explainPlanForNode(String indent) {
+        StringBuilder sb = new StringBuilder();
+        sb.append("WINDOW FUNCTION ops: ");
+        for (ExpressionType e : m_aggregateTypes) {
+            sb.append(e.symbol()).append(", ");
+        }
+        // trim the last ", " from the string
+        sb.setLength(sb.length() - 2);
+        return sb.toString();
+    }
+
+    @Override
+    public void loadFromJSONObject( JSONObject jobj, Database db ) throws JSONException {
+        super.loadFromJSONObject(jobj, db);
+        AbstractExpression.loadFromJSONArrayChild(m_orderByExpressions, jobj,
+                                                  Members.ORDERBY_EXPRESSIONS.name(), null);
+    }
+}
@@ -0,0 +1,69 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package org.voltdb.sysprocs;
+
+import java.util.List;
+import java.util.Map;
+
+import org.voltdb.DependencyPair;
+import org.voltdb.ParameterSet;
+import org.voltdb.ProcInfo;
+import org.voltdb.SystemProcedureExecutionContext;
+import org.voltdb.VoltSystemProcedure;
+import org.voltdb.VoltTable;
+
+/**
+ * Deletes, at one partition, the rows of every table with a time to live
+ * (EXPIRE TABLE) that have outlived it. The rows expire as of the
+ * transaction's timestamp, so every replica deletes the same rows, and the
+ * deletes are undone if the transaction rolls back. At most maxTuples rows
+ * go per call; ClientInterface calls it again while a call deletes that
+ * many.
+ */
+@ProcInfo(
+    partitionInfo = "DUMMY: 0", // partitioning is done special for this class
+    singlePartition = true
+)
+public class PurgeExpiredTuples extends VoltSystemProcedure {
+
+    @Override
+    public void init() {}
+
+    /**
+     * This single-partition sysproc has no special fragments
+     */
+    @Override
+    public DependencyPair executePlanFragment(Map<Integer, List<VoltTable>> dependencies,
+                                              long fragmentId, ParameterSet params,
+                                              SystemProcedureExecutionContext context)
+    {
+        return null;
+    }
+
+    /**
+     * @param ctx Internal. Not a user-supplied parameter.
+     * @param partitionKey A key that hashes to the partition to purge.
+     * @param maxTuples The most rows to delete.
+     * @return The number of rows deleted.
+     */
+    public long run(SystemProcedureExecutionContext ctx, int partitionKey, long maxTuples)
+    {
+        return ctx.getSiteProcedureConnection().purgeExpiredTuples(getTransactionTime().getTime(),
+                                                                    maxTuples);
+    }
+}
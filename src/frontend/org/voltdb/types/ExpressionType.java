@@ -107,6 +107,9 @@ public enum ExpressionType {
     AGGREGATE_MIN                 (AggregateExpression.class, 43, "MIN"),
     AGGREGATE_MAX                 (AggregateExpression.class, 44, "MAX"),
     AGGREGATE_AVG                 (AggregateExpression.class, 45, "AVG"),
+    AGGREGATE_ROW_NUMBER          (AggregateExpression.class, 46, "ROW_NUMBER"),
+    AGGREGATE_RANK                (AggregateExpression.class, 47, "RANK"),
+    AGGREGATE_DENSE_RANK          (AggregateExpression.class, 48, "DENSE_RANK"),
 
     // ----------------------------
     // Function
@@ -27,7 +27,9 @@ public enum JoinType {
     INNER       (1),
     LEFT        (2),
     FULL        (3),
-    RIGHT       (4);
+    RIGHT       (4),
+    SEMI        (5),
+    ANTI        (6);
 
     JoinType(int val) {
         assert (this.ordinal() == val) :
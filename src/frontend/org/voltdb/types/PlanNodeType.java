@@ -32,6 +32,7 @@ import org.voltdb.plannodes.InsertPlanNode;
 import org.voltdb.plannodes.LimitPlanNode;
 import org.voltdb.plannodes.MaterializePlanNode;
 import org.voltdb.plannodes.MaterializedScanPlanNode;
+import org.voltdb.plannodes.MergeJoinPlanNode;
 import org.voltdb.plannodes.NestLoopIndexPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
 import org.voltdb.plannodes.OrderByPlanNode;
@@ -42,6 +43,7 @@ import org.voltdb.plannodes.SeqScanPlanNode;
 import org.voltdb.plannodes.TableCountPlanNode;
 import org.voltdb.plannodes.UnionPlanNode;
 import org.voltdb.plannodes.UpdatePlanNode;
+import org.voltdb.plannodes.WindowFunctionPlanNode;
 
 /**
  *
@@ -63,6 +65,7 @@ public enum PlanNodeType {
     //
     NESTLOOP        (20, NestLoopPlanNode.class),
     NESTLOOPINDEX   (21, NestLoopIndexPlanNode.class),
+    MERGEJOIN       (22, MergeJoinPlanNode.class),
 
     //
     // Operator Nodes
@@ -87,7 +90,8 @@ public enum PlanNodeType {
     PROJECTION      (54, ProjectionPlanNode.class),
     MATERIALIZE     (55, MaterializePlanNode.class),
     LIMIT           (56, LimitPlanNode.class),
-    DISTINCT        (57, DistinctPlanNode.class)
+    DISTINCT        (57, DistinctPlanNode.class),
+    WINDOWFUNCTION  (58, WindowFunctionPlanNode.class)
 
     ;
 
@@ -57,6 +57,8 @@
 #include "catalog/procedure.h"
 #include "catalog/statement.h"
 #include "catalog/stmtparameter.h"
+#include "catalog/table.h"
+#include "catalog/column.h"
 
 using namespace catalog;
 using namespace std;
@@ -1244,6 +1246,58 @@ TEST_F(CatalogTest, HexDecode) {
     Catalog::hexDecodeString(val, output);
     output[len / 2] = '\0';
 }
+
+TEST_F(CatalogTest, BinaryDiff) {
+    string schema =
+        "add / clusters cluster"
+        "\nadd /clusters[cluster] databases database"
+        "\nadd /clusters[cluster]/databases[database] tables A"
+        "\nadd /clusters[cluster]/databases[database] tables B"
+        "\nadd /clusters[cluster]/databases[database]/tables[A] columns X"
+        "\nset $PREV isreplicated false"
+        "\nadd /clusters[cluster]/databases[database]/tables[B] columns Y";
+    string diff =
+        "set /clusters[cluster]/databases[database]/tables[A]/columns[X] nullable true"
+        "\nset $PREV size 8"
+        "\nadd /clusters[cluster]/databases[database] tables C"
+        "\nset /clusters[cluster]/databases[database]/tables[C] isreplicated true";
+
+    string binary = Catalog::toBinaryDiff(diff);
+    ASSERT_TRUE(Catalog::isBinaryDiff(binary));
+    ASSERT_FALSE(Catalog::isBinaryDiff(diff));
+
+    Catalog text;
+    text.execute(schema);
+    text.execute(diff);
+    Catalog cat;
+    cat.execute(Catalog::toBinaryDiff(schema));
+    cat.execute(binary);
+
+    const Database *db = cat.clusters().get("cluster")->databases().get("database");
+    const Database *textDb = text.clusters().get("cluster")->databases().get("database");
+    ASSERT_EQ(3, db->tables().size());
+    const Column *x = db->tables().get("A")->columns().get("X");
+    EXPECT_TRUE(x->nullable());
+    EXPECT_EQ(8, x->size());
+    EXPECT_TRUE(db->tables().get("C")->isreplicated());
+    EXPECT_EQ(textDb->tables().get("A")->columns().get("X")->size(), x->size());
+
+    // Only the objects under a change are flagged
+    EXPECT_TRUE(x->wasUpdated());
+    EXPECT_TRUE(db->tables().get("A")->wasChanged());
+    EXPECT_FALSE(db->tables().get("A")->wasUpdated());
+    EXPECT_FALSE(db->tables().get("B")->wasChanged());
+    EXPECT_TRUE(db->tables().get("C")->wasAdded());
+    EXPECT_TRUE(db->wasChanged());
+
+    // and the flags are cleared by the next update
+    cat.execute(Catalog::toBinaryDiff("set /clusters[cluster]/databases[database]/tables[B] isreplicated true"));
+    EXPECT_FALSE(x->wasUpdated());
+    EXPECT_FALSE(db->tables().get("A")->wasChanged());
+    EXPECT_FALSE(db->tables().get("C")->wasAdded());
+    EXPECT_TRUE(db->tables().get("B")->wasChanged());
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
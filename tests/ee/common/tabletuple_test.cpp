@@ -88,6 +88,43 @@ TEST_F(TableTupleTest, ComputeNonInlinedMemory)
     TupleSchema::freeTupleSchema(non_inline_schema);
 }
 
+TEST_F(TableTupleTest, LayoutPrefix)
+{
+    vector<ValueType> types;
+    vector<int32_t> lengths;
+    types.push_back(VALUE_TYPE_BIGINT);
+    lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    types.push_back(VALUE_TYPE_VARCHAR);
+    lengths.push_back(10);
+    TupleSchema* schema =
+        TupleSchema::createTupleSchema(types, lengths, vector<bool>(2, true), true);
+
+    // an appended column keeps the layout
+    types.push_back(VALUE_TYPE_INTEGER);
+    lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    TupleSchema* appended =
+        TupleSchema::createTupleSchema(types, lengths, vector<bool>(3, true), true);
+    EXPECT_TRUE(schema->isLayoutPrefixOf(appended));
+    EXPECT_TRUE(schema->isLayoutPrefixOf(schema));
+    EXPECT_FALSE(appended->isLayoutPrefixOf(schema));
+
+    // neither does a column that turned NOT NULL
+    TupleSchema* notNull =
+        TupleSchema::createTupleSchema(types, lengths, vector<bool>(3, false), true);
+    EXPECT_FALSE(schema->isLayoutPrefixOf(notNull));
+
+    // a widened string column does not
+    lengths[1] = 20;
+    TupleSchema* widened =
+        TupleSchema::createTupleSchema(types, lengths, vector<bool>(3, true), true);
+    EXPECT_FALSE(schema->isLayoutPrefixOf(widened));
+
+    TupleSchema::freeTupleSchema(schema);
+    TupleSchema::freeTupleSchema(appended);
+    TupleSchema::freeTupleSchema(notNull);
+    TupleSchema::freeTupleSchema(widened);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,100 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/tabletuple.h"
+#include "common/TupleHashTable.h"
+#include "common/ValueFactory.hpp"
+
+using namespace voltdb;
+using namespace std;
+
+class TupleHashTableTest : public Test
+{
+public:
+    TupleHashTableTest() : m_schema(NULL), m_data(NULL)
+    {
+        vector<ValueType> types(1, VALUE_TYPE_BIGINT);
+        vector<int32_t> lengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> allowNull(1, true);
+        m_schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        m_data = new char[m_schema->tupleLength() * TUPLE_COUNT];
+    }
+
+    ~TupleHashTableTest()
+    {
+        delete[] m_data;
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    // The ii'th tuple of the buffer, holding value
+    TableTuple tupleAt(int ii, int64_t value)
+    {
+        TableTuple tuple(m_schema);
+        tuple.move(m_data + ii * m_schema->tupleLength());
+        tuple.setNValue(0, ValueFactory::getBigIntValue(value));
+        return tuple;
+    }
+
+protected:
+    static const int TUPLE_COUNT = 1000;
+    TupleSchema* m_schema;
+    char* m_data;
+};
+
+TEST_F(TupleHashTableTest, FindOrInsertAndGrow)
+{
+    // Deliberately undersized so that the table has to grow.
+    TupleHashTable tuples(4);
+    bool inserted;
+    for (int ii = 0; ii < TUPLE_COUNT; ii++) {
+        TupleHashTable::Entry* entry = tuples.findOrInsert(tupleAt(ii, ii % 100), inserted);
+        EXPECT_EQ(ii < 100, inserted);
+        ++entry->count;
+    }
+    EXPECT_EQ(100, tuples.size());
+
+    for (int ii = 0; ii < 100; ii++) {
+        TupleHashTable::Entry* entry = tuples.find(tupleAt(TUPLE_COUNT - 1, ii));
+        ASSERT_TRUE(entry != NULL);
+        EXPECT_EQ(10, entry->count);
+        EXPECT_EQ(ii, ValuePeeker::peekAsBigInt(entry->tuple.getNValue(0)));
+    }
+    EXPECT_TRUE(tuples.find(tupleAt(TUPLE_COUNT - 1, 100)) == NULL);
+
+    size_t total = 0;
+    for (TupleHashTable::iterator it = tuples.begin(); it != tuples.end(); ++it) {
+        if (!it->isEmpty()) {
+            total += it->count;
+        }
+    }
+    EXPECT_EQ(TUPLE_COUNT, total);
+
+    tuples.reset(TUPLE_COUNT);
+    EXPECT_EQ(0, tuples.size());
+    EXPECT_TRUE(tuples.find(tupleAt(0, 0)) == NULL);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
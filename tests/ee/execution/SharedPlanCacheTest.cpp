@@ -0,0 +1,171 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include "harness.h"
+#include "common/PlannerDomValue.h"
+#include "execution/SharedPlanCache.h"
+
+using namespace voltdb;
+using namespace std;
+
+class SharedPlanCacheTest : public Test {
+public:
+};
+
+TEST_F(SharedPlanCacheTest, Basic) {
+    string json = "{\"PLAN_NODES\":[],\"EXECUTE_LIST\":[],\"PARAMETERS\":[]}";
+    const size_t planBytes = PlannerDomRoot(json.c_str()).toBinary().size();
+    // room for two of the plan
+    SharedPlanCache cache(2 * planBytes);
+
+    ASSERT_TRUE(cache.get(1).get() == NULL);
+
+    // JSON is kept in the binary form
+    SharedPlanCache::PlanPtr plan1 = cache.put(1, json);
+    ASSERT_TRUE(PlannerDomRoot::isBinary(plan1->plan.data(), plan1->plan.size()));
+    ASSERT_TRUE(plan1->shape.empty());
+    PlannerDomRoot root(plan1->plan.data(), plan1->plan.size());
+    ASSERT_EQ(0, root.rootObject().valueForKey("PLAN_NODES").arrayLen());
+    ASSERT_EQ(plan1->plan, cache.get(1)->plan);
+
+    // Engines share the cached plan
+    ASSERT_TRUE(cache.get(1).get() == plan1.get());
+
+    // A racing put for the same fragment gets the cached plan
+    ASSERT_TRUE(cache.put(1, json).get() == plan1.get());
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(planBytes, cache.bytes());
+
+    // Plans that don't parse are kept as they are
+    SharedPlanCache::PlanPtr plan2 = cache.put(2, "not json");
+    ASSERT_EQ(string("not json"), plan2->plan);
+
+    // Least recently used goes first, plans handed out stay valid
+    ASSERT_EQ(plan1->plan, cache.get(1)->plan);
+    cache.put(3, json);
+    ASSERT_EQ(2, cache.size());
+    ASSERT_EQ(2 * planBytes, cache.bytes());
+    ASSERT_TRUE(cache.get(2).get() == NULL);
+    ASSERT_EQ(plan1->plan, cache.get(1)->plan);
+    ASSERT_EQ(string("not json"), plan2->plan);
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.bytes());
+    ASSERT_TRUE(cache.get(1).get() == NULL);
+}
+
+TEST_F(SharedPlanCacheTest, BoundedByBytes) {
+    SharedPlanCache cache(1000);
+    string small = "{\"PLAN_NODES\":[],\"EXECUTE_LIST\":[],\"PARAMETERS\":[]}";
+    string big = "{\"PLAN_NODES\":[],\"EXECUTE_LIST\":[],\"PARAMETERS\":[],\"PAD\":\"" +
+        string(600, 'x') + "\"}";
+
+    // many small plans fit where one big plan and a few small ones do
+    for (int64_t i = 0; i < 10; i++) {
+        cache.put(i, small);
+    }
+    ASSERT_EQ(10, cache.size());
+    cache.put(10, big);
+    ASSERT_TRUE(cache.bytes() <= 1000);
+    ASSERT_TRUE(cache.size() < 10);
+    ASSERT_TRUE(cache.get(10).get() != NULL);
+    ASSERT_TRUE(cache.get(0).get() == NULL);
+
+    // a plan over the capacity on its own is still kept, alone
+    SharedPlanCache tiny(10);
+    tiny.put(1, small);
+    tiny.put(2, big);
+    ASSERT_EQ(1, tiny.size());
+    ASSERT_TRUE(tiny.get(2).get() != NULL);
+}
+
+TEST_F(SharedPlanCacheTest, EmptiedWithoutEngines) {
+    SharedPlanCache cache(1024 * 1024);
+    string json = "{\"PLAN_NODES\":[],\"EXECUTE_LIST\":[],\"PARAMETERS\":[]}";
+
+    cache.attachEngine();
+    cache.attachEngine();
+    SharedPlanCache::PlanPtr plan1 = cache.put(1, json);
+    cache.detachEngine();
+    ASSERT_EQ(1, cache.size());
+
+    // Without engines the frontend may start over at the same fragment ids,
+    cache.detachEngine();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_TRUE(cache.get(1).get() == NULL);
+    // and plans still in use outlive their entries
+    PlannerDomRoot root(plan1->plan.data(), plan1->plan.size());
+    ASSERT_EQ(0, root.rootObject().valueForKey("EXECUTE_LIST").arrayLen());
+}
+
+TEST_F(SharedPlanCacheTest, ConstantsLifted) {
+    SharedPlanCache cache(1024 * 1024);
+    // SELECT ... WHERE A = ? AND B = <constant>, with the constant varying
+    string planA =
+        "{\"PLAN_NODES\":[{\"ID\":1,\"PREDICATE\":"
+        "{\"TYPE\":\"CONJUNCTION_AND\",\"VALUE_TYPE\":\"BOOLEAN\",\"VALUE_SIZE\":1,"
+        "\"LEFT\":{\"TYPE\":\"VALUE_PARAMETER\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8,\"PARAM_IDX\":0},"
+        "\"RIGHT\":{\"TYPE\":\"VALUE_CONSTANT\",\"VALUE_TYPE\":\"VARCHAR\",\"VALUE_SIZE\":5,"
+        "\"ISNULL\":false,\"VALUE\":\"";
+    string planB = "\"}}}],\"EXECUTE_LIST\":[1],\"PARAMETERS\":[[0,\"BIGINT\"]],\"AD_HOC\":true}";
+
+    SharedPlanCache::PlanPtr plan1 = cache.put(1, planA + "hello" + planB);
+    SharedPlanCache::PlanPtr plan2 = cache.put(2, planA + "world" + planB);
+    ASSERT_FALSE(plan1->shape.empty());
+    ASSERT_TRUE(plan1->shape == plan2->shape);
+    ASSERT_EQ(plan1->shapeHash, plan2->shapeHash);
+    ASSERT_TRUE(plan1->plan != plan2->plan);
+
+    // The constant becomes the parameter after the plan's own
+    ASSERT_EQ(1, plan1->constantBase);
+    ASSERT_EQ(1, plan1->constants.size());
+    PlannerDomRoot shape(plan1->shape.data(), plan1->shape.size());
+    PlannerDomValue right = shape.rootObject().valueForKey("PLAN_NODES").valueAtIndex(0).
+        valueForKey("PREDICATE").valueForKey("RIGHT");
+    EXPECT_EQ(string("VALUE_PARAMETER"), right.valueForKey("TYPE").asStr());
+    EXPECT_EQ(1, right.valueForKey("PARAM_IDX").asInt());
+    EXPECT_FALSE(right.hasKey("VALUE"));
+
+    PlannerDomRoot constant(plan2->constants[0].data(), plan2->constants[0].size());
+    EXPECT_EQ(string("world"), constant.rootObject().valueForKey("VALUE").asStr());
+
+    // A different constant type is a different shape
+    string planC = planA + "hello" + planB;
+    planC.replace(planC.find("VARCHAR"), 7, "BIGINT");
+    SharedPlanCache::PlanPtr plan3 = cache.put(3, planC);
+    ASSERT_TRUE(plan1->shape != plan3->shape);
+
+    // Stored procedure plans keep their constants
+    string planD = planA + "hello" + planB;
+    string adHoc = ",\"AD_HOC\":true";
+    planD.replace(planD.find(adHoc), adHoc.size(), "");
+    SharedPlanCache::PlanPtr plan4 = cache.put(4, planD);
+    ASSERT_TRUE(plan4->shape.empty());
+    ASSERT_TRUE(plan4->constants.empty());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
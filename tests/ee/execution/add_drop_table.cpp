@@ -29,9 +29,18 @@
 #include "catalog/table.h"
 #include "common/common.h"
 #include "execution/VoltDBEngine.h"
+#include "indexes/tableindex.h"
+#include "storage/ConstraintFailureException.h"
+#include "storage/persistenttable.h"
 #include "storage/table.h"
+#include "storage/tableiterator.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/executorcontext.hpp"
 
 #include <cstdlib>
+#include <cstring>
+#include <sstream>
 
 using namespace voltdb;
 using namespace std;
@@ -124,6 +133,47 @@ class AddDropTableTest : public Test {
     }
 
 
+    std::string tableDCmds()
+    {
+        std::string table = "/clusters[cluster]/databases[database]/tables[tableD]";
+        return
+          "add /clusters[cluster]/databases[database] tables tableD\n"
+          "set " + table + " type 0\n"
+          "set " + table + " isreplicated false\n"
+          "set " + table + " partitioncolumn 0\n"
+          "set " + table + " estimatedtuplecount 0\n"
+          "add " + table + " columns A\n"
+          "set " + table + "/columns[A] index 0\n"
+          "set " + table + "/columns[A] type 5\n"
+          "set " + table + "/columns[A] size 0\n"
+          "set " + table + "/columns[A] nullable false\n"
+          "set " + table + "/columns[A] name \"A\"\n"
+          "add " + table + " columns S\n"
+          "set " + table + "/columns[S] index 1\n"
+          "set " + table + "/columns[S] type 9\n"
+          "set " + table + "/columns[S] size 60\n"
+          "set " + table + "/columns[S] nullable true\n"
+          "set " + table + "/columns[S] name \"S\"\n"
+          "add " + table + " indexes IDX_A\n"
+          "set " + table + "/indexes[IDX_A] unique true\n"
+          "set " + table + "/indexes[IDX_A] type 2\n"
+          "add " + table + "/indexes[IDX_A] columns A\n"
+          "set " + table + "/indexes[IDX_A]/columns[A] index 0\n"
+          "set " + table + "/indexes[IDX_A]/columns[A] column " + table + "/columns[A]";
+    }
+
+    std::string tableDAddColumnCmds()
+    {
+        std::string table = "/clusters[cluster]/databases[database]/tables[tableD]";
+        return
+          "add " + table + " columns B\n"
+          "set " + table + "/columns[B] index 2\n"
+          "set " + table + "/columns[B] type 5\n"
+          "set " + table + "/columns[B] size 0\n"
+          "set " + table + "/columns[B] nullable true\n"
+          "set " + table + "/columns[B] name \"B\"";
+    }
+
   protected:
     CatalogId m_clusterId;
     CatalogId m_databaseId;
@@ -499,6 +549,202 @@ TEST_F(AddDropTableTest, BadAddTable)
     }
 }
 
+/*
+ * Test on engine.
+ * Adding a column moves the tuples over a few blocks on each tick, and all
+ * at once when the table is next used as a whole.
+ */
+TEST_F(AddDropTableTest, OnlineSchemaChange)
+{
+    bool result = m_engine->updateCatalog(0, tableDCmds());
+    ASSERT_TRUE(result);
+
+    // the wide inlined string column fills blocks with fewer tuples
+    PersistentTable *before = dynamic_cast<PersistentTable*>(m_engine->getTable("tableD"));
+    m_engine->setUndoToken(1);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0);
+    NValue padding = ValueFactory::getStringValue(string(60, 'x'));
+    TableTuple tuple = before->tempTuple();
+    int tupleCount = 0;
+    while (before->allocatedBlockCount() <= SCHEMA_CHANGE_BLOCKS_PER_TICK) {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(tupleCount++));
+        tuple.setNValue(1, padding);
+        before->insertTuple(tuple);
+    }
+    padding.free();
+    m_engine->releaseUndoToken(1);
+    const size_t blockCount = before->allocatedBlockCount();
+
+    // keep the old table around to watch it drain
+    before->incrementRefcount();
+    result = m_engine->updateCatalog(1, tableDAddColumnCmds());
+    ASSERT_TRUE(result);
+    ASSERT_EQ(tupleCount, before->activeTupleCount());
+
+    PersistentTable *after = dynamic_cast<PersistentTable*>(m_engine->getTable("tableD"));
+    ASSERT_TRUE(after->isMigrating());
+    ASSERT_EQ(tupleCount, after->migratingTupleCount());
+
+    m_engine->tick(0, 0);
+    ASSERT_EQ(blockCount - SCHEMA_CHANGE_BLOCKS_PER_TICK, before->allocatedBlockCount());
+    ASSERT_TRUE(before->activeTupleCount() > 0);
+    ASSERT_EQ(tupleCount, after->activeTupleCount() + after->migratingTupleCount());
+
+    // a plain lookup moves nothing, using the whole table moves the rest
+    ASSERT_TRUE(after == m_engine->getTable("tableD"));
+    ASSERT_TRUE(after->isMigrating());
+    ASSERT_TRUE(after == m_engine->getMigratedTable("tableD"));
+    ASSERT_FALSE(after->isMigrating());
+    ASSERT_EQ(0, before->activeTupleCount());
+    ASSERT_EQ(tupleCount, after->activeTupleCount());
+    ASSERT_EQ(3, after->columnCount());
+    before->decrementRefcount();
+
+    TableIterator iterator = after->iterator();
+    TableTuple scanned(after->schema());
+    int64_t sum = 0;
+    while (iterator.next(scanned)) {
+        sum += ValuePeeker::peekAsBigInt(scanned.getNValue(0));
+        ASSERT_TRUE(scanned.getNValue(2).isNull());
+    }
+    ASSERT_EQ(static_cast<int64_t>(tupleCount) * (tupleCount - 1) / 2, sum);
+}
+
+/*
+ * Test on engine.
+ * While a table migrates, index lookups and inserts move just the tuples
+ * they would find, so they see the same rows as before the change.
+ */
+TEST_F(AddDropTableTest, OnlineSchemaChangeLookups)
+{
+    bool result = m_engine->updateCatalog(0, tableDCmds());
+    ASSERT_TRUE(result);
+
+    const int tupleCount = 100;
+    Table *before = m_engine->getTable("tableD");
+    m_engine->setUndoToken(1);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0);
+    TableTuple tuple = before->tempTuple();
+    for (int i = 0; i < tupleCount; i++) {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(i));
+        tuple.setNValue(1, ValueFactory::getNullStringValue());
+        before->insertTuple(tuple);
+    }
+    m_engine->releaseUndoToken(1);
+
+    before->incrementRefcount();
+    result = m_engine->updateCatalog(1, tableDAddColumnCmds());
+    ASSERT_TRUE(result);
+    PersistentTable *after = dynamic_cast<PersistentTable*>(m_engine->getTable("tableD"));
+    ASSERT_TRUE(after->isMigrating());
+
+    // an equality lookup moves only the tuple it finds
+    TableIndex *index = after->index("IDX_A");
+    ASSERT_TRUE(index != NULL);
+    char keyData[64];
+    ::memset(keyData, 0, sizeof(keyData));
+    TableTuple searchKey(index->getKeySchema());
+    searchKey.move(keyData);
+    searchKey.setNValue(0, ValueFactory::getIntegerValue(7));
+    after->migrateMatches(index, searchKey);
+    ASSERT_EQ(1, after->activeTupleCount());
+    ASSERT_EQ(tupleCount - 1, before->activeTupleCount());
+    ASSERT_FALSE(index->uniqueMatchingTuple(searchKey).isNullTuple());
+
+    // inserting a key that has yet to move still violates the unique index
+    m_engine->setUndoToken(2);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0);
+    TableTuple &duplicate = after->tempTuple();
+    duplicate.setNValue(0, ValueFactory::getIntegerValue(8));
+    duplicate.setNValue(1, ValueFactory::getNullStringValue());
+    duplicate.setNValue(2, ValueFactory::getNullValue());
+    try {
+        after->insertTuple(duplicate);
+        ASSERT_TRUE(false);
+    }
+    catch (ConstraintFailureException &e) {
+        ASSERT_TRUE(true);
+    }
+    m_engine->releaseUndoToken(2);
+    ASSERT_EQ(2, after->activeTupleCount());
+    ASSERT_EQ(tupleCount - 2, before->activeTupleCount());
+    ASSERT_EQ(tupleCount, after->activeTupleCount() + after->migratingTupleCount());
+
+    after->finishMigration();
+    ASSERT_FALSE(after->isMigrating());
+    ASSERT_EQ(0, before->activeTupleCount());
+    ASSERT_EQ(tupleCount, after->activeTupleCount());
+    before->decrementRefcount();
+}
+
+/*
+ * Test on engine.
+ * Appending a column hands the existing tuples, strings and all, over to
+ * the new table.
+ */
+TEST_F(AddDropTableTest, AppendColumnKeepsStrings)
+{
+    string table = "/clusters[cluster]/databases[database]/tables[tableC]";
+    bool result = m_engine->updateCatalog(0,
+        "add /clusters[cluster]/databases[database] tables tableC\n"
+        "set " + table + " type 0\n"
+        "set " + table + " isreplicated false\n"
+        "set " + table + " partitioncolumn 0\n"
+        "set " + table + " estimatedtuplecount 0\n"
+        "add " + table + " columns A\n"
+        "set " + table + "/columns[A] index 0\n"
+        "set " + table + "/columns[A] type 5\n"
+        "set " + table + "/columns[A] size 0\n"
+        "set " + table + "/columns[A] nullable false\n"
+        "set " + table + "/columns[A] name \"A\"\n"
+        "add " + table + " columns S\n"
+        "set " + table + "/columns[S] index 1\n"
+        "set " + table + "/columns[S] type 9\n"
+        "set " + table + "/columns[S] size 100\n"
+        "set " + table + "/columns[S] nullable true\n"
+        "set " + table + "/columns[S] name \"S\"");
+    ASSERT_TRUE(result);
+
+    const int tupleCount = 100;
+    Table *before = m_engine->getTable("tableC");
+    m_engine->setUndoToken(1);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0);
+    TableTuple tuple = before->tempTuple();
+    for (int i = 0; i < tupleCount; i++) {
+        std::ostringstream text;
+        text << "string number " << i << " long enough not to be inlined";
+        NValue value = ValueFactory::getStringValue(text.str());
+        tuple.setNValue(0, ValueFactory::getIntegerValue(i));
+        tuple.setNValue(1, value);
+        before->insertTuple(tuple);
+        value.free();
+    }
+    m_engine->releaseUndoToken(1);
+    const int64_t stringMemory = before->nonInlinedMemorySize();
+
+    result = m_engine->updateCatalog(1,
+        "add " + table + " columns T\n"
+        "set " + table + "/columns[T] index 2\n"
+        "set " + table + "/columns[T] type 9\n"
+        "set " + table + "/columns[T] size 100\n"
+        "set " + table + "/columns[T] nullable true\n"
+        "set " + table + "/columns[T] name \"T\"");
+    ASSERT_TRUE(result);
+
+    Table *after = m_engine->getMigratedTable("tableC");
+    ASSERT_EQ(tupleCount, after->activeTupleCount());
+    ASSERT_EQ(stringMemory, after->nonInlinedMemorySize());
+
+    TableIterator iterator = after->iterator();
+    TableTuple scanned(after->schema());
+    while (iterator.next(scanned)) {
+        std::ostringstream text;
+        text << "string number " << ValuePeeker::peekAsBigInt(scanned.getNValue(0))
+             << " long enough not to be inlined";
+        ASSERT_EQ(text.str(), ValuePeeker::peekStringCopy(scanned.getNValue(1)));
+        ASSERT_TRUE(scanned.getNValue(2).isNull());
+    }
+}
 
 int main() {
     return TestSuite::globalInstance()->runAll();
@@ -0,0 +1,194 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+#include "plannodes/indexscannode.h"
+#include "plannodes/plannodefragment.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace voltdb;
+using namespace std;
+
+namespace {
+
+const int ROW_COUNT = 150;
+const int DISTINCT_VALUES = 50;
+const int LIMIT = 10;
+
+// INDEXSCAN over T(ID, V) by its index on V, starting at the key and
+// stopping at the bound, with an inline LIMIT and OFFSET. Ascending scans
+// look up V >= key and stop before V >= bound; descending scans look up
+// V <= key and stop before V < bound. A post predicate that every row
+// passes keeps the scan from seeking past the offset by rank.
+string indexScanPlanJSON(bool ascending, int64_t key, int64_t bound,
+                         int offset, bool postPredicate)
+{
+    const string v = tupleValueJSON(1);
+    const char *columnNames[] = { "ID", "V" };
+
+    ostringstream json;
+    json << "{\"PLAN_NODES\":["
+         << "{\"PLAN_NODE_TYPE\":\"INDEXSCAN\",\"ID\":1,"
+         << "\"INLINE_NODES\":[" << limitJSON(2, LIMIT, offset) << "],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 2) << "],"
+         << "\"TARGET_TABLE_NAME\":\"T\",\"TARGET_INDEX_NAME\":\"IDX_V\","
+         << "\"LOOKUP_TYPE\":\"" << (ascending ? "GTE" : "LTE") << "\","
+         << "\"SORT_DIRECTION\":\"" << (ascending ? "ASC" : "DESC") << "\","
+         << "\"SEARCHKEY_EXPRESSIONS\":[" << constantJSON(key) << "],";
+    if (!ascending) {
+        json << "\"INITIAL_EXPRESSION\":"
+             << binaryJSON("COMPARE_LESSTHANOREQUALTO", v, constantJSON(key)) << ",";
+    }
+    json << "\"END_EXPRESSION\":"
+         << (ascending ? binaryJSON("COMPARE_LESSTHAN", v, constantJSON(bound))
+                       : binaryJSON("COMPARE_GREATERTHANOREQUALTO", v, constantJSON(bound))) << ","
+         << "\"PREDICATE\":"
+         << (postPredicate ? binaryJSON("COMPARE_EQUAL", v, v) : "null") << "}],"
+         << "\"EXECUTE_LIST\":[1],\"PARAMETERS\":[]}";
+    return json.str();
+}
+
+}
+
+class IndexScanExecutorTest : public Test
+{
+public:
+    IndexScanExecutorTest() : m_table(NULL)
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+
+        vector<ValueType> types(2, VALUE_TYPE_BIGINT);
+        vector<int32_t> sizes(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> allowNull(2, false);
+        vector<string> names;
+        names.push_back("ID");
+        names.push_back("V");
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, sizes, allowNull, true);
+        m_table = dynamic_cast<PersistentTable*>(TableFactory::getPersistentTable(0, "T", schema, names));
+
+        // a countable index, so that an offset can be skipped by rank
+        vector<int> columns(1, 1);
+        TableIndexScheme scheme("IDX_V", BALANCED_TREE_INDEX, columns,
+                                TableIndex::simplyIndexColumns(), false, true, schema);
+        m_table->addIndex(TableIndexFactory::getInstance(scheme));
+
+        // each value of V three times, out of order
+        TableTuple &tuple = m_table->tempTuple();
+        for (int i = 0; i < ROW_COUNT; i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(1, ValueFactory::getBigIntValue((i * 7) % DISTINCT_VALUES));
+            m_table->insertTuple(tuple);
+        }
+    }
+
+    ~IndexScanExecutorTest()
+    {
+        delete m_table;
+    }
+
+    // Run the scan and return the ID of each tuple it output
+    vector<int64_t> scan(bool ascending, int64_t key, int64_t bound,
+                         int offset, bool postPredicate)
+    {
+        auto_ptr<PlanNodeFragment> fragment(PlanNodeFragment::createFromCatalog(
+            indexScanPlanJSON(ascending, key, bound, offset, postPredicate)));
+        IndexScanPlanNode *node = static_cast<IndexScanPlanNode*>(fragment->getExecuteList()[0]);
+        node->setTargetTable(m_table);
+        vector<int64_t> result;
+        auto_ptr<AbstractExecutor> executor(getNewExecutor(&m_engine, node));
+        if (!executor->init(&m_engine, &m_limits) || !executor->execute(NValueArray())) {
+            return result;
+        }
+        Table *output = node->getOutputTable();
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        while (iter.next(tuple)) {
+            result.push_back(ValuePeeker::peekAsBigInt(tuple.getNValue(0)));
+        }
+        return result;
+    }
+
+    // The V of the tuple with the given ID
+    static int64_t valueOf(int64_t id)
+    {
+        return (id * 7) % DISTINCT_VALUES;
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+    PersistentTable *m_table;
+};
+
+TEST_F(IndexScanExecutorTest, OffsetByRankAscending)
+{
+    // V in [10, 40) holds 90 tuples
+    for (int offset = 0; offset <= 95; offset += 5) {
+        vector<int64_t> byRank = scan(true, 10, 40, offset, false);
+        vector<int64_t> linear = scan(true, 10, 40, offset, true);
+        ASSERT_TRUE(byRank == linear);
+        ASSERT_EQ(static_cast<size_t>(std::max(0, std::min(LIMIT, 90 - offset))), byRank.size());
+        for (size_t i = 0; i < byRank.size(); i++) {
+            // three tuples to a value, from V = 10 up
+            EXPECT_EQ(10 + (offset + static_cast<int>(i)) / 3, valueOf(byRank[i]));
+        }
+    }
+}
+
+TEST_F(IndexScanExecutorTest, OffsetByRankDescending)
+{
+    // V in [5, 30] holds 78 tuples
+    for (int offset = 0; offset <= 80; offset += 4) {
+        vector<int64_t> byRank = scan(false, 30, 5, offset, false);
+        vector<int64_t> linear = scan(false, 30, 5, offset, true);
+        ASSERT_TRUE(byRank == linear);
+        ASSERT_EQ(static_cast<size_t>(std::max(0, std::min(LIMIT, 78 - offset))), byRank.size());
+        for (size_t i = 0; i < byRank.size(); i++) {
+            // three tuples to a value, from V = 30 down
+            EXPECT_EQ(30 - (offset + static_cast<int>(i)) / 3, valueOf(byRank[i]));
+        }
+    }
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,168 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "plannodes/mergejoinnode.h"
+#include "plannodes/plannodefragment.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <memory>
+
+using namespace voltdb;
+using namespace std;
+
+class MergeJoinExecutorTest : public Test
+{
+public:
+    MergeJoinExecutorTest()
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    // Run the join on O.ID = I.K over inputs sorted on their keys and
+    // return the V and W of each joined tuple, with NULL_VALUE for a
+    // padded W
+    vector<pair<int64_t, int64_t> > join(const string &joinType,
+                                         const string &joinPredicate = "null",
+                                         const string &inlineNodes = "")
+    {
+        const int64_t outerRows[][2] = { {NULL_VALUE, 0}, {1, 10}, {2, 20}, {2, 21}, {4, 40}, {5, 50} };
+        const int64_t innerRows[][2] = { {NULL_VALUE, 0}, {2, 200}, {2, 201}, {3, 300}, {5, 500}, {6, 600} };
+
+        auto_ptr<PlanNodeFragment> fragment(PlanNodeFragment::createFromCatalog(
+            joinPlanJSON("MERGEJOIN", joinType, true, joinPredicate, 4, inlineNodes)));
+        fragment->getExecuteList()[0]->setOutputTable(inputTable("O", outerRows, 6));
+        fragment->getExecuteList()[1]->setOutputTable(inputTable("I", innerRows, 6));
+        AbstractPlanNode *node = fragment->getExecuteList()[2];
+        vector<pair<int64_t, int64_t> > result;
+        auto_ptr<AbstractExecutor> executor(getNewExecutor(&m_engine, node));
+        if (!executor->init(&m_engine, &m_limits) || !executor->execute(NValueArray())) {
+            return result;
+        }
+        Table *output = node->getOutputTable();
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        while (iter.next(tuple)) {
+            NValue w = tuple.getNValue(3);
+            result.push_back(make_pair(ValuePeeker::peekAsBigInt(tuple.getNValue(1)),
+                                       w.isNull() ? NULL_VALUE : ValuePeeker::peekAsBigInt(w)));
+        }
+        return result;
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+};
+
+TEST_F(MergeJoinExecutorTest, InnerJoin)
+{
+    // duplicate keys on both sides join every pair, NULL keys match nothing
+    const int64_t expected[][2] = { {20, 200}, {20, 201}, {21, 200}, {21, 201}, {50, 500} };
+    vector<pair<int64_t, int64_t> > joined = join("INNER");
+    ASSERT_EQ(5, joined.size());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(expected[i][0], joined[i].first);
+        EXPECT_EQ(expected[i][1], joined[i].second);
+    }
+}
+
+TEST_F(MergeJoinExecutorTest, LeftOuterJoin)
+{
+    const int64_t expected[][2] = { {0, NULL_VALUE}, {10, NULL_VALUE}, {20, 200}, {20, 201},
+                                    {21, 200}, {21, 201}, {40, NULL_VALUE}, {50, 500} };
+    vector<pair<int64_t, int64_t> > joined = join("LEFT");
+    ASSERT_EQ(8, joined.size());
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(expected[i][0], joined[i].first);
+        EXPECT_EQ(expected[i][1], joined[i].second);
+    }
+}
+
+TEST_F(MergeJoinExecutorTest, JoinPredicate)
+{
+    // V + 180 < W leaves 21 unmatched; a left join pads the outer tuples
+    // whose key matches but whose predicate never does
+    const string predicate = binaryJSON("COMPARE_LESSTHAN",
+                                        binaryJSON("OPERATOR_PLUS", tupleValueJSON(0, 1), constantJSON(180)),
+                                        tupleValueJSON(1, 1));
+    const int64_t innerExpected[][2] = { {20, 201}, {50, 500} };
+    vector<pair<int64_t, int64_t> > joined = join("INNER", predicate);
+    ASSERT_EQ(2, joined.size());
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(innerExpected[i][0], joined[i].first);
+        EXPECT_EQ(innerExpected[i][1], joined[i].second);
+    }
+
+    const int64_t leftExpected[][2] = { {0, NULL_VALUE}, {10, NULL_VALUE}, {20, 201},
+                                        {21, NULL_VALUE}, {40, NULL_VALUE}, {50, 500} };
+    joined = join("LEFT", predicate);
+    ASSERT_EQ(6, joined.size());
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(leftExpected[i][0], joined[i].first);
+        EXPECT_EQ(leftExpected[i][1], joined[i].second);
+    }
+}
+
+TEST_F(MergeJoinExecutorTest, InlineLimitAndOffset)
+{
+    const int64_t innerExpected[][2] = { {20, 201}, {21, 200} };
+    vector<pair<int64_t, int64_t> > joined = join("INNER", "null", limitJSON(4, 2, 1));
+    ASSERT_EQ(2, joined.size());
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(innerExpected[i][0], joined[i].first);
+        EXPECT_EQ(innerExpected[i][1], joined[i].second);
+    }
+
+    // the offset and limit count padded tuples too
+    const int64_t leftExpected[][2] = { {10, NULL_VALUE}, {20, 200}, {20, 201} };
+    joined = join("LEFT", "null", limitJSON(4, 3, 1));
+    ASSERT_EQ(3, joined.size());
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(leftExpected[i][0], joined[i].first);
+        EXPECT_EQ(leftExpected[i][1], joined[i].second);
+    }
+
+    // an offset that ends within a run of duplicate keys
+    joined = join("LEFT", "null", limitJSON(4, 3, 5));
+    ASSERT_EQ(3, joined.size());
+    EXPECT_EQ(21, joined[0].first);
+    EXPECT_EQ(201, joined[0].second);
+    EXPECT_EQ(40, joined[1].first);
+    EXPECT_EQ(NULL_VALUE, joined[1].second);
+    EXPECT_EQ(50, joined[2].first);
+    EXPECT_EQ(500, joined[2].second);
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
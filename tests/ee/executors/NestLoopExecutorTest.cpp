@@ -0,0 +1,156 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "plannodes/nestloopnode.h"
+#include "plannodes/plannodefragment.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <memory>
+
+using namespace voltdb;
+using namespace std;
+
+namespace {
+
+// NESTLOOP <- SEQSCAN over O(ID, V), SEQSCAN over I(K, W), joining on
+// O.ID = I.K, either as keys or in the join predicate, optionally with
+// the residual O.V < I.W, and outputting O. A keyed join may look up
+// outerKey = I.K instead.
+string nestLoopPlanJSON(const string &joinType, bool keyed, bool residual, const string &outerKey)
+{
+    const string keyEquality = binaryJSON("COMPARE_EQUAL", tupleValueJSON(0, 0), tupleValueJSON(1, 0));
+    const string residualPredicate = binaryJSON("COMPARE_LESSTHAN", tupleValueJSON(0, 1), tupleValueJSON(1, 1));
+    string joinPredicate = "null";
+    if (keyed) {
+        joinPredicate = residual ? residualPredicate : "null";
+    } else {
+        joinPredicate = residual ? binaryJSON("CONJUNCTION_AND", keyEquality, residualPredicate) : keyEquality;
+    }
+    return joinPlanJSON("NESTLOOP", joinType, keyed, joinPredicate, 2, "", outerKey);
+}
+
+string doubleConstantJSON(const string &value)
+{
+    return "{\"TYPE\":\"VALUE_CONSTANT\",\"VALUE_TYPE\":\"FLOAT\",\"VALUE_SIZE\":8,"
+        "\"ISNULL\":false,\"VALUE\":" + value + "}";
+}
+
+}
+
+class NestLoopExecutorTest : public Test
+{
+public:
+    NestLoopExecutorTest()
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    // Run the join and return the V of each outer tuple it output
+    vector<int64_t> join(const string &joinType, bool keyed, bool residual, const string &outerKey = "")
+    {
+        const int64_t outerRows[][2] = { {1, 10}, {2, 20}, {3, 30}, {NULL_VALUE, 40}, {5, 50} };
+        const int64_t innerRows[][2] = { {2, 100}, {2, 5}, {3, 1}, {NULL_VALUE, 0}, {7, 0} };
+
+        auto_ptr<PlanNodeFragment> fragment(PlanNodeFragment::createFromCatalog(nestLoopPlanJSON(joinType, keyed, residual, outerKey)));
+        fragment->getExecuteList()[0]->setOutputTable(inputTable("O", outerRows, 5));
+        fragment->getExecuteList()[1]->setOutputTable(inputTable("I", innerRows, 5));
+        AbstractPlanNode *node = fragment->getExecuteList()[2];
+        vector<int64_t> result;
+        auto_ptr<AbstractExecutor> executor(getNewExecutor(&m_engine, node));
+        if (!executor->init(&m_engine, &m_limits) || !executor->execute(NValueArray())) {
+            return result;
+        }
+        Table *output = node->getOutputTable();
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        while (iter.next(tuple)) {
+            result.push_back(ValuePeeker::peekAsBigInt(tuple.getNValue(1)));
+        }
+        return result;
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+};
+
+TEST_F(NestLoopExecutorTest, SemiJoin)
+{
+    // each match is output once, NULL keys match nothing
+    for (int keyed = 0; keyed < 2; keyed++) {
+        vector<int64_t> semi = join("SEMI", keyed, false);
+        ASSERT_EQ(2, semi.size());
+        EXPECT_EQ(20, semi[0]);
+        EXPECT_EQ(30, semi[1]);
+
+        semi = join("SEMI", keyed, true);
+        ASSERT_EQ(1, semi.size());
+        EXPECT_EQ(20, semi[0]);
+    }
+}
+
+TEST_F(NestLoopExecutorTest, AntiJoin)
+{
+    for (int keyed = 0; keyed < 2; keyed++) {
+        vector<int64_t> anti = join("ANTI", keyed, false);
+        ASSERT_EQ(3, anti.size());
+        EXPECT_EQ(10, anti[0]);
+        EXPECT_EQ(40, anti[1]);
+        EXPECT_EQ(50, anti[2]);
+
+        anti = join("ANTI", keyed, true);
+        ASSERT_EQ(4, anti.size());
+        EXPECT_EQ(10, anti[0]);
+        EXPECT_EQ(30, anti[1]);
+        EXPECT_EQ(40, anti[2]);
+        EXPECT_EQ(50, anti[3]);
+    }
+}
+
+TEST_F(NestLoopExecutorTest, MixedTypeKeys)
+{
+    // A FLOAT outer key of 2.5 would be 2 as the BIGINT key of I.K, but
+    // equals no BIGINT, while 2.0 matches the inner tuples with K = 2.
+    vector<int64_t> semi = join("SEMI", true, false, doubleConstantJSON("2.5"));
+    EXPECT_EQ(0, semi.size());
+    vector<int64_t> anti = join("ANTI", true, false, doubleConstantJSON("2.5"));
+    EXPECT_EQ(5, anti.size());
+
+    semi = join("SEMI", true, false, doubleConstantJSON("2.0"));
+    EXPECT_EQ(5, semi.size());
+    anti = join("ANTI", true, false, doubleConstantJSON("2.0"));
+    EXPECT_EQ(0, anti.size());
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,266 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+#include "plannodes/indexscannode.h"
+#include "plannodes/plannodefragment.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <memory>
+
+using namespace voltdb;
+using namespace std;
+
+namespace {
+
+const int ROW_COUNT = 150;
+const int DISTINCT_VALUES = 50;
+
+// PARENT <- INDEXSCAN over T(ID, V), where parent is the JSON of the
+// parent node's own attributes. IDX_V is a tree index on V and
+// IDX_V_HASH a hash index on V. Without a key the scan covers the whole
+// index in the given direction; with one it looks up V = key.
+string planJSON(const string &parent, const char *indexName, const char *direction,
+                int64_t key = -1)
+{
+    const char *columnNames[] = { "ID", "V" };
+    ostringstream json;
+    json << "{\"PLAN_NODES\":[" << parent << ","
+         << "{\"PLAN_NODE_TYPE\":\"INDEXSCAN\",\"ID\":2,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 2) << "],"
+         << "\"TARGET_TABLE_NAME\":\"T\",\"TARGET_INDEX_NAME\":\"" << indexName << "\","
+         << "\"LOOKUP_TYPE\":\"" << (key < 0 ? "GTE" : "EQ") << "\","
+         << "\"SORT_DIRECTION\":\"" << direction << "\","
+         << "\"SEARCHKEY_EXPRESSIONS\":[" << (key < 0 ? "" : constantJSON(key)) << "],"
+         << "\"END_EXPRESSION\":null,\"PREDICATE\":null}],"
+         << "\"EXECUTE_LIST\":[2,1],\"PARAMETERS\":[]}";
+    return json.str();
+}
+
+// ORDERBY column in direction, with an inline LIMIT/OFFSET if limit is set
+string orderByJSON(int column, const char *direction, int limit, int offset)
+{
+    const char *columnNames[] = { "ID", "V" };
+    ostringstream json;
+    json << "{\"PLAN_NODE_TYPE\":\"ORDERBY\",\"ID\":1,"
+         << "\"INLINE_NODES\":[" << (limit >= 0 ? limitJSON(3, limit, offset) : "") << "],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 2) << "],"
+         << "\"SORT_COLUMNS\":[{\"SORT_EXPRESSION\":" << tupleValueJSON(column) << ","
+         << "\"SORT_DIRECTION\":\"" << direction << "\"}]}";
+    return json.str();
+}
+
+// A LIMIT/OFFSET of its own, not inlined
+string limitParentJSON(int limit, int offset)
+{
+    ostringstream json;
+    json << "{\"PLAN_NODE_TYPE\":\"LIMIT\",\"ID\":1,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2],"
+         << "\"LIMIT\":" << limit << ",\"OFFSET\":" << offset << "}";
+    return json.str();
+}
+
+// The V of the tuple with the given ID
+int64_t valueOf(int64_t id)
+{
+    return (id * 7) % DISTINCT_VALUES;
+}
+
+}
+
+class OrderByExecutorTest : public Test
+{
+public:
+    OrderByExecutorTest() : m_table(NULL), m_scanned(0)
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+
+        vector<ValueType> types(2, VALUE_TYPE_BIGINT);
+        vector<int32_t> sizes(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> allowNull(2, false);
+        vector<string> names;
+        names.push_back("ID");
+        names.push_back("V");
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, sizes, allowNull, true);
+        m_table = dynamic_cast<PersistentTable*>(TableFactory::getPersistentTable(0, "T", schema, names));
+
+        vector<int> columns(1, 1);
+        TableIndexScheme treeScheme("IDX_V", BALANCED_TREE_INDEX, columns,
+                                    TableIndex::simplyIndexColumns(), false, false, schema);
+        m_table->addIndex(TableIndexFactory::getInstance(treeScheme));
+        TableIndexScheme hashScheme("IDX_V_HASH", HASH_TABLE_INDEX, columns,
+                                    TableIndex::simplyIndexColumns(), false, false, schema);
+        m_table->addIndex(TableIndexFactory::getInstance(hashScheme));
+
+        // each value of V three times, out of order
+        TableTuple &tuple = m_table->tempTuple();
+        for (int i = 0; i < ROW_COUNT; i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(valueOf(i)));
+            m_table->insertTuple(tuple);
+        }
+    }
+
+    ~OrderByExecutorTest()
+    {
+        delete m_table;
+    }
+
+    // Run the scan and its parent, note how many tuples the scan output
+    // in m_scanned, and return the given column of each tuple the parent
+    // output
+    vector<int64_t> execute(const string &plan, int column)
+    {
+        vector<int64_t> result;
+        auto_ptr<PlanNodeFragment> fragment(PlanNodeFragment::createFromCatalog(plan));
+        IndexScanPlanNode *scanNode = static_cast<IndexScanPlanNode*>(fragment->getExecuteList()[0]);
+        scanNode->setTargetTable(m_table);
+        AbstractPlanNode *parentNode = fragment->getExecuteList()[1];
+
+        // the plan nodes own their executors
+        AbstractExecutor *scan = getNewExecutor(&m_engine, scanNode);
+        scanNode->setExecutor(scan);
+        AbstractExecutor *parent = getNewExecutor(&m_engine, parentNode);
+        parentNode->setExecutor(parent);
+        if (!scan->init(&m_engine, &m_limits) || !parent->init(&m_engine, &m_limits) ||
+            !scan->execute(NValueArray()) || !parent->execute(NValueArray())) {
+            return result;
+        }
+
+        m_scanned = scanNode->getOutputTable()->activeTupleCount();
+        Table *output = parentNode->getOutputTable();
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        while (iter.next(tuple)) {
+            result.push_back(ValuePeeker::peekAsBigInt(tuple.getNValue(column)));
+        }
+        return result;
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+    PersistentTable *m_table;
+    int64_t m_scanned;
+};
+
+TEST_F(OrderByExecutorTest, MatchingIndexOrder)
+{
+    // The tree index already yields ORDER BY V, so the tuples come out in
+    // index order and the inline limit stops the scan after LIMIT + OFFSET.
+    vector<int64_t> values = execute(planJSON(orderByJSON(1, "ASC", 5, 7), "IDX_V", "ASC"), 1);
+    ASSERT_EQ(5, values.size());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ((7 + i) / 3, values[i]);
+    }
+    EXPECT_EQ(12, m_scanned);
+
+    values = execute(planJSON(orderByJSON(1, "DESC", 4, 2), "IDX_V", "DESC"), 1);
+    ASSERT_EQ(4, values.size());
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(DISTINCT_VALUES - 1 - (2 + i) / 3, values[i]);
+    }
+    EXPECT_EQ(6, m_scanned);
+
+    // without a limit every tuple comes through, still in order
+    values = execute(planJSON(orderByJSON(1, "ASC", -1, 0), "IDX_V", "ASC"), 1);
+    ASSERT_EQ(ROW_COUNT, values.size());
+    for (int i = 0; i < ROW_COUNT; i++) {
+        EXPECT_EQ(i / 3, values[i]);
+    }
+    EXPECT_EQ(ROW_COUNT, m_scanned);
+}
+
+TEST_F(OrderByExecutorTest, NonMatchingOrder)
+{
+    // The scan runs against the sort direction: the sort is kept and the
+    // limit can't stop the scan.
+    vector<int64_t> values = execute(planJSON(orderByJSON(1, "DESC", 5, 1), "IDX_V", "ASC"), 1);
+    ASSERT_EQ(5, values.size());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(DISTINCT_VALUES - 1 - (1 + i) / 3, values[i]);
+    }
+    EXPECT_EQ(ROW_COUNT, m_scanned);
+
+    // The sort is on a column the index is not ordered on.
+    vector<int64_t> ids = execute(planJSON(orderByJSON(0, "ASC", 10, 0), "IDX_V", "ASC"), 0);
+    ASSERT_EQ(10, ids.size());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, ids[i]);
+    }
+    EXPECT_EQ(ROW_COUNT, m_scanned);
+}
+
+TEST_F(OrderByExecutorTest, HashIndexIsNeverOrdered)
+{
+    // A lookup of V = 5 finds IDs 15, 65 and 115. Even sorted on the key
+    // it looked up, a hash index scan is sorted and never cut short.
+    vector<int64_t> ids = execute(planJSON(orderByJSON(0, "DESC", 2, 0), "IDX_V_HASH", "ASC", 5), 0);
+    ASSERT_EQ(2, ids.size());
+    EXPECT_EQ(115, ids[0]);
+    EXPECT_EQ(65, ids[1]);
+    EXPECT_EQ(3, m_scanned);
+
+    vector<int64_t> values = execute(planJSON(orderByJSON(1, "ASC", 1, 0), "IDX_V_HASH", "ASC", 5), 1);
+    ASSERT_EQ(1, values.size());
+    EXPECT_EQ(5, values[0]);
+    EXPECT_EQ(3, m_scanned);
+}
+
+TEST_F(OrderByExecutorTest, ParentLimitStopsScan)
+{
+    // A LIMIT of its own takes any rows, so the scan stops after
+    // LIMIT + OFFSET of them and the LIMIT skips the first OFFSET.
+    vector<int64_t> values = execute(planJSON(limitParentJSON(6, 9), "IDX_V", "ASC"), 1);
+    ASSERT_EQ(6, values.size());
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ((9 + i) / 3, values[i]);
+    }
+    EXPECT_EQ(15, m_scanned);
+
+    // an offset past the end leaves nothing
+    values = execute(planJSON(limitParentJSON(6, ROW_COUNT), "IDX_V", "DESC"), 1);
+    EXPECT_EQ(0, values.size());
+    EXPECT_EQ(ROW_COUNT, m_scanned);
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,299 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/Topend.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "logging/StdoutLogProxy.h"
+#include "plannodes/plannodefragment.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/temptable.h"
+#include "storage/TempBlockPool.h"
+#include "storage/TempTableLimits.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+using namespace voltdb;
+using namespace std;
+
+namespace {
+
+// Enough (K, V) rows to fill a few dozen temp table blocks, so that the
+// sorted runs are merged in more than one pass
+const int ROW_COUNT = 250000;
+const int KEY_COUNT = 5000;
+
+int64_t keyOf(int row)
+{
+    return (static_cast<int64_t>(row) * 7919) % KEY_COUNT;
+}
+
+// PARENT <- SEQSCAN over (K, V), where parent is the JSON of the parent
+// node's own attributes
+string planJSON(const string &parent)
+{
+    const char *columnNames[] = { "K", "V" };
+    ostringstream json;
+    json << "{\"PLAN_NODES\":[" << parent << ","
+         << "{\"PLAN_NODE_TYPE\":\"SEQSCAN\",\"ID\":2,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 2) << "],"
+         << "\"TARGET_TABLE_NAME\":\"T\"}],"
+         << "\"EXECUTE_LIST\":[2,1],\"PARAMETERS\":[]}";
+    return json.str();
+}
+
+// ORDERBY K with an optional inline LIMIT/OFFSET
+string orderByPlanJSON(const char *direction, int limit, int offset)
+{
+    const char *columnNames[] = { "K", "V" };
+    ostringstream json;
+    json << "{\"PLAN_NODE_TYPE\":\"ORDERBY\",\"ID\":1,"
+         << "\"INLINE_NODES\":[" << (limit >= 0 ? limitJSON(3, limit, offset) : "") << "],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 2) << "],"
+         << "\"SORT_COLUMNS\":[{\"SORT_EXPRESSION\":" << tupleValueJSON(0) << ","
+         << "\"SORT_DIRECTION\":\"" << direction << "\"}]}";
+    return planJSON(json.str());
+}
+
+// SELECT K, SUM(V), COUNT(*) ... GROUP BY K
+string hashAggregatePlanJSON()
+{
+    const char *columnNames[] = { "K", "SUM", "COUNT" };
+    ostringstream json;
+    json << "{\"PLAN_NODE_TYPE\":\"HASHAGGREGATE\",\"ID\":1,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(columnNames, 3, 2) << "],"
+         << "\"AGGREGATE_COLUMNS\":["
+         << "{\"AGGREGATE_TYPE\":\"AGGREGATE_SUM\",\"AGGREGATE_DISTINCT\":0,"
+         << "\"AGGREGATE_OUTPUT_COLUMN\":1,\"AGGREGATE_EXPRESSION\":" << tupleValueJSON(1) << "},"
+         << "{\"AGGREGATE_TYPE\":\"AGGREGATE_COUNT_STAR\",\"AGGREGATE_DISTINCT\":0,"
+         << "\"AGGREGATE_OUTPUT_COLUMN\":2}],"
+         << "\"GROUPBY_EXPRESSIONS\":[" << tupleValueJSON(0) << "]}";
+    return planJSON(json.str());
+}
+
+// Takes the progress reports of the long running fragments
+class ProgressTopend : public Topend {
+  public:
+    int loadNextDependency(int32_t dependencyId, Pool *pool, Table* destination) {
+        return 0;
+    }
+    bool fragmentProgressUpdate(int32_t batchIndex, string planNodeName,
+                                string targetTableName, int64_t targetTableSize,
+                                int64_t tuplesProcessed) {
+        return false;
+    }
+    string planForFragmentId(int64_t fragmentId) {
+        return "";
+    }
+    void crashVoltDB(FatalException e) {
+    }
+    int64_t getQueuedExportBytes(int32_t partitionId, string signature) {
+        return 0;
+    }
+    void pushExportBuffer(int64_t exportGeneration, int32_t partitionId, string signature,
+                          StreamBlock *block, bool sync, bool endOfStream) {
+    }
+    void fallbackToEEAllocatedBuffer(char *buffer, size_t length) {
+    }
+};
+
+bool descendingKey(const pair<int64_t, int64_t> &a, const pair<int64_t, int64_t> &b)
+{
+    return a.first > b.first;
+}
+
+bool ascendingKey(const pair<int64_t, int64_t> &a, const pair<int64_t, int64_t> &b)
+{
+    return a.first < b.first;
+}
+
+}
+
+class SpillingExecutorTest : public Test
+{
+public:
+    SpillingExecutorTest() : m_engine(new ProgressTopend(), new StdoutLogProxy())
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+        // Spill every temp table block
+        m_limits.setSpillThreshold(TEMP_TABLE_BLOCK_SIZE / 2);
+    }
+
+    // Plan the fragment with an empty (K, V) input table for the parent,
+    // as the child executor leaves it before it runs.
+    AbstractExecutor* planFragment(const string &json)
+    {
+        m_fragment.reset(PlanNodeFragment::createFromCatalog(json));
+        m_input = inputTable("T", NULL, 0, &m_limits);
+        m_fragment->getExecuteList()[0]->setOutputTable(m_input);
+        AbstractPlanNode *node = m_fragment->getExecuteList()[1];
+        m_executor.reset(getNewExecutor(&m_engine, node));
+        if (!m_executor->init(&m_engine, &m_limits)) {
+            return NULL;
+        }
+        return m_executor.get();
+    }
+
+    // Produce rows [first, last) into the input, as the child executor would
+    void produceInput(int first, int last)
+    {
+        TableTuple &tuple = m_input->tempTuple();
+        for (int i = first; i < last; i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(keyOf(i)));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(i));
+            m_input->insertTempTuple(tuple);
+        }
+    }
+
+    // Check that the output holds the rows, in order
+    bool outputMatches(const vector<pair<int64_t, int64_t> > &rows)
+    {
+        Table *output = m_fragment->getExecuteList()[1]->getOutputTable();
+        if (output->activeTupleCount() != static_cast<int64_t>(rows.size())) {
+            return false;
+        }
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        for (size_t i = 0; iter.next(tuple); i++) {
+            if (ValuePeeker::peekAsBigInt(tuple.getNValue(0)) != rows[i].first ||
+                ValuePeeker::peekAsBigInt(tuple.getNValue(1)) != rows[i].second) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+    auto_ptr<PlanNodeFragment> m_fragment;
+    auto_ptr<AbstractExecutor> m_executor;
+    TempTable *m_input;
+};
+
+TEST_F(SpillingExecutorTest, OrderBySpillsWhileInputIsProduced)
+{
+    AbstractExecutor *executor = planFragment(orderByPlanJSON("ASC", -1, -1));
+    ASSERT_TRUE(executor != NULL);
+    produceInput(0, ROW_COUNT);
+    // The input was sorted into runs and spilled block by block.
+    ASSERT_TRUE(m_input->activeTupleCount() < ROW_COUNT / 10);
+
+    // The merge keeps equal keys in input order.
+    vector<pair<int64_t, int64_t> > expected;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        expected.push_back(make_pair(keyOf(i), static_cast<int64_t>(i)));
+    }
+    stable_sort(expected.begin(), expected.end(), ascendingKey);
+    ASSERT_TRUE(executor->execute(NValueArray()));
+    ASSERT_TRUE(outputMatches(expected));
+    EXPECT_EQ(0, m_input->activeTupleCount());
+
+    // Runs spilled before the input is cleared for the next execution
+    // go with it.
+    produceInput(0, ROW_COUNT);
+    m_input->deleteAllTuplesNonVirtual(false);
+    produceInput(0, 100);
+    expected.clear();
+    for (int i = 0; i < 100; i++) {
+        expected.push_back(make_pair(keyOf(i), static_cast<int64_t>(i)));
+    }
+    stable_sort(expected.begin(), expected.end(), ascendingKey);
+    ASSERT_TRUE(executor->execute(NValueArray()));
+    // Too few rows to spill, so ties come out in no particular order
+    Table *output = m_fragment->getExecuteList()[1]->getOutputTable();
+    ASSERT_EQ(100, output->activeTupleCount());
+    TableTuple tuple(output->schema());
+    TableIterator iter = output->iterator();
+    for (int i = 0; iter.next(tuple); i++) {
+        EXPECT_EQ(expected[i].first, ValuePeeker::peekAsBigInt(tuple.getNValue(0)));
+    }
+}
+
+TEST_F(SpillingExecutorTest, OrderBySpillsWithLimitAndOffset)
+{
+    AbstractExecutor *executor = planFragment(orderByPlanJSON("DESC", 100, 1000));
+    ASSERT_TRUE(executor != NULL);
+    produceInput(0, ROW_COUNT);
+    ASSERT_TRUE(m_input->activeTupleCount() < ROW_COUNT / 10);
+
+    vector<pair<int64_t, int64_t> > sorted;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        sorted.push_back(make_pair(keyOf(i), static_cast<int64_t>(i)));
+    }
+    stable_sort(sorted.begin(), sorted.end(), descendingKey);
+    vector<pair<int64_t, int64_t> > expected(sorted.begin() + 1000, sorted.begin() + 1100);
+    ASSERT_TRUE(executor->execute(NValueArray()));
+    ASSERT_TRUE(outputMatches(expected));
+}
+
+TEST_F(SpillingExecutorTest, HashAggregateSpillsWhileInputIsProduced)
+{
+    AbstractExecutor *executor = planFragment(hashAggregatePlanJSON());
+    ASSERT_TRUE(executor != NULL);
+    map<int64_t, pair<int64_t, int64_t> > expected;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        expected[keyOf(i)].first += i;
+        expected[keyOf(i)].second++;
+    }
+
+    // run twice to check that the partitions start over
+    for (int run = 0; run < 2; run++) {
+        m_input->deleteAllTuplesNonVirtual(false);
+        produceInput(0, ROW_COUNT);
+        ASSERT_TRUE(m_input->activeTupleCount() < ROW_COUNT / 10);
+        ASSERT_TRUE(executor->execute(NValueArray()));
+
+        Table *output = m_fragment->getExecuteList()[1]->getOutputTable();
+        ASSERT_EQ(KEY_COUNT, output->activeTupleCount());
+        TableTuple tuple(output->schema());
+        TableIterator iter = output->iterator();
+        while (iter.next(tuple)) {
+            const int64_t key = ValuePeeker::peekAsBigInt(tuple.getNValue(0));
+            ASSERT_TRUE(expected.find(key) != expected.end());
+            EXPECT_EQ(expected[key].first, ValuePeeker::peekAsBigInt(tuple.getNValue(1)));
+            EXPECT_EQ(expected[key].second, ValuePeeker::peekAsBigInt(tuple.getNValue(2)));
+        }
+    }
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,169 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/abstractexecutor.h"
+#include "executors/executorutil.h"
+#include "executors/executortestutil.h"
+#include "plannodes/plannodefragment.h"
+#include "plannodes/windowfunctionnode.h"
+#include "storage/tableiterator.h"
+#include "storage/TempTableLimits.h"
+
+#include <memory>
+
+using namespace voltdb;
+using namespace std;
+
+namespace {
+
+string aggregateJSON(const string &type, int outputColumn, int inputColumn)
+{
+    ostringstream json;
+    json << "{\"AGGREGATE_TYPE\":\"" << type << "\",\"AGGREGATE_DISTINCT\":0,"
+         << "\"AGGREGATE_OUTPUT_COLUMN\":" << outputColumn;
+    if (inputColumn >= 0) {
+        json << ",\"AGGREGATE_EXPRESSION\":" << tupleValueJSON(inputColumn);
+    }
+    json << "}";
+    return json.str();
+}
+
+// WINDOWFUNCTION <- SEQSCAN over (P, S), computing each of the functions
+// OVER (PARTITION BY P ORDER BY S). The functions other than the ranks
+// take S as their argument.
+string windowPlanJSON(const vector<string> &functions)
+{
+    vector<const char*> columnNames;
+    columnNames.push_back("P");
+    columnNames.push_back("S");
+    for (int i = 0; i < static_cast<int>(functions.size()); i++) {
+        columnNames.push_back(functions[i].c_str());
+    }
+
+    ostringstream json;
+    json << "{\"PLAN_NODES\":["
+         << "{\"PLAN_NODE_TYPE\":\"WINDOWFUNCTION\",\"ID\":1,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(&columnNames[0], static_cast<int>(columnNames.size()), 2) << "],"
+         << "\"AGGREGATE_COLUMNS\":[";
+    for (int i = 0; i < static_cast<int>(functions.size()); i++) {
+        bool isRank = functions[i] == "ROW_NUMBER" ||
+                      functions[i] == "RANK" ||
+                      functions[i] == "DENSE_RANK";
+        json << (i == 0 ? "" : ",")
+             << aggregateJSON("AGGREGATE_" + functions[i], 2 + i, isRank ? -1 : 1);
+    }
+    json << "],"
+         << "\"GROUPBY_EXPRESSIONS\":[" << tupleValueJSON(0) << "],"
+         << "\"ORDERBY_EXPRESSIONS\":[" << tupleValueJSON(1) << "]},"
+         << "{\"PLAN_NODE_TYPE\":\"SEQSCAN\",\"ID\":2,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(&columnNames[0], 2) << "],"
+         << "\"TARGET_TABLE_NAME\":\"T\"}],"
+         << "\"EXECUTE_LIST\":[2,1],\"PARAMETERS\":[]}";
+    return json.str();
+}
+
+}
+
+class WindowFunctionExecutorTest : public Test
+{
+public:
+    WindowFunctionExecutorTest()
+    {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    // Runs the functions over the rows twice, to check that they start
+    // over, and compares each output row's function values.
+    void verifyWindow(const vector<string> &functions,
+                      const int64_t rows[][2], int rowCount,
+                      const int64_t expected[][4])
+    {
+        auto_ptr<PlanNodeFragment> fragment(PlanNodeFragment::createFromCatalog(windowPlanJSON(functions)));
+        ASSERT_EQ(2, fragment->getExecuteList().size());
+        fragment->getExecuteList()[0]->setOutputTable(inputTable("T", rows, rowCount));
+        AbstractPlanNode *node = fragment->getExecuteList()[1];
+        ASSERT_EQ(PLAN_NODE_TYPE_WINDOWFUNCTION, node->getPlanNodeType());
+        ASSERT_EQ(1, static_cast<WindowFunctionPlanNode*>(node)->getOrderByExpressions().size());
+
+        auto_ptr<AbstractExecutor> executor(getNewExecutor(&m_engine, node));
+        ASSERT_TRUE(executor->init(&m_engine, &m_limits));
+        for (int run = 0; run < 2; run++) {
+            ASSERT_TRUE(executor->execute(NValueArray()));
+            Table *output = node->getOutputTable();
+            ASSERT_EQ(rowCount, output->activeTupleCount());
+            TableTuple tuple(output->schema());
+            TableIterator iter = output->iterator();
+            for (int i = 0; iter.next(tuple); i++) {
+                EXPECT_EQ(rows[i][0], ValuePeeker::peekAsBigInt(tuple.getNValue(0)));
+                EXPECT_EQ(rows[i][1], ValuePeeker::peekAsBigInt(tuple.getNValue(1)));
+                for (int j = 0; j < static_cast<int>(functions.size()); j++) {
+                    EXPECT_EQ(expected[i][j], ValuePeeker::peekAsBigInt(tuple.getNValue(2 + j)));
+                }
+            }
+        }
+    }
+
+    VoltDBEngine m_engine;
+    TempTableLimits m_limits;
+};
+
+TEST_F(WindowFunctionExecutorTest, RanksAndRunningSumOverPartitions)
+{
+    const int64_t rows[][2] = { {1, 10}, {1, 20}, {1, 20}, {1, 30}, {2, 5}, {2, 5} };
+    // ROW_NUMBER, RANK, DENSE_RANK, SUM; peers share their rank and sum
+    const int64_t expected[][4] = { {1, 1, 1, 10}, {2, 2, 2, 50}, {3, 2, 2, 50},
+                                    {4, 4, 3, 80}, {1, 1, 1, 10}, {2, 1, 1, 10} };
+
+    vector<string> functions;
+    functions.push_back("ROW_NUMBER");
+    functions.push_back("RANK");
+    functions.push_back("DENSE_RANK");
+    functions.push_back("SUM");
+    verifyWindow(functions, rows, 6, expected);
+}
+
+TEST_F(WindowFunctionExecutorTest, RunningCountMinMaxOverPartitions)
+{
+    const int64_t rows[][2] = { {1, 30}, {1, 40}, {1, 40}, {1, 50}, {2, 5}, {2, 5}, {3, 7} };
+    // COUNT, MIN, MAX over the rows up to and including each row's peers
+    const int64_t expected[][4] = { {1, 30, 30}, {3, 30, 40}, {3, 30, 40},
+                                    {4, 30, 50}, {2, 5, 5}, {2, 5, 5}, {1, 7, 7} };
+
+    vector<string> functions;
+    functions.push_back("COUNT");
+    functions.push_back("MIN");
+    functions.push_back("MAX");
+    verifyWindow(functions, rows, 7, expected);
+}
+
+int main()
+{
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,165 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef EXECUTORTESTUTIL_H
+#define EXECUTORTESTUTIL_H
+
+#include "common/NValue.hpp"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "storage/tablefactory.h"
+#include "storage/temptable.h"
+#include "storage/TempTableLimits.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Plan JSON and input tables for the executor tests. Every column is a
+ * BIGINT, and the plans are built the way the planner serializes them.
+ */
+namespace voltdb {
+
+// Stands for NULL in the rows given to inputTable()
+const int64_t NULL_VALUE = -1;
+
+inline std::string tupleValueJSON(int column)
+{
+    std::ostringstream json;
+    json << "{\"TYPE\":\"VALUE_TUPLE\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8,"
+         << "\"COLUMN_IDX\":" << column << "}";
+    return json.str();
+}
+
+// A column of the outer (0) or inner (1) tuple of a join
+inline std::string tupleValueJSON(int table, int column)
+{
+    std::ostringstream json;
+    json << "{\"TYPE\":\"VALUE_TUPLE\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8,"
+         << "\"TABLE_IDX\":" << table << ",\"COLUMN_IDX\":" << column << "}";
+    return json.str();
+}
+
+inline std::string constantJSON(int64_t value)
+{
+    std::ostringstream json;
+    json << "{\"TYPE\":\"VALUE_CONSTANT\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8,"
+         << "\"ISNULL\":false,\"VALUE\":" << value << "}";
+    return json.str();
+}
+
+inline std::string binaryJSON(const std::string &type, const std::string &left, const std::string &right)
+{
+    return "{\"TYPE\":\"" + type + "\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8," +
+        "\"LEFT\":" + left + ",\"RIGHT\":" + right + "}";
+}
+
+// The columns of an OUTPUT_SCHEMA. Columns past the first inputColumnCount
+// are computed by the node itself and name column 0 only as a placeholder.
+inline std::string schemaJSON(const char *columnNames[], int columnCount, int inputColumnCount = -1)
+{
+    std::ostringstream json;
+    for (int i = 0; i < columnCount; i++) {
+        json << (i == 0 ? "" : ",")
+             << "{\"COLUMN_NAME\":\"" << columnNames[i] << "\",\"TYPE\":\"BIGINT\",\"SIZE\":8,"
+             << "\"EXPRESSION\":"
+             << tupleValueJSON(inputColumnCount < 0 || i < inputColumnCount ? i : 0) << "}";
+    }
+    return json.str();
+}
+
+// An inline LIMIT node
+inline std::string limitJSON(int id, int limit, int offset)
+{
+    std::ostringstream json;
+    json << "{\"PLAN_NODE_TYPE\":\"LIMIT\",\"ID\":" << id << ",\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[],"
+         << "\"LIMIT\":" << limit << ",\"OFFSET\":" << offset << "}";
+    return json.str();
+}
+
+// nodeType <- SEQSCAN over O(ID, V), SEQSCAN over I(K, W), outputting the
+// first outputColumnCount of (ID, V, K, W). A keyed join matches O.ID = I.K
+// by its key expressions, or outerKey = I.K when outerKey is given, and
+// leaves the joinPredicate for the rest.
+inline std::string joinPlanJSON(const std::string &nodeType, const std::string &joinType,
+                                bool keyed, const std::string &joinPredicate,
+                                int outputColumnCount, const std::string &inlineNodes = "",
+                                const std::string &outerKey = "")
+{
+    const char *outerColumns[] = { "ID", "V" };
+    const char *innerColumns[] = { "K", "W" };
+    const char *joinedColumns[] = { "ID", "V", "K", "W" };
+
+    std::ostringstream json;
+    json << "{\"PLAN_NODES\":["
+         << "{\"PLAN_NODE_TYPE\":\"" << nodeType << "\",\"ID\":1,"
+         << "\"INLINE_NODES\":[" << inlineNodes << "],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2,3],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(joinedColumns, outputColumnCount) << "],"
+         << "\"JOIN_TYPE\":\"" << joinType << "\",\"PRE_JOIN_PREDICATE\":null,"
+         << "\"JOIN_PREDICATE\":" << joinPredicate << ",\"WHERE_PREDICATE\":null";
+    if (keyed) {
+        json << ",\"OUTER_KEY_EXPRESSIONS\":[" << (outerKey.empty() ? tupleValueJSON(0, 0) : outerKey) << "]"
+             << ",\"INNER_KEY_EXPRESSIONS\":[" << tupleValueJSON(1, 0) << "]";
+    }
+    json << "},"
+         << "{\"PLAN_NODE_TYPE\":\"SEQSCAN\",\"ID\":2,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(outerColumns, 2) << "],\"TARGET_TABLE_NAME\":\"O\"},"
+         << "{\"PLAN_NODE_TYPE\":\"SEQSCAN\",\"ID\":3,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],"
+         << "\"OUTPUT_SCHEMA\":[" << schemaJSON(innerColumns, 2) << "],\"TARGET_TABLE_NAME\":\"I\"}],"
+         << "\"EXECUTE_LIST\":[2,3,1],\"PARAMETERS\":[]}";
+    return json.str();
+}
+
+// A temp table of two nullable BIGINT columns holding the rows, where
+// NULL_VALUE stands for NULL
+inline TempTable* inputTable(const std::string &name, const int64_t rows[][2], int rowCount,
+                             TempTableLimits *limits = NULL)
+{
+    std::vector<ValueType> types(2, VALUE_TYPE_BIGINT);
+    std::vector<int32_t> sizes(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    std::vector<bool> allowNull(2, true);
+    std::vector<std::string> names;
+    names.push_back("A");
+    names.push_back("B");
+    TupleSchema *schema = TupleSchema::createTupleSchema(types, sizes, allowNull, true);
+    TempTable *table = TableFactory::getTempTable(0, name, schema, names, limits);
+    TableTuple &tuple = table->tempTuple();
+    for (int i = 0; i < rowCount; i++) {
+        for (int j = 0; j < 2; j++) {
+            tuple.setNValue(j, rows[i][j] == NULL_VALUE ?
+                            NValue::getNullValue(VALUE_TYPE_BIGINT) : ValueFactory::getBigIntValue(rows[i][j]));
+        }
+        table->insertTempTuple(tuple);
+    }
+    return table;
+}
+
+}
+
+#endif // EXECUTORTESTUTIL_H
@@ -49,6 +49,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <boost/foreach.hpp>
 
 #include "harness.h"
@@ -818,6 +819,82 @@ TEST_F(IndexTest, TupleKeyUnique) {
     delete[] searchkey.address();
 }
 
+TEST_F(IndexTest, AdvanceByRank) {
+    vector<int> ixr_column_indices;
+    vector<ValueType> ixr_column_types;
+    ixr_column_indices.push_back(2);
+    ixr_column_types.push_back(VALUE_TYPE_BIGINT);
+    init("ixr",
+         BALANCED_TREE_INDEX,
+         ixr_column_indices,
+         ixr_column_types,
+         false);
+
+    TableIndex* index = table->index("ixr");
+    EXPECT_EQ(true, index != NULL);
+    EXPECT_TRUE(index->isCountableIndex());
+
+    // The scan order, duplicate keys included, for each direction.
+    TableTuple tuple(table->schema());
+    vector<void*> ascending;
+    index->moveToEnd(true);
+    while (!(tuple = index->nextValue()).isNullTuple()) {
+        ascending.push_back(tuple.address());
+    }
+    EXPECT_EQ(static_cast<size_t>(NUM_OF_TUPLES), ascending.size());
+    vector<void*> descending(ascending.rbegin(), ascending.rend());
+
+    // step by one near the end, where the skips run out of tuples
+    for (int skip = 0; skip <= NUM_OF_TUPLES; skip += (skip < NUM_OF_TUPLES - 7 ? 7 : 1)) {
+        index->moveToEnd(true);
+        EXPECT_EQ(skip < NUM_OF_TUPLES, index->advanceByRank(skip));
+        tuple = index->nextValue();
+        if (skip < NUM_OF_TUPLES) {
+            EXPECT_EQ(ascending[skip], tuple.address());
+            // skipping continues from wherever the scan is
+            EXPECT_EQ(skip + 3 < NUM_OF_TUPLES, index->advanceByRank(2));
+            tuple = index->nextValue();
+            if (skip + 3 < NUM_OF_TUPLES) {
+                EXPECT_EQ(ascending[skip + 3], tuple.address());
+            } else {
+                EXPECT_TRUE(tuple.isNullTuple());
+            }
+        } else {
+            EXPECT_TRUE(tuple.isNullTuple());
+        }
+
+        index->moveToEnd(false);
+        EXPECT_EQ(skip < NUM_OF_TUPLES, index->advanceByRank(skip));
+        tuple = index->nextValue();
+        if (skip < NUM_OF_TUPLES) {
+            EXPECT_EQ(descending[skip], tuple.address());
+        } else {
+            EXPECT_TRUE(tuple.isNullTuple());
+        }
+    }
+
+    // a range scan skips from its own start
+    TableTuple searchkey(index->getKeySchema());
+    searchkey.move(new char[searchkey.tupleLength()]);
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
+    index->moveToKeyOrGreater(&searchkey);
+    void *firstOfKey = index->nextValue().address();
+    size_t start = std::find(ascending.begin(), ascending.end(), firstOfKey) - ascending.begin();
+    index->moveToKeyOrGreater(&searchkey);
+    EXPECT_TRUE(index->advanceByRank(5));
+    EXPECT_EQ(ascending[start + 5], index->nextValue().address());
+    delete[] searchkey.address();
+
+    EXPECT_TRUE(index->moveToRank(1, true));
+    EXPECT_EQ(ascending[0], index->nextValue().address());
+    EXPECT_EQ(ascending[1], index->nextValue().address());
+    EXPECT_TRUE(index->moveToRank(NUM_OF_TUPLES, false));
+    EXPECT_EQ(descending[0], index->nextValue().address());
+    EXPECT_FALSE(index->moveToRank(0, true));
+    EXPECT_FALSE(index->moveToRank(NUM_OF_TUPLES + 1, true));
+    EXPECT_TRUE(index->nextValue().isNullTuple());
+}
+
 int main()
 {
     return TestSuite::globalInstance()->runAll();
@@ -29,18 +29,85 @@
 #include "plannodes/indexscannode.h"
 #include "plannodes/sendnode.h"
 #include "plannodes/seqscannode.h"
+#include "plannodes/limitnode.h"
+#include "common/PlannerDomValue.h"
+#include "common/valuevector.h"
 
 #include <sstream>
 
 using namespace voltdb;
 using namespace std;
 
+namespace {
+
+string tupleValueJSON(int column)
+{
+    ostringstream json;
+    json << "{\"TYPE\":\"VALUE_TUPLE\",\"VALUE_TYPE\":\"BIGINT\",\"VALUE_SIZE\":8,"
+         << "\"COLUMN_IDX\":" << column << "}";
+    return json.str();
+}
+
+// SEND <- SEQSCAN with a predicate, an inline LIMIT and an output schema
+string seqScanPlanJSON(int columnCount)
+{
+    ostringstream json;
+    json << "{\"PLAN_NODES\":["
+         << "{\"PLAN_NODE_TYPE\":\"SEND\",\"ID\":1,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[2]},"
+         << "{\"PLAN_NODE_TYPE\":\"SEQSCAN\",\"ID\":2,\"INLINE_NODES\":["
+         << "{\"PLAN_NODE_TYPE\":\"LIMIT\",\"ID\":3,\"INLINE_NODES\":[],"
+         << "\"PARENT_IDS\":[],\"CHILDREN_IDS\":[],\"LIMIT\":10,\"OFFSET\":5,"
+         << "\"LIMIT_PARAM_IDX\":null}],"
+         << "\"PARENT_IDS\":[1],\"CHILDREN_IDS\":[],\"OUTPUT_SCHEMA\":[";
+    for (int i = 0; i < columnCount; i++) {
+        json << (i == 0 ? "" : ",")
+             << "{\"COLUMN_NAME\":\"C" << i << "\",\"TYPE\":\"BIGINT\",\"SIZE\":8,"
+             << "\"EXPRESSION\":" << tupleValueJSON(i) << "}";
+    }
+    json << "],\"TARGET_TABLE_NAME\":\"T\","
+         << "\"PREDICATE\":{\"TYPE\":\"COMPARE_EQUAL\",\"VALUE_TYPE\":\"BIGINT\","
+         << "\"VALUE_SIZE\":8,\"LEFT\":" << tupleValueJSON(columnCount - 1) << ","
+         << "\"RIGHT\":{\"TYPE\":\"VALUE_PARAMETER\",\"VALUE_TYPE\":\"BIGINT\","
+         << "\"VALUE_SIZE\":8,\"PARAM_IDX\":0}}}],"
+         << "\"EXECUTE_LIST\":[2,1],\"PARAMETERS\":[[0,\"BIGINT\"]]}";
+    return json.str();
+}
+
+}
+
 class PlanNodeFragmentTest : public Test
 {
 public:
     PlanNodeFragmentTest()
     {
     }
+
+    void checkSeqScanPlan(PlanNodeFragment *pnf, int columnCount)
+    {
+        ASSERT_EQ(2, pnf->getExecuteList().size());
+        AbstractPlanNode *scan = pnf->getExecuteList()[0];
+        EXPECT_EQ(PLAN_NODE_TYPE_SEQSCAN, scan->getPlanNodeType());
+        EXPECT_EQ(2, scan->getPlanNodeId());
+        EXPECT_EQ(PLAN_NODE_TYPE_SEND, pnf->getExecuteList()[1]->getPlanNodeType());
+        EXPECT_EQ(pnf->getExecuteList()[1], scan->getParents()[0]);
+        EXPECT_EQ("T", static_cast<SeqScanPlanNode*>(scan)->getTargetTableName());
+        EXPECT_TRUE(static_cast<SeqScanPlanNode*>(scan)->getPredicate() != NULL);
+        EXPECT_EQ(columnCount, scan->getOutputSchema().size());
+        EXPECT_EQ("C1", scan->getOutputSchema()[1]->getColumnName());
+
+        LimitPlanNode *limit =
+            dynamic_cast<LimitPlanNode*>(scan->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+        ASSERT_TRUE(limit != NULL);
+        int limitValue = -1;
+        int offsetValue = -1;
+        limit->getLimitAndOffsetByReference(NValueArray(), limitValue, offsetValue);
+        EXPECT_EQ(10, limitValue);
+        EXPECT_EQ(5, offsetValue);
+
+        ASSERT_EQ(1, pnf->getParameters().size());
+        EXPECT_EQ(VALUE_TYPE_BIGINT, pnf->getParameters()[0].second);
+    }
 };
 
 TEST_F(PlanNodeFragmentTest, HasDeleteTrue)
@@ -80,6 +147,83 @@ TEST_F(PlanNodeFragmentTest, HasDeleteInline)
     EXPECT_TRUE(dut.hasDelete());
 }
 
+TEST_F(PlanNodeFragmentTest, BinaryPlanMatchesJSON)
+{
+    const int columnCount = 8;
+    string json = seqScanPlanJSON(columnCount);
+    string binary = PlannerDomRoot(json.c_str()).toBinary();
+    EXPECT_TRUE(PlannerDomRoot::isBinary(binary.data(), binary.size()));
+    EXPECT_FALSE(PlannerDomRoot::isBinary(json.data(), json.size()));
+
+    auto_ptr<PlanNodeFragment> fromJSON(PlanNodeFragment::createFromCatalog(json));
+    checkSeqScanPlan(fromJSON.get(), columnCount);
+    auto_ptr<PlanNodeFragment> fromBinary(PlanNodeFragment::createFromCatalog(binary));
+    checkSeqScanPlan(fromBinary.get(), columnCount);
+
+    // Missing and null keys behave the same in both forms
+    PlannerDomRoot root(binary.data(), binary.size());
+    PlannerDomValue scan = root.rootObject().valueForKey("PLAN_NODES").valueAtIndex(1);
+    PlannerDomValue limit = scan.valueForKey("INLINE_NODES").valueAtIndex(0);
+    EXPECT_TRUE(limit.hasKey("LIMIT_PARAM_IDX"));
+    EXPECT_FALSE(limit.hasNonNullKey("LIMIT_PARAM_IDX"));
+    EXPECT_FALSE(scan.hasKey("NO_SUCH_KEY"));
+    EXPECT_EQ(10, limit.valueForKey("LIMIT").asInt());
+    EXPECT_EQ(10, limit.valueForKey("LIMIT").asInt64());
+    EXPECT_EQ("LIMIT", limit.valueForKey("PLAN_NODE_TYPE").asStr());
+}
+
+TEST_F(PlanNodeFragmentTest, BinaryArrayAccess)
+{
+    const int columnCount = 400;
+    string json = seqScanPlanJSON(columnCount);
+    string binary = PlannerDomRoot(json.c_str()).toBinary();
+
+    auto_ptr<PlanNodeFragment> fromBinary(PlanNodeFragment::createFromCatalog(binary));
+    checkSeqScanPlan(fromBinary.get(), columnCount);
+
+    // Elements come back right in and out of order
+    PlannerDomRoot root(binary.data(), binary.size());
+    PlannerDomValue scan = root.rootObject().valueForKey("PLAN_NODES").valueAtIndex(1);
+    PlannerDomValue schema = scan.valueForKey("OUTPUT_SCHEMA");
+    ASSERT_EQ(columnCount, schema.arrayLen());
+    for (int i = 0; i < columnCount; i++) {
+        EXPECT_EQ(i, schema.valueAtIndex(i).valueForKey("EXPRESSION").
+                  valueForKey("COLUMN_IDX").asInt());
+    }
+    const int indexes[] = { 7, 3, 3, 399, 0, 200 };
+    for (int i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++) {
+        ostringstream name;
+        name << "C" << indexes[i];
+        EXPECT_EQ(name.str(), schema.valueAtIndex(indexes[i]).valueForKey("COLUMN_NAME").asStr());
+    }
+    bool threw = false;
+    try {
+        schema.valueAtIndex(columnCount);
+    }
+    catch (SerializableEEException &e) {
+        threw = true;
+    }
+    EXPECT_TRUE(threw);
+}
+
+TEST_F(PlanNodeFragmentTest, BinaryLongKeys)
+{
+    // Keys of any length survive, including ones whose length doesn't
+    // fit a byte, and a key that shares a long prefix is told apart.
+    const string longKey(300, 'K');
+    const string midKey(200, 'M');
+    string json = "{\"" + midKey + "\":1,\"" + longKey + "X\":2,\"" + longKey + "\":3,\"A\":4}";
+    string binary = PlannerDomRoot(json.c_str()).toBinary();
+
+    PlannerDomRoot root(binary.data(), binary.size());
+    PlannerDomValue object = root.rootObject();
+    EXPECT_EQ(1, object.valueForKey(midKey.c_str()).asInt());
+    EXPECT_EQ(2, object.valueForKey((longKey + "X").c_str()).asInt());
+    EXPECT_EQ(3, object.valueForKey(longKey.c_str()).asInt());
+    EXPECT_EQ(4, object.valueForKey("A").asInt());
+    EXPECT_FALSE(object.hasKey(string(44, 'K').c_str()));
+}
+
 int main()
 {
     return TestSuite::globalInstance()->runAll();
@@ -283,7 +283,7 @@ TEST_F(CompactionTest, BasicCompaction) {
 #ifdef MEMCHECK
     int tupleCount = 1000;
 #else
-    int tupleCount = 645260;
+    int tupleCount = static_cast<int>(m_table->getTuplesPerBlock()) * 20;
 #endif
     addRandomUniqueTuples( m_table, tupleCount);
 
@@ -369,7 +369,7 @@ TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
 #ifdef MEMCHECK
     int tupleCount = 1000;
 #else
-    int tupleCount = 645260;
+    int tupleCount = static_cast<int>(m_table->getTuplesPerBlock()) * 20;
 #endif
     addRandomUniqueTuples( m_table, tupleCount);
 
@@ -517,14 +517,15 @@ TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
 #ifndef MEMCHECK
 TEST_F(CompactionTest, TestENG897) {
     initTable(true);
-    addRandomUniqueTuples( m_table, 32263 * 5);
+    const int tupleCount = static_cast<int>(m_table->getTuplesPerBlock()) * 5;
+    addRandomUniqueTuples( m_table, tupleCount);
 
     //Delete stuff to put everything in a bucket
     voltdb::TableIndex *pkeyIndex = m_table->primaryKeyIndex();
     TableTuple key(pkeyIndex->getKeySchema());
     boost::scoped_array<char> backingStore(new char[pkeyIndex->getKeySchema()->tupleLength()]);
     key.moveNoHeader(backingStore.get());
-    for (int ii = 0; ii < 32263 * 5; ii++) {
+    for (int ii = 0; ii < tupleCount; ii++) {
         if (ii % 2 == 0) {
             key.setNValue(0, ValueFactory::getIntegerValue(ii));
             ASSERT_TRUE(pkeyIndex->moveToKey(&key));
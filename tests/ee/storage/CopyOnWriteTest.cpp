@@ -41,16 +41,20 @@
 #include "storage/TableStreamerContext.h"
 #include "storage/ElasticScanner.h"
 #include "storage/ElasticContext.h"
+#include "storage/TableImage.h"
 #include "stx/btree_set.h"
 #include "common/DefaultTupleSerializer.h"
 #include "jsoncpp/jsoncpp.h"
 #include <vector>
 #include <string>
+#include <sstream>
 #include <iostream>
 #include <stdint.h>
 #include <stdarg.h>
+#include <unistd.h>
 #include <boost/foreach.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <murmur3/MurmurHash3.h>
 
@@ -441,6 +445,10 @@ public:
         return m_table->m_surgeon;
     }
 
+    size_t getRetiredBlockCount() {
+        return m_table->m_retiredBlocks.size();
+    }
+
 
     boost::unordered_set<TBPtr> &getBlocksPendingSnapshot() {
         return m_table->m_blocksPendingSnapshot;
@@ -477,7 +485,7 @@ public:
     }
 
     boost::shared_ptr<ElasticScanner> getElasticScanner() {
-        return boost::shared_ptr<ElasticScanner>(new ElasticScanner(*m_table, m_table->m_surgeon.getData()));
+        return boost::shared_ptr<ElasticScanner>(new ElasticScanner(*m_table, m_table->m_surgeon));
     }
 
     void context(const std::string& msg, ...) {
@@ -1140,7 +1148,8 @@ TEST_F(CopyOnWriteTest, CopyOnWriteIterator) {
     addRandomUniqueTuples( m_table, tupleCount);
 
     voltdb::TableIterator& iterator = m_table->iterator();
-    TBMap blocks(getTableData());
+    TBBorrowedMap blocks;
+    getSurgeon().borrowData(blocks);
     getBlocksPendingSnapshot().swap(getBlocksNotPendingSnapshot());
     getBlocksPendingSnapshotLoad().swap(getBlocksNotPendingSnapshotLoad());
     voltdb::CopyOnWriteIterator COWIterator(m_table, &getSurgeon(), blocks);
@@ -1163,6 +1172,95 @@ TEST_F(CopyOnWriteTest, CopyOnWriteIterator) {
     ASSERT_FALSE(COWIterator.next(COWTuple));
 }
 
+// Blocks the table lets go of while they are in a pinned map stay
+// allocated until no pinned map holds them.
+TEST_F(CopyOnWriteTest, BlocksRetiredWhilePinned) {
+    initTable(true, 1, 0);
+    addRandomUniqueTuples(m_table, TUPLE_COUNT);
+    const size_t blockCount = m_table->allocatedBlockCount();
+    ASSERT_TRUE(blockCount > 1);
+
+    TableTuple tuple(m_table->schema());
+    TBBorrowedMap blocks;
+    getSurgeon().borrowData(blocks);
+    getSurgeon().pinBlocks(blocks);
+    TableIterator first = m_table->iteratorDeletingAsWeGo();
+    while (first.next(tuple)) {
+        m_table->deleteTuple(tuple, false);
+    }
+    ASSERT_EQ(0, m_table->allocatedBlockCount());
+    ASSERT_EQ(blockCount, getRetiredBlockCount());
+
+    // a block the stream is done with goes once it is out of the map
+    blocks.erase(blocks.begin().key());
+    getSurgeon().releaseRetiredBlocks();
+    ASSERT_EQ(blockCount - 1, getRetiredBlockCount());
+
+    // blocks allocated after the map was taken are not held
+    addRandomUniqueTuples(m_table, TUPLE_COUNT);
+    TableIterator second = m_table->iteratorDeletingAsWeGo();
+    while (second.next(tuple)) {
+        m_table->deleteTuple(tuple, false);
+    }
+    ASSERT_EQ(blockCount - 1, getRetiredBlockCount());
+    getSurgeon().unpinBlocks(blocks);
+    ASSERT_EQ(0, getRetiredBlockCount());
+}
+
+// The snapshot keeps only the blocks it has still to scan: a block it has
+// passed is freed as soon as it empties, the block it is on only once it
+// moves past it.
+TEST_F(CopyOnWriteTest, BlocksPassedBySnapshotAreFreed) {
+    initTable(true, 1, 0);
+    addRandomUniqueTuples(m_table, TUPLE_COUNT);
+    const size_t blockCount = m_table->allocatedBlockCount();
+    ASSERT_TRUE(blockCount > 2);
+    const int tuplesPerBlock = static_cast<int>(m_table->getTuplesPerBlock());
+
+    // the tuples of the first two blocks, in the order the snapshot scans them
+    std::vector<char*> addresses;
+    TableTuple tuple(m_table->schema());
+    TableIterator& iterator = m_table->iterator();
+    while (static_cast<int>(addresses.size()) < 2 * tuplesPerBlock && iterator.next(tuple)) {
+        addresses.push_back(tuple.address());
+    }
+
+    TBBorrowedMap blocks;
+    getSurgeon().borrowData(blocks);
+    getSurgeon().pinBlocks(blocks);
+    getBlocksPendingSnapshot().swap(getBlocksNotPendingSnapshot());
+    getBlocksPendingSnapshotLoad().swap(getBlocksNotPendingSnapshotLoad());
+    voltdb::CopyOnWriteIterator COWIterator(m_table, &getSurgeon(), blocks);
+
+    // step onto the second block
+    TableTuple COWTuple(m_table->schema());
+    for (int ii = 0; ii <= tuplesPerBlock; ii++) {
+        ASSERT_TRUE(COWIterator.next(COWTuple));
+    }
+    ASSERT_EQ(addresses[tuplesPerBlock], COWTuple.address());
+    ASSERT_EQ(blockCount - 1, blocks.size());
+
+    for (int ii = 0; ii < tuplesPerBlock; ii++) {
+        tuple.move(addresses[ii]);
+        m_table->deleteTuple(tuple, false);
+    }
+    ASSERT_EQ(blockCount - 1, m_table->allocatedBlockCount());
+    ASSERT_EQ(0, getRetiredBlockCount());
+
+    for (int ii = tuplesPerBlock; ii < 2 * tuplesPerBlock; ii++) {
+        tuple.move(addresses[ii]);
+        m_table->deleteTuple(tuple, false);
+    }
+    ASSERT_EQ(blockCount - 2, m_table->allocatedBlockCount());
+    ASSERT_EQ(1, getRetiredBlockCount());
+
+    // moving on to the third block lets the second go
+    ASSERT_TRUE(COWIterator.next(COWTuple));
+    ASSERT_EQ(0, getRetiredBlockCount());
+    ASSERT_EQ(blockCount - 2, blocks.size());
+    getSurgeon().unpinBlocks(blocks);
+}
+
 TEST_F(CopyOnWriteTest, TestTableTupleFlags) {
     initTable(true, 1, 0);
     char storage[9];
@@ -1558,6 +1656,245 @@ TEST_F(CopyOnWriteTest, BufferBoundaryCondition) {
     ASSERT_EQ(origPendingCount, curPendingCount);
 }
 
+/**
+ * Table with an out-of-line string and three kinds of index, for the
+ * recovery tests.
+ */
+static PersistentTable *createRecoveryTable(CatalogId tableId) {
+    std::vector<ValueType> types;
+    std::vector<int32_t> sizes;
+    std::vector<bool> allowNull;
+    std::vector<std::string> names;
+    types.push_back(VALUE_TYPE_INTEGER);
+    sizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+    names.push_back("ID");
+    types.push_back(VALUE_TYPE_VARCHAR);
+    sizes.push_back(300);
+    allowNull.push_back(true);
+    names.push_back("NAME");
+    types.push_back(VALUE_TYPE_INTEGER);
+    sizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+    names.push_back("GROUPID");
+    TupleSchema *schema = TupleSchema::createTupleSchema(types, sizes, allowNull, false);
+    PersistentTable *table = dynamic_cast<PersistentTable*>(
+            TableFactory::getPersistentTable(tableId, "RECOVERED", schema, names, 0, false, false));
+
+    std::vector<int> pkeyColumns(1, 0);
+    std::vector<int> groupColumns(1, 2);
+    TableIndex *pkeyIndex = TableIndexFactory::getInstance(
+            TableIndexScheme("pkey", BALANCED_TREE_INDEX, pkeyColumns,
+                             TableIndex::simplyIndexColumns(), true, true, schema));
+    table->addIndex(pkeyIndex);
+    table->setPrimaryKeyIndex(pkeyIndex);
+    table->addIndex(TableIndexFactory::getInstance(
+            TableIndexScheme("groups", BALANCED_TREE_INDEX, groupColumns,
+                             TableIndex::simplyIndexColumns(), false, false, schema)));
+    table->addIndex(TableIndexFactory::getInstance(
+            TableIndexScheme("groupsHash", HASH_TABLE_INDEX, groupColumns,
+                             TableIndex::simplyIndexColumns(), false, false, schema)));
+    return table;
+}
+
+static bool fillRecoveryTable(PersistentTable *table, int tupleCount) {
+    TableTuple tuple = table->tempTuple();
+    for (int i = 0; i < tupleCount; i++) {
+        std::ostringstream name;
+        name << "tuple " << i << std::string(i % 200, '*');
+        NValue nameValue = (i % 7 == 0) ? NValue::getNullValue(VALUE_TYPE_VARCHAR)
+                                        : ValueFactory::getStringValue(name.str());
+        tuple.setNValue(0, ValueFactory::getIntegerValue(tupleCount - i));
+        tuple.setNValue(1, nameValue);
+        tuple.setNValue(2, ValueFactory::getIntegerValue(i % 10));
+        const bool inserted = table->insertTuple(tuple);
+        nameValue.free();
+        if (!inserted) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stream a table through recovery into an empty copy, in messages small
+ * enough that the copy defers its indexes across several of them.
+ */
+TEST_F(CopyOnWriteTest, RecoveryTupleImages) {
+    const int tupleCount = 5000;
+    boost::scoped_ptr<PersistentTable> source(createRecoveryTable(m_tableId));
+    boost::scoped_ptr<PersistentTable> copy(createRecoveryTable(m_tableId));
+
+    ASSERT_TRUE(fillRecoveryTable(source.get(), tupleCount));
+    ASSERT_EQ(tupleCount, source->activeTupleCount());
+
+    char config[4];
+    ::memset(config, 0, 4);
+    ReferenceSerializeInput input(config, 4);
+    ASSERT_TRUE(source->activateStream(m_serializer, TABLE_STREAM_RECOVERY, 0, m_tableId, input));
+
+    char buffer[32768];
+    int messages = 0;
+    while (true) {
+        TupleOutputStreamProcessor outputStreams(buffer, sizeof(buffer));
+        std::vector<int> retPositions;
+        int64_t remaining = source->streamMore(outputStreams, TABLE_STREAM_RECOVERY, retPositions);
+        ASSERT_EQ(1, retPositions.size());
+        if (remaining == 0) {
+            ASSERT_EQ(RECOVERY_MSG_TYPE_COMPLETE, static_cast<RecoveryMsgType>(buffer[0]));
+            break;
+        }
+        ReferenceSerializeInput in(buffer, retPositions[0]);
+        RecoveryProtoMsg message(&in);
+        ASSERT_EQ(RECOVERY_MSG_TYPE_SCAN_TUPLE_IMAGES, message.msgType());
+        copy->processRecoveryMessage(&message, NULL);
+        messages++;
+        // the indexes stay empty until the last scanned tuples arrive
+        ASSERT_EQ(message.isLastScanMessage() ? tupleCount : 0,
+                  copy->primaryKeyIndex()->getSize());
+    }
+    ASSERT_TRUE(messages > 1);
+
+    ASSERT_EQ(source->activeTupleCount(), copy->activeTupleCount());
+    ASSERT_EQ(source->nonInlinedMemorySize(), copy->nonInlinedMemorySize());
+    ASSERT_EQ(source->hashCode(), copy->hashCode());
+    BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+        ASSERT_EQ(tupleCount, index->getSize());
+    }
+
+    // every tuple is reachable through each index of the copy
+    TableIterator &iterator = source->iterator();
+    TableTuple sourceTuple(source->schema());
+    while (iterator.next(sourceTuple)) {
+        TableTuple found = copy->lookupTuple(sourceTuple);
+        ASSERT_FALSE(found.isNullTuple());
+        ASSERT_TRUE(found.equals(sourceTuple));
+        BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+            ASSERT_TRUE(index->exists(&found));
+        }
+    }
+}
+
+/**
+ * Load serialized tables chunk by chunk into an empty copy, with the
+ * indexes waiting for the last chunk and then taking every tuple at once
+ * on helper threads, and last with every key repeated.
+ */
+TEST_F(CopyOnWriteTest, LoadDeferringIndexes) {
+    m_engine->setIndexBuildThreads(3);
+    const int tupleCount = 3000;
+    boost::scoped_ptr<PersistentTable> lower(createRecoveryTable(m_tableId));
+    boost::scoped_ptr<PersistentTable> upper(createRecoveryTable(m_tableId));
+    boost::scoped_ptr<PersistentTable> copy(createRecoveryTable(m_tableId));
+    ASSERT_TRUE(fillRecoveryTable(lower.get(), tupleCount / 2));
+    ASSERT_TRUE(fillRecoveryTable(upper.get(), tupleCount));
+    for (int i = 1; i <= tupleCount / 2; ++i) {
+        TableTuple victim = upper->tempTuple();
+        victim.setNValue(0, ValueFactory::getIntegerValue(i));
+        victim = upper->lookupTuple(victim);
+        ASSERT_FALSE(victim.isNullTuple());
+        ASSERT_TRUE(upper->deleteTuple(victim, false));
+    }
+
+    CopySerializeOutput lowerData;
+    lower->serializeTo(lowerData);
+    CopySerializeOutput upperData;
+    upper->serializeTo(upperData);
+    ReferenceSerializeInput lowerIn(lowerData.data() + sizeof(int32_t), lowerData.size() - sizeof(int32_t));
+    copy->loadTuplesDeferringIndexes(lowerIn, NULL);
+    ReferenceSerializeInput upperIn(upperData.data() + sizeof(int32_t), upperData.size() - sizeof(int32_t));
+    copy->loadTuplesDeferringIndexes(upperIn, NULL);
+
+    ASSERT_EQ(tupleCount, copy->activeTupleCount());
+    ASSERT_TRUE(copy->hasDeferredIndexes());
+    BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+        ASSERT_EQ(0, index->getSize());
+    }
+
+    copy->buildDeferredIndexes();
+    ASSERT_FALSE(copy->hasDeferredIndexes());
+    ASSERT_EQ(lower->nonInlinedMemorySize() + upper->nonInlinedMemorySize(),
+              copy->nonInlinedMemorySize());
+    BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+        ASSERT_EQ(tupleCount, index->getSize());
+    }
+    TableIterator &iterator = copy->iterator();
+    TableTuple tuple(copy->schema());
+    while (iterator.next(tuple)) {
+        BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+            ASSERT_TRUE(index->exists(&tuple));
+        }
+    }
+
+    // the primary key index fails on a helper and the site thread reports it
+    boost::scoped_ptr<PersistentTable> repeat(createRecoveryTable(m_tableId));
+    for (int i = 0; i < 2; ++i) {
+        ReferenceSerializeInput repeatIn(upperData.data() + sizeof(int32_t), upperData.size() - sizeof(int32_t));
+        repeat->loadTuplesDeferringIndexes(repeatIn, NULL);
+    }
+    bool failed = false;
+    try {
+        repeat->buildDeferredIndexes();
+    } catch (const FatalException &) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    m_engine->setIndexBuildThreads(0);
+}
+
+/**
+ * Save a table as a table image and map it back into an empty copy.
+ */
+TEST_F(CopyOnWriteTest, TableImageRestore) {
+    const int tupleCount = 3000;
+    boost::scoped_ptr<PersistentTable> source(createRecoveryTable(m_tableId));
+    boost::scoped_ptr<PersistentTable> copy(createRecoveryTable(m_tableId));
+    ASSERT_TRUE(fillRecoveryTable(source.get(), tupleCount));
+    // leave some holes in the source blocks
+    for (int i = 1; i <= tupleCount; i += 3) {
+        TableTuple victim = source->tempTuple();
+        victim.setNValue(0, ValueFactory::getIntegerValue(i));
+        victim = source->lookupTuple(victim);
+        ASSERT_FALSE(victim.isNullTuple());
+        ASSERT_TRUE(source->deleteTuple(victim, false));
+    }
+
+    char path[] = "/tmp/TableImageRestoreXXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    ::close(fd);
+    ASSERT_TRUE(TableImage::save(*source, m_tableId, path));
+
+    TableImage image;
+    ASSERT_TRUE(image.map(path));
+    ASSERT_EQ(m_tableId, image.tableId());
+    ASSERT_EQ(source->activeTupleCount(), image.tupleCount());
+    ASSERT_TRUE(copy->restoreImage(image));
+
+    ASSERT_EQ(source->activeTupleCount(), copy->activeTupleCount());
+    ASSERT_EQ(source->nonInlinedMemorySize(), copy->nonInlinedMemorySize());
+    ASSERT_EQ(source->hashCode(), copy->hashCode());
+    BOOST_FOREACH(TableIndex *index, copy->allIndexes()) {
+        ASSERT_EQ(source->activeTupleCount(), index->getSize());
+    }
+
+    // only empty tables with the same layout take an image
+    ASSERT_FALSE(copy->restoreImage(image));
+    initTable(true, 1, 0);
+    ASSERT_FALSE(m_table->restoreImage(image));
+
+    // an image written in the other byte order is refused
+    const uint32_t otherByteOrder = 0x04030201;
+    FILE *file = ::fopen(path, "r+b");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(0, ::fseek(file, 4, SEEK_SET));
+    ASSERT_EQ(1, ::fwrite(&otherByteOrder, sizeof(otherByteOrder), 1, file));
+    ASSERT_EQ(0, ::fclose(file));
+    TableImage foreign;
+    ASSERT_FALSE(foreign.map(path));
+    ::unlink(path);
+}
+
 /**
  * Dummy TableStreamer for intercepting and tracking tuple notifications.
  */
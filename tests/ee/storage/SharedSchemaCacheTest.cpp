@@ -0,0 +1,132 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/FatalException.hpp"
+#include "common/TupleSchema.h"
+#include "execution/VoltDBEngine.h"
+#include "storage/SharedSchemaCache.h"
+#include "storage/table.h"
+#include "storage/tablefactory.h"
+
+using namespace voltdb;
+using namespace std;
+
+class SharedSchemaCacheTest : public Test {
+public:
+    SharedSchemaCacheTest() {
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+
+        m_types.push_back(VALUE_TYPE_INTEGER);
+        m_types.push_back(VALUE_TYPE_VARCHAR);
+        m_lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        m_lengths.push_back(300);
+        m_allowNull.push_back(false);
+        m_allowNull.push_back(true);
+        m_names.push_back("A");
+        m_names.push_back("B");
+    }
+
+    ~SharedSchemaCacheTest() {
+        delete m_engine;
+    }
+
+    VoltDBEngine *m_engine;
+    vector<ValueType> m_types;
+    vector<int32_t> m_lengths;
+    vector<bool> m_allowNull;
+    vector<string> m_names;
+};
+
+TEST_F(SharedSchemaCacheTest, Basic) {
+    SharedSchemaCache cache;
+
+    // Equal layouts get the same schema
+    TupleSchema *first = cache.acquire(m_types, m_lengths, m_allowNull);
+    TupleSchema *second = cache.acquire(m_types, m_lengths, m_allowNull);
+    ASSERT_TRUE(first == second);
+    ASSERT_EQ(2, first->columnCount());
+    ASSERT_FALSE(first->columnIsInlined(1));
+    ASSERT_EQ(1, cache.size());
+
+    // Any difference gets another one
+    m_allowNull[0] = true;
+    TupleSchema *nullable = cache.acquire(m_types, m_lengths, m_allowNull);
+    ASSERT_TRUE(nullable != first);
+    ASSERT_EQ(2, cache.size());
+
+    // Freed with the last reference
+    cache.release(first);
+    ASSERT_EQ(2, cache.size());
+    cache.release(second);
+    ASSERT_EQ(1, cache.size());
+    cache.release(nullable);
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST_F(SharedSchemaCacheTest, TablesShareSchema) {
+    SharedSchemaCache &cache = SharedSchemaCache::instance();
+    size_t initialSize = cache.size();
+
+    Table *first = TableFactory::getPersistentTable(0, "FOO",
+            cache.acquire(m_types, m_lengths, m_allowNull), m_names, 0, false, false, 0, true);
+    Table *second = TableFactory::getPersistentTable(0, "FOO",
+            cache.acquire(m_types, m_lengths, m_allowNull), m_names, 0, false, false, 0, true);
+    ASSERT_TRUE(first->schema() == second->schema());
+    ASSERT_EQ(initialSize + 1, cache.size());
+
+    delete first;
+    ASSERT_EQ(initialSize + 1, cache.size());
+    ASSERT_EQ(2, second->schema()->columnCount());
+    delete second;
+    ASSERT_EQ(initialSize, cache.size());
+}
+
+TEST_F(SharedSchemaCacheTest, TablesOutliveEngines) {
+    Table *table = TableFactory::getPersistentTable(0, "FOO",
+            SharedSchemaCache::instance().acquire(m_types, m_lengths, m_allowNull),
+            m_names, 0, false, false, 0, true);
+
+    // the table's schema keeps the cache once the last engine is gone
+    delete m_engine;
+    m_engine = NULL;
+    ASSERT_EQ(1, SharedSchemaCache::instance().size());
+    ASSERT_EQ(2, table->schema()->columnCount());
+
+    // and releasing it deletes the cache
+    delete table;
+    bool deleted = false;
+    try {
+        SharedSchemaCache::instance();
+    } catch (const FatalException &) {
+        deleted = true;
+    }
+    ASSERT_TRUE(deleted);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
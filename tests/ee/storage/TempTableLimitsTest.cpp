@@ -25,9 +25,16 @@
 
 #include "harness.h"
 #include "common/SQLException.h"
+#include "common/ThreadLocalPool.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
 #include "logging/LogManager.h"
+#include "storage/TempBlockPool.h"
+#include "storage/tablefactory.h"
+#include "storage/temptable.h"
 
 #include <sstream>
+#include <vector>
 
 using namespace voltdb;
 using namespace std;
@@ -136,6 +143,110 @@ TEST_F(TempTableLimitsTest, CheckLimitException)
     EXPECT_TRUE(threw);
 }
 
+TEST_F(TempTableLimitsTest, CheckSpillThreshold)
+{
+    TempTableLimits dut;
+    // spilling is off until a threshold is set
+    EXPECT_FALSE(dut.shouldSpill(1024 * 1024 * 1024));
+    dut.setSpillThreshold(1024 * 10);
+    EXPECT_FALSE(dut.shouldSpill(1024 * 10));
+    EXPECT_TRUE(dut.shouldSpill(1024 * 10 + 1));
+    dut.setSpillThreshold(0);
+    EXPECT_TRUE(dut.shouldSpill(1));
+}
+
+TEST_F(TempTableLimitsTest, BlocksRecycled)
+{
+    ThreadLocalPool tlPool;
+    TempBlockPoolHolder poolHolder;
+    TempBlockPool *pool = TempBlockPool::forThisThread();
+    ASSERT_TRUE(pool != NULL);
+    pool->setHighWaterMark(2 * TEMP_TABLE_BLOCK_SIZE);
+
+    vector<ValueType> types(1, VALUE_TYPE_BIGINT);
+    vector<int32_t> lengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> allowNull(1, false);
+    vector<string> names(1, "A");
+    TempTableLimits limits;
+    TempTable *table = TableFactory::getTempTable(0, "TEMP",
+            TupleSchema::createTupleSchema(types, lengths, allowNull, true), names, &limits);
+    const int tuplesPerBlock = table->getTuplesPerBlock();
+
+    // Four blocks, all freshly allocated
+    TableTuple &tuple = table->tempTuple();
+    for (int i = 0; i < tuplesPerBlock * 4; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        table->insertTempTuple(tuple);
+    }
+    EXPECT_EQ(4 * TEMP_TABLE_BLOCK_SIZE, limits.getAllocated());
+    EXPECT_EQ(0, pool->pooledBlockCount());
+
+    // The table keeps one, the pool takes two up to its high water mark
+    table->deleteAllTuples(false);
+    EXPECT_EQ(TEMP_TABLE_BLOCK_SIZE, limits.getAllocated());
+    EXPECT_EQ(2, pool->pooledBlockCount());
+
+    // Pooled blocks are reused and charged to the table as before
+    for (int i = 0; i < tuplesPerBlock * 2; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        table->insertTempTuple(tuple);
+    }
+    EXPECT_EQ(2 * TEMP_TABLE_BLOCK_SIZE, limits.getAllocated());
+    EXPECT_EQ(1, pool->pooledBlockCount());
+
+    delete table;
+    EXPECT_EQ(2, pool->pooledBlockCount());
+    pool->setHighWaterMark(0);
+    EXPECT_EQ(0, pool->pooledBlockCount());
+}
+
+TEST_F(TempTableLimitsTest, PooledBlocksCountAgainstLimit)
+{
+    ThreadLocalPool tlPool;
+    TempBlockPoolHolder poolHolder;
+    TempBlockPool *pool = TempBlockPool::forThisThread();
+    pool->setHighWaterMark(4 * TEMP_TABLE_BLOCK_SIZE);
+
+    vector<ValueType> types(1, VALUE_TYPE_BIGINT);
+    vector<int32_t> lengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> allowNull(1, false);
+    vector<string> names(1, "A");
+    TempTableLimits limits;
+    TempTable *table = TableFactory::getTempTable(0, "TEMP",
+            TupleSchema::createTupleSchema(types, lengths, allowNull, true), names, &limits);
+    const int tuplesPerBlock = table->getTuplesPerBlock();
+
+    TableTuple &tuple = table->tempTuple();
+    for (int i = 0; i < tuplesPerBlock * 4; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        table->insertTempTuple(tuple);
+    }
+    table->deleteAllTuples(false);
+    EXPECT_EQ(TEMP_TABLE_BLOCK_SIZE, limits.getAllocated());
+    EXPECT_EQ(3, pool->pooledBlockCount());
+
+    // A second block would put the table and the pool over the limit,
+    // so the pool gives up its storage rather than the table failing
+    limits.setMemoryLimit(2 * TEMP_TABLE_BLOCK_SIZE);
+    for (int i = 0; i < tuplesPerBlock * 2; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        table->insertTempTuple(tuple);
+    }
+    EXPECT_EQ(2 * TEMP_TABLE_BLOCK_SIZE, limits.getAllocated());
+    EXPECT_EQ(0, pool->pooledBlockCount());
+
+    // Over the limit on its own, the table fails as before
+    bool threw = false;
+    try {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(0));
+        table->insertTempTuple(tuple);
+    } catch (SQLException& e) {
+        threw = true;
+    }
+    EXPECT_TRUE(threw);
+    delete table;
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,115 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2013 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "storage/TupleSpill.h"
+
+#include "harness.h"
+#include "common/NValue.hpp"
+#include "common/Pool.hpp"
+#include "common/ThreadLocalPool.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+
+#include <sstream>
+#include <vector>
+
+using namespace voltdb;
+using namespace std;
+
+class TupleSpillTest : public Test
+{
+public:
+    TupleSpillTest()
+    {
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        types.push_back(VALUE_TYPE_BIGINT);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        // long enough not to be inlined
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(300);
+        vector<bool> allowNull(2, true);
+        m_schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+    }
+
+    ~TupleSpillTest()
+    {
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    ThreadLocalPool m_tlPool;
+    TupleSchema *m_schema;
+};
+
+TEST_F(TupleSpillTest, RoundTrip)
+{
+    const int count = 1000;
+    TupleSpill spill(m_schema);
+    {
+        StandAloneTupleStorage storage(m_schema);
+        TableTuple tuple = storage;
+        for (int i = 0; i < count; ++i) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            if (i % 7 == 0) {
+                tuple.setNValue(1, ValueFactory::getNullStringValue());
+                spill.append(tuple);
+                continue;
+            }
+            ostringstream text;
+            text << "spilled string " << i;
+            NValue value = ValueFactory::getStringValue(text.str());
+            tuple.setNValue(1, value);
+            spill.append(tuple);
+            value.free();
+        }
+    }
+    EXPECT_EQ(count, spill.tupleCount());
+
+    // Read it all back twice, the objects going into the given pool
+    Pool pool;
+    for (int pass = 0; pass < 2; ++pass) {
+        spill.rewind();
+        TableTuple tuple(m_schema);
+        tuple.move(pool.allocateZeroes(m_schema->tupleLength() + TUPLE_HEADER_SIZE));
+        for (int i = 0; i < count; ++i) {
+            ASSERT_TRUE(spill.next(tuple, &pool));
+            EXPECT_TRUE(tuple.isActive());
+            EXPECT_EQ(0, tuple.getNValue(0).compare(ValueFactory::getBigIntValue(i)));
+            if (i % 7 == 0) {
+                EXPECT_TRUE(tuple.getNValue(1).isNull());
+                continue;
+            }
+            ostringstream text;
+            text << "spilled string " << i;
+            NValue expected = ValueFactory::getStringValue(text.str());
+            EXPECT_EQ(0, tuple.getNValue(1).compare(expected));
+            expected.free();
+        }
+        EXPECT_FALSE(spill.next(tuple, &pool));
+        pool.purge();
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -26,11 +26,13 @@
 #include "common/types.h"
 #include "common/NValue.hpp"
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 #include "common/serializeio.h"
 #include "execution/VoltDBEngine.h"
 #include "storage/persistenttable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableutil.h"
+#include "storage/tableiterator.h"
 #include "indexes/tableindex.h"
 #include <vector>
 #include <string>
@@ -176,6 +178,46 @@ TEST_F(PersistentTableLogTest, InsertDeleteThenUndoOneTest) {
     ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
 }
 
+TEST_F(PersistentTableLogTest, ScanByBlockTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    // Leave holes in the blocks, some of them pending delete until the
+    // undo token is released
+    voltdb::TableTuple tuple(m_tableSchema);
+    for (int i = 0; i < 100; ++i) {
+        tableutil::getRandomTuple(m_table, tuple);
+        m_table->deleteTuple(tuple, true);
+    }
+
+    std::vector<char*> expected;
+    voltdb::TableIterator iterator = m_table->iterator();
+    while (iterator.next(tuple)) {
+        expected.push_back(tuple.address());
+    }
+    ASSERT_EQ(900, expected.size());
+
+    std::vector<char*> scanned;
+    voltdb::TableIterator blocks = m_table->iterator();
+    voltdb::TupleBlockSpan span;
+    while (blocks.nextBlock(span)) {
+        ASSERT_FALSE(span.dense);
+        for (uint32_t slot = 0; slot < span.count; ++slot) {
+            if (span.isVisible(slot)) {
+                scanned.push_back(span.tupleAddress(slot));
+            }
+        }
+    }
+    ASSERT_TRUE(expected == scanned);
+
+    m_engine->releaseUndoToken(INT64_MIN + 2);
+}
+
 TEST_F(PersistentTableLogTest, LoadTableThenUndoTest) {
     initTable(true);
     tableutil::addRandomTuples(m_table, 1000);
@@ -208,9 +250,15 @@ TEST_F(PersistentTableLogTest, LoadTableThenUndoTest) {
     tableutil::getRandomTuple(m_table, tuple);
     ASSERT_FALSE( m_table->lookupTuple(tuple).isNullTuple());
 
+    // the undo frees the tuple's block, so look it up by a copy
+    voltdb::TableTuple tupleBackup(m_tableSchema);
+    tupleBackup.move(new char[tupleBackup.tupleLength()]);
+    tupleBackup.copyForPersistentInsert(tuple);
+    StackCleaner cleaner(tupleBackup);
+
     m_engine->undoUndoToken(INT64_MIN + 3);
 
-    ASSERT_TRUE(m_table->lookupTuple(tuple).isNullTuple());
+    ASSERT_TRUE(m_table->lookupTuple(tupleBackup).isNullTuple());
     ASSERT_TRUE(m_table->activeTupleCount() == (int64_t)0);
 }
 
@@ -307,6 +355,158 @@ TEST_F(PersistentTableLogTest, InsertUpdateThenUndoOneTest) {
     oldStringValue.free();
 }
 
+TEST_F(PersistentTableLogTest, UpdateInPlaceThenUndoTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1);
+    voltdb::TableTuple tuple(m_tableSchema);
+
+    tableutil::getRandomTuple(m_table, tuple);
+    NValue oldIntValue = tuple.getNValue(2);
+    NValue oldDoubleValue = tuple.getNValue(5);
+
+    /*
+     * Source tuple carrying the new values for the non-indexed
+     * INTEGER and DOUBLE columns.
+     */
+    voltdb::TableTuple tupleCopy(m_tableSchema);
+    tupleCopy.move(new char[tupleCopy.tupleLength()]);
+    tupleCopy.copyForPersistentInsert(tuple);
+    tupleCopy.setNValue(2, ValueFactory::getIntegerValue(42));
+    tupleCopy.setNValue(5, ValueFactory::getDoubleValue(4.5));
+
+    std::vector<std::pair<int, int> > columns;
+    columns.push_back(std::pair<int, int>(2, 2));
+    columns.push_back(std::pair<int, int>(5, 5));
+    uint32_t offset = m_tableSchema->columnOffset(2);
+    uint32_t length = m_tableSchema->columnOffset(5) + m_tableSchema->columnLength(5) - offset;
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->updateTupleInPlace(tuple, tupleCopy, columns, offset, length);
+    ASSERT_EQ(0, tuple.getNValue(2).compare(ValueFactory::getIntegerValue(42)));
+    ASSERT_EQ(0, tuple.getNValue(5).compare(ValueFactory::getDoubleValue(4.5)));
+
+    m_engine->undoUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(0, tuple.getNValue(2).compare(oldIntValue));
+    ASSERT_EQ(0, tuple.getNValue(5).compare(oldDoubleValue));
+    ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
+
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    m_table->updateTupleInPlace(tuple, tupleCopy, columns, offset, length);
+    m_engine->releaseUndoToken(INT64_MIN + 3);
+    ASSERT_EQ(0, tuple.getNValue(2).compare(ValueFactory::getIntegerValue(42)));
+
+    tupleCopy.freeObjectColumns();
+    delete [] tupleCopy.address();
+}
+
+TEST_F(PersistentTableLogTest, TruncateThenUndoTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+    voltdb::TableTuple tuple(m_tableSchema);
+    tableutil::getRandomTuple(m_table, tuple);
+
+    voltdb::TableTuple tupleBackup(m_tableSchema);
+    tupleBackup.move(new char[tupleBackup.tupleLength()]);
+    tupleBackup.copyForPersistentInsert(tuple);
+    StackCleaner cleaner(tupleBackup);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->truncateTable();
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->allocatedBlockCount());
+    ASSERT_EQ(0, m_table->primaryKeyIndex()->getSize());
+    ASSERT_TRUE(m_table->lookupTuple(tupleBackup).isNullTuple());
+
+    // inserts after the truncate are undone first
+    tableutil::addRandomTuples(m_table, 10);
+    ASSERT_EQ(10, m_table->activeTupleCount());
+
+    m_engine->undoUndoToken(INT64_MIN + 2);
+
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    ASSERT_EQ(1000, m_table->primaryKeyIndex()->getSize());
+    ASSERT_FALSE(m_table->lookupTuple(tupleBackup).isNullTuple());
+
+    // the index entries swapped back in keep taking updates
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    tableutil::addRandomTuples(m_table, 10);
+    ASSERT_EQ(1010, m_table->primaryKeyIndex()->getSize());
+    m_engine->releaseUndoToken(INT64_MIN + 3);
+}
+
+TEST_F(PersistentTableLogTest, TruncateThenReleaseTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->truncateTable();
+    m_engine->releaseUndoToken(INT64_MIN + 2);
+
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->nonInlinedMemorySize());
+
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    tableutil::addRandomTuples(m_table, 10);
+    ASSERT_EQ(10, m_table->activeTupleCount());
+    ASSERT_EQ(10, m_table->primaryKeyIndex()->getSize());
+}
+
+TEST_F(PersistentTableLogTest, DeleteTuplesThenUndoThenReleaseTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+
+    // pick every other tuple, in reverse storage order
+    std::vector<char*> addresses;
+    voltdb::TableTuple tuple(m_tableSchema);
+    TableIterator iter = m_table->iterator();
+    bool pick = true;
+    while (iter.next(tuple)) {
+        if (pick) {
+            addresses.insert(addresses.begin(), tuple.address());
+        }
+        pick = !pick;
+    }
+    ASSERT_EQ(500, addresses.size());
+    std::vector<char*> addressesCopy(addresses);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->deleteTuples(addresses, true);
+    ASSERT_EQ(500, m_table->visibleTupleCount());
+    ASSERT_EQ(500, m_table->primaryKeyIndex()->getSize());
+
+    m_engine->undoUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(1000, m_table->visibleTupleCount());
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    ASSERT_EQ(1000, m_table->primaryKeyIndex()->getSize());
+
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    m_table->deleteTuples(addressesCopy, true);
+    m_engine->releaseUndoToken(INT64_MIN + 3);
+    ASSERT_EQ(500, m_table->visibleTupleCount());
+    ASSERT_EQ(500, m_table->activeTupleCount());
+    ASSERT_EQ(500, m_table->primaryKeyIndex()->getSize());
+}
+
 TEST_F(PersistentTableLogTest, InsertThenUndoInsertsOneTest) {
     initTable(true);
     tableutil::addRandomTuples(m_table, 10);
@@ -318,33 +518,124 @@ TEST_F(PersistentTableLogTest, InsertThenUndoInsertsOneTest) {
 TEST_F(PersistentTableLogTest, FindBlockTest) {
     initTable(true);
     const int blockSize = m_table->getTableAllocationSize();
+    const int tupleLength = m_table->getTupleLength();
+    const int lastTuple = (m_table->getTuplesPerBlock() - 1) * tupleLength;
     TBBucketPtr bucket(new TBBucket());
 
-    // these will be used as artificial tuple block addresses
+    // The header and the tuples share a power of two of storage
+    ASSERT_EQ(0, blockSize & (blockSize - 1));
+    ASSERT_TRUE(TUPLE_BLOCK_HEADER_SIZE + lastTuple + tupleLength <= blockSize);
+
     TBPtr block1(new (ThreadLocalPool::getExact(sizeof(TupleBlock))->malloc()) TupleBlock(m_table, bucket));
     TBPtr block2(new (ThreadLocalPool::getExact(sizeof(TupleBlock))->malloc()) TupleBlock(m_table, bucket));
     TBPtr block3(new (ThreadLocalPool::getExact(sizeof(TupleBlock))->malloc()) TupleBlock(m_table, bucket));
 
+    // block2 is left out of the map
     TBMap blocks;
-    char *base = block1->address();
-
-    // block2 is adjacent to block1, block3 is 1 block away from block2
-    blocks.insert(base,                 block1);
-    blocks.insert(base + blockSize,     block2);
-    blocks.insert(base + blockSize * 3, block3);
+    blocks.insert(block1->address(), block1);
+    blocks.insert(block3->address(), block3);
 
-    // in the middle but land on a missing boundary
-    ASSERT_EQ(PersistentTable::findBlock(base + blockSize * 2, blocks, blockSize).get(), NULL);
-    // past the end but on a boundary
-    ASSERT_EQ(PersistentTable::findBlock(base + blockSize * 4, blocks, blockSize).get(), NULL);
+    ASSERT_EQ(PersistentTable::findBlock(block2->address(), blocks, blockSize).get(), NULL);
+    ASSERT_EQ(PersistentTable::findBlock(block2->address() + lastTuple, blocks, blockSize).get(), NULL);
 
     // the following tuples should be found in the map
-    ASSERT_EQ(PersistentTable::findBlock(base,                     blocks, blockSize)->address(),
-              block1->address());
-    ASSERT_EQ(PersistentTable::findBlock(base + blockSize - 1,     blocks, blockSize)->address(),
-              block1->address());
-    ASSERT_EQ(PersistentTable::findBlock(base + blockSize * 4 - 1, blocks, blockSize)->address(),
-              block3->address());
+    ASSERT_EQ(PersistentTable::findBlock(block1->address(), blocks, blockSize).get(), block1.get());
+    ASSERT_EQ(PersistentTable::findBlock(block1->address() + tupleLength, blocks, blockSize).get(),
+              block1.get());
+    ASSERT_EQ(PersistentTable::findBlock(block1->address() + lastTuple, blocks, blockSize).get(),
+              block1.get());
+    ASSERT_EQ(PersistentTable::findBlock(block3->address() + lastTuple, blocks, blockSize).get(),
+              block3.get());
+
+    // and the table finds its own blocks without a map
+    tableutil::addRandomTuples(m_table, 1000);
+    voltdb::TableTuple tuple(m_tableSchema);
+    voltdb::TableIterator iterator = m_table->iterator();
+    while (iterator.next(tuple)) {
+        TBPtr block = m_table->findBlock(tuple.address());
+        ASSERT_TRUE(block->address() <= tuple.address());
+        ASSERT_TRUE(tuple.address() < block->address() + blockSize);
+    }
+}
+
+TEST_F(PersistentTableLogTest, PurgeExpiredTuplesTest) {
+    m_tableSchemaTypes[3] = voltdb::VALUE_TYPE_TIMESTAMP;
+    initTable(true);
+    std::vector<int> timestampColumn(1, 3);
+    voltdb::TableIndexScheme timestampScheme("timestampIndex",
+                                             voltdb::BALANCED_TREE_INDEX,
+                                             timestampColumn,
+                                             TableIndex::simplyIndexColumns(),
+                                             false, false, m_tableSchema);
+    TableIndex *timestampIndex = TableIndexFactory::getInstance(timestampScheme);
+    m_table->addIndex(timestampIndex);
+
+    // a tuple stamped each second for 100 seconds, and one never stamped
+    for (int i = 0; i <= 100; ++i) {
+        voltdb::TableTuple &tuple = m_table->tempTuple();
+        tableutil::setRandomTupleValues(m_table, &tuple);
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        tuple.setNValue(3, i < 100 ? ValueFactory::getTimestampValue(i * 1000000LL) :
+                                     NValue::getNullValue(VALUE_TYPE_TIMESTAMP));
+        ASSERT_TRUE(m_table->insertTuple(tuple));
+        for (int ii = 0; ii < m_tableSchema->getUninlinedObjectColumnCount(); ii++) {
+            tuple.getNValue(m_tableSchema->getUninlinedObjectColumnInfoIndex(ii)).free();
+        }
+    }
+    m_engine->releaseUndoToken(INT64_MIN + 1);
+
+    // purges run in a transaction
+    m_engine->setUndoToken(INT64_MIN + 2);
+
+    // nothing expires without a time to live
+    ASSERT_EQ(0, m_table->purgeExpiredTuples(50000, 1000));
+
+    // at 50 seconds with 10 to live, the 40 tuples stamped before 40 expire
+    m_table->setTimeToLive(3, 10);
+    ASSERT_EQ(25, m_table->purgeExpiredTuples(50000, 25));
+    ASSERT_EQ(15, m_table->purgeExpiredTuples(50000, 25));
+    ASSERT_EQ(0, m_table->purgeExpiredTuples(50000, 25));
+    // counted only once the transaction commits
+    ASSERT_EQ(0, m_table->expiredTupleCount());
+    m_engine->releaseUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(40, m_table->expiredTupleCount());
+    ASSERT_EQ(61, m_table->activeTupleCount());
+    ASSERT_EQ(61, m_table->primaryKeyIndex()->getSize());
+    ASSERT_EQ(61, timestampIndex->getSize());
+
+    voltdb::TableTuple tuple(m_tableSchema);
+    TableIterator iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        ASSERT_TRUE(ValuePeeker::peekAsBigInt(tuple.getNValue(0)) >= 40);
+    }
+
+    // a purge is undone with the transaction it ran in
+    m_engine->setUndoToken(INT64_MIN + 3);
+    ASSERT_EQ(60, m_table->purgeExpiredTuples(1000000, 1000));
+    m_engine->undoUndoToken(INT64_MIN + 3);
+    ASSERT_EQ(40, m_table->expiredTupleCount());
+    ASSERT_EQ(61, m_table->activeTupleCount());
+    ASSERT_EQ(61, timestampIndex->getSize());
+    int64_t restoredIds = 0;
+    iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        restoredIds += ValuePeeker::peekAsBigInt(tuple.getNValue(0));
+    }
+    // 40 + 41 + ... + 100
+    ASSERT_EQ(4270, restoredIds);
+
+    // the unstamped tuple outlives them all
+    m_engine->setUndoToken(INT64_MIN + 4);
+    ASSERT_EQ(60, m_table->purgeExpiredTuples(1000000, 1000));
+    ASSERT_EQ(0, m_table->purgeExpiredTuples(1000000, 1000));
+    m_engine->releaseUndoToken(INT64_MIN + 4);
+    ASSERT_EQ(100, m_table->expiredTupleCount());
+    ASSERT_EQ(1, m_table->activeTupleCount());
+    ASSERT_EQ(1, timestampIndex->getSize());
+    iter = m_table->iterator();
+    ASSERT_TRUE(iter.next(tuple));
+    ASSERT_EQ(100, ValuePeeker::peekAsBigInt(tuple.getNValue(0)));
+    ASSERT_TRUE(tuple.getNValue(3).isNull());
 }
 
 int main() {
@@ -187,6 +187,30 @@ TEST_F(TableTest, TupleInsert) {
     }
 }
 
+TEST_F(TableTest, ScanByBlock) {
+    //
+    // A block at a time scan sees the same tuples as a tuple at a time one
+    //
+    vector<char*> expected;
+    TableIterator iterator = this->table->iterator();
+    TableTuple tuple(table->schema());
+    while (iterator.next(tuple)) {
+        expected.push_back(tuple.address());
+    }
+
+    vector<char*> scanned;
+    TableIterator blocks = this->table->iterator();
+    TupleBlockSpan span;
+    while (blocks.nextBlock(span)) {
+        ASSERT_TRUE(span.dense);
+        for (uint32_t slot = 0; slot < span.count; ++slot) {
+            scanned.push_back(span.tupleAddress(slot));
+        }
+    }
+    ASSERT_EQ(NUM_OF_TUPLES, scanned.size());
+    ASSERT_TRUE(expected == scanned);
+}
+
 /* updateTuple in TempTable is not supported because it is not required in the product.
 TEST_F(TableTest, TupleUpdate) {
     //
@@ -755,6 +755,104 @@ TEST_F(CompactingMapTest, RandomMulti) {
     // std::cout << "UpperBounds: " << upperBounds << " ub greatest chain: " << ub_greatestChain << std::endl;
 }
 
+TEST_F(CompactingMapTest, BulkLoad) {
+    srand(0);
+    // every tree shape from a lone root up to a few full levels
+    for (int count = 0; count < 70; count++) {
+        std::vector<std::pair<int,int> > entries;
+        for (int i = 0; i < count; i++) {
+            entries.push_back(std::pair<int,int>(i * 2, i));
+        }
+        std::random_shuffle(entries.begin(), entries.end());
+
+        voltdb::CompactingMap<int, int, IntComparator, true> volt(true, IntComparator());
+        ASSERT_TRUE(volt.bulkLoad(entries));
+        ASSERT_EQ(count, volt.size());
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+
+        voltdb::CompactingMap<int, int, IntComparator, true>::iterator iter = volt.begin();
+        for (int i = 0; i < count; i++) {
+            ASSERT_FALSE(iter.isEnd());
+            ASSERT_EQ(i * 2, iter.key());
+            ASSERT_EQ(i, iter.value());
+            iter.moveNext();
+        }
+        ASSERT_TRUE(iter.isEnd());
+
+        // the loaded tree keeps working as a normal one
+        for (int i = 0; i < count; i++) {
+            ASSERT_TRUE(volt.insert(std::pair<int,int>(i * 2 + 1, i)));
+            if (rand() % 2) {
+                ASSERT_TRUE(volt.erase(i * 2));
+            }
+        }
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+    }
+
+    // unique maps refuse equal keys and stay empty
+    std::vector<std::pair<int,int> > duplicates;
+    for (int i = 0; i < 100; i++) {
+        duplicates.push_back(std::pair<int,int>(i % 50, i));
+    }
+    voltdb::CompactingMap<int, int, IntComparator> unique(true, IntComparator());
+    ASSERT_FALSE(unique.bulkLoad(duplicates));
+    ASSERT_EQ(0, unique.size());
+
+    voltdb::CompactingMap<int, int, IntComparator> multi(false, IntComparator());
+    ASSERT_TRUE(multi.bulkLoad(duplicates));
+    ASSERT_EQ(100, multi.size());
+    ASSERT_TRUE(multi.verify());
+    voltdb::CompactingMap<int, int, IntComparator>::iterator lower = multi.lowerBound(7);
+    voltdb::CompactingMap<int, int, IntComparator>::iterator upper = multi.upperBound(7);
+    int matches = 0;
+    while (!lower.equals(upper)) {
+        ASSERT_EQ(7, lower.key());
+        ++matches;
+        lower.moveNext();
+    }
+    ASSERT_EQ(2, matches);
+}
+
+TEST_F(CompactingMapTest, Swap) {
+    voltdb::CompactingMap<int, int, IntComparator, true> full(true, IntComparator());
+    voltdb::CompactingMap<int, int, IntComparator, true> empty(true, IntComparator());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(full.insert(std::pair<int,int>(i, i * 3)));
+    }
+
+    empty.swap(full);
+    ASSERT_EQ(0, full.size());
+    ASSERT_TRUE(full.begin().isEnd());
+    ASSERT_EQ(1000, empty.size());
+    ASSERT_TRUE(empty.verify());
+    ASSERT_TRUE(empty.verifyRank());
+
+    // both maps keep working on their own nodes
+    ASSERT_TRUE(full.insert(std::pair<int,int>(7, 7)));
+    ASSERT_TRUE(full.verify());
+    for (int i = 0; i < 1000; i += 2) {
+        ASSERT_TRUE(empty.erase(i));
+    }
+    ASSERT_TRUE(empty.verify());
+    ASSERT_TRUE(empty.verifyRank());
+
+    // and swap back
+    empty.swap(full);
+    ASSERT_EQ(1, empty.size());
+    ASSERT_EQ(500, full.size());
+    ASSERT_TRUE(full.verify());
+    voltdb::CompactingMap<int, int, IntComparator, true>::iterator iter = full.begin();
+    for (int i = 1; i < 1000; i += 2) {
+        ASSERT_FALSE(iter.isEnd());
+        ASSERT_EQ(i, iter.key());
+        ASSERT_EQ(i * 3, iter.value());
+        iter.moveNext();
+    }
+    ASSERT_TRUE(iter.isEnd());
+}
+
 // ENG-1057
 //
 // I have commented this out intentionally.  It demonstrates that the
@@ -3060,6 +3060,32 @@ public class TestVoltCompiler extends TestCase {
         assertFalse(success);
     }
 
+    public void testExpireTable() {
+        final String table =
+            "create table t (id integer not null, name varchar(32), ts timestamp);\n" +
+            "create index t_ts on t (ts);\n" +
+            "create index t_id on t (id);\n" +
+            "partition table t on column id;\n";
+
+        // a TIMESTAMP column leading a tree index
+        VoltCompiler compiler = compileForDDLTest(getPathForSchema(
+                table + "EXPIRE TABLE t ON COLUMN ts AFTER 60 SECONDS;\n"), true);
+        Table catTable = compiler.getCatalog().getClusters().get("cluster")
+                .getDatabases().get("database").getTables().getIgnoreCase("t");
+        assertEquals("TS", catTable.getTtlcolumn().getTypeName());
+        assertEquals(60, catTable.getTtlseconds());
+
+        checkDDLErrorMessage(table + "EXPIRE TABLE t ON COLUMN id AFTER 60 SECONDS;\n",
+                "Time to live column 'T.id' is not a TIMESTAMP.");
+        checkDDLErrorMessage(table + "EXPIRE TABLE t ON COLUMN ts AFTER 0 SECONDS;\n",
+                "the time to live must be from 1 to");
+
+        // a replicated table can't be purged a partition at a time
+        checkDDLErrorMessage(table.replace("partition table t on column id;\n", "") +
+                "EXPIRE TABLE t ON COLUMN ts AFTER 60 SECONDS;\n",
+                "EXPIRE TABLE 'T' is replicated");
+    }
+
     private int countStringsMatching(List<String> diagnostics, String pattern) {
         int count = 0;
         for (String string : diagnostics) {